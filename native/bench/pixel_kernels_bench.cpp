@@ -0,0 +1,202 @@
+// 像素内核基准：先校验各指令集实现与标量版本逐位一致，再在 16..1024 px 的方形图像上
+// 与 icon_thumbnail.cpp 原有的逐像素循环对比耗时。
+// 构建：node-gyp rebuild --build_bench=1，运行 build/Release/pixel_kernels_bench
+
+#include "../src/pixel_kernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+
+// 原 SaveBitmapToBuffer：逐字节复制 alpha，按行号处理上下颠倒
+void LegacyMergeAlpha(uint8_t* target, const uint8_t* source, int width, int height, bool bottomUp) {
+    for (int y = 0; y < height; y++) {
+        int sourceY = bottomUp ? (height - 1 - y) : y;
+        const uint8_t* src = source + static_cast<size_t>(sourceY) * width * 4;
+        uint8_t* dst = target + static_cast<size_t>(y) * width * 4;
+        for (int x = 0; x < width; x++) {
+            dst[x * 4 + 3] = src[x * 4 + 3];
+        }
+    }
+}
+
+// 原 ProcessBlackEdgesToTransparent：遍历整张图，只修改边上的黑色像素
+void LegacyBlackEdges(uint8_t* pixels, int width, int height) {
+    for (int y = 0; y < height; y++) {
+        uint8_t* row = pixels + static_cast<size_t>(y) * width * 4;
+        for (int x = 0; x < width; x++) {
+            if (x == 0 || x == width - 1 || y == 0 || y == height - 1) {
+                uint8_t* pixel = row + x * 4;
+                if (pixel[2] == 0 && pixel[1] == 0 && pixel[0] == 0) {
+                    pixel[3] = 0;
+                }
+            }
+        }
+    }
+}
+
+// 原 EncodePngStored 的 BGRA -> RGBA 转换
+void LegacySwizzle(uint8_t* dst, const uint8_t* src, size_t count) {
+    for (size_t x = 0; x < count; x++) {
+        dst[x * 4 + 0] = src[x * 4 + 2];
+        dst[x * 4 + 1] = src[x * 4 + 1];
+        dst[x * 4 + 2] = src[x * 4 + 0];
+        dst[x * 4 + 3] = src[x * 4 + 3];
+    }
+}
+
+// 多次运行取最快一次的单次耗时（微秒）
+double Measure(const std::function<void()>& body, size_t pixels) {
+    int iterations = static_cast<int>(std::max<size_t>(4, (1u << 24) / std::max<size_t>(pixels, 1)));
+    double best = 1e30;
+    for (int round = 0; round < 5; round++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            body();
+        }
+        double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, elapsed / iterations);
+    }
+    return best;
+}
+
+bool Verify(const PixelKernels& kernels) {
+    const PixelKernels& scalar = GetScalarPixelKernels();
+    bool ok = true;
+
+    // 反预乘用全部 (c, a) 组合校验，其余内核用随机数据和各种尾部长度
+    std::vector<uint8_t> all(256 * 256 * 4);
+    for (int a = 0; a < 256; a++) {
+        for (int c = 0; c < 256; c++) {
+            uint8_t* p = all.data() + (a * 256 + c) * 4;
+            p[0] = static_cast<uint8_t>(c);
+            p[1] = static_cast<uint8_t>(255 - c);
+            p[2] = static_cast<uint8_t>(c ^ 0x5A);
+            p[3] = static_cast<uint8_t>(a);
+        }
+    }
+    std::vector<uint8_t> expected(all.size()), actual(all.size());
+    scalar.unpremultiply(expected.data(), all.data(), 65536);
+    kernels.unpremultiply(actual.data(), all.data(), 65536);
+    ok = ok && expected == actual;
+    scalar.premultiply(expected.data(), all.data(), 65536);
+    kernels.premultiply(actual.data(), all.data(), 65536);
+    ok = ok && expected == actual;
+
+    std::mt19937 random(42);
+    for (size_t count = 0; count < 70 && ok; count++) {
+        std::vector<uint8_t> source(count * 4), other(count * 4);
+        for (auto& byte : source) byte = static_cast<uint8_t>(random() & (random() & 1 ? 0xFF : 0x03));
+        for (auto& byte : other) byte = static_cast<uint8_t>(random());
+        std::vector<uint8_t> a = other, b = other;
+
+        scalar.mergeAlpha(a.data(), source.data(), count);
+        kernels.mergeAlpha(b.data(), source.data(), count);
+        ok = ok && a == b;
+
+        scalar.swizzle(a.data(), source.data(), count);
+        kernels.swizzle(b.data(), source.data(), count);
+        ok = ok && a == b;
+
+        a = source;
+        b = source;
+        scalar.keyRow(a.data(), count, 0x000000);
+        kernels.keyRow(b.data(), count, 0x000000);
+        ok = ok && a == b;
+
+        a = source;
+        b = other;
+        std::vector<uint8_t> c = source, d = other;
+        kernels.swapBytes(a.data(), b.data(), a.size());
+        ok = ok && a == d && b == c;
+    }
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    std::vector<const PixelKernels*> available = GetAvailablePixelKernels();
+    printf("selected: %s\n", GetPixelKernels().name);
+    for (const PixelKernels* kernels : available) {
+        bool ok = Verify(*kernels);
+        printf("verify %-6s %s\n", kernels->name, ok ? "ok" : "MISMATCH");
+        if (!ok) {
+            return 1;
+        }
+    }
+
+    printf("\n%-12s %6s %10s", "kernel", "size", "legacy(us)");
+    for (const PixelKernels* kernels : available) {
+        printf(" %9s", kernels->name);
+    }
+    printf("\n");
+
+    std::mt19937 random(7);
+    for (int size = 16; size <= 1024; size *= 2) {
+        size_t pixels = static_cast<size_t>(size) * size;
+        size_t stride = static_cast<size_t>(size) * 4;
+        std::vector<uint8_t> source(pixels * 4), target(pixels * 4);
+        for (auto& byte : source) byte = static_cast<uint8_t>(random() & 0x0F);
+
+        struct Row {
+            const char* name;
+            std::function<void()> legacy;
+            std::function<void(const PixelKernels&)> kernel;
+        };
+        Row rows[] = {
+            { "alpha-merge",
+              [&] { LegacyMergeAlpha(target.data(), source.data(), size, size, true); },
+              [&](const PixelKernels& k) {
+                  for (int y = 0; y < size; y++) {
+                      k.mergeAlpha(target.data() + stride * y, source.data() + stride * (size - 1 - y), size);
+                  }
+              } },
+            { "border-key",
+              [&] { LegacyBlackEdges(target.data(), size, size); },
+              [&](const PixelKernels& k) {
+                  k.keyRow(target.data(), size, 0);
+                  k.keyRow(target.data() + stride * (size - 1), size, 0);
+                  // 与 KeyBorder 相同，两侧的单个像素用标量处理
+                  const PixelKernels& scalar = GetScalarPixelKernels();
+                  for (int y = 1; y < size - 1; y++) {
+                      scalar.keyRow(target.data() + stride * y, 1, 0);
+                      scalar.keyRow(target.data() + stride * y + stride - 4, 1, 0);
+                  }
+              } },
+            { "swizzle",
+              [&] { LegacySwizzle(target.data(), source.data(), pixels); },
+              [&](const PixelKernels& k) { k.swizzle(target.data(), source.data(), pixels); } },
+            { "premultiply", nullptr,
+              [&](const PixelKernels& k) { k.premultiply(target.data(), source.data(), pixels); } },
+            { "unpremult", nullptr,
+              [&](const PixelKernels& k) { k.unpremultiply(target.data(), source.data(), pixels); } },
+            { "flip", nullptr,
+              [&](const PixelKernels& k) {
+                  for (int top = 0, bottom = size - 1; top < bottom; top++, bottom--) {
+                      k.swapBytes(target.data() + stride * top, target.data() + stride * bottom, stride);
+                  }
+              } },
+        };
+
+        for (const Row& row : rows) {
+            printf("%-12s %6d", row.name, size);
+            if (row.legacy) {
+                printf(" %10.2f", Measure(row.legacy, pixels));
+            } else {
+                printf(" %10s", "-");
+            }
+            for (const PixelKernels* kernels : available) {
+                printf(" %9.2f", Measure([&] { row.kernel(*kernels); }, pixels));
+            }
+            printf("\n");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,238 @@
+// PNG 编码基准：各级别的输出先用 DecodePng 解码校验与源像素逐位一致，再在 16..1024 px 的
+// 合成图标上与原有输出路径对比耗时和体积：
+// - legacy：原 EncodePngStored，再加上 buffer.assign 和 Napi::Buffer::Copy 的两次复制
+// - gdi+：（仅 Windows）Bitmap::Save 到 HGLOBAL 上的 IStream，GlobalLock 后两次复制
+// 构建：node-gyp rebuild --build_bench=1，运行 build/Release/png_encoder_bench
+
+#include "../src/png_codec.h"
+#include "../src/png_encoder.h"
+#include "../src/pixel_kernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <objidl.h>
+#include <gdiplus.h>
+#endif
+
+namespace {
+
+void WriteBe32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// 原 EncodePngStored：先生成完整的滤波数据，再逐块插入输出
+bool LegacyEncodePngStored(const BgraImage& image, std::vector<uint8_t>& output) {
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    size_t rowBytes = static_cast<size_t>(image.width) * 4 + 1;
+    std::vector<uint8_t> raw(rowBytes * image.height);
+    const PixelKernels& kernels = GetPixelKernels();
+    for (int y = 0; y < image.height; y++) {
+        uint8_t* dst = raw.data() + rowBytes * y;
+        dst[0] = 0;
+        kernels.swizzle(dst + 1, image.Row(y), image.width);
+    }
+
+    auto beginChunk = [&output](const char* type, uint32_t length) {
+        WriteBe32(output, length);
+        output.insert(output.end(), type, type + 4);
+        return output.size() - 4;
+    };
+    auto endChunk = [&output](size_t start) {
+        WriteBe32(output, Crc32(0, output.data() + start, output.size() - start));
+    };
+
+    size_t blocks = (raw.size() + 65534) / 65535;
+    size_t zlibSize = 2 + raw.size() + blocks * 5 + 4;
+    output.clear();
+    output.reserve(8 + 25 + 12 + zlibSize + 12);
+    output.insert(output.end(), signature, signature + 8);
+    size_t start = beginChunk("IHDR", 13);
+    WriteBe32(output, static_cast<uint32_t>(image.width));
+    WriteBe32(output, static_cast<uint32_t>(image.height));
+    const uint8_t ihdrTail[5] = { 8, 6, 0, 0, 0 };
+    output.insert(output.end(), ihdrTail, ihdrTail + 5);
+    endChunk(start);
+    start = beginChunk("IDAT", static_cast<uint32_t>(zlibSize));
+    output.push_back(0x78);
+    output.push_back(0x01);
+    for (size_t offset = 0; offset < raw.size(); offset += 65535) {
+        size_t length = std::min<size_t>(raw.size() - offset, 65535);
+        output.push_back(offset + length == raw.size() ? 1 : 0);
+        output.push_back(static_cast<uint8_t>(length));
+        output.push_back(static_cast<uint8_t>(length >> 8));
+        output.push_back(static_cast<uint8_t>(~length));
+        output.push_back(static_cast<uint8_t>(~length >> 8));
+        output.insert(output.end(), raw.begin() + offset, raw.begin() + offset + length);
+    }
+    WriteBe32(output, Adler32(1, raw.data(), raw.size()));
+    endChunk(start);
+    start = beginChunk("IEND", 0);
+    endChunk(start);
+    return true;
+}
+
+#ifdef _WIN32
+CLSID PngEncoderClsid() {
+    UINT num = 0, size = 0;
+    Gdiplus::GetImageEncodersSize(&num, &size);
+    std::vector<uint8_t> storage(size);
+    auto* codecs = reinterpret_cast<Gdiplus::ImageCodecInfo*>(storage.data());
+    Gdiplus::GetImageEncoders(num, size, codecs);
+    for (UINT i = 0; i < num; i++) {
+        if (wcscmp(codecs[i].MimeType, L"image/png") == 0) return codecs[i].Clsid;
+    }
+    return CLSID_NULL;
+}
+
+// 原 Windows 路径：GDI+ 编码到 IStream，GlobalLock 后复制到 vector
+bool LegacyEncodeGdiPlus(const BgraImage& image, std::vector<uint8_t>& output) {
+    static const CLSID clsid = PngEncoderClsid();
+    Gdiplus::Bitmap bitmap(image.width, image.height, image.width * 4, PixelFormat32bppARGB,
+                           const_cast<BYTE*>(image.pixels.data()));
+    IStream* stream = NULL;
+    if (CreateStreamOnHGlobal(NULL, TRUE, &stream) != S_OK) return false;
+    bool ok = false;
+    if (bitmap.Save(stream, &clsid, NULL) == Gdiplus::Ok) {
+        STATSTG stat;
+        HGLOBAL global = NULL;
+        if (stream->Stat(&stat, STATFLAG_NONAME) == S_OK && GetHGlobalFromStream(stream, &global) == S_OK) {
+            BYTE* data = (BYTE*)GlobalLock(global);
+            if (data) {
+                output.assign(data, data + stat.cbSize.QuadPart);
+                GlobalUnlock(global);
+                ok = true;
+            }
+        }
+    }
+    stream->Release();
+    return ok;
+}
+#endif
+
+// 合成图标：圆形渐变（透明背景 + 抗锯齿边）、像素画（大块纯色）、噪声照片（难以压缩）
+BgraImage MakeImage(int size, int kind, std::mt19937& random) {
+    BgraImage image;
+    image.Allocate(size, size);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            uint8_t* p = image.Row(y) + x * 4;
+            if (kind == 0) {
+                double dx = x + 0.5 - size / 2.0, dy = y + 0.5 - size / 2.0;
+                double edge = size / 2.0 - std::sqrt(dx * dx + dy * dy);
+                int alpha = static_cast<int>(std::max(0.0, std::min(1.0, edge)) * 255);
+                p[0] = static_cast<uint8_t>(alpha ? x * 255 / size : 0);
+                p[1] = static_cast<uint8_t>(alpha ? y * 255 / size : 0);
+                p[2] = static_cast<uint8_t>(alpha ? 160 : 0);
+                p[3] = static_cast<uint8_t>(alpha);
+            } else if (kind == 1) {
+                int cell = std::max(1, size / 16);
+                int index = (x / cell) * 7 + (y / cell) * 13;
+                p[0] = static_cast<uint8_t>(index * 37);
+                p[1] = static_cast<uint8_t>(index * 91);
+                p[2] = static_cast<uint8_t>(index * 53);
+                p[3] = ((x / cell) + (y / cell)) % 5 == 0 ? 0 : 255;
+            } else {
+                p[0] = static_cast<uint8_t>(x + (random() & 15));
+                p[1] = static_cast<uint8_t>(y + (random() & 15));
+                p[2] = static_cast<uint8_t>(random());
+                p[3] = 255;
+            }
+        }
+    }
+    return image;
+}
+
+// 多次运行取最快一次的单次耗时（微秒）
+double Measure(const std::function<void()>& body, size_t pixels) {
+    int iterations = static_cast<int>(std::max<size_t>(2, (1u << 20) / std::max<size_t>(pixels, 1)));
+    double best = 1e30;
+    for (int round = 0; round < 3; round++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            body();
+        }
+        double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, elapsed / iterations);
+    }
+    return best;
+}
+
+} // namespace
+
+int main() {
+    const char* kinds[] = { "circle", "pixel", "noise" };
+    const PngLevel levels[] = { PngLevel::Stored, PngLevel::Fast, PngLevel::Default, PngLevel::Small };
+    const char* levelNames[] = { "stored", "fast", "default", "small" };
+
+#ifdef _WIN32
+    ULONG_PTR token = 0;
+    Gdiplus::GdiplusStartupInput input;
+    Gdiplus::GdiplusStartup(&token, &input, NULL);
+#endif
+
+    std::mt19937 random(7);
+    bool allOk = true;
+    printf("%-7s %5s %18s", "image", "size", "legacy us/bytes");
+#ifdef _WIN32
+    printf(" %18s", "gdi+ us/bytes");
+#endif
+    for (const char* name : levelNames) {
+        printf(" %18s", name);
+    }
+    printf("\n");
+
+    for (int size = 16; size <= 1024; size *= 2) {
+        for (int kind = 0; kind < 3; kind++) {
+            BgraImage image = MakeImage(size, kind, random);
+            size_t pixels = static_cast<size_t>(size) * size;
+            std::vector<uint8_t> output;
+
+            // 原路径的结果还要复制两次才能交给 JS
+            auto legacy = [&] {
+                LegacyEncodePngStored(image, output);
+                std::vector<uint8_t> assigned(output.begin(), output.end());
+                std::vector<uint8_t> copied(assigned.begin(), assigned.end());
+            };
+            double us = Measure(legacy, pixels);
+            printf("%-7s %5d %9.1f/%-8zu", kinds[kind], size, us, output.size());
+#ifdef _WIN32
+            auto gdiplus = [&] {
+                LegacyEncodeGdiPlus(image, output);
+                std::vector<uint8_t> copied(output.begin(), output.end());
+            };
+            us = Measure(gdiplus, pixels);
+            printf(" %9.1f/%-8zu", us, output.size());
+#endif
+            for (PngLevel level : levels) {
+                us = Measure([&] { EncodePng(image, level, output); }, pixels);
+                BgraImage decoded;
+                bool ok = DecodePng(output.data(), output.size(), decoded) && decoded.width == image.width &&
+                          decoded.height == image.height && decoded.pixels == image.pixels;
+                allOk = allOk && ok;
+                printf(" %9.1f/%-8zu", us, output.size());
+                if (!ok) {
+                    printf("MISMATCH");
+                }
+            }
+            printf("\n");
+        }
+    }
+
+#ifdef _WIN32
+    Gdiplus::GdiplusShutdown(token);
+#endif
+    printf("\nround-trip %s\n", allOk ? "ok" : "MISMATCH");
+    return allOk ? 0 : 1;
+}
@@ -1,4 +1,8 @@
 {
+  "variables": {
+    "build_bench%": 0,
+    "build_tests%": 0
+  },
   "targets": [
     {
       "target_name": "app_launcher",
@@ -26,7 +30,17 @@
     {
       "target_name": "icon_thumbnail",
       "sources": [
-        "src/icon_thumbnail.cpp"
+        "src/icon_thumbnail.cpp",
+        "src/icon_extractor.cpp",
+        "src/png_codec.cpp",
+        "src/png_encoder.cpp",
+        "src/image_formats.cpp",
+        "src/icon_atlas.cpp",
+        "src/icon_atlas_bindings.cpp",
+        "src/bgra_image.cpp",
+        "src/thumbnail_cache.cpp",
+        "src/thumbnail_pool.cpp",
+        "src/pixel_kernels.cpp"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")"
@@ -61,5 +75,179 @@
       ]
       
     }
+  ],
+  "conditions": [
+    ["build_bench!=0", {
+      "targets": [
+        {
+          "target_name": "pixel_kernels_bench",
+          "type": "executable",
+          "sources": [
+            "bench/pixel_kernels_bench.cpp",
+            "src/pixel_kernels.cpp"
+          ],
+          "cflags!": ["-fno-exceptions"],
+          "cflags_cc!": ["-fno-exceptions"],
+          "xcode_settings": {
+            "GCC_ENABLE_CPP_EXCEPTIONS": "YES"
+          },
+          "msvs_settings": {
+            "VCCLCompilerTool": {
+              "AdditionalOptions": ["/EHsc", "/utf-8"]
+            }
+          }
+        },
+        {
+          "target_name": "png_encoder_bench",
+          "type": "executable",
+          "sources": [
+            "bench/png_encoder_bench.cpp",
+            "src/png_encoder.cpp",
+            "src/png_codec.cpp",
+            "src/bgra_image.cpp",
+            "src/pixel_kernels.cpp"
+          ],
+          "cflags!": ["-fno-exceptions"],
+          "cflags_cc!": ["-fno-exceptions"],
+          "xcode_settings": {
+            "GCC_ENABLE_CPP_EXCEPTIONS": "YES"
+          },
+          "msvs_settings": {
+            "VCCLCompilerTool": {
+              "AdditionalOptions": ["/EHsc", "/utf-8"]
+            }
+          },
+          "conditions": [
+            ["OS=='win'", {
+              "libraries": ["-lgdiplus", "-lOle32"]
+            }]
+          ]
+        }
+      ]
+    }],
+    ["build_tests!=0 and OS!='win'", {
+      "targets": [
+        {
+          "target_name": "png_encoder_test",
+          "type": "executable",
+          "sources": [
+            "test/png_encoder_test.cpp",
+            "src/png_encoder.cpp",
+            "src/png_codec.cpp",
+            "src/bgra_image.cpp",
+            "src/pixel_kernels.cpp"
+          ],
+          "cflags!": ["-fno-exceptions"],
+          "cflags_cc!": ["-fno-exceptions"],
+          "xcode_settings": {
+            "GCC_ENABLE_CPP_EXCEPTIONS": "YES"
+          },
+          "libraries": ["-lpng", "-lz"]
+        }
+      ]
+    }],
+    ["build_tests!=0", {
+      "targets": [
+        {
+          "target_name": "icon_extractor_test",
+          "type": "executable",
+          "sources": [
+            "test/icon_extractor_test.cpp",
+            "src/icon_extractor.cpp",
+            "src/png_encoder.cpp",
+            "src/png_codec.cpp",
+            "src/bgra_image.cpp",
+            "src/pixel_kernels.cpp"
+          ],
+          "cflags!": ["-fno-exceptions"],
+          "cflags_cc!": ["-fno-exceptions"],
+          "xcode_settings": {
+            "GCC_ENABLE_CPP_EXCEPTIONS": "YES"
+          },
+          "msvs_settings": {
+            "VCCLCompilerTool": {
+              "AdditionalOptions": ["/EHsc", "/utf-8"]
+            }
+          }
+        },
+        {
+          "target_name": "image_formats_test",
+          "type": "executable",
+          "sources": [
+            "test/image_formats_test.cpp",
+            "src/image_formats.cpp",
+            "src/png_encoder.cpp",
+            "src/png_codec.cpp",
+            "src/bgra_image.cpp",
+            "src/pixel_kernels.cpp"
+          ],
+          "cflags!": ["-fno-exceptions"],
+          "cflags_cc!": ["-fno-exceptions"],
+          "xcode_settings": {
+            "GCC_ENABLE_CPP_EXCEPTIONS": "YES"
+          },
+          "msvs_settings": {
+            "VCCLCompilerTool": {
+              "AdditionalOptions": ["/EHsc", "/utf-8"]
+            }
+          }
+        },
+        {
+          "target_name": "icon_atlas_test",
+          "type": "executable",
+          "sources": [
+            "test/icon_atlas_test.cpp",
+            "src/icon_atlas.cpp"
+          ],
+          "cflags!": ["-fno-exceptions"],
+          "cflags_cc!": ["-fno-exceptions"],
+          "xcode_settings": {
+            "GCC_ENABLE_CPP_EXCEPTIONS": "YES"
+          },
+          "msvs_settings": {
+            "VCCLCompilerTool": {
+              "AdditionalOptions": ["/EHsc", "/utf-8"]
+            }
+          }
+        },
+        {
+          "target_name": "pixel_kernels_test",
+          "type": "executable",
+          "sources": [
+            "test/pixel_kernels_test.cpp",
+            "src/pixel_kernels.cpp"
+          ],
+          "cflags!": ["-fno-exceptions"],
+          "cflags_cc!": ["-fno-exceptions"],
+          "xcode_settings": {
+            "GCC_ENABLE_CPP_EXCEPTIONS": "YES"
+          },
+          "msvs_settings": {
+            "VCCLCompilerTool": {
+              "AdditionalOptions": ["/EHsc", "/utf-8"]
+            }
+          }
+        },
+        {
+          "target_name": "resampler_test",
+          "type": "executable",
+          "sources": [
+            "test/resampler_test.cpp",
+            "src/bgra_image.cpp",
+            "src/pixel_kernels.cpp"
+          ],
+          "cflags!": ["-fno-exceptions"],
+          "cflags_cc!": ["-fno-exceptions"],
+          "xcode_settings": {
+            "GCC_ENABLE_CPP_EXCEPTIONS": "YES"
+          },
+          "msvs_settings": {
+            "VCCLCompilerTool": {
+              "AdditionalOptions": ["/EHsc", "/utf-8"]
+            }
+          }
+        }
+      ]
+    }]
   ]
-}
\ No newline at end of file
+}
@@ -4,6 +4,8 @@
 #include <chrono>
 #include <thread>
 #include <mutex>
+#include <vector>
+#include <memory>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -13,6 +15,7 @@
 #include <sys/wait.h>
 #include <signal.h>
 #include <unistd.h>
+#include <cerrno>
 #endif
 
 class AppLauncher {
@@ -21,10 +24,70 @@ private:
     std::map<std::string, std::chrono::system_clock::time_point> startTimes_;
     std::mutex mutex_;
 
+    // 进程表的不可变快照，查询只原子加载快照，不获取 mutex_
+    struct ProcessEntry {
+        uint32_t processId;
+        std::chrono::system_clock::time_point startTime;
+    };
+    using ProcessTable = std::map<std::string, ProcessEntry>;
+    std::shared_ptr<const ProcessTable> snapshot_ = std::make_shared<ProcessTable>();
+
+    // 修改 runningProcesses_/startTimes_ 后调用（需持有 mutex_）
+    void PublishSnapshot() {
+        auto table = std::make_shared<ProcessTable>();
+        for (const auto& pair : runningProcesses_) {
+            (*table)[pair.first] = ProcessEntry{ pair.second, startTimes_[pair.first] };
+        }
+        std::atomic_store(&snapshot_, std::shared_ptr<const ProcessTable>(std::move(table)));
+    }
+
+    // 进程仍在运行时返回 true；Unix 下已结束的子进程会被回收
+    static bool IsProcessAlive(uint32_t processId) {
+#ifdef _WIN32
+        HANDLE process = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, processId);
+        if (!process) {
+            return false;
+        }
+        DWORD exitCode;
+        bool alive = GetExitCodeProcess(process, &exitCode) && exitCode == STILL_ACTIVE;
+        CloseHandle(process);
+        return alive;
+#else
+        // 必须回收子进程，否则僵尸进程会让 kill(pid, 0) 一直成功
+        return !ReapChild(static_cast<pid_t>(processId));
+#endif
+    }
+
+#ifndef _WIN32
+    // 已发送 SIGTERM 但尚未回收的子进程
+    std::vector<pid_t> pendingReap_;
+
+    // 非阻塞回收子进程，进程已结束时返回 true
+    static bool ReapChild(pid_t pid) {
+        int status = 0;
+        pid_t result = waitpid(pid, &status, WNOHANG);
+        return result == pid || (result < 0 && errno == ECHILD);
+    }
+
+    void ReapTerminated() {
+        for (auto it = pendingReap_.begin(); it != pendingReap_.end(); ) {
+            if (ReapChild(*it)) {
+                it = pendingReap_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+#endif
+
 public:
     bool LaunchApp(const std::string& appId, const std::string& executablePath) {
         std::lock_guard<std::mutex> lock(mutex_);
         
+#ifndef _WIN32
+        ReapTerminated();
+#endif
+
 #ifdef _WIN32
         STARTUPINFO si;
         PROCESS_INFORMATION pi;
@@ -55,6 +118,7 @@ public:
         
         runningProcesses_[appId] = pi.dwProcessId;
         startTimes_[appId] = std::chrono::system_clock::now();
+        PublishSnapshot();
         
         CloseHandle(pi.hThread);
         CloseHandle(pi.hProcess);
@@ -68,6 +132,7 @@ public:
         } else if (pid > 0) {
             runningProcesses_[appId] = pid;
             startTimes_[appId] = std::chrono::system_clock::now();
+            PublishSnapshot();
             return true;
         }
         return false;
@@ -90,13 +155,16 @@ public:
             if (result) {
                 runningProcesses_.erase(it);
                 startTimes_.erase(appId);
+                PublishSnapshot();
                 return true;
             }
         }
 #else
         if (kill(it->second, SIGTERM) == 0) {
+            pendingReap_.push_back(it->second);
             runningProcesses_.erase(it);
             startTimes_.erase(appId);
+            PublishSnapshot();
             return true;
         }
 #endif
@@ -104,49 +172,42 @@ public:
     }
     
     std::string GetStatus(const std::string& appId) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        
-        auto it = runningProcesses_.find(appId);
-        if (it == runningProcesses_.end()) {
+        std::shared_ptr<const ProcessTable> snapshot = std::atomic_load(&snapshot_);
+
+        auto it = snapshot->find(appId);
+        if (it == snapshot->end()) {
             return "not_running";
         }
-        
-#ifdef _WIN32
-        HANDLE process = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, it->second);
-        if (process) {
-            DWORD exitCode;
-            if (GetExitCodeProcess(process, &exitCode)) {
-                if (exitCode == STILL_ACTIVE) {
-                    CloseHandle(process);
-                    return "running";
-                }
-            }
-            CloseHandle(process);
-        }
-        runningProcesses_.erase(it);
-        startTimes_.erase(appId);
-        return "exited";
-#else
-        if (kill(it->second, 0) == 0) {
+
+        uint32_t processId = it->second.processId;
+        if (IsProcessAlive(processId)) {
             return "running";
-        } else {
-            runningProcesses_.erase(it);
+        }
+
+        // 只有进程退出时才加锁移除
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto current = runningProcesses_.find(appId);
+        if (current != runningProcesses_.end() && current->second == processId) {
+            runningProcesses_.erase(current);
             startTimes_.erase(appId);
-            return "exited";
+            PublishSnapshot();
         }
+#ifndef _WIN32
+        ReapTerminated();
 #endif
+        return "exited";
     }
     
     double GetDuration(const std::string& appId) {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::shared_ptr<const ProcessTable> snapshot = std::atomic_load(&snapshot_);
         
-        auto timeIt = startTimes_.find(appId);
-        if (timeIt == startTimes_.end()) {
+        auto it = snapshot->find(appId);
+        if (it == snapshot->end()) {
             return 0.0;
         }
         
         auto now = std::chrono::system_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::seconds>(now - timeIt->second);
+        auto duration = std::chrono::duration_cast<std::chrono::seconds>(now - it->second.startTime);
         return duration.count();
     }
 };
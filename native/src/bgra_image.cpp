@@ -0,0 +1,337 @@
+#include "bgra_image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "pixel_kernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BGRA_RESAMPLE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// 定点权重的小数位数：像素 (<= 255) 乘权重的累加在 int32 内，且权重可放入 int16 供 SSE2 pmaddwd 使用
+const int kWeightBits = 14;
+const int kWeightOne = 1 << kWeightBits;
+const double kPi = 3.14159265358979323846;
+
+// 一维卷积系数：输出 i 使用源像素 [first[i], first[i] + count[i])，权重从 weights[offset[i]] 开始
+struct FilterBank {
+    std::vector<int> first;
+    std::vector<int> count;
+    std::vector<size_t> offset;
+    std::vector<int16_t> weights;
+};
+
+double Sinc(double x) {
+    if (x == 0.0) {
+        return 1.0;
+    }
+    x *= kPi;
+    return std::sin(x) / x;
+}
+
+// 把一个输出的浮点权重归一化并量化，舍入误差计入最大的权重，保证总和精确为 kWeightOne
+void AppendWeights(FilterBank& bank, int first, std::vector<double>& weights) {
+    // 去掉两端为 0 的权重，减少无效乘法
+    size_t begin = 0;
+    size_t end = weights.size();
+    while (begin < end && weights[begin] == 0.0) begin++;
+    while (end > begin && weights[end - 1] == 0.0) end--;
+
+    double sum = 0.0;
+    for (size_t k = begin; k < end; k++) {
+        sum += weights[k];
+    }
+
+    bank.first.push_back(first + static_cast<int>(begin));
+    bank.count.push_back(static_cast<int>(end - begin));
+    bank.offset.push_back(bank.weights.size());
+    if (begin == end || sum == 0.0) {
+        bank.first.back() = first;
+        bank.count.back() = 1;
+        bank.weights.push_back(static_cast<int16_t>(kWeightOne));
+        return;
+    }
+
+    size_t start = bank.weights.size();
+    size_t largest = start;
+    int total = 0;
+    for (size_t k = begin; k < end; k++) {
+        int quantized = static_cast<int>(std::lround(weights[k] / sum * kWeightOne));
+        bank.weights.push_back(static_cast<int16_t>(quantized));
+        total += quantized;
+        if (bank.weights.back() > bank.weights[largest]) {
+            largest = bank.weights.size() - 1;
+        }
+    }
+    bank.weights[largest] = static_cast<int16_t>(bank.weights[largest] + kWeightOne - total);
+}
+
+FilterBank MakeFilterBank(int sourceSize, int targetSize, ResampleFilter filter) {
+    FilterBank bank;
+    double scale = static_cast<double>(sourceSize) / targetSize;
+    std::vector<double> weights;
+
+    for (int i = 0; i < targetSize; i++) {
+        weights.clear();
+        int first = 0;
+        if (targetSize < sourceSize && filter == ResampleFilter::Box) {
+            // 输出 i 覆盖源区间 [i * scale, (i + 1) * scale)
+            double start = i * scale;
+            double end = std::min<double>((i + 1) * scale, sourceSize);
+            first = static_cast<int>(start);
+            int last = std::min(static_cast<int>(std::ceil(end)), sourceSize);
+            for (int s = first; s < last; s++) {
+                weights.push_back(std::min<double>(end, s + 1) - std::max<double>(start, s));
+            }
+        } else if (targetSize < sourceSize) {
+            // Lanczos3，支撑区间随缩小倍数放大
+            double center = (i + 0.5) * scale;
+            double support = 3.0 * scale;
+            first = std::max(0, static_cast<int>(std::floor(center - support)));
+            int last = std::min(sourceSize, static_cast<int>(std::ceil(center + support)));
+            for (int s = first; s < last; s++) {
+                double x = (s + 0.5 - center) / scale;
+                weights.push_back(std::fabs(x) < 3.0 ? Sinc(x) * Sinc(x / 3.0) : 0.0);
+            }
+        } else {
+            // 放大：像素中心对齐的双线性插值
+            double center = (i + 0.5) * scale - 0.5;
+            center = std::max(0.0, std::min(center, static_cast<double>(sourceSize - 1)));
+            first = static_cast<int>(center);
+            double fraction = center - first;
+            weights.push_back(1.0 - fraction);
+            if (first + 1 < sourceSize) {
+                weights.push_back(fraction);
+            }
+        }
+        AppendWeights(bank, first, weights);
+    }
+    return bank;
+}
+
+inline uint8_t ClampWeighted(int sum) {
+    sum >>= kWeightBits;
+    return static_cast<uint8_t>(sum < 0 ? 0 : (sum > 255 ? 255 : sum));
+}
+
+#ifdef BGRA_RESAMPLE_SSE2
+// 两个 int16 权重交错填满寄存器，与 pmaddwd 的相邻两项对应
+inline __m128i WeightPair(int16_t first, int16_t second) {
+    uint32_t packed = (static_cast<uint32_t>(static_cast<uint16_t>(second)) << 16) | static_cast<uint16_t>(first);
+    return _mm_set1_epi32(static_cast<int>(packed));
+}
+#endif
+
+// 水平卷积一行（4 通道），src 为预乘的源行
+void ConvolveHorizontal(const uint8_t* src, uint8_t* dst, const FilterBank& bank) {
+    size_t width = bank.first.size();
+    for (size_t x = 0; x < width; x++) {
+        const uint8_t* p = src + static_cast<size_t>(bank.first[x]) * 4;
+        const int16_t* w = bank.weights.data() + bank.offset[x];
+        int count = bank.count[x];
+#ifdef BGRA_RESAMPLE_SSE2
+        // 两个像素交错为 b0 b1 g0 g1 r0 r1 a0 a1，pmaddwd 一次完成两个抽头
+        const __m128i zero = _mm_setzero_si128();
+        __m128i sum = _mm_set1_epi32(1 << (kWeightBits - 1));
+        int k = 0;
+        for (; k + 2 <= count; k += 2) {
+            __m128i pair = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + k * 4));
+            pair = _mm_unpacklo_epi8(_mm_unpacklo_epi8(pair, _mm_srli_si128(pair, 4)), zero);
+            __m128i weight = WeightPair(w[k], w[k + 1]);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(pair, weight));
+        }
+        if (k < count) {
+            int32_t value;
+            memcpy(&value, p + k * 4, 4);
+            __m128i single = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero), zero);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(single, _mm_set1_epi32(static_cast<uint16_t>(w[k]))));
+        }
+        sum = _mm_srai_epi32(sum, kWeightBits);
+        sum = _mm_packus_epi16(_mm_packs_epi32(sum, sum), zero);
+        int32_t packed = _mm_cvtsi128_si32(sum);
+        memcpy(dst + x * 4, &packed, 4);
+#else
+        int b = 1 << (kWeightBits - 1), g = b, r = b, a = b;
+        for (int k = 0; k < count; k++) {
+            b += p[k * 4 + 0] * w[k];
+            g += p[k * 4 + 1] * w[k];
+            r += p[k * 4 + 2] * w[k];
+            a += p[k * 4 + 3] * w[k];
+        }
+        dst[x * 4 + 0] = ClampWeighted(b);
+        dst[x * 4 + 1] = ClampWeighted(g);
+        dst[x * 4 + 2] = ClampWeighted(r);
+        dst[x * 4 + 3] = ClampWeighted(a);
+#endif
+    }
+}
+
+// 垂直卷积得到输出行 y，rows 为水平卷积后的中间图（行字节数 rowBytes）
+void ConvolveVertical(const uint8_t* rows, size_t rowBytes, const FilterBank& bank, int y, uint8_t* dst) {
+    const uint8_t* base = rows + static_cast<size_t>(bank.first[y]) * rowBytes;
+    const int16_t* w = bank.weights.data() + bank.offset[y];
+    int count = bank.count[y];
+    size_t i = 0;
+#ifdef BGRA_RESAMPLE_SSE2
+    // 每次 16 字节：相邻两行按字节交错后用 pmaddwd 完成两个抽头
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= rowBytes; i += 16) {
+        __m128i sums[4];
+        for (int s = 0; s < 4; s++) {
+            sums[s] = _mm_set1_epi32(1 << (kWeightBits - 1));
+        }
+        int k = 0;
+        for (; k + 2 <= count; k += 2) {
+            __m128i upper = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + k * rowBytes + i));
+            __m128i lower = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + (k + 1) * rowBytes + i));
+            __m128i weight = WeightPair(w[k], w[k + 1]);
+            __m128i lo = _mm_unpacklo_epi8(upper, lower);
+            __m128i hi = _mm_unpackhi_epi8(upper, lower);
+            sums[0] = _mm_add_epi32(sums[0], _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), weight));
+            sums[1] = _mm_add_epi32(sums[1], _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), weight));
+            sums[2] = _mm_add_epi32(sums[2], _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), weight));
+            sums[3] = _mm_add_epi32(sums[3], _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), weight));
+        }
+        if (k < count) {
+            __m128i upper = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + k * rowBytes + i));
+            __m128i weight = _mm_set1_epi32(static_cast<uint16_t>(w[k]));
+            __m128i lo = _mm_unpacklo_epi8(upper, zero);
+            __m128i hi = _mm_unpackhi_epi8(upper, zero);
+            sums[0] = _mm_add_epi32(sums[0], _mm_madd_epi16(_mm_unpacklo_epi16(lo, zero), weight));
+            sums[1] = _mm_add_epi32(sums[1], _mm_madd_epi16(_mm_unpackhi_epi16(lo, zero), weight));
+            sums[2] = _mm_add_epi32(sums[2], _mm_madd_epi16(_mm_unpacklo_epi16(hi, zero), weight));
+            sums[3] = _mm_add_epi32(sums[3], _mm_madd_epi16(_mm_unpackhi_epi16(hi, zero), weight));
+        }
+        for (int s = 0; s < 4; s++) {
+            sums[s] = _mm_srai_epi32(sums[s], kWeightBits);
+        }
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(sums[0], sums[1]), _mm_packs_epi32(sums[2], sums[3]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+    }
+#endif
+    for (; i < rowBytes; i++) {
+        int sum = 1 << (kWeightBits - 1);
+        for (int k = 0; k < count; k++) {
+            sum += base[k * rowBytes + i] * w[k];
+        }
+        dst[i] = ClampWeighted(sum);
+    }
+}
+
+// 一个目标尺寸的卷积系数和水平卷积中间图；与源图尺寸相同时直接复制
+struct ResizePass {
+    int width = 0;
+    int height = 0;
+    bool copy = false;
+    FilterBank columns;
+    FilterBank rows;
+    std::vector<uint8_t> horizontal;
+};
+
+ResizePass MakePass(const BgraImage& source, int width, int height, ResampleFilter filter) {
+    ResizePass pass;
+    pass.width = width;
+    pass.height = height;
+    pass.copy = width == source.width && height == source.height;
+    if (!pass.copy) {
+        pass.columns = MakeFilterBank(source.width, width, filter);
+        pass.rows = MakeFilterBank(source.height, height, filter);
+        pass.horizontal.resize(static_cast<size_t>(width) * 4 * source.height);
+    }
+    return pass;
+}
+
+// 源图只遍历一次：每行预乘后依次做各尺寸的水平卷积，再分别做垂直卷积
+void RunPasses(const BgraImage& source, std::vector<ResizePass>& passes, std::vector<BgraImage>& targets) {
+    const PixelKernels& kernels = GetPixelKernels();
+    std::vector<uint8_t> premultiplied(static_cast<size_t>(source.width) * 4);
+    for (int y = 0; y < source.height; y++) {
+        kernels.premultiply(premultiplied.data(), source.Row(y), source.width);
+        for (ResizePass& pass : passes) {
+            if (!pass.copy) {
+                size_t rowBytes = static_cast<size_t>(pass.width) * 4;
+                ConvolveHorizontal(premultiplied.data(), pass.horizontal.data() + rowBytes * y, pass.columns);
+            }
+        }
+    }
+
+    targets.assign(passes.size(), BgraImage());
+    for (size_t i = 0; i < passes.size(); i++) {
+        ResizePass& pass = passes[i];
+        BgraImage& target = targets[i];
+        if (pass.copy) {
+            target = source;
+            continue;
+        }
+        size_t rowBytes = static_cast<size_t>(pass.width) * 4;
+        target.Allocate(pass.width, pass.height);
+        for (int y = 0; y < pass.height; y++) {
+            ConvolveVertical(pass.horizontal.data(), rowBytes, pass.rows, y, target.Row(y));
+            kernels.unpremultiply(target.Row(y), target.Row(y), pass.width);
+        }
+        // 中间图不再需要，及早释放
+        std::vector<uint8_t>().swap(pass.horizontal);
+    }
+}
+
+} // namespace
+
+void FitBgraSize(const BgraImage& source, int size, int& width, int& height) {
+    width = size;
+    height = size;
+    if (source.width > source.height) {
+        height = std::max(1, static_cast<int>(static_cast<int64_t>(size) * source.height / source.width));
+    } else if (source.height > source.width) {
+        width = std::max(1, static_cast<int>(static_cast<int64_t>(size) * source.width / source.height));
+    }
+}
+
+bool ResizeBgra(const BgraImage& source, int width, int height, BgraImage& target, ResampleFilter filter) {
+    if (source.width <= 0 || source.height <= 0 || width <= 0 || height <= 0) {
+        return false;
+    }
+    if (source.width == width && source.height == height) {
+        target = source;
+        return true;
+    }
+
+    std::vector<ResizePass> passes;
+    passes.push_back(MakePass(source, width, height, filter));
+    std::vector<BgraImage> targets;
+    RunPasses(source, passes, targets);
+    target = std::move(targets[0]);
+    return true;
+}
+
+bool ResizeBgraToFit(const BgraImage& source, int size, BgraImage& target, ResampleFilter filter) {
+    if (source.width <= 0 || source.height <= 0) {
+        return false;
+    }
+    int width, height;
+    FitBgraSize(source, size, width, height);
+    return ResizeBgra(source, width, height, target, filter);
+}
+
+bool ResizeBgraToFitSizes(const BgraImage& source, const std::vector<int>& sizes,
+                          std::vector<BgraImage>& targets, ResampleFilter filter) {
+    if (source.width <= 0 || source.height <= 0) {
+        return false;
+    }
+
+    std::vector<ResizePass> passes;
+    for (int size : sizes) {
+        if (size <= 0) {
+            return false;
+        }
+        int width, height;
+        FitBgraSize(source, size, width, height);
+        passes.push_back(MakePass(source, width, height, filter));
+    }
+    RunPasses(source, passes, targets);
+    return true;
+}
@@ -0,0 +1,43 @@
+#ifndef BGRA_IMAGE_H
+#define BGRA_IMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 紧密排列（stride = width * 4）的 32 位 BGRA 图像，alpha 未预乘
+struct BgraImage {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;
+
+    void Allocate(int w, int h) {
+        width = w;
+        height = h;
+        pixels.assign(static_cast<size_t>(w) * h * 4, 0);
+    }
+    uint8_t* Row(int y) { return pixels.data() + static_cast<size_t>(y) * width * 4; }
+    const uint8_t* Row(int y) const { return pixels.data() + static_cast<size_t>(y) * width * 4; }
+};
+
+// 缩小时使用的滤波器；放大时总是双线性插值
+enum class ResampleFilter {
+    Box,      // 按面积平均
+    Lanczos3, // 更锐利，适合由大图生成多个小尺寸
+};
+
+// 缩放到 width x height。先水平后垂直的可分离卷积，在 8 位预乘空间中以 14 位定点权重计算，
+// 避免透明边缘发黑
+bool ResizeBgra(const BgraImage& source, int width, int height, BgraImage& target,
+                ResampleFilter filter = ResampleFilter::Box);
+
+// 保持宽高比缩放到 size x size 以内时的目标尺寸（对应 SIIGBF_RESIZETOFIT）
+void FitBgraSize(const BgraImage& source, int size, int& width, int& height);
+bool ResizeBgraToFit(const BgraImage& source, int size, BgraImage& target,
+                     ResampleFilter filter = ResampleFilter::Box);
+
+// 一次遍历源图，生成 sizes 中每个尺寸的 ResizeBgraToFit 结果，targets 与 sizes 一一对应
+bool ResizeBgraToFitSizes(const BgraImage& source, const std::vector<int>& sizes,
+                          std::vector<BgraImage>& targets, ResampleFilter filter);
+
+#endif
@@ -0,0 +1,378 @@
+#include "icon_atlas.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 页面尺寸上限：索引中的坐标为 uint16，常见 GPU 的纹理上限也不低于 8192
+const int kMaxPageSize = 8192;
+const int kMaxPadding = 16;
+
+void PutLe16(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void PutLe32(std::vector<uint8_t>& out, uint32_t value) {
+    PutLe16(out, value & 0xffff);
+    PutLe16(out, value >> 16);
+}
+
+size_t Area(const AtlasRect& rect) {
+    return static_cast<size_t>(rect.width) * rect.height;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// SkylinePacker
+
+void SkylinePacker::Reset(int width, int height) {
+    width_ = width;
+    height_ = height;
+    segments_.assign(1, Segment{ 0, 0, width });
+}
+
+// 以第 index 段左端为起点放置时矩形底边所在的高度：取覆盖范围内各段的最高点
+bool SkylinePacker::Fit(size_t index, int width, int height, int& y) const {
+    int x = segments_[index].x;
+    if (x + width > width_) {
+        return false;
+    }
+    int remaining = width;
+    y = 0;
+    for (size_t i = index; remaining > 0; i++) {
+        y = std::max(y, segments_[i].y);
+        if (y + height > height_) {
+            return false;
+        }
+        remaining -= segments_[i].width;
+    }
+    return true;
+}
+
+bool SkylinePacker::Insert(int width, int height, AtlasRect& rect) {
+    size_t best = segments_.size();
+    int bestY = 0;
+    for (size_t i = 0; i < segments_.size(); i++) {
+        int y;
+        if (Fit(i, width, height, y) && (best == segments_.size() || y < bestY)) {
+            best = i;
+            bestY = y;
+        }
+    }
+    if (best == segments_.size()) {
+        return false;
+    }
+
+    rect.x = segments_[best].x;
+    rect.y = bestY;
+    rect.width = width;
+    rect.height = height;
+
+    // 新段覆盖 [x, x + width)，被它遮住的段删除或截短
+    segments_.insert(segments_.begin() + best, Segment{ rect.x, bestY + height, width });
+    int right = rect.x + width;
+    size_t next = best + 1;
+    while (next < segments_.size() && segments_[next].x < right) {
+        int overlap = right - segments_[next].x;
+        if (overlap >= segments_[next].width) {
+            segments_.erase(segments_.begin() + next);
+        } else {
+            segments_[next].x += overlap;
+            segments_[next].width -= overlap;
+            break;
+        }
+    }
+    // 合并高度相同的相邻段
+    for (size_t i = 0; i + 1 < segments_.size();) {
+        if (segments_[i].y == segments_[i + 1].y) {
+            segments_[i].width += segments_[i + 1].width;
+            segments_.erase(segments_.begin() + i + 1);
+        } else {
+            i++;
+        }
+    }
+    return true;
+}
+
+int SkylinePacker::UsedHeight() const {
+    int height = 0;
+    for (const Segment& segment : segments_) {
+        height = std::max(height, segment.y);
+    }
+    return height;
+}
+
+// ---------------------------------------------------------------------------
+// IconAtlas
+
+IconAtlas::IconAtlas(int pageSize, int padding)
+    : pageSize_(std::max(1, std::min(pageSize, kMaxPageSize))),
+      padding_(std::max(0, std::min(padding, kMaxPadding))) {}
+
+bool IconAtlas::Set(const std::string& id, const BgraImage& image) {
+    int width = image.width + padding_ * 2;
+    int height = image.height + padding_ * 2;
+    if (image.width <= 0 || image.height <= 0 || width > pageSize_ || height > pageSize_) {
+        return false;
+    }
+
+    auto it = entries_.find(id);
+    if (it != entries_.end()) {
+        // 原槽位放得下时原位覆盖，其他图标不受影响
+        AtlasEntry& entry = it->second;
+        if (width <= entry.slot.width && height <= entry.slot.height) {
+            Page& page = pages_[entry.page];
+            ClearRect(page, entry.slot);
+            entry.width = image.width;
+            entry.height = image.height;
+            Draw(page, entry, image.pixels.data(), static_cast<size_t>(image.width) * 4);
+            page.dirty = true;
+            return true;
+        }
+        Release(entry);
+        entries_.erase(it);
+    }
+
+    AtlasEntry entry;
+    Place(width, height, true, entry);
+    entry.width = image.width;
+    entry.height = image.height;
+    Draw(pages_[entry.page], entry, image.pixels.data(), static_cast<size_t>(image.width) * 4);
+    entries_[id] = entry;
+
+    // 换槽位后原来的末页可能已经空了
+    while (!pages_.empty() && pages_.back().entryCount == 0) {
+        pages_.pop_back();
+    }
+    return true;
+}
+
+bool IconAtlas::Remove(const std::string& id) {
+    auto it = entries_.find(id);
+    if (it == entries_.end()) {
+        return false;
+    }
+    Release(it->second);
+    entries_.erase(it);
+    // 只删除末尾的空页，中间的空页保留以免后续页号变化
+    while (!pages_.empty() && pages_.back().entryCount == 0) {
+        pages_.pop_back();
+    }
+    return true;
+}
+
+void IconAtlas::Clear() {
+    pages_.clear();
+    entries_.clear();
+}
+
+const AtlasEntry* IconAtlas::Find(const std::string& id) const {
+    auto it = entries_.find(id);
+    return it == entries_.end() ? nullptr : &it->second;
+}
+
+void IconAtlas::MarkClean() {
+    for (Page& page : pages_) {
+        page.dirty = false;
+    }
+}
+
+bool IconAtlas::Place(int width, int height, bool allowRepack, AtlasEntry& entry) {
+    if (TakeFreeSlot(width, height, entry)) {
+        return true;
+    }
+    for (size_t i = 0; i < pages_.size(); i++) {
+        if (InsertIntoPage(i, width, height, entry)) {
+            return true;
+        }
+    }
+    // 空闲槽位零散、单个都放不下时，重排空闲面积足够的页把空间收拢到天际线上方
+    if (allowRepack) {
+        for (size_t i = 0; i < pages_.size(); i++) {
+            if (pages_[i].freeArea >= static_cast<size_t>(width) * height) {
+                Repack(i);
+                if (InsertIntoPage(i, width, height, entry)) {
+                    return true;
+                }
+            }
+        }
+    }
+    pages_.emplace_back();
+    ResetPage(pages_.back());
+    return InsertIntoPage(pages_.size() - 1, width, height, entry);
+}
+
+// 所有页中能容纳 width x height 的面积最小的空闲槽位，整个槽位分给新图标
+bool IconAtlas::TakeFreeSlot(int width, int height, AtlasEntry& entry) {
+    size_t bestPage = 0;
+    size_t bestSlot = 0;
+    size_t bestArea = 0;
+    for (size_t p = 0; p < pages_.size(); p++) {
+        const std::vector<AtlasRect>& slots = pages_[p].freeSlots;
+        for (size_t s = 0; s < slots.size(); s++) {
+            if (slots[s].width >= width && slots[s].height >= height &&
+                (bestArea == 0 || Area(slots[s]) < bestArea)) {
+                bestPage = p;
+                bestSlot = s;
+                bestArea = Area(slots[s]);
+            }
+        }
+    }
+    if (bestArea == 0) {
+        return false;
+    }
+
+    Page& page = pages_[bestPage];
+    AtlasRect slot = page.freeSlots[bestSlot];
+    page.freeSlots.erase(page.freeSlots.begin() + bestSlot);
+    page.freeArea -= bestArea;
+    Occupy(bestPage, slot, entry);
+    return true;
+}
+
+bool IconAtlas::InsertIntoPage(size_t page, int width, int height, AtlasEntry& entry) {
+    AtlasRect slot;
+    if (!pages_[page].packer.Insert(width, height, slot)) {
+        return false;
+    }
+    Occupy(page, slot, entry);
+    return true;
+}
+
+void IconAtlas::Occupy(size_t page, const AtlasRect& slot, AtlasEntry& entry) {
+    Page& target = pages_[page];
+    entry.page = static_cast<int>(page);
+    entry.slot = slot;
+    entry.x = slot.x + padding_;
+    entry.y = slot.y + padding_;
+    target.entryCount++;
+    target.dirty = true;
+
+    // 页面高度随内容增长，新增的行为透明
+    int bottom = slot.y + slot.height;
+    if (bottom > target.image.height) {
+        target.image.pixels.resize(static_cast<size_t>(target.image.width) * bottom * 4, 0);
+        target.image.height = bottom;
+    }
+}
+
+// 清空该页后按高度从大到小重新放入原有图标，槽位收缩到图标的实际尺寸。
+// 个别图标重新放置后放不下时移到其他页
+void IconAtlas::Repack(size_t page) {
+    BgraImage previous = std::move(pages_[page].image);
+    ResetPage(pages_[page]);
+
+    std::vector<AtlasEntry*> moving;
+    for (auto& item : entries_) {
+        if (item.second.page == static_cast<int>(page)) {
+            moving.push_back(&item.second);
+        }
+    }
+    std::sort(moving.begin(), moving.end(), [](const AtlasEntry* a, const AtlasEntry* b) {
+        return a->height != b->height ? a->height > b->height : a->width > b->width;
+    });
+
+    for (AtlasEntry* entry : moving) {
+        const uint8_t* pixels = previous.Row(entry->y) + static_cast<size_t>(entry->x) * 4;
+        int width = entry->width + padding_ * 2;
+        int height = entry->height + padding_ * 2;
+        if (!InsertIntoPage(page, width, height, *entry)) {
+            Place(width, height, false, *entry);
+        }
+        Draw(pages_[entry->page], *entry, pixels, static_cast<size_t>(previous.width) * 4);
+    }
+}
+
+void IconAtlas::Release(const AtlasEntry& entry) {
+    Page& page = pages_[entry.page];
+    page.dirty = true;
+    if (--page.entryCount == 0) {
+        ResetPage(page);
+        return;
+    }
+    ClearRect(page, entry.slot);
+    page.freeSlots.push_back(entry.slot);
+    page.freeArea += Area(entry.slot);
+}
+
+void IconAtlas::ResetPage(Page& page) {
+    page.packer.Reset(pageSize_, pageSize_);
+    page.image.width = pageSize_;
+    page.image.height = 0;
+    // 按满页预留地址空间，增长时不再重新分配和复制；实际内存在写入时才占用
+    page.image.pixels.clear();
+    page.image.pixels.reserve(static_cast<size_t>(pageSize_) * pageSize_ * 4);
+    page.freeSlots.clear();
+    page.freeArea = 0;
+    page.entryCount = 0;
+    page.dirty = true;
+}
+
+void IconAtlas::ClearRect(Page& page, const AtlasRect& rect) {
+    for (int y = rect.y; y < rect.y + rect.height; y++) {
+        memset(page.image.Row(y) + static_cast<size_t>(rect.x) * 4, 0, static_cast<size_t>(rect.width) * 4);
+    }
+}
+
+void IconAtlas::Draw(Page& page, const AtlasEntry& entry, const uint8_t* pixels, size_t stride) {
+    size_t rowBytes = static_cast<size_t>(entry.width) * 4;
+    for (int y = 0; y < entry.height; y++) {
+        uint8_t* dst = page.image.Row(entry.y + y) + static_cast<size_t>(entry.x) * 4;
+        const uint8_t* src = pixels + stride * y;
+        memcpy(dst, src, rowBytes);
+        for (int i = 1; i <= padding_; i++) {
+            memcpy(dst - i * 4, src, 4);
+            memcpy(dst + rowBytes + (i - 1) * 4, src + rowBytes - 4, 4);
+        }
+    }
+
+    // 上下留白复制首末两行（已包含左右留白）
+    size_t outerBytes = rowBytes + static_cast<size_t>(padding_) * 8;
+    size_t left = static_cast<size_t>(entry.x - padding_) * 4;
+    const uint8_t* top = page.image.Row(entry.y) + left;
+    const uint8_t* bottom = page.image.Row(entry.y + entry.height - 1) + left;
+    for (int i = 1; i <= padding_; i++) {
+        memcpy(page.image.Row(entry.y - i) + left, top, outerBytes);
+        memcpy(page.image.Row(entry.y + entry.height - 1 + i) + left, bottom, outerBytes);
+    }
+}
+
+void IconAtlas::BuildIndex(std::vector<uint8_t>& output) const {
+    size_t idBytes = 0;
+    for (const auto& item : entries_) {
+        idBytes += item.first.size();
+    }
+
+    output.clear();
+    output.reserve(16 + pages_.size() * 4 + entries_.size() * 16 + idBytes);
+    output.insert(output.end(), { 'A', 'T', 'L', 'S' });
+    PutLe16(output, 1);
+    PutLe16(output, static_cast<uint32_t>(pages_.size()));
+    PutLe32(output, static_cast<uint32_t>(entries_.size()));
+    PutLe32(output, static_cast<uint32_t>(idBytes));
+    for (const Page& page : pages_) {
+        PutLe16(output, static_cast<uint32_t>(page.image.width));
+        PutLe16(output, static_cast<uint32_t>(page.image.height));
+    }
+
+    uint32_t offset = 0;
+    for (const auto& item : entries_) {
+        const AtlasEntry& entry = item.second;
+        // id 超过 65535 字节时截断长度，实际不会出现
+        uint32_t length = static_cast<uint32_t>(std::min<size_t>(item.first.size(), 0xffff));
+        PutLe16(output, static_cast<uint32_t>(entry.page));
+        PutLe16(output, static_cast<uint32_t>(entry.x));
+        PutLe16(output, static_cast<uint32_t>(entry.y));
+        PutLe16(output, static_cast<uint32_t>(entry.width));
+        PutLe16(output, static_cast<uint32_t>(entry.height));
+        PutLe16(output, length);
+        PutLe32(output, offset);
+        offset += static_cast<uint32_t>(item.first.size());
+    }
+    for (const auto& item : entries_) {
+        output.insert(output.end(), item.first.begin(), item.first.end());
+    }
+}
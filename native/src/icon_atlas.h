@@ -0,0 +1,122 @@
+#ifndef ICON_ATLAS_H
+#define ICON_ATLAS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "bgra_image.h"
+
+struct AtlasRect {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// 天际线装箱（bottom-left）：记录每段 x 区间已占用到的高度，新矩形放在顶边最低的位置，
+// 相同时取最左。尺寸相近的图标可以几乎无缝地逐行排满
+class SkylinePacker {
+public:
+    void Reset(int width, int height);
+    bool Insert(int width, int height, AtlasRect& rect);
+    // 已占用的最大高度
+    int UsedHeight() const;
+
+private:
+    struct Segment {
+        int x;
+        int y;
+        int width;
+    };
+
+    int width_ = 0;
+    int height_ = 0;
+    std::vector<Segment> segments_;
+
+    bool Fit(size_t index, int width, int height, int& y) const;
+};
+
+// 图标在图集中的位置。x/y/width/height 为图标本身的像素区域（不含留白），
+// slot 为实际占用的槽位（含留白，替换为更小的图标时保持不变）
+struct AtlasEntry {
+    int page = 0;
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    AtlasRect slot;
+};
+
+// 多页图标图集。每页宽为 pageSize，高随内容增长，最高 pageSize。
+// 图标四周留 padding 像素并复制边缘像素，双线性采样时不会混入相邻图标。
+// 增量更新：
+// - 替换为不大于原槽位的图标时原位覆盖，其他图标位置不变，只有所在页变脏
+// - 移除或换到更大槽位后旧槽位进入空闲列表，之后尺寸合适的图标优先复用
+// - 所有页都放不下时，先重排空闲面积足够的页，仍放不下才新增一页
+// 非线程安全
+class IconAtlas {
+public:
+    static constexpr int kDefaultPageSize = 2048;
+    static constexpr int kDefaultPadding = 1;
+
+    explicit IconAtlas(int pageSize = kDefaultPageSize, int padding = kDefaultPadding);
+
+    // 添加或替换 id 的图标，image 为非预乘 BGRA。图标加留白超过页面尺寸时返回 false
+    bool Set(const std::string& id, const BgraImage& image);
+    bool Remove(const std::string& id);
+    void Clear();
+
+    const AtlasEntry* Find(const std::string& id) const;
+    size_t EntryCount() const { return entries_.size(); }
+    size_t PageCount() const { return pages_.size(); }
+    // 页面图像，高度为该页已使用的高度
+    const BgraImage& PageImage(size_t page) const { return pages_[page].image; }
+    // 自上次 MarkClean 以来像素或布局发生变化的页
+    bool IsPageDirty(size_t page) const { return pages_[page].dirty; }
+    void MarkClean();
+
+    // 紧凑二进制索引（多字节字段为小端）：
+    //   0  "ATLS"
+    //   4  uint16 版本 = 1
+    //   6  uint16 页数
+    //   8  uint32 图标数
+    //   12 uint32 id 字符串总字节数
+    //   16 每页 4 字节：uint16 宽、uint16 高
+    //   之后每个图标 16 字节，按 id 排序：
+    //      uint16 页、uint16 x、uint16 y、uint16 宽、uint16 高、uint16 id 长度、uint32 id 偏移
+    //   最后是全部 id（UTF-8，无分隔），偏移相对于该区域开头
+    // 纹理坐标 u = x / 页宽、v = y / 页高
+    void BuildIndex(std::vector<uint8_t>& output) const;
+
+private:
+    struct Page {
+        SkylinePacker packer;
+        BgraImage image;
+        std::vector<AtlasRect> freeSlots;
+        size_t freeArea = 0;
+        size_t entryCount = 0;
+        bool dirty = true;
+    };
+
+    int pageSize_;
+    int padding_;
+    std::vector<Page> pages_;
+    std::map<std::string, AtlasEntry> entries_; // 有序，索引输出稳定
+
+    // 为 width x height（含留白）的槽位找位置，设置 entry.page 和 entry.slot
+    bool Place(int width, int height, bool allowRepack, AtlasEntry& entry);
+    bool TakeFreeSlot(int width, int height, AtlasEntry& entry);
+    bool InsertIntoPage(size_t page, int width, int height, AtlasEntry& entry);
+    void Occupy(size_t page, const AtlasRect& slot, AtlasEntry& entry);
+    void Repack(size_t page);
+    void Release(const AtlasEntry& entry);
+    void ResetPage(Page& page);
+    void ClearRect(Page& page, const AtlasRect& rect);
+    // 把 entry.width x entry.height 的像素画到 entry 的位置，并向四周留白复制边缘
+    void Draw(Page& page, const AtlasEntry& entry, const uint8_t* pixels, size_t stride);
+};
+
+#endif
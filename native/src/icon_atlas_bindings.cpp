@@ -0,0 +1,137 @@
+#include "icon_atlas.h"
+#include "icon_thumbnail.h"
+
+#include <algorithm>
+
+// JS 端的图标图集：
+//   const atlas = new IconAtlas({ pageSize?, iconSize?, padding?, outputFormat? })
+//   atlas.setIcon(id, pathOrBuffer)  路径按 iconSize 提取（经过缩略图缓存）；
+//                                    Buffer 可以是 PNG/QOI/原始 RGBA，例如 extractThumbnailsAsync 的结果
+//   atlas.removeIcon(id)
+//   atlas.build(all?) => { pages: (Buffer|null)[], index: Buffer }
+// build 只编码自上次 build 以来有变化的页，其余为 null，渲染端保留已上传的纹理即可；
+// all 为 true 时编码全部页。index 的布局见 IconAtlas::BuildIndex
+class IconAtlasWrapper : public Napi::ObjectWrap<IconAtlasWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    IconAtlasWrapper(const Napi::CallbackInfo& info);
+
+private:
+    IconAtlas atlas_;
+    int iconSize_ = 64;
+    ThumbnailFormat format_ = ThumbnailFormat::Png;
+
+    Napi::Value SetIcon(const Napi::CallbackInfo& info);
+    Napi::Value RemoveIcon(const Napi::CallbackInfo& info);
+    Napi::Value Build(const Napi::CallbackInfo& info);
+};
+
+Napi::Object IconAtlasWrapper::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "IconAtlas", {
+        InstanceMethod("setIcon", &IconAtlasWrapper::SetIcon),
+        InstanceMethod("removeIcon", &IconAtlasWrapper::RemoveIcon),
+        InstanceMethod("build", &IconAtlasWrapper::Build)
+    });
+
+    exports.Set("IconAtlas", func);
+    return exports;
+}
+
+IconAtlasWrapper::IconAtlasWrapper(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<IconAtlasWrapper>(info) {
+    Napi::Env env = info.Env();
+    int pageSize = IconAtlas::kDefaultPageSize;
+    int padding = IconAtlas::kDefaultPadding;
+
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object options = info[0].As<Napi::Object>();
+        if (options.Has("pageSize") && options.Get("pageSize").IsNumber()) {
+            pageSize = options.Get("pageSize").As<Napi::Number>().Int32Value();
+            pageSize = std::max(256, std::min(pageSize, 8192));
+        }
+        if (options.Has("iconSize") && options.Get("iconSize").IsNumber()) {
+            iconSize_ = options.Get("iconSize").As<Napi::Number>().Int32Value();
+            iconSize_ = std::max(16, std::min(iconSize_, 1024));
+        }
+        if (options.Has("padding") && options.Get("padding").IsNumber()) {
+            padding = options.Get("padding").As<Napi::Number>().Int32Value();
+            padding = std::max(0, std::min(padding, 16));
+        }
+    }
+    if (!ReadOutputFormat(env, info[0], format_)) {
+        return;
+    }
+    atlas_ = IconAtlas(pageSize, padding);
+}
+
+Napi::Value IconAtlasWrapper::SetIcon(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || (!info[1].IsString() && !info[1].IsBuffer())) {
+        Napi::TypeError::New(env, "需要图标 id 和文件路径或 Buffer").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string id = info[0].As<Napi::String>().Utf8Value();
+    BgraImage image;
+    if (info[1].IsBuffer()) {
+        Napi::Buffer<uint8_t> data = info[1].As<Napi::Buffer<uint8_t>>();
+        if (!DecodeThumbnail(data.Data(), data.Length(), image)) {
+            return Napi::Boolean::New(env, false);
+        }
+    } else {
+        // 以 QOI 经过缓存：解码比 PNG 快，重复构建时不必重新提取
+        std::string filePath = info[1].As<Napi::String>().Utf8Value();
+        std::vector<BYTE> buffer;
+        if (!ExtractThumbnailCached(filePath, iconSize_, SIIGBF_RESIZETOFIT | SIIGBF_ICONONLY, buffer,
+                                    ThumbnailFormat::Qoi) ||
+            !DecodeQoi(buffer.data(), buffer.size(), image)) {
+            return Napi::Boolean::New(env, false);
+        }
+    }
+    return Napi::Boolean::New(env, atlas_.Set(id, image));
+}
+
+Napi::Value IconAtlasWrapper::RemoveIcon(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "需要图标 id").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    return Napi::Boolean::New(env, atlas_.Remove(info[0].As<Napi::String>().Utf8Value()));
+}
+
+Napi::Value IconAtlasWrapper::Build(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    bool all = info.Length() > 0 && info[0].IsBoolean() && info[0].As<Napi::Boolean>().Value();
+
+    // 已清空的中间页高度为 0，与未变化的页一样返回 null，可由索引中的页高区分
+    Napi::Array pages = Napi::Array::New(env, atlas_.PageCount());
+    for (size_t i = 0; i < atlas_.PageCount(); i++) {
+        const BgraImage& image = atlas_.PageImage(i);
+        Napi::Value value = env.Null();
+        if ((all || atlas_.IsPageDirty(i)) && image.height > 0) {
+            std::vector<BYTE> buffer;
+            if (!EncodeBgraThumbnail(image, format_, buffer)) {
+                Napi::Error::New(env, "无法编码图集").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            value = TakeBuffer(env, buffer);
+        }
+        pages.Set(static_cast<uint32_t>(i), value);
+    }
+    atlas_.MarkClean();
+
+    std::vector<BYTE> index;
+    atlas_.BuildIndex(index);
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("pages", pages);
+    result.Set("index", TakeBuffer(env, index));
+    return result;
+}
+
+Napi::Object InitIconAtlas(Napi::Env env, Napi::Object exports) {
+    return IconAtlasWrapper::Init(env, exports);
+}
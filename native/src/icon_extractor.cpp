@@ -0,0 +1,547 @@
+#include "icon_extractor.h"
+#include "png_codec.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const uint32_t kResourceIcon = 3;       // RT_ICON
+const uint32_t kResourceGroupIcon = 14; // RT_GROUP_ICON
+const uint32_t kSubdirectoryFlag = 0x80000000u;
+
+// 资源目录最多嵌套三层（类型 / 名称 / 语言），防止损坏文件中的环
+const int kMaxResourceDepth = 3;
+
+uint16_t ReadLe16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t ReadLe32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+struct Section {
+    uint32_t virtualAddress;
+    uint32_t virtualSize;
+    uint32_t rawOffset;
+    uint32_t rawSize;
+};
+
+// PE 镜像的最小视图：把 RVA 映射到文件偏移
+struct PeImage {
+    const uint8_t* data;
+    size_t size;
+    std::vector<Section> sections;
+
+    // 返回 RVA 处长度为 length 的数据，越界时返回 nullptr
+    const uint8_t* At(uint32_t rva, size_t length) const {
+        for (const auto& section : sections) {
+            uint32_t extent = std::max(section.virtualSize, section.rawSize);
+            if (rva < section.virtualAddress || rva - section.virtualAddress >= extent) {
+                continue;
+            }
+            size_t offset = static_cast<size_t>(section.rawOffset) + (rva - section.virtualAddress);
+            if (rva - section.virtualAddress + length > section.rawSize || offset + length > size) {
+                return nullptr;
+            }
+            return data + offset;
+        }
+        return nullptr;
+    }
+};
+
+struct ResourceEntry {
+    bool named;
+    uint32_t id;      // named 为 false 时有效
+    uint32_t offset;  // 相对资源目录起点
+    bool directory;
+};
+
+// 读取一个 IMAGE_RESOURCE_DIRECTORY 的全部条目（命名条目在前，数字 ID 按升序）
+bool ReadResourceDirectory(const PeImage& image, uint32_t base, uint32_t offset, std::vector<ResourceEntry>& entries) {
+    const uint8_t* header = image.At(base + offset, 16);
+    if (!header) {
+        return false;
+    }
+    size_t count = static_cast<size_t>(ReadLe16(header + 12)) + ReadLe16(header + 14);
+    const uint8_t* table = image.At(base + offset + 16, count * 8);
+    if (!table) {
+        return false;
+    }
+
+    entries.clear();
+    for (size_t i = 0; i < count; i++) {
+        uint32_t name = ReadLe32(table + i * 8);
+        uint32_t target = ReadLe32(table + i * 8 + 4);
+        ResourceEntry entry;
+        entry.named = (name & kSubdirectoryFlag) != 0;
+        entry.id = name & 0xffff;
+        entry.directory = (target & kSubdirectoryFlag) != 0;
+        entry.offset = target & ~kSubdirectoryFlag;
+        entries.push_back(entry);
+    }
+    return true;
+}
+
+// 沿子目录下降到第一个数据条目（语言层取第一个），返回数据的 RVA 和长度
+bool ResolveResourceData(const PeImage& image, uint32_t base, const ResourceEntry& start, uint32_t& rva, uint32_t& size) {
+    ResourceEntry entry = start;
+    std::vector<ResourceEntry> children;
+    for (int depth = 0; entry.directory; depth++) {
+        if (depth >= kMaxResourceDepth || !ReadResourceDirectory(image, base, entry.offset, children) || children.empty()) {
+            return false;
+        }
+        entry = children.front();
+    }
+
+    const uint8_t* data = image.At(base + entry.offset, 16);
+    if (!data) {
+        return false;
+    }
+    rva = ReadLe32(data);
+    size = ReadLe32(data + 4);
+    return true;
+}
+
+// 16/32 位 BI_BITFIELDS 的颜色掩码
+struct ChannelMask {
+    uint32_t mask = 0;
+    int shift = 0;
+    int bits = 0;
+
+    explicit ChannelMask(uint32_t value = 0) : mask(value) {
+        if (mask == 0) {
+            return;
+        }
+        while (!((mask >> shift) & 1)) shift++;
+        while (shift + bits < 32 && ((mask >> (shift + bits)) & 1)) bits++;
+    }
+    uint8_t Extract(uint32_t pixel) const {
+        if (bits == 0) {
+            return 0;
+        }
+        uint32_t value = (pixel & mask) >> shift;
+        return static_cast<uint8_t>(bits >= 8 ? value >> (bits - 8) : value * 255 / ((1u << bits) - 1));
+    }
+};
+
+// 解码 ICO 中的 DIB：XOR 位图 + 1 位 AND 掩码，高度为两者之和
+bool DecodeDib(const uint8_t* data, size_t size, BgraImage& image) {
+    if (size < 40) {
+        return false;
+    }
+    uint32_t headerSize = ReadLe32(data);
+    int32_t width = static_cast<int32_t>(ReadLe32(data + 4));
+    int32_t fullHeight = static_cast<int32_t>(ReadLe32(data + 8));
+    uint16_t bitCount = ReadLe16(data + 14);
+    uint32_t compression = ReadLe32(data + 16);
+    uint32_t colorsUsed = ReadLe32(data + 32);
+    if (headerSize < 40 || headerSize > size || width <= 0 || width > 1024 ||
+        fullHeight == 0 || (compression != 0 && compression != 3)) {
+        return false;
+    }
+
+    bool bottomUp = fullHeight > 0;
+    int32_t height = (bottomUp ? fullHeight : -fullHeight) / 2;
+    if (height <= 0 || height > 1024) {
+        return false;
+    }
+
+    size_t offset = headerSize;
+    ChannelMask red(0x00ff0000), green(0x0000ff00), blue(0x000000ff), alpha(0xff000000);
+    if (bitCount == 16) {
+        red = ChannelMask(0x7c00);
+        green = ChannelMask(0x03e0);
+        blue = ChannelMask(0x001f);
+        alpha = ChannelMask(0);
+    }
+    if (compression == 3) {
+        if (bitCount != 16 && bitCount != 32) {
+            return false;
+        }
+        // BITMAPINFOHEADER 之后紧跟三个掩码；V4/V5 头中掩码位于头内相同位置
+        if (size < 52) {
+            return false;
+        }
+        red = ChannelMask(ReadLe32(data + 40));
+        green = ChannelMask(ReadLe32(data + 44));
+        blue = ChannelMask(ReadLe32(data + 48));
+        if (headerSize == 40) {
+            offset += 12;
+        }
+    }
+
+    const uint8_t* palette = nullptr;
+    uint32_t paletteSize = 0;
+    if (bitCount <= 8) {
+        paletteSize = colorsUsed != 0 && colorsUsed <= (1u << bitCount) ? colorsUsed : (1u << bitCount);
+        if (offset + paletteSize * 4 > size) {
+            return false;
+        }
+        palette = data + offset;
+        offset += paletteSize * 4;
+    } else if (bitCount != 16 && bitCount != 24 && bitCount != 32) {
+        return false;
+    }
+
+    size_t xorStride = ((static_cast<size_t>(width) * bitCount + 31) / 32) * 4;
+    size_t andStride = ((static_cast<size_t>(width) + 31) / 32) * 4;
+    if (offset + xorStride * height > size) {
+        return false;
+    }
+    const uint8_t* xorBits = data + offset;
+    // 部分 32 位图标省略了 AND 掩码
+    const uint8_t* andBits = offset + xorStride * height + andStride * height <= size ?
+                             xorBits + xorStride * height : nullptr;
+
+    image.Allocate(width, height);
+    bool anyAlpha = false;
+    for (int32_t y = 0; y < height; y++) {
+        int32_t sourceY = bottomUp ? height - 1 - y : y;
+        const uint8_t* src = xorBits + xorStride * sourceY;
+        uint8_t* dst = image.Row(y);
+        for (int32_t x = 0; x < width; x++) {
+            uint8_t* out = dst + x * 4;
+            switch (bitCount) {
+                case 1: case 2: case 4: case 8: {
+                    size_t bit = static_cast<size_t>(x) * bitCount;
+                    uint32_t index = (src[bit / 8] >> (8 - bitCount - bit % 8)) & ((1u << bitCount) - 1);
+                    if (index < paletteSize) {
+                        memcpy(out, palette + index * 4, 3);
+                    }
+                    out[3] = 255;
+                    break;
+                }
+                case 16: {
+                    uint32_t pixel = ReadLe16(src + x * 2);
+                    out[0] = blue.Extract(pixel);
+                    out[1] = green.Extract(pixel);
+                    out[2] = red.Extract(pixel);
+                    out[3] = 255;
+                    break;
+                }
+                case 24:
+                    memcpy(out, src + x * 3, 3);
+                    out[3] = 255;
+                    break;
+                case 32: {
+                    uint32_t pixel = ReadLe32(src + x * 4);
+                    out[0] = blue.Extract(pixel);
+                    out[1] = green.Extract(pixel);
+                    out[2] = red.Extract(pixel);
+                    out[3] = alpha.Extract(pixel);
+                    anyAlpha = anyAlpha || out[3] != 0;
+                    break;
+                }
+            }
+        }
+    }
+
+    // 32 位图像自带 alpha；其余（以及 alpha 全为 0 的旧式 32 位图标）使用 AND 掩码
+    if (bitCount == 32 && anyAlpha) {
+        return true;
+    }
+    for (int32_t y = 0; y < height; y++) {
+        int32_t sourceY = bottomUp ? height - 1 - y : y;
+        uint8_t* dst = image.Row(y);
+        for (int32_t x = 0; x < width; x++) {
+            bool transparent = andBits && ((andBits[andStride * sourceY + x / 8] >> (7 - x % 8)) & 1);
+            dst[x * 4 + 3] = transparent ? 0 : 255;
+        }
+    }
+    return true;
+}
+
+bool HasExtension(const std::string& path, const char* extension) {
+    size_t length = strlen(extension);
+    if (path.size() < length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        char c = path[path.size() - length + i];
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+        if (c != extension[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+IconFile::~IconFile() {
+    Close();
+}
+
+bool IconFile::Open(const std::string& path) {
+    Close();
+    if (!MapFile(path)) {
+        Close();
+        return false;
+    }
+    if (size_ >= 2 && data_[0] == 'M' && data_[1] == 'Z' ? ParsePe() : ParseIco()) {
+        return true;
+    }
+    Close();
+    return false;
+}
+
+void IconFile::Close() {
+    entries_.clear();
+#ifdef _WIN32
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_) CloseHandle(file_);
+    mapping_ = nullptr;
+    file_ = nullptr;
+#else
+    if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+bool IconFile::MapFile(const std::string& path) {
+#ifdef _WIN32
+    int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), (int)path.size(), NULL, 0);
+    std::wstring widePath(length, 0);
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), (int)path.size(), &widePath[0], length);
+
+    HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    file_ = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        return false;
+    }
+    mapping_ = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping_) {
+        return false;
+    }
+    data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    size_ = data_ ? static_cast<size_t>(fileSize.QuadPart) : 0;
+    return data_ != nullptr;
+#else
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    data_ = static_cast<const uint8_t*>(data);
+    size_ = static_cast<size_t>(info.st_size);
+    return true;
+#endif
+}
+
+void IconFile::AddEntry(int width, int height, int bitCount, const uint8_t* data, size_t size) {
+    IconEntry entry;
+    // 目录中的 0 表示 256
+    entry.width = width == 0 ? 256 : width;
+    entry.height = height == 0 ? 256 : height;
+    entry.bitCount = bitCount;
+    entry.data = data;
+    entry.size = size;
+
+    // PNG 候选以 IHDR 中的真实尺寸为准，目录中的值常常不可靠
+    int pngWidth = 0, pngHeight = 0;
+    if (IsPngData(data, size)) {
+        entry.png = true;
+        if (ReadPngSize(data, size, pngWidth, pngHeight)) {
+            entry.width = pngWidth;
+            entry.height = pngHeight;
+        }
+        if (entry.bitCount == 0) {
+            entry.bitCount = 32;
+        }
+    } else if (size >= 16 && entry.bitCount == 0) {
+        entry.bitCount = ReadLe16(data + 14);
+    }
+    entries_.push_back(entry);
+}
+
+// ICONDIR + ICONDIRENTRY[]，每项 16 字节，直接给出图像在文件中的偏移
+bool IconFile::ParseIco() {
+    if (size_ < 6 || ReadLe16(data_) != 0 || ReadLe16(data_ + 2) != 1) {
+        return false;
+    }
+    size_t count = ReadLe16(data_ + 4);
+    if (count == 0 || 6 + count * 16 > size_) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* entry = data_ + 6 + i * 16;
+        uint32_t bytes = ReadLe32(entry + 8);
+        uint32_t offset = ReadLe32(entry + 12);
+        if (offset >= size_ || bytes > size_ - offset) {
+            continue;
+        }
+        AddEntry(entry[0], entry[1], ReadLe16(entry + 6), data_ + offset, bytes);
+    }
+    return !entries_.empty();
+}
+
+// 解析 PE 资源目录：取第一个 RT_GROUP_ICON（与 Shell 选择的默认图标一致），
+// 其中每个 GRPICONDIRENTRY 通过 ID 引用一个 RT_ICON 资源
+bool IconFile::ParsePe() {
+    if (size_ < 0x40) {
+        return false;
+    }
+    uint32_t peOffset = ReadLe32(data_ + 0x3c);
+    if (peOffset > size_ - 24 || memcmp(data_ + peOffset, "PE\0\0", 4) != 0) {
+        return false;
+    }
+
+    const uint8_t* coff = data_ + peOffset + 4;
+    uint16_t sectionCount = ReadLe16(coff + 2);
+    uint16_t optionalSize = ReadLe16(coff + 16);
+    const uint8_t* optional = coff + 20;
+    if (static_cast<size_t>(optional - data_) + optionalSize > size_ || optionalSize < 2) {
+        return false;
+    }
+
+    // PE32 与 PE32+ 的数据目录位置不同
+    uint16_t magic = ReadLe16(optional);
+    size_t directoryOffset = magic == 0x20b ? 112 : magic == 0x10b ? 96 : 0;
+    if (directoryOffset == 0 || optionalSize < directoryOffset) {
+        return false;
+    }
+    uint32_t directoryCount = ReadLe32(optional + directoryOffset - 4);
+    if (directoryCount < 3 || optionalSize < directoryOffset + 3 * 8) {
+        return false;
+    }
+    uint32_t resourceRva = ReadLe32(optional + directoryOffset + 2 * 8);
+    if (resourceRva == 0) {
+        return false;
+    }
+
+    PeImage image{ data_, size_, {} };
+    const uint8_t* sectionTable = optional + optionalSize;
+    if (static_cast<size_t>(sectionTable - data_) + static_cast<size_t>(sectionCount) * 40 > size_) {
+        return false;
+    }
+    for (uint16_t i = 0; i < sectionCount; i++) {
+        const uint8_t* section = sectionTable + i * 40;
+        image.sections.push_back({ ReadLe32(section + 12), ReadLe32(section + 8),
+                                   ReadLe32(section + 20), ReadLe32(section + 16) });
+    }
+
+    std::vector<ResourceEntry> types;
+    if (!ReadResourceDirectory(image, resourceRva, 0, types)) {
+        return false;
+    }
+    const ResourceEntry* groupType = nullptr;
+    const ResourceEntry* iconType = nullptr;
+    for (const auto& type : types) {
+        if (type.named || !type.directory) continue;
+        if (type.id == kResourceGroupIcon) groupType = &type;
+        if (type.id == kResourceIcon) iconType = &type;
+    }
+    if (!groupType || !iconType) {
+        return false;
+    }
+
+    std::vector<ResourceEntry> groups;
+    if (!ReadResourceDirectory(image, resourceRva, groupType->offset, groups) || groups.empty()) {
+        return false;
+    }
+    uint32_t groupRva = 0, groupSize = 0;
+    if (!ResolveResourceData(image, resourceRva, groups.front(), groupRva, groupSize) || groupSize < 6) {
+        return false;
+    }
+    const uint8_t* group = image.At(groupRva, groupSize);
+    if (!group) {
+        return false;
+    }
+    size_t count = ReadLe16(group + 4);
+    if (6 + count * 14 > groupSize) {
+        return false;
+    }
+
+    std::vector<ResourceEntry> icons;
+    if (!ReadResourceDirectory(image, resourceRva, iconType->offset, icons)) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* entry = group + 6 + i * 14;
+        uint16_t id = ReadLe16(entry + 12);
+        auto icon = std::find_if(icons.begin(), icons.end(), [id](const ResourceEntry& e) {
+            return !e.named && e.id == id;
+        });
+        uint32_t rva = 0, bytes = 0;
+        if (icon == icons.end() || !ResolveResourceData(image, resourceRva, *icon, rva, bytes)) {
+            continue;
+        }
+        const uint8_t* payload = image.At(rva, bytes);
+        if (payload) {
+            AddEntry(entry[0], entry[1], ReadLe16(entry + 6), payload, bytes);
+        }
+    }
+    return !entries_.empty();
+}
+
+const IconEntry* IconFile::SelectBest(int size) const {
+    const IconEntry* best = nullptr;
+    for (const auto& entry : entries_) {
+        if (!best) {
+            best = &entry;
+            continue;
+        }
+        int current = std::max(best->width, best->height);
+        int candidate = std::max(entry.width, entry.height);
+        bool currentFits = current >= size;
+        bool candidateFits = candidate >= size;
+        if (candidateFits != currentFits) {
+            if (candidateFits) best = &entry;
+        } else if (candidate != current) {
+            // 都够大时取较小的，都不够大时取较大的
+            if ((candidate < current) == candidateFits) best = &entry;
+        } else if (entry.bitCount > best->bitCount) {
+            best = &entry;
+        }
+    }
+    return best;
+}
+
+bool DecodeIconEntry(const IconEntry& entry, BgraImage& image) {
+    if (entry.png) {
+        return DecodePng(entry.data, entry.size, image);
+    }
+    return DecodeDib(entry.data, entry.size, image);
+}
+
+bool IsIconContainerPath(const std::string& path) {
+    static const char* const kExtensions[] = { ".exe", ".dll", ".ico", ".cpl", ".scr", ".ocx" };
+    for (const char* extension : kExtensions) {
+        if (HasExtension(path, extension)) {
+            return true;
+        }
+    }
+    return false;
+}
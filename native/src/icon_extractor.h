@@ -0,0 +1,62 @@
+#ifndef ICON_EXTRACTOR_H
+#define ICON_EXTRACTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bgra_image.h"
+
+// 图标组中的一个候选图像，data 指向映射内存中的 PNG 或 DIB 数据
+struct IconEntry {
+    int width = 0;
+    int height = 0;
+    int bitCount = 0;
+    bool png = false;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+// 只读映射 .exe/.dll/.ico 文件并列出第一个图标组的全部候选，不依赖 Windows Shell，
+// 可在任何平台上处理 Windows 程序（例如 Proton/Wine 前缀中的游戏）。
+// 候选的 data 在 IconFile 销毁前有效
+class IconFile {
+public:
+    IconFile() = default;
+    ~IconFile();
+    IconFile(const IconFile&) = delete;
+    IconFile& operator=(const IconFile&) = delete;
+
+    // path 为 UTF-8
+    bool Open(const std::string& path);
+    void Close();
+
+    const std::vector<IconEntry>& Entries() const { return entries_; }
+
+    // 为 size 选择候选：不小于 size 的最小图像，没有时取最大的图像；同尺寸优先色深更高的。
+    // 只比较目录中的尺寸（PNG 取 IHDR），不解码任何候选
+    const IconEntry* SelectBest(int size) const;
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+    std::vector<IconEntry> entries_;
+
+    bool MapFile(const std::string& path);
+    bool ParseIco();
+    bool ParsePe();
+    void AddEntry(int width, int height, int bitCount, const uint8_t* data, size_t size);
+};
+
+// 解码候选图像（PNG 或 ICO 中的 DIB）为非预乘 BGRA
+bool DecodeIconEntry(const IconEntry& entry, BgraImage& image);
+
+// 扩展名是否为内置解析器支持的格式
+bool IsIconContainerPath(const std::string& path);
+
+#endif
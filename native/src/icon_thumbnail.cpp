@@ -1,15 +1,32 @@
 #include "icon_thumbnail.h"
-#include <comdef.h>
+#include "icon_extractor.h"
+#include "image_formats.h"
+#include "png_codec.h"
+#include "png_encoder.h"
+#include "pixel_kernels.h"
+#include "thumbnail_cache.h"
+#include "thumbnail_pool.h"
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <mutex>
+#include <thread>
+#ifdef _WIN32
+#include <comdef.h>
 #include <locale>
 #include <codecvt>
+#else
+#include <cerrno>
+#endif
 
 using namespace Napi;
+#ifdef _WIN32
 using namespace Gdiplus;
 
-// 全局GDI+管理器
+// 全局GDI+管理器，可能由多个提取线程同时触发初始化
 static ULONG_PTR g_gdiplusToken = 0;
 static bool g_gdiplusInitialized = false;
+static std::once_flag g_gdiplusOnce;
 
 // UTF-8 到 UTF-16 转换
 std::wstring Utf8ToWide(const std::string& utf8) {
@@ -30,16 +47,31 @@ std::wstring Utf8ToWide(const std::string& utf8) {
 
 // 初始化GDI+
 bool EnsureGdiPlusInitialized() {
-    if (!g_gdiplusInitialized) {
+    std::call_once(g_gdiplusOnce, [] {
         GdiplusStartupInput gdiplusStartupInput;
-        GdiplusStartup(&g_gdiplusToken, &gdiplusStartupInput, NULL);
-        g_gdiplusInitialized = true;
-    }
+        g_gdiplusInitialized = GdiplusStartup(&g_gdiplusToken, &gdiplusStartupInput, NULL) == Ok;
+    });
     return g_gdiplusInitialized;
 }
 
-// 获取PNG编码器
-CLSID GetPngEncoderClsid() {
+// 每个线程的 COM 套间：首次使用时初始化，线程退出时释放，不再逐个文件初始化
+struct ComApartment {
+    HRESULT hr;
+    ComApartment() : hr(CoInitializeEx(NULL, COINIT_APARTMENTTHREADED)) {}
+    ~ComApartment() {
+        if (SUCCEEDED(hr)) {
+            CoUninitialize();
+        }
+    }
+};
+
+static bool EnsureComInitialized() {
+    thread_local ComApartment apartment;
+    // 线程已按其他模型初始化过 COM 时仍可使用
+    return SUCCEEDED(apartment.hr) || apartment.hr == RPC_E_CHANGED_MODE;
+}
+
+static CLSID FindPngEncoderClsid() {
     UINT num = 0, size = 0;
     
     if (GetImageEncodersSize(&num, &size) != Ok || size == 0) {
@@ -60,6 +92,12 @@ CLSID GetPngEncoderClsid() {
     return CLSID_NULL;
 }
 
+// 获取PNG编码器（结果只查询一次）
+CLSID GetPngEncoderClsid() {
+    static const CLSID clsid = FindPngEncoderClsid();
+    return clsid;
+}
+
 // 处理黑色边缘为透明
 bool ProcessBlackEdgesToTransparent(Bitmap* bitmap) {
     if (!bitmap) return false;
@@ -76,25 +114,15 @@ bool ProcessBlackEdgesToTransparent(Bitmap* bitmap) {
         return false;
     }
     
+    // 只处理边缘像素（四周边界）：纯黑色（RGB=0,0,0）设为完全透明。
+    // 负步长表示行在内存中倒序，边框上下对称，从最低地址的行开始处理即可
     BYTE* pixels = (BYTE*)bitmapData.Scan0;
     int stride = bitmapData.Stride;
-    
-    // 只处理边缘像素（四周边界）
-    for (int y = 0; y < height; y++) {
-        BYTE* row = pixels + (y * stride);
-        for (int x = 0; x < width; x++) {
-            // 只处理图像边缘的像素（四周边界）
-            if (x == 0 || x == width - 1 || y == 0 || y == height - 1) {
-                BYTE* pixel = row + (x * 4); // 32bpp ARGB
-                
-                // 检查是否为纯黑色（RGB=0,0,0）
-                if (pixel[2] == 0 && pixel[1] == 0 && pixel[0] == 0) {
-                    // 将Alpha通道设为0（完全透明）
-                    pixel[3] = 0;
-                }
-            }
-        }
+    if (stride < 0) {
+        pixels += static_cast<ptrdiff_t>(stride) * (height - 1);
+        stride = -stride;
     }
+    KeyBorder(pixels, width, height, stride, 0x000000);
     
     bitmap->UnlockBits(&bitmapData);
     return true;
@@ -179,7 +207,7 @@ bool _SaveBitmapToBuffer(HBITMAP hBitmap, std::vector<BYTE>& buffer) {
     return true;
 }
 
-bool SaveBitmapToBuffer(HBITMAP hBitmap, std::vector<BYTE>& buffer) {
+bool SaveBitmapToBuffer(HBITMAP hBitmap, std::vector<BYTE>& buffer, ThumbnailFormat format) {
     if (!hBitmap) return false;
 
     // 1. 先从 HBITMAP 创建 GDI+ Bitmap
@@ -190,84 +218,58 @@ bool SaveBitmapToBuffer(HBITMAP hBitmap, std::vector<BYTE>& buffer) {
     int width = sourceBitmap->GetWidth();
     int height = sourceBitmap->GetHeight();
 
-    // 2. 创建一个全新的、确认为 32bppARGB 格式的位图
-    Bitmap targetBitmap(width, height, PixelFormat32bppARGB);
-    Graphics g(&targetBitmap);
-    
-    // 设置绘图质量
-    g.SetInterpolationMode(InterpolationModeHighQualityBicubic);
-    g.SetSmoothingMode(SmoothingModeHighQuality);
+    // 2. 目标位图直接包装 BgraImage 的内存（布局与 PixelFormat32bppARGB 相同），
+    // 绘制结果不需要再通过 LockBits 复制出来
+    BgraImage image;
+    image.Allocate(width, height);
+    {
+        Bitmap targetBitmap(width, height, width * 4, PixelFormat32bppARGB, image.pixels.data());
+        Graphics g(&targetBitmap);
+        
+        // 设置绘图质量
+        g.SetInterpolationMode(InterpolationModeHighQualityBicubic);
+        g.SetSmoothingMode(SmoothingModeHighQuality);
 
-    // 3. 将原始位图画到新位图中
-    // 这一步 GDI+ 会自动处理原始 HBITMAP 的 orientation (颠倒问题)
-    g.DrawImage(sourceBitmap.get(), 0, 0, width, height);
+        // 3. 将原始位图画到新位图中
+        // 这一步 GDI+ 会自动处理原始 HBITMAP 的 orientation (颠倒问题)
+        g.DrawImage(sourceBitmap.get(), 0, 0, width, height);
+    }
 
     // 4. 【关键步骤】由于 FromHBITMAP 丢失了 Alpha，我们需要手动找回它
-    // 我们再次锁定原始 HBITMAP 的数据（如果是32位的话）
+    // 我们再次读取原始 HBITMAP 的数据（如果是32位的话）
     BITMAP bm;
     GetObject(hBitmap, sizeof(bm), &bm);
     if (bm.bmBitsPixel == 32 && bm.bmBits != NULL) {
-        BitmapData targetData;
-        Rect rect(0, 0, width, height);
-        if (targetBitmap.LockBits(&rect, ImageLockModeWrite, PixelFormat32bppARGB, &targetData) == Ok) {
-            BYTE* targetPixels = (BYTE*)targetData.Scan0;
-            BYTE* sourcePixels = (BYTE*)bm.bmBits;
-            
-            // 检查原始数据是否也是反向的
-            // 如果 bmHeight 为正数，说明内存里数据是倒着的
-            bool isBottomUp = (bm.bmHeight > 0);
+        BYTE* sourcePixels = (BYTE*)bm.bmBits;
+        
+        // 检查原始数据是否也是反向的
+        // 如果 bmHeight 为正数，说明内存里数据是倒着的
+        bool isBottomUp = (bm.bmHeight > 0);
+        const PixelKernels& kernels = GetPixelKernels();
+        
+        for (int y = 0; y < height; y++) {
+            // 如果是 Bottom-Up，源码行需要反向计算
+            int sourceY = isBottomUp ? (height - 1 - y) : y;
+            BYTE* pSrcRow = sourcePixels + (sourceY * bm.bmWidthBytes);
             
-            for (int y = 0; y < height; y++) {
-                // 如果是 Bottom-Up，源码行需要反向计算
-                int sourceY = isBottomUp ? (height - 1 - y) : y;
-                BYTE* pSrcRow = sourcePixels + (sourceY * bm.bmWidthBytes);
-                BYTE* pDestRow = targetPixels + (y * targetData.Stride);
-                
-                for (int x = 0; x < width; x++) {
-                    // 只把原始数据的 Alpha 通道拷贝过去
-                    // 假设 source 是 BGRA 格式
-                    pDestRow[x * 4 + 3] = pSrcRow[x * 4 + 3]; 
-                }
-            }
-            targetBitmap.UnlockBits(&targetData);
+            // 只把原始数据的 Alpha 通道拷贝过去
+            // 假设 source 是 BGRA 格式
+            kernels.mergeAlpha(image.Row(y), pSrcRow, width);
         }
     }
 
-    // 5. 保存到流（保持原有的保存逻辑）
-    IStream* stream = NULL;
-    if (CreateStreamOnHGlobal(NULL, TRUE, &stream) != S_OK) return false;
-
-    CLSID clsidPng = GetPngEncoderClsid();
-    if (clsidPng != CLSID_NULL && targetBitmap.Save(stream, &clsidPng, NULL) == Ok) {
-        STATSTG stat;
-        if (stream->Stat(&stat, STATFLAG_NONAME) == S_OK) {
-            HGLOBAL hGlobal = NULL;
-            if (GetHGlobalFromStream(stream, &hGlobal) == S_OK) {
-                BYTE* pData = (BYTE*)GlobalLock(hGlobal);
-                if (pData) {
-                    buffer.assign(pData, pData + stat.cbSize.QuadPart);
-                    GlobalUnlock(hGlobal);
-                }
-            }
-        }
-    }
-    stream->Release();
-    return !buffer.empty();
+    // 5. 用内置编码器编码为请求的格式
+    return EncodeBgraThumbnail(image, format, buffer);
 }
 
-// 核心提取函数
-bool ExtractThumbnailInternal(const std::wstring& filePath, int size, 
-                              DWORD flags, std::vector<BYTE>& buffer) {
-    if (!EnsureGdiPlusInitialized()) {
+// Shell 后端：IShellItemImageFactory 可处理任意文件类型（快捷方式、图片缩略图等）
+static bool ExtractThumbnailShell(const std::wstring& filePath, int size, DWORD flags,
+                                  std::vector<BYTE>& buffer, ThumbnailFormat format) {
+    if (!EnsureGdiPlusInitialized() || !EnsureComInitialized()) {
         return false;
     }
     
-    HRESULT hr = CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
-    if (FAILED(hr)) {
-        return false;
-    }
-    
-    
+    HRESULT hr;
     IShellItemImageFactory* pFactory = NULL;
     HBITMAP hBitmap = NULL;
     bool success = false;
@@ -282,19 +284,227 @@ bool ExtractThumbnailInternal(const std::wstring& filePath, int size,
         hr = pFactory->GetImage(sz, flags, &hBitmap);
         if (FAILED(hr) || !hBitmap) break;
         
-        success = SaveBitmapToBuffer(hBitmap, buffer);
+        success = SaveBitmapToBuffer(hBitmap, buffer, format);
         
     } while (false);
     
     if (hBitmap) DeleteObject(hBitmap);
     if (pFactory) pFactory->Release();
     
-    CoUninitialize();
-    
     return success;
 }
 
-// N-API: 提取到Buffer
+#endif
+
+// 编码级别可由 JS 调整，提取线程在编码时读取。默认 Fast：缩略图在提取路径上同步编码，
+// 更高级别的试压缩要多花数倍时间，换来的体积差距对图标很小
+static std::atomic<int> g_pngLevel(static_cast<int>(PngLevel::Fast));
+
+bool EncodeBgraToPng(const BgraImage& image, std::vector<BYTE>& buffer) {
+    return EncodePng(image, static_cast<PngLevel>(g_pngLevel.load(std::memory_order_relaxed)), buffer);
+}
+
+bool EncodeBgraThumbnail(const BgraImage& image, ThumbnailFormat format, std::vector<BYTE>& buffer) {
+    switch (format) {
+        case ThumbnailFormat::Qoi: return EncodeQoi(image, buffer);
+        case ThumbnailFormat::Rgba: return EncodeRawRgba(image, buffer);
+        default: return EncodeBgraToPng(image, buffer);
+    }
+}
+
+void PrepareThumbnailThread() {
+#ifdef _WIN32
+    EnsureComInitialized();
+    EnsureGdiPlusInitialized();
+#endif
+}
+
+// 内置 PE/ICO 后端：不需要 COM 和 Shell，可在任何平台运行
+static bool ExtractThumbnailPortable(const std::string& filePath, int size,
+                                     std::vector<BYTE>& buffer, ThumbnailFormat format) {
+    IconFile file;
+    if (!file.Open(filePath)) {
+        return false;
+    }
+    const IconEntry* entry = file.SelectBest(size);
+    if (!entry) {
+        return false;
+    }
+
+    // 请求 PNG 且尺寸正好时无需解码，直接返回原始数据
+    if (format == ThumbnailFormat::Png && entry->png && entry->width == size && entry->height == size) {
+        buffer.assign(entry->data, entry->data + entry->size);
+        return true;
+    }
+
+    BgraImage image;
+    if (!DecodeIconEntry(*entry, image)) {
+        return false;
+    }
+    BgraImage resized;
+    if (!ResizeBgraToFit(image, size, resized)) {
+        return false;
+    }
+    return EncodeBgraThumbnail(resized, format, buffer);
+}
+
+// 核心提取函数
+bool ExtractThumbnailInternal(const std::string& filePath, int size, 
+                              DWORD flags, std::vector<BYTE>& buffer, ThumbnailFormat format) {
+    if (IsIconContainerPath(filePath) && ExtractThumbnailPortable(filePath, size, buffer, format)) {
+        return true;
+    }
+#ifdef _WIN32
+    // 没有图标资源的程序和其他文件类型交给 Shell，由它提供默认图标或缩略图
+    buffer.clear();
+    return ExtractThumbnailShell(Utf8ToWide(filePath), size, flags, buffer, format);
+#else
+    (void)flags;
+    (void)format;
+    return false;
+#endif
+}
+
+// 进程内共享的缩略图缓存，默认只启用内存层
+static ThumbnailCache g_thumbnailCache;
+
+// 输出格式占变体的 24..27 位。PNG 为 0，原有的缓存条目继续有效
+static uint32_t FormatVariant(ThumbnailFormat format) {
+    return static_cast<uint32_t>(format) << 24;
+}
+
+// 同一缩略图已有其他无损格式（PNG/QOI）的缓存时解码后转为 format，像素与重新提取的结果一致，
+// 但省去了 Shell 调用或图标解析和缩放
+static bool TranscodeCached(const std::string& filePath, int size, uint32_t variant,
+                            ThumbnailFormat format, std::vector<BYTE>& buffer) {
+    static const ThumbnailFormat kLosslessFormats[] = { ThumbnailFormat::Png, ThumbnailFormat::Qoi };
+    for (ThumbnailFormat source : kLosslessFormats) {
+        ThumbnailKey key;
+        if (source == format || !ThumbnailCache::MakeKey(filePath, size, variant | FormatVariant(source), key)) {
+            continue;
+        }
+        ThumbnailData cached = g_thumbnailCache.Lookup(key);
+        BgraImage image;
+        if (cached && DecodeThumbnail(cached->data(), cached->size(), image)) {
+            return EncodeBgraThumbnail(image, format, buffer);
+        }
+    }
+    return false;
+}
+
+bool ExtractThumbnailCached(const std::string& filePath, int size,
+                            DWORD flags, std::vector<BYTE>& buffer, ThumbnailFormat format) {
+    // 无法获取文件身份（如文件不存在）时不缓存，直接提取
+    ThumbnailKey key;
+    if (!ThumbnailCache::MakeKey(filePath, size, flags | FormatVariant(format), key)) {
+        return ExtractThumbnailInternal(filePath, size, flags, buffer, format);
+    }
+
+    ThumbnailData cached = g_thumbnailCache.Lookup(key);
+    if (cached) {
+        buffer.assign(cached->begin(), cached->end());
+        return true;
+    }
+    if (!TranscodeCached(filePath, size, flags, format, buffer) &&
+        !ExtractThumbnailInternal(filePath, size, flags, buffer, format)) {
+        return false;
+    }
+    g_thumbnailCache.Store(key, buffer);
+    return true;
+}
+
+// 多尺寸结果使用不同的源候选和滤波器，缓存时与单尺寸提取的结果分开
+static const uint32_t kVariantSizes = 0x80000000u;
+
+// 解码一次源图像：图标容器取适合 size 的候选，其他文件取后端在 size 下的输出
+static bool DecodeThumbnailSource(const std::string& filePath, int size, DWORD flags, BgraImage& image) {
+    if (IsIconContainerPath(filePath)) {
+        IconFile file;
+        if (file.Open(filePath)) {
+            const IconEntry* entry = file.SelectBest(size);
+            if (entry && DecodeIconEntry(*entry, image)) {
+                return true;
+            }
+        }
+    }
+    // 中间结果只在内部使用，QOI 的编解码比 PNG 快得多
+    std::vector<BYTE> encoded;
+    return ExtractThumbnailInternal(filePath, size, flags, encoded, ThumbnailFormat::Qoi) &&
+           DecodeQoi(encoded.data(), encoded.size(), image);
+}
+
+bool ExtractThumbnailSizesInternal(const std::string& filePath, const std::vector<int>& sizes,
+                                   DWORD flags, std::vector<std::vector<BYTE>>& buffers,
+                                   ThumbnailFormat format) {
+    buffers.assign(sizes.size(), std::vector<BYTE>());
+
+    // 先查缓存，只为未命中的尺寸解码
+    std::vector<ThumbnailKey> keys(sizes.size());
+    std::vector<bool> keyed(sizes.size(), false);
+    std::vector<int> missingSizes;
+    std::vector<size_t> missingIndices;
+    for (size_t i = 0; i < sizes.size(); i++) {
+        keyed[i] = ThumbnailCache::MakeKey(filePath, sizes[i], flags | kVariantSizes | FormatVariant(format), keys[i]);
+        ThumbnailData cached = keyed[i] ? g_thumbnailCache.Lookup(keys[i]) : nullptr;
+        if (cached) {
+            buffers[i].assign(cached->begin(), cached->end());
+        } else {
+            missingSizes.push_back(sizes[i]);
+            missingIndices.push_back(i);
+        }
+    }
+    if (missingSizes.empty()) {
+        return true;
+    }
+
+    BgraImage source;
+    int largest = *std::max_element(missingSizes.begin(), missingSizes.end());
+    if (!DecodeThumbnailSource(filePath, largest, flags, source)) {
+        return false;
+    }
+    std::vector<BgraImage> images;
+    if (!ResizeBgraToFitSizes(source, missingSizes, images, ResampleFilter::Lanczos3)) {
+        return false;
+    }
+
+    for (size_t j = 0; j < images.size(); j++) {
+        size_t i = missingIndices[j];
+        if (!EncodeBgraThumbnail(images[j], format, buffers[i])) {
+            return false;
+        }
+        if (keyed[i]) {
+            g_thumbnailCache.Store(keys[i], buffers[i]);
+        }
+    }
+    return true;
+}
+
+// 把编码结果交给 JS：作为外部 Buffer 直接移交 vector 的内存，由 finalizer 释放，不再复制。
+// Electron 启用 V8 内存沙箱后不允许外部 Buffer，此时 NewOrCopy 退回复制并立即调用 finalizer
+Napi::Value TakeBuffer(Napi::Env env, std::vector<BYTE>& buffer) {
+    auto* owned = new std::vector<BYTE>(std::move(buffer));
+    return Napi::Buffer<BYTE>::NewOrCopy(env, owned->data(), owned->size(),
+        [](Napi::Env, BYTE*, std::vector<BYTE>* data) { delete data; }, owned);
+}
+
+// 读取 options.outputFormat（"png" / "qoi" / "rgba"），未指定时 format 保持不变。
+// 值无效时抛出 TypeError 并返回 false
+bool ReadOutputFormat(Napi::Env env, const Napi::Value& options, ThumbnailFormat& format) {
+    if (!options.IsObject()) {
+        return true;
+    }
+    Napi::Value value = options.As<Napi::Object>().Get("outputFormat");
+    if (value.IsUndefined()) {
+        return true;
+    }
+    if (!value.IsString() || !ParseThumbnailFormat(value.As<Napi::String>().Utf8Value(), format)) {
+        Napi::TypeError::New(env, "outputFormat 必须是 png、qoi 或 rgba").ThrowAsJavaScriptException();
+        return false;
+    }
+    return true;
+}
+
+// N-API: 提取到Buffer extractThumbnail(path, size?, { outputFormat? })
 Napi::Value ExtractThumbnail(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
@@ -313,18 +523,23 @@ Napi::Value ExtractThumbnail(const Napi::CallbackInfo& info) {
         flags = SIIGBF_RESIZETOFIT | SIIGBF_ICONONLY;
     }
     
-    std::wstring wFilePath = Utf8ToWide(filePath);
+    ThumbnailFormat format = ThumbnailFormat::Png;
+    if (!ReadOutputFormat(env, info[2], format)) {
+        return env.Null();
+    }
+    
     std::vector<BYTE> buffer;
     
-    if (!ExtractThumbnailInternal(wFilePath, size, flags, buffer)) {
+    if (!ExtractThumbnailCached(filePath, size, flags, buffer, format)) {
         Napi::Error::New(env, "无法提取缩略图").ThrowAsJavaScriptException();
         return env.Null();
     }
     
-    return Napi::Buffer<BYTE>::Copy(env, buffer.data(), buffer.size());
+    return TakeBuffer(env, buffer);
 }
 
-// N-API: 提取到文件
+// N-API: 提取到文件 extractThumbnailToFile(path, outputPath, size?, { outputFormat? })
+// 未指定 outputFormat 时按输出文件扩展名选择格式（.qoi、.rgba），其他扩展名写入 PNG
 Napi::Value ExtractThumbnailToFile(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
@@ -344,16 +559,21 @@ Napi::Value ExtractThumbnailToFile(const Napi::CallbackInfo& info) {
         flags = SIIGBF_RESIZETOFIT | SIIGBF_ICONONLY ;
     }
     
-    std::wstring wFilePath = Utf8ToWide(filePath);
-    std::wstring wOutputPath = Utf8ToWide(outputPath);
+    ThumbnailFormat format = ThumbnailFormat::Png;
+    ThumbnailFormatFromPath(outputPath, format);
+    if (!ReadOutputFormat(env, info[3], format)) {
+        return env.Null();
+    }
     
     std::vector<BYTE> buffer;
-    if (!ExtractThumbnailInternal(wFilePath, size, flags, buffer)) {
+    if (!ExtractThumbnailCached(filePath, size, flags, buffer, format)) {
         Napi::Error::New(env, "无法提取缩略图").ThrowAsJavaScriptException();
         return env.Null();
     }
     
+#ifdef _WIN32
     // 使用Windows API写入文件（支持Unicode路径）
+    std::wstring wOutputPath = Utf8ToWide(outputPath);
     HANDLE hFile = CreateFileW(
         wOutputPath.c_str(),
         GENERIC_WRITE,
@@ -384,11 +604,23 @@ Napi::Value ExtractThumbnailToFile(const Napi::CallbackInfo& info) {
         Napi::Error::New(env, "写入文件失败").ThrowAsJavaScriptException();
         return env.Null();
     }
+#else
+    std::ofstream file(outputPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::string errorMsg = "无法创建文件，错误代码: " + std::to_string(errno);
+        Napi::Error::New(env, errorMsg).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size())) {
+        Napi::Error::New(env, "写入文件失败").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+#endif
     
     return Napi::String::New(env, outputPath);
 }
 
-// N-API: 批量提取
+// N-API: 批量提取 extractThumbnails(paths, size?, { outputFormat? })
 Napi::Value ExtractThumbnails(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
@@ -407,6 +639,11 @@ Napi::Value ExtractThumbnails(const Napi::CallbackInfo& info) {
         flags = SIIGBF_RESIZETOFIT | SIIGBF_ICONONLY ;
     }
     
+    ThumbnailFormat format = ThumbnailFormat::Png;
+    if (!ReadOutputFormat(env, info[2], format)) {
+        return env.Null();
+    }
+    
     Napi::Array results = Napi::Array::New(env, filePaths.Length());
     
     for (uint32_t i = 0; i < filePaths.Length(); i++) {
@@ -417,11 +654,10 @@ Napi::Value ExtractThumbnails(const Napi::CallbackInfo& info) {
         }
         
         std::string filePath = item.As<Napi::String>().Utf8Value();
-        std::wstring wFilePath = Utf8ToWide(filePath);
         
         std::vector<BYTE> buffer;
-        if (ExtractThumbnailInternal(wFilePath, size, flags, buffer)) {
-            results.Set(i, Napi::Buffer<BYTE>::Copy(env, buffer.data(), buffer.size()));
+        if (ExtractThumbnailCached(filePath, size, flags, buffer, format)) {
+            results.Set(i, TakeBuffer(env, buffer));
         } else {
             results.Set(i, env.Null());
         }
@@ -430,6 +666,246 @@ Napi::Value ExtractThumbnails(const Napi::CallbackInfo& info) {
     return results;
 }
 
+// N-API: 同一文件的多个尺寸 extractThumbnailSizes(path, [sizes], { outputFormat? }) => Buffer[]
+Napi::Value ExtractThumbnailSizes(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsArray()) {
+        Napi::TypeError::New(env, "需要文件路径和尺寸数组").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    std::string filePath = info[0].As<Napi::String>().Utf8Value();
+    Napi::Array sizeArray = info[1].As<Napi::Array>();
+    DWORD flags = SIIGBF_RESIZETOFIT | SIIGBF_ICONONLY;
+    
+    std::vector<int> sizes;
+    for (uint32_t i = 0; i < sizeArray.Length(); i++) {
+        Napi::Value item = sizeArray[i];
+        if (!item.IsNumber()) {
+            Napi::TypeError::New(env, "尺寸必须是数字").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        int size = item.As<Napi::Number>().Int32Value();
+        sizes.push_back(std::max(16, std::min(size, 1024)));
+    }
+    
+    ThumbnailFormat format = ThumbnailFormat::Png;
+    if (!ReadOutputFormat(env, info[2], format)) {
+        return env.Null();
+    }
+    
+    std::vector<std::vector<BYTE>> buffers;
+    if (!ExtractThumbnailSizesInternal(filePath, sizes, flags, buffers, format)) {
+        Napi::Error::New(env, "无法提取缩略图").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    Napi::Array results = Napi::Array::New(env, buffers.size());
+    for (size_t i = 0; i < buffers.size(); i++) {
+        results.Set(static_cast<uint32_t>(i), TakeBuffer(env, buffers[i]));
+    }
+    return results;
+}
+
+// extractThumbnailsAsync 的批次状态，由 JS 线程在最终回调中释放
+struct AsyncThumbnailBatch {
+    Napi::Promise::Deferred deferred;
+    Napi::Reference<Napi::Array> results;
+    Napi::ThreadSafeFunction tsfn;
+    std::shared_ptr<ThumbnailBatch> batch;
+    std::vector<std::string> paths; // 非字符串项为空串，结果为 null
+    int size;
+    DWORD flags;
+    ThumbnailFormat format;
+    bool streaming;
+};
+
+// 单个文件的结果，由工作线程创建、JS 线程释放
+struct AsyncThumbnailItem {
+    uint32_t index;
+    bool success;
+    std::vector<BYTE> buffer;
+};
+
+// N-API: 并行批量提取
+// extractThumbnailsAsync(paths, size?, { concurrency?, onResult?, outputFormat? }) => Promise<(Buffer|null)[]>
+// 结果按输入顺序排列；onResult(index, buffer|null) 在每个文件完成时调用。
+// 返回的 Promise 带有 cancel()：尚未开始的文件被跳过，Promise 以 code 为 ECANCELED 的错误拒绝
+Napi::Value ExtractThumbnailsAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        Napi::TypeError::New(env, "需要文件路径数组").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    Napi::Array filePaths = info[0].As<Napi::Array>();
+    int size = 256;
+    DWORD flags = SIIGBF_BIGGERSIZEOK | SIIGBF_RESIZETOFIT;
+    
+    if (info.Length() > 1 && info[1].IsNumber()) {
+        size = info[1].As<Napi::Number>().Int32Value();
+        size = std::max(16, std::min(size, 1024));
+        flags = SIIGBF_RESIZETOFIT | SIIGBF_ICONONLY ;
+    }
+    
+    // 默认按 CPU 核数并行，上限 8：Shell 后端主要受磁盘和 COM 限制，更多线程收益不大
+    unsigned int cores = std::thread::hardware_concurrency();
+    int concurrency = static_cast<int>(std::max(1u, std::min(cores, 8u)));
+    Napi::Function onResult;
+    ThumbnailFormat format = ThumbnailFormat::Png;
+    if (!ReadOutputFormat(env, info[2], format)) {
+        return env.Null();
+    }
+    if (info.Length() > 2 && info[2].IsObject()) {
+        Napi::Object options = info[2].As<Napi::Object>();
+        if (options.Has("concurrency") && options.Get("concurrency").IsNumber()) {
+            concurrency = options.Get("concurrency").As<Napi::Number>().Int32Value();
+            concurrency = std::max(1, std::min(concurrency, 64));
+        }
+        if (options.Has("onResult") && options.Get("onResult").IsFunction()) {
+            onResult = options.Get("onResult").As<Napi::Function>();
+        }
+    }
+    
+    uint32_t count = filePaths.Length();
+    auto* state = new AsyncThumbnailBatch{
+        Napi::Promise::Deferred::New(env), Napi::Persistent(Napi::Array::New(env, count)),
+        Napi::ThreadSafeFunction(), nullptr, std::vector<std::string>(count), size, flags, format,
+        !onResult.IsEmpty() };
+    for (uint32_t i = 0; i < count; i++) {
+        Napi::Value item = filePaths[i];
+        if (item.IsString()) {
+            state->paths[i] = item.As<Napi::String>().Utf8Value();
+        }
+    }
+    
+    Napi::Promise promise = state->deferred.Promise();
+    state->tsfn = Napi::ThreadSafeFunction::New(
+        env, state->streaming ? onResult : Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+        "extractThumbnailsAsync", 0, 1);
+    state->batch = std::make_shared<ThumbnailBatch>(count, static_cast<size_t>(concurrency));
+    
+    std::weak_ptr<ThumbnailBatch> weakBatch = state->batch;
+    promise.Set("cancel", Napi::Function::New(env, [weakBatch](const Napi::CallbackInfo& info) {
+        if (auto batch = weakBatch.lock()) {
+            batch->Cancel();
+        }
+        return info.Env().Undefined();
+    }));
+    
+    Napi::ThreadSafeFunction tsfn = state->tsfn;
+    state->batch->Start(PrepareThumbnailThread, [state, tsfn](size_t index) {
+        auto* item = new AsyncThumbnailItem{ static_cast<uint32_t>(index), false, std::vector<BYTE>() };
+        const std::string& filePath = state->paths[index];
+        item->success = !filePath.empty() && ExtractThumbnailCached(filePath, state->size, state->flags,
+                                                                            item->buffer, state->format);
+        
+        // 结果在 JS 线程逐个移交为 Buffer，避免完成时集中处理
+        tsfn.BlockingCall(item, [state](Napi::Env env, Napi::Function onResult, AsyncThumbnailItem* item) {
+            Napi::Value value = env.Null();
+            if (item->success) {
+                value = TakeBuffer(env, item->buffer);
+            }
+            state->results.Value().Set(item->index, value);
+            if (state->streaming) {
+                onResult.Call({ Napi::Number::New(env, item->index), value });
+            }
+            delete item;
+        });
+    }, [state, tsfn](bool cancelled) {
+        // 线程安全函数按调用顺序执行，最终回调一定在所有单项结果之后
+        tsfn.BlockingCall(state, [cancelled](Napi::Env env, Napi::Function, AsyncThumbnailBatch* state) {
+            state->batch->Join();
+            if (cancelled) {
+                Napi::Error error = Napi::Error::New(env, "已取消");
+                error.Set("code", Napi::String::New(env, "ECANCELED"));
+                state->deferred.Reject(error.Value());
+            } else {
+                state->deferred.Resolve(state->results.Value());
+            }
+            delete state;
+        });
+        tsfn.Release();
+    });
+    
+    return promise;
+}
+
+// N-API: 配置缓存 setThumbnailCache({ directory, memoryBytes, diskBytes })
+// directory 为空字符串时关闭磁盘层；同一目录已被其他进程使用时抛出异常
+Napi::Value SetThumbnailCache(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "需要缓存配置对象").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object options = info[0].As<Napi::Object>();
+    if (options.Has("memoryBytes") && options.Get("memoryBytes").IsNumber()) {
+        double bytes = options.Get("memoryBytes").As<Napi::Number>().DoubleValue();
+        g_thumbnailCache.SetMemoryBudget(bytes > 0 ? static_cast<size_t>(bytes) : 0);
+    }
+    if (options.Has("diskBytes") && options.Get("diskBytes").IsNumber()) {
+        double bytes = options.Get("diskBytes").As<Napi::Number>().DoubleValue();
+        g_thumbnailCache.SetDiskBudget(bytes > 0 ? static_cast<uint64_t>(bytes) : 0);
+    }
+    if (options.Has("directory") && options.Get("directory").IsString()) {
+        std::string directory = options.Get("directory").As<Napi::String>().Utf8Value();
+        if (!g_thumbnailCache.SetDirectory(directory)) {
+            Napi::Error::New(env, "无法打开缓存目录").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+    }
+    return Napi::Boolean::New(env, true);
+}
+
+// N-API: 设置 PNG 编码级别 setPngLevel(PNG_LEVEL.FAST)
+// 只影响之后编码的结果，已缓存的缩略图保持原样
+Napi::Value SetPngLevel(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "需要编码级别").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    int level = info[0].As<Napi::Number>().Int32Value();
+    if (level < static_cast<int>(PngLevel::Stored) || level > static_cast<int>(PngLevel::Small)) {
+        Napi::RangeError::New(env, "编码级别无效").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    g_pngLevel.store(level, std::memory_order_relaxed);
+    return Napi::Boolean::New(env, true);
+}
+
+// N-API: 缓存命中统计
+Napi::Value GetThumbnailCacheStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    ThumbnailCacheStats stats = g_thumbnailCache.GetStats();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("memoryHits", Napi::Number::New(env, static_cast<double>(stats.memoryHits)));
+    result.Set("diskHits", Napi::Number::New(env, static_cast<double>(stats.diskHits)));
+    result.Set("misses", Napi::Number::New(env, static_cast<double>(stats.misses)));
+    result.Set("stores", Napi::Number::New(env, static_cast<double>(stats.stores)));
+    result.Set("evictions", Napi::Number::New(env, static_cast<double>(stats.evictions)));
+    result.Set("memoryBytes", Napi::Number::New(env, static_cast<double>(stats.memoryBytes)));
+    result.Set("memoryEntries", Napi::Number::New(env, static_cast<double>(stats.memoryEntries)));
+    result.Set("diskEntries", Napi::Number::New(env, static_cast<double>(stats.diskEntries)));
+    result.Set("diskBytes", Napi::Number::New(env, static_cast<double>(stats.diskBytes)));
+    result.Set("diskCollections", Napi::Number::New(env, static_cast<double>(stats.diskCollections)));
+    return result;
+}
+
+// N-API: 清空缓存
+Napi::Value ClearThumbnailCache(const Napi::CallbackInfo& info) {
+    g_thumbnailCache.Clear();
+    return info.Env().Undefined();
+}
+
 // 模块初始化
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
     exports.Set("extractThumbnail", 
@@ -438,6 +914,18 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
                 Napi::Function::New(env, ExtractThumbnailToFile));
     exports.Set("extractThumbnails", 
                 Napi::Function::New(env, ExtractThumbnails));
+    exports.Set("extractThumbnailsAsync", 
+                Napi::Function::New(env, ExtractThumbnailsAsync));
+    exports.Set("extractThumbnailSizes", 
+                Napi::Function::New(env, ExtractThumbnailSizes));
+    exports.Set("setThumbnailCache", 
+                Napi::Function::New(env, SetThumbnailCache));
+    exports.Set("getThumbnailCacheStats", 
+                Napi::Function::New(env, GetThumbnailCacheStats));
+    exports.Set("clearThumbnailCache", 
+                Napi::Function::New(env, ClearThumbnailCache));
+    exports.Set("setPngLevel", 
+                Napi::Function::New(env, SetPngLevel));
     
     // 导出常量
     Napi::Object flags = Napi::Object::New(env);
@@ -448,6 +936,15 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
     flags.Set("ICONBACKGROUND", Napi::Number::New(env, SIIGBF_ICONBACKGROUND));
     exports.Set("FLAGS", flags);
     
+    Napi::Object pngLevels = Napi::Object::New(env);
+    pngLevels.Set("STORED", Napi::Number::New(env, static_cast<int>(PngLevel::Stored)));
+    pngLevels.Set("FAST", Napi::Number::New(env, static_cast<int>(PngLevel::Fast)));
+    pngLevels.Set("DEFAULT", Napi::Number::New(env, static_cast<int>(PngLevel::Default)));
+    pngLevels.Set("SMALL", Napi::Number::New(env, static_cast<int>(PngLevel::Small)));
+    exports.Set("PNG_LEVEL", pngLevels);
+    
+    InitIconAtlas(env, exports);
+    
     return exports;
 }
 
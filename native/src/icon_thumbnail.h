@@ -2,15 +2,24 @@
 #define ICON_THUMBNAIL_H
 
 #include <napi.h>
+#ifdef _WIN32
 #include <windows.h>
 #include <shobjidl.h>
 #include <shlobj.h>
 #include <gdiplus.h>
+#else
+#include <cstdint>
+typedef uint8_t BYTE;
+typedef uint32_t DWORD;
+#endif
 #include <vector>
 #include <string>
 #include <memory>
 #include <fstream>
 
+#include "bgra_image.h"
+#include "image_formats.h"
+
 // Windows thumbnail API flags
 #define SIIGBF_RESIZETOFIT     0x00000000
 #define SIIGBF_BIGGERSIZEOK    0x00000001
@@ -18,16 +27,51 @@
 #define SIIGBF_ICONONLY        0x00000004
 #define SIIGBF_THUMBNAILONLY   0x00000008
 #define SIIGBF_INCACHEONLY     0x00000010
+#define SIIGBF_ICONBACKGROUND  0x00000080
 
 // Main export functions
 Napi::Value ExtractThumbnail(const Napi::CallbackInfo& info);
 Napi::Value ExtractThumbnailToFile(const Napi::CallbackInfo& info);
 Napi::Value ExtractThumbnails(const Napi::CallbackInfo& info);
+Napi::Value ExtractThumbnailsAsync(const Napi::CallbackInfo& info);
+Napi::Value ExtractThumbnailSizes(const Napi::CallbackInfo& info);
+Napi::Value SetThumbnailCache(const Napi::CallbackInfo& info);
+Napi::Value GetThumbnailCacheStats(const Napi::CallbackInfo& info);
+Napi::Value ClearThumbnailCache(const Napi::CallbackInfo& info);
+Napi::Value SetPngLevel(const Napi::CallbackInfo& info);
+// 导出 IconAtlas 类（icon_atlas_bindings.cpp）
+Napi::Object InitIconAtlas(Napi::Env env, Napi::Object exports);
+
+// N-API helpers
+// 把 buffer 的内存移交给 JS Buffer，调用后 buffer 为空
+Napi::Value TakeBuffer(Napi::Env env, std::vector<BYTE>& buffer);
+// 读取 options.outputFormat，无效时抛出 TypeError 并返回 false
+bool ReadOutputFormat(Napi::Env env, const Napi::Value& options, ThumbnailFormat& format);
 
 // Internal helper functions
+#ifdef _WIN32
 CLSID GetPngEncoderClsid();
-bool SaveBitmapToBuffer(HBITMAP hBitmap, std::vector<BYTE>& buffer);
-bool ExtractThumbnailInternal(const std::wstring& filePath, int size, 
-                              DWORD flags, std::vector<BYTE>& buffer);
+bool SaveBitmapToBuffer(HBITMAP hBitmap, std::vector<BYTE>& buffer,
+                        ThumbnailFormat format = ThumbnailFormat::Png);
+#endif
+// 初始化当前线程的提取后端（Windows 上为 COM 单线程套间和 GDI+），每个线程只执行一次
+void PrepareThumbnailThread();
+// BGRA 像素编码为 PNG（内置编码器，级别由 setPngLevel 设置）
+bool EncodeBgraToPng(const BgraImage& image, std::vector<BYTE>& buffer);
+// 按输出格式编码（PNG / QOI / 预乘 RGBA）
+bool EncodeBgraThumbnail(const BgraImage& image, ThumbnailFormat format, std::vector<BYTE>& buffer);
+// filePath 为 UTF-8。.exe/.dll/.ico 先由内置 PE/ICO 解析器处理，失败时（Windows 上）退回 Shell
+bool ExtractThumbnailInternal(const std::string& filePath, int size, 
+                              DWORD flags, std::vector<BYTE>& buffer,
+                              ThumbnailFormat format = ThumbnailFormat::Png);
+// 先查缩略图缓存（各格式分别缓存），未命中时从已缓存的其他无损格式转码，
+// 都没有时调用 ExtractThumbnailInternal，结果写回缓存
+bool ExtractThumbnailCached(const std::string& filePath, int size,
+                            DWORD flags, std::vector<BYTE>& buffer,
+                            ThumbnailFormat format = ThumbnailFormat::Png);
+// 同一文件的多个尺寸：源图像只解码一次，一次遍历生成全部尺寸，buffers 与 sizes 一一对应
+bool ExtractThumbnailSizesInternal(const std::string& filePath, const std::vector<int>& sizes,
+                                   DWORD flags, std::vector<std::vector<BYTE>>& buffers,
+                                   ThumbnailFormat format = ThumbnailFormat::Png);
 
-#endif
\ No newline at end of file
+#endif
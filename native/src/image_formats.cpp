@@ -0,0 +1,331 @@
+#include "image_formats.h"
+
+#include <cstring>
+
+#include "pixel_kernels.h"
+#include "png_codec.h"
+
+namespace {
+
+// 图像尺寸上限，与 PNG 解码器一致
+const uint32_t kMaxDimension = 16384;
+
+// 比较 text 末尾 length 个字符与小写的 expected，忽略 ASCII 大小写
+bool EndsWithIgnoreCase(const std::string& text, const char* expected) {
+    size_t length = strlen(expected);
+    if (text.size() < length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        char c = text[text.size() - length + i];
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+        if (c != expected[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t ReadBe32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+uint32_t ReadLe32(const uint8_t* p) {
+    return p[0] | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint8_t* PutBe32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+    return p + 4;
+}
+
+uint8_t* PutLe32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+    p[2] = static_cast<uint8_t>(value >> 16);
+    p[3] = static_cast<uint8_t>(value >> 24);
+    return p + 4;
+}
+
+bool ValidSize(uint32_t width, uint32_t height) {
+    return width > 0 && height > 0 && width <= kMaxDimension && height <= kMaxDimension;
+}
+
+// ---------------------------------------------------------------------------
+// QOI
+
+const size_t kQoiHeaderSize = 14;
+const uint8_t kQoiPadding[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+const uint8_t kQoiOpIndex = 0x00;
+const uint8_t kQoiOpDiff = 0x40;
+const uint8_t kQoiOpLuma = 0x80;
+const uint8_t kQoiOpRun = 0xc0;
+const uint8_t kQoiOpRgb = 0xfe;
+const uint8_t kQoiOpRgba = 0xff;
+const uint8_t kQoiMask = 0xc0;
+const int kQoiMaxRun = 62;
+
+// 像素按 BGRA 内存顺序读成小端 uint32：0xAARRGGBB，整数比较即可判断相等
+inline uint32_t LoadPixel(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return value;
+}
+
+inline int QoiHash(uint32_t bgra) {
+    uint32_t b = bgra & 0xff, g = (bgra >> 8) & 0xff, r = (bgra >> 16) & 0xff, a = bgra >> 24;
+    return static_cast<int>((r * 3 + g * 5 + b * 7 + a * 11) & 63);
+}
+
+} // namespace
+
+bool ParseThumbnailFormat(const std::string& name, ThumbnailFormat& format) {
+    if (name.size() == 3 && EndsWithIgnoreCase(name, "png")) {
+        format = ThumbnailFormat::Png;
+    } else if (name.size() == 3 && EndsWithIgnoreCase(name, "qoi")) {
+        format = ThumbnailFormat::Qoi;
+    } else if (name.size() == 4 && EndsWithIgnoreCase(name, "rgba")) {
+        format = ThumbnailFormat::Rgba;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ThumbnailFormatFromPath(const std::string& path, ThumbnailFormat& format) {
+    if (EndsWithIgnoreCase(path, ".png")) {
+        format = ThumbnailFormat::Png;
+    } else if (EndsWithIgnoreCase(path, ".qoi")) {
+        format = ThumbnailFormat::Qoi;
+    } else if (EndsWithIgnoreCase(path, ".rgba")) {
+        format = ThumbnailFormat::Rgba;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool IsQoiData(const uint8_t* data, size_t size) {
+    return size >= kQoiHeaderSize + sizeof(kQoiPadding) && memcmp(data, "qoif", 4) == 0;
+}
+
+bool EncodeQoi(const BgraImage& image, std::vector<uint8_t>& output) {
+    if (!ValidSize(static_cast<uint32_t>(image.width), static_cast<uint32_t>(image.height))) {
+        return false;
+    }
+
+    // 最坏情况每个像素 5 字节（QOI_OP_RGBA），一次分配后按实际长度截断
+    size_t pixelCount = static_cast<size_t>(image.width) * image.height;
+    output.resize(kQoiHeaderSize + pixelCount * 5 + sizeof(kQoiPadding));
+    uint8_t* out = output.data();
+    memcpy(out, "qoif", 4);
+    out = PutBe32(out + 4, static_cast<uint32_t>(image.width));
+    out = PutBe32(out, static_cast<uint32_t>(image.height));
+    *out++ = 4; // RGBA
+    *out++ = 0; // sRGB，alpha 为线性
+
+    uint32_t index[64] = {};
+    uint32_t previous = 0xff000000u;
+    int run = 0;
+    const uint8_t* src = image.pixels.data();
+    for (size_t i = 0; i < pixelCount; i++, src += 4) {
+        uint32_t pixel = LoadPixel(src);
+        if (pixel == previous) {
+            if (++run == kQoiMaxRun) {
+                *out++ = static_cast<uint8_t>(kQoiOpRun | (run - 1));
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            *out++ = static_cast<uint8_t>(kQoiOpRun | (run - 1));
+            run = 0;
+        }
+
+        int hash = QoiHash(pixel);
+        if (index[hash] == pixel) {
+            *out++ = static_cast<uint8_t>(kQoiOpIndex | hash);
+        } else {
+            index[hash] = pixel;
+            if ((pixel ^ previous) >> 24 == 0) {
+                int8_t dr = static_cast<int8_t>(src[2] - static_cast<uint8_t>(previous >> 16));
+                int8_t dg = static_cast<int8_t>(src[1] - static_cast<uint8_t>(previous >> 8));
+                int8_t db = static_cast<int8_t>(src[0] - static_cast<uint8_t>(previous));
+                int drg = dr - dg;
+                int dbg = db - dg;
+                if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                    *out++ = static_cast<uint8_t>(kQoiOpDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+                } else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+                    *out++ = static_cast<uint8_t>(kQoiOpLuma | (dg + 32));
+                    *out++ = static_cast<uint8_t>((drg + 8) << 4 | (dbg + 8));
+                } else {
+                    out[0] = kQoiOpRgb;
+                    out[1] = src[2];
+                    out[2] = src[1];
+                    out[3] = src[0];
+                    out += 4;
+                }
+            } else {
+                out[0] = kQoiOpRgba;
+                out[1] = src[2];
+                out[2] = src[1];
+                out[3] = src[0];
+                out[4] = src[3];
+                out += 5;
+            }
+        }
+        previous = pixel;
+    }
+    if (run > 0) {
+        *out++ = static_cast<uint8_t>(kQoiOpRun | (run - 1));
+    }
+    memcpy(out, kQoiPadding, sizeof(kQoiPadding));
+    out += sizeof(kQoiPadding);
+    output.resize(out - output.data());
+    return true;
+}
+
+bool DecodeQoi(const uint8_t* data, size_t size, BgraImage& image) {
+    if (!IsQoiData(data, size)) {
+        return false;
+    }
+    uint32_t width = ReadBe32(data + 4);
+    uint32_t height = ReadBe32(data + 8);
+    if (!ValidSize(width, height) || (data[12] != 3 && data[12] != 4) || data[13] > 1) {
+        return false;
+    }
+
+    image.Allocate(static_cast<int>(width), static_cast<int>(height));
+    uint8_t* dst = image.pixels.data();
+    uint8_t* end = dst + image.pixels.size();
+    // 数据块不会越过结尾填充：每次读取前检查剩余字节数
+    const uint8_t* in = data + kQoiHeaderSize;
+    const uint8_t* chunksEnd = data + size - sizeof(kQoiPadding);
+
+    uint32_t index[64] = {};
+    uint8_t b = 0, g = 0, r = 0, a = 255;
+    while (dst < end) {
+        if (in >= chunksEnd) {
+            return false;
+        }
+        uint8_t op = *in++;
+        if (op == kQoiOpRgb) {
+            if (chunksEnd - in < 3) {
+                return false;
+            }
+            r = in[0];
+            g = in[1];
+            b = in[2];
+            in += 3;
+        } else if (op == kQoiOpRgba) {
+            if (chunksEnd - in < 4) {
+                return false;
+            }
+            r = in[0];
+            g = in[1];
+            b = in[2];
+            a = in[3];
+            in += 4;
+        } else if ((op & kQoiMask) == kQoiOpIndex) {
+            uint32_t pixel = index[op];
+            b = static_cast<uint8_t>(pixel);
+            g = static_cast<uint8_t>(pixel >> 8);
+            r = static_cast<uint8_t>(pixel >> 16);
+            a = static_cast<uint8_t>(pixel >> 24);
+        } else if ((op & kQoiMask) == kQoiOpDiff) {
+            r = static_cast<uint8_t>(r + ((op >> 4) & 3) - 2);
+            g = static_cast<uint8_t>(g + ((op >> 2) & 3) - 2);
+            b = static_cast<uint8_t>(b + (op & 3) - 2);
+        } else if ((op & kQoiMask) == kQoiOpLuma) {
+            if (in >= chunksEnd) {
+                return false;
+            }
+            int dg = (op & 0x3f) - 32;
+            uint8_t next = *in++;
+            r = static_cast<uint8_t>(r + dg - 8 + (next >> 4));
+            g = static_cast<uint8_t>(g + dg);
+            b = static_cast<uint8_t>(b + dg - 8 + (next & 0x0f));
+        } else {
+            // QOI_OP_RUN：重复上一个像素 1..62 次，index 不变
+            size_t count = static_cast<size_t>((op & 0x3f) + 1);
+            if (count > static_cast<size_t>(end - dst) / 4) {
+                return false;
+            }
+            uint32_t pixel = b | (g << 8) | (r << 16) | (static_cast<uint32_t>(a) << 24);
+            for (size_t i = 0; i < count; i++, dst += 4) {
+                memcpy(dst, &pixel, 4);
+            }
+            continue;
+        }
+
+        uint32_t pixel = b | (g << 8) | (r << 16) | (static_cast<uint32_t>(a) << 24);
+        index[QoiHash(pixel)] = pixel;
+        memcpy(dst, &pixel, 4);
+        dst += 4;
+    }
+    return true;
+}
+
+bool IsRawRgbaData(const uint8_t* data, size_t size) {
+    return size >= kRawRgbaHeaderSize && memcmp(data, "RGBA", 4) == 0;
+}
+
+bool EncodeRawRgba(const BgraImage& image, std::vector<uint8_t>& output) {
+    if (!ValidSize(static_cast<uint32_t>(image.width), static_cast<uint32_t>(image.height))) {
+        return false;
+    }
+
+    size_t pixelCount = static_cast<size_t>(image.width) * image.height;
+    output.resize(kRawRgbaHeaderSize + pixelCount * 4);
+    uint8_t* out = output.data();
+    memcpy(out, "RGBA", 4);
+    out = PutLe32(out + 4, static_cast<uint32_t>(image.width));
+    out = PutLe32(out, static_cast<uint32_t>(image.height));
+    out[0] = kRawRgbaPremultiplied;
+    out[1] = out[2] = out[3] = 0;
+
+    // 图像紧密排列，整幅作为一行处理
+    const PixelKernels& kernels = GetPixelKernels();
+    uint8_t* pixels = output.data() + kRawRgbaHeaderSize;
+    kernels.premultiply(pixels, image.pixels.data(), pixelCount);
+    kernels.swizzle(pixels, pixels, pixelCount);
+    return true;
+}
+
+bool DecodeRawRgba(const uint8_t* data, size_t size, BgraImage& image) {
+    if (!IsRawRgbaData(data, size)) {
+        return false;
+    }
+    uint32_t width = ReadLe32(data + 4);
+    uint32_t height = ReadLe32(data + 8);
+    size_t pixelCount = static_cast<size_t>(width) * height;
+    if (!ValidSize(width, height) || size - kRawRgbaHeaderSize < pixelCount * 4) {
+        return false;
+    }
+
+    image.Allocate(static_cast<int>(width), static_cast<int>(height));
+    const PixelKernels& kernels = GetPixelKernels();
+    kernels.swizzle(image.pixels.data(), data + kRawRgbaHeaderSize, pixelCount);
+    if (data[12] & kRawRgbaPremultiplied) {
+        kernels.unpremultiply(image.pixels.data(), image.pixels.data(), pixelCount);
+    }
+    return true;
+}
+
+bool DecodeThumbnail(const uint8_t* data, size_t size, BgraImage& image) {
+    if (IsPngData(data, size)) {
+        return DecodePng(data, size, image);
+    }
+    if (IsQoiData(data, size)) {
+        return DecodeQoi(data, size, image);
+    }
+    return DecodeRawRgba(data, size, image);
+}
@@ -0,0 +1,47 @@
+#ifndef IMAGE_FORMATS_H
+#define IMAGE_FORMATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bgra_image.h"
+
+// 缩略图输出格式，数值参与缓存键，不可更改
+enum class ThumbnailFormat {
+    Png = 0,
+    Qoi = 1,  // QOI（qoiformat.org）：无损，编解码都只需一次线性遍历，远快于 PNG
+    Rgba = 2, // 16 字节头 + 预乘 RGBA 像素，渲染端无需解码即可上传为纹理
+};
+
+// 原始 RGBA 格式布局（多字节字段为小端）：
+//   0  "RGBA"
+//   4  uint32 宽度
+//   8  uint32 高度
+//   12 uint8  标志，kRawRgbaPremultiplied
+//   13 3 字节保留，为 0
+//   16 像素，逐行紧密排列、自上而下。头长 16 字节，Buffer 起始对齐时像素同样对齐，可直接建 Uint32Array 视图
+const size_t kRawRgbaHeaderSize = 16;
+const uint8_t kRawRgbaPremultiplied = 0x01;
+
+// "png" / "qoi" / "rgba"，不区分大小写
+bool ParseThumbnailFormat(const std::string& name, ThumbnailFormat& format);
+// 按输出文件扩展名推断格式（.qoi、.rgba），无法识别时返回 false
+bool ThumbnailFormatFromPath(const std::string& path, ThumbnailFormat& format);
+
+bool IsQoiData(const uint8_t* data, size_t size);
+// 编码为 4 通道 QOI，解码后与 image 逐位一致
+bool EncodeQoi(const BgraImage& image, std::vector<uint8_t>& output);
+bool DecodeQoi(const uint8_t* data, size_t size, BgraImage& image);
+
+bool IsRawRgbaData(const uint8_t* data, size_t size);
+// 预乘并交换红蓝（pixel_kernels），output 一次分配到最终大小
+bool EncodeRawRgba(const BgraImage& image, std::vector<uint8_t>& output);
+// 还原为非预乘 BGRA，alpha 介于 0 和 255 之间的像素颜色有舍入误差
+bool DecodeRawRgba(const uint8_t* data, size_t size, BgraImage& image);
+
+// 按数据头识别 PNG / QOI / 原始 RGBA 并解码为非预乘 BGRA
+bool DecodeThumbnail(const uint8_t* data, size_t size, BgraImage& image);
+
+#endif
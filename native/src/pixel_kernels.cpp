@@ -0,0 +1,527 @@
+#include "pixel_kernels.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PIXEL_KERNELS_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define PIXEL_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC/Clang 需要为 AVX2 函数单独开启指令集，MSVC 可直接使用全部内建函数
+#if defined(PIXEL_KERNELS_X86) && !(defined(_MSC_VER) && !defined(__clang__))
+#define PIXEL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define PIXEL_TARGET_AVX2
+#endif
+
+namespace {
+
+// ---------------- 标量参考实现 ----------------
+
+// round(c * a / 255)，对全部 0..255 输入精确
+inline uint8_t MulDiv255(uint32_t c, uint32_t a) {
+    uint32_t t = c * a + 128;
+    return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+}
+
+inline uint8_t Unpremultiply(uint32_t c, uint32_t a) {
+    uint32_t value = (c * 255 + a / 2) / a;
+    return static_cast<uint8_t>(value < 255 ? value : 255);
+}
+
+void MergeAlphaScalar(uint8_t* dst, const uint8_t* src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i * 4 + 3] = src[i * 4 + 3];
+    }
+}
+
+void SwizzleScalar(uint8_t* dst, const uint8_t* src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint8_t first = src[i * 4 + 0];
+        uint8_t third = src[i * 4 + 2];
+        dst[i * 4 + 0] = third;
+        dst[i * 4 + 1] = src[i * 4 + 1];
+        dst[i * 4 + 2] = first;
+        dst[i * 4 + 3] = src[i * 4 + 3];
+    }
+}
+
+void PremultiplyScalar(uint8_t* dst, const uint8_t* src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* p = src + i * 4;
+        uint8_t* out = dst + i * 4;
+        uint8_t a = p[3];
+        out[0] = MulDiv255(p[0], a);
+        out[1] = MulDiv255(p[1], a);
+        out[2] = MulDiv255(p[2], a);
+        out[3] = a;
+    }
+}
+
+void UnpremultiplyScalar(uint8_t* dst, const uint8_t* src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* p = src + i * 4;
+        uint8_t* out = dst + i * 4;
+        uint8_t a = p[3];
+        if (a == 0) {
+            out[0] = out[1] = out[2] = 0;
+        } else {
+            out[0] = Unpremultiply(p[0], a);
+            out[1] = Unpremultiply(p[1], a);
+            out[2] = Unpremultiply(p[2], a);
+        }
+        out[3] = a;
+    }
+}
+
+void KeyRowScalar(uint8_t* row, size_t count, uint32_t key) {
+    uint8_t b = static_cast<uint8_t>(key);
+    uint8_t g = static_cast<uint8_t>(key >> 8);
+    uint8_t r = static_cast<uint8_t>(key >> 16);
+    for (size_t i = 0; i < count; i++) {
+        uint8_t* p = row + i * 4;
+        if (p[0] == b && p[1] == g && p[2] == r) {
+            p[3] = 0;
+        }
+    }
+}
+
+void SwapBytesScalar(uint8_t* a, uint8_t* b, size_t bytes) {
+    uint8_t temp[256];
+    while (bytes > 0) {
+        size_t chunk = bytes < sizeof(temp) ? bytes : sizeof(temp);
+        memcpy(temp, a, chunk);
+        memcpy(a, b, chunk);
+        memcpy(b, temp, chunk);
+        a += chunk;
+        b += chunk;
+        bytes -= chunk;
+    }
+}
+
+const PixelKernels kScalarKernels = {
+    "scalar", MergeAlphaScalar, SwizzleScalar, PremultiplyScalar, UnpremultiplyScalar, KeyRowScalar, SwapBytesScalar
+};
+
+#ifdef PIXEL_KERNELS_X86
+
+// ---------------- SSE2：每次 4 个像素 ----------------
+
+const uint32_t kAlphaMask = 0xFF000000u;
+const uint32_t kColorMask = 0x00FFFFFFu;
+
+inline __m128i Load128(const uint8_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+inline void Store128(uint8_t* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+
+void MergeAlphaSse2(uint8_t* dst, const uint8_t* src, size_t count) {
+    const __m128i mask = _mm_set1_epi32(static_cast<int>(kAlphaMask));
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i d = Load128(dst + i * 4);
+        __m128i s = Load128(src + i * 4);
+        Store128(dst + i * 4, _mm_or_si128(_mm_andnot_si128(mask, d), _mm_and_si128(mask, s)));
+    }
+    MergeAlphaScalar(dst + i * 4, src + i * 4, count - i);
+}
+
+// 没有 pshufb，用移位交换第 0 和第 2 字节
+void SwizzleSse2(uint8_t* dst, const uint8_t* src, size_t count) {
+    const __m128i keep = _mm_set1_epi32(static_cast<int>(0xFF00FF00u));
+    const __m128i swap = _mm_set1_epi32(0x00FF00FF);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = Load128(src + i * 4);
+        __m128i rb = _mm_and_si128(v, swap);
+        rb = _mm_or_si128(_mm_srli_epi32(rb, 16), _mm_slli_epi32(rb, 16));
+        Store128(dst + i * 4, _mm_or_si128(_mm_and_si128(v, keep), rb));
+    }
+    SwizzleScalar(dst + i * 4, src + i * 4, count - i);
+}
+
+// 两个像素的 16 位通道乘以各自的 alpha 并除以 255，与 MulDiv255 相同
+inline __m128i MulDiv255Sse2(__m128i channels) {
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(channels, 0xFF), 0xFF);
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(channels, alpha), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+void PremultiplySse2(uint8_t* dst, const uint8_t* src, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask = _mm_set1_epi32(static_cast<int>(kAlphaMask));
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = Load128(src + i * 4);
+        __m128i lo = MulDiv255Sse2(_mm_unpacklo_epi8(v, zero));
+        __m128i hi = MulDiv255Sse2(_mm_unpackhi_epi8(v, zero));
+        __m128i result = _mm_packus_epi16(lo, hi);
+        Store128(dst + i * 4, _mm_or_si128(_mm_andnot_si128(mask, result), _mm_and_si128(mask, v)));
+    }
+    PremultiplyScalar(dst + i * 4, src + i * 4, count - i);
+}
+
+// 单个像素（4 个 32 位通道）反预乘。c * 255 / a 的浮点商是正确舍入的，
+// 而精确商与 x.5 的距离至少为 1 / 510，远大于误差，所以截断 (q + 0.5) 与整数公式一致
+inline __m128i UnpremultiplyPixelSse2(__m128i pixel) {
+    __m128 value = _mm_cvtepi32_ps(pixel);
+    __m128 alpha = _mm_shuffle_ps(value, value, 0xFF);
+    __m128 q = _mm_div_ps(_mm_mul_ps(value, _mm_set1_ps(255.0f)), alpha);
+    q = _mm_min_ps(_mm_add_ps(q, _mm_set1_ps(0.5f)), _mm_set1_ps(255.0f));
+    __m128i nonzero = _mm_castps_si128(_mm_cmpgt_ps(alpha, _mm_setzero_ps()));
+    return _mm_and_si128(_mm_cvttps_epi32(q), nonzero);
+}
+
+void UnpremultiplySse2(uint8_t* dst, const uint8_t* src, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask = _mm_set1_epi32(static_cast<int>(kAlphaMask));
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = Load128(src + i * 4);
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        __m128i p0 = UnpremultiplyPixelSse2(_mm_unpacklo_epi16(lo, zero));
+        __m128i p1 = UnpremultiplyPixelSse2(_mm_unpackhi_epi16(lo, zero));
+        __m128i p2 = UnpremultiplyPixelSse2(_mm_unpacklo_epi16(hi, zero));
+        __m128i p3 = UnpremultiplyPixelSse2(_mm_unpackhi_epi16(hi, zero));
+        __m128i result = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+        Store128(dst + i * 4, _mm_or_si128(_mm_andnot_si128(mask, result), _mm_and_si128(mask, v)));
+    }
+    UnpremultiplyScalar(dst + i * 4, src + i * 4, count - i);
+}
+
+void KeyRowSse2(uint8_t* row, size_t count, uint32_t key) {
+    const __m128i color = _mm_set1_epi32(static_cast<int>(kColorMask));
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(kAlphaMask));
+    const __m128i target = _mm_set1_epi32(static_cast<int>(key & kColorMask));
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = Load128(row + i * 4);
+        __m128i match = _mm_cmpeq_epi32(_mm_and_si128(v, color), target);
+        Store128(row + i * 4, _mm_andnot_si128(_mm_and_si128(match, alpha), v));
+    }
+    KeyRowScalar(row + i * 4, count - i, key);
+}
+
+void SwapBytesSse2(uint8_t* a, uint8_t* b, size_t bytes) {
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i x = Load128(a + i);
+        __m128i y = Load128(b + i);
+        Store128(a + i, y);
+        Store128(b + i, x);
+    }
+    SwapBytesScalar(a + i, b + i, bytes - i);
+}
+
+const PixelKernels kSse2Kernels = {
+    "sse2", MergeAlphaSse2, SwizzleSse2, PremultiplySse2, UnpremultiplySse2, KeyRowSse2, SwapBytesSse2
+};
+
+// ---------------- AVX2：每次 8 个像素，逐 128 位通道与 SSE2 版本相同 ----------------
+// 尾部直接用标量处理，并在离开前清零 YMM 高位：GCC 尾调用时不会自动插入 vzeroupper，
+// 之后执行的非 VEX SSE 代码（如缩放卷积）会因 AVX-SSE 状态切换变慢数倍
+
+PIXEL_TARGET_AVX2 inline __m256i Load256(const uint8_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+PIXEL_TARGET_AVX2 inline void Store256(uint8_t* p, __m256i v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+}
+
+PIXEL_TARGET_AVX2 void MergeAlphaAvx2(uint8_t* dst, const uint8_t* src, size_t count) {
+    const __m256i mask = _mm256_set1_epi32(static_cast<int>(kAlphaMask));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i d = Load256(dst + i * 4);
+        __m256i s = Load256(src + i * 4);
+        Store256(dst + i * 4, _mm256_blendv_epi8(d, s, mask));
+    }
+    _mm256_zeroupper();
+    MergeAlphaScalar(dst + i * 4, src + i * 4, count - i);
+}
+
+PIXEL_TARGET_AVX2 void SwizzleAvx2(uint8_t* dst, const uint8_t* src, size_t count) {
+    const __m256i order = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                           2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        Store256(dst + i * 4, _mm256_shuffle_epi8(Load256(src + i * 4), order));
+    }
+    _mm256_zeroupper();
+    SwizzleScalar(dst + i * 4, src + i * 4, count - i);
+}
+
+PIXEL_TARGET_AVX2 inline __m256i MulDiv255Avx2(__m256i channels) {
+    __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(channels, 0xFF), 0xFF);
+    __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(channels, alpha), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+PIXEL_TARGET_AVX2 void PremultiplyAvx2(uint8_t* dst, const uint8_t* src, size_t count) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i mask = _mm256_set1_epi32(static_cast<int>(kAlphaMask));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = Load256(src + i * 4);
+        __m256i lo = MulDiv255Avx2(_mm256_unpacklo_epi8(v, zero));
+        __m256i hi = MulDiv255Avx2(_mm256_unpackhi_epi8(v, zero));
+        Store256(dst + i * 4, _mm256_blendv_epi8(_mm256_packus_epi16(lo, hi), v, mask));
+    }
+    _mm256_zeroupper();
+    PremultiplyScalar(dst + i * 4, src + i * 4, count - i);
+}
+
+// 每个 128 位通道是一个像素，与 UnpremultiplyPixelSse2 相同
+PIXEL_TARGET_AVX2 inline __m256i UnpremultiplyPixelsAvx2(__m256i pixels) {
+    __m256 value = _mm256_cvtepi32_ps(pixels);
+    __m256 alpha = _mm256_shuffle_ps(value, value, 0xFF);
+    __m256 q = _mm256_div_ps(_mm256_mul_ps(value, _mm256_set1_ps(255.0f)), alpha);
+    q = _mm256_min_ps(_mm256_add_ps(q, _mm256_set1_ps(0.5f)), _mm256_set1_ps(255.0f));
+    __m256i nonzero = _mm256_castps_si256(_mm256_cmp_ps(alpha, _mm256_setzero_ps(), _CMP_GT_OQ));
+    return _mm256_and_si256(_mm256_cvttps_epi32(q), nonzero);
+}
+
+PIXEL_TARGET_AVX2 void UnpremultiplyAvx2(uint8_t* dst, const uint8_t* src, size_t count) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i mask = _mm256_set1_epi32(static_cast<int>(kAlphaMask));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = Load256(src + i * 4);
+        __m256i lo = _mm256_unpacklo_epi8(v, zero);
+        __m256i hi = _mm256_unpackhi_epi8(v, zero);
+        __m256i p0 = UnpremultiplyPixelsAvx2(_mm256_unpacklo_epi16(lo, zero));
+        __m256i p1 = UnpremultiplyPixelsAvx2(_mm256_unpackhi_epi16(lo, zero));
+        __m256i p2 = UnpremultiplyPixelsAvx2(_mm256_unpacklo_epi16(hi, zero));
+        __m256i p3 = UnpremultiplyPixelsAvx2(_mm256_unpackhi_epi16(hi, zero));
+        __m256i result = _mm256_packus_epi16(_mm256_packs_epi32(p0, p1), _mm256_packs_epi32(p2, p3));
+        Store256(dst + i * 4, _mm256_blendv_epi8(result, v, mask));
+    }
+    _mm256_zeroupper();
+    UnpremultiplyScalar(dst + i * 4, src + i * 4, count - i);
+}
+
+PIXEL_TARGET_AVX2 void KeyRowAvx2(uint8_t* row, size_t count, uint32_t key) {
+    const __m256i color = _mm256_set1_epi32(static_cast<int>(kColorMask));
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(kAlphaMask));
+    const __m256i target = _mm256_set1_epi32(static_cast<int>(key & kColorMask));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = Load256(row + i * 4);
+        __m256i match = _mm256_cmpeq_epi32(_mm256_and_si256(v, color), target);
+        Store256(row + i * 4, _mm256_andnot_si256(_mm256_and_si256(match, alpha), v));
+    }
+    _mm256_zeroupper();
+    KeyRowScalar(row + i * 4, count - i, key);
+}
+
+PIXEL_TARGET_AVX2 void SwapBytesAvx2(uint8_t* a, uint8_t* b, size_t bytes) {
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i x = Load256(a + i);
+        __m256i y = Load256(b + i);
+        Store256(a + i, y);
+        Store256(b + i, x);
+    }
+    _mm256_zeroupper();
+    SwapBytesScalar(a + i, b + i, bytes - i);
+}
+
+const PixelKernels kAvx2Kernels = {
+    "avx2", MergeAlphaAvx2, SwizzleAvx2, PremultiplyAvx2, UnpremultiplyAvx2, KeyRowAvx2, SwapBytesAvx2
+};
+
+bool CpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    // 需要操作系统保存 YMM 寄存器（OSXSAVE 且 XCR0 的 SSE/AVX 位已置位）
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // PIXEL_KERNELS_X86
+
+#ifdef PIXEL_KERNELS_NEON
+
+// ---------------- NEON：每次 16 个像素，按通道解交错 ----------------
+
+void MergeAlphaNeon(uint8_t* dst, const uint8_t* src, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t d = vld4q_u8(dst + i * 4);
+        d.val[3] = vld4q_u8(src + i * 4).val[3];
+        vst4q_u8(dst + i * 4, d);
+    }
+    MergeAlphaScalar(dst + i * 4, src + i * 4, count - i);
+}
+
+void SwizzleNeon(uint8_t* dst, const uint8_t* src, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t v = vld4q_u8(src + i * 4);
+        uint8x16_t first = v.val[0];
+        v.val[0] = v.val[2];
+        v.val[2] = first;
+        vst4q_u8(dst + i * 4, v);
+    }
+    SwizzleScalar(dst + i * 4, src + i * 4, count - i);
+}
+
+inline uint8x8_t MulDiv255Neon(uint16x8_t product) {
+    uint16x8_t t = vaddq_u16(product, vdupq_n_u16(128));
+    return vshrn_n_u16(vaddq_u16(t, vshrq_n_u16(t, 8)), 8);
+}
+
+void PremultiplyNeon(uint8_t* dst, const uint8_t* src, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t v = vld4q_u8(src + i * 4);
+        for (int c = 0; c < 3; c++) {
+            uint8x8_t lo = MulDiv255Neon(vmull_u8(vget_low_u8(v.val[c]), vget_low_u8(v.val[3])));
+            uint8x8_t hi = MulDiv255Neon(vmull_high_u8(v.val[c], v.val[3]));
+            v.val[c] = vcombine_u8(lo, hi);
+        }
+        vst4q_u8(dst + i * 4, v);
+    }
+    PremultiplyScalar(dst + i * 4, src + i * 4, count - i);
+}
+
+// 4 个像素的同一通道反预乘，推导见 UnpremultiplyPixelSse2
+inline uint32x4_t UnpremultiplyLanesNeon(uint32x4_t channel, uint32x4_t alpha) {
+    float32x4_t q = vdivq_f32(vmulq_n_f32(vcvtq_f32_u32(channel), 255.0f), vcvtq_f32_u32(alpha));
+    q = vminq_f32(vaddq_f32(q, vdupq_n_f32(0.5f)), vdupq_n_f32(255.0f));
+    return vbicq_u32(vcvtq_u32_f32(q), vceqq_u32(alpha, vdupq_n_u32(0)));
+}
+
+inline uint8x16_t UnpremultiplyChannelNeon(uint8x16_t channel, uint8x16_t alpha) {
+    uint16x8_t c16[2] = { vmovl_u8(vget_low_u8(channel)), vmovl_u8(vget_high_u8(channel)) };
+    uint16x8_t a16[2] = { vmovl_u8(vget_low_u8(alpha)), vmovl_u8(vget_high_u8(alpha)) };
+    uint8x8_t halves[2];
+    for (int h = 0; h < 2; h++) {
+        uint32x4_t lo = UnpremultiplyLanesNeon(vmovl_u16(vget_low_u16(c16[h])), vmovl_u16(vget_low_u16(a16[h])));
+        uint32x4_t hi = UnpremultiplyLanesNeon(vmovl_u16(vget_high_u16(c16[h])), vmovl_u16(vget_high_u16(a16[h])));
+        halves[h] = vmovn_u16(vcombine_u16(vmovn_u32(lo), vmovn_u32(hi)));
+    }
+    return vcombine_u8(halves[0], halves[1]);
+}
+
+void UnpremultiplyNeon(uint8_t* dst, const uint8_t* src, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t v = vld4q_u8(src + i * 4);
+        for (int c = 0; c < 3; c++) {
+            v.val[c] = UnpremultiplyChannelNeon(v.val[c], v.val[3]);
+        }
+        vst4q_u8(dst + i * 4, v);
+    }
+    UnpremultiplyScalar(dst + i * 4, src + i * 4, count - i);
+}
+
+void KeyRowNeon(uint8_t* row, size_t count, uint32_t key) {
+    const uint8x16_t b = vdupq_n_u8(static_cast<uint8_t>(key));
+    const uint8x16_t g = vdupq_n_u8(static_cast<uint8_t>(key >> 8));
+    const uint8x16_t r = vdupq_n_u8(static_cast<uint8_t>(key >> 16));
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t v = vld4q_u8(row + i * 4);
+        uint8x16_t match = vandq_u8(vandq_u8(vceqq_u8(v.val[0], b), vceqq_u8(v.val[1], g)), vceqq_u8(v.val[2], r));
+        v.val[3] = vbicq_u8(v.val[3], match);
+        vst4q_u8(row + i * 4, v);
+    }
+    KeyRowScalar(row + i * 4, count - i, key);
+}
+
+void SwapBytesNeon(uint8_t* a, uint8_t* b, size_t bytes) {
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        uint8x16_t x = vld1q_u8(a + i);
+        uint8x16_t y = vld1q_u8(b + i);
+        vst1q_u8(a + i, y);
+        vst1q_u8(b + i, x);
+    }
+    SwapBytesScalar(a + i, b + i, bytes - i);
+}
+
+const PixelKernels kNeonKernels = {
+    "neon", MergeAlphaNeon, SwizzleNeon, PremultiplyNeon, UnpremultiplyNeon, KeyRowNeon, SwapBytesNeon
+};
+
+#endif // PIXEL_KERNELS_NEON
+
+const PixelKernels& SelectPixelKernels() {
+#if defined(PIXEL_KERNELS_X86)
+    return CpuHasAvx2() ? kAvx2Kernels : kSse2Kernels;
+#elif defined(PIXEL_KERNELS_NEON)
+    return kNeonKernels;
+#else
+    return kScalarKernels;
+#endif
+}
+
+} // namespace
+
+const PixelKernels& GetPixelKernels() {
+    static const PixelKernels& kernels = SelectPixelKernels();
+    return kernels;
+}
+
+const PixelKernels& GetScalarPixelKernels() {
+    return kScalarKernels;
+}
+
+std::vector<const PixelKernels*> GetAvailablePixelKernels() {
+    std::vector<const PixelKernels*> available = { &kScalarKernels };
+#if defined(PIXEL_KERNELS_X86)
+    available.push_back(&kSse2Kernels);
+    if (CpuHasAvx2()) {
+        available.push_back(&kAvx2Kernels);
+    }
+#elif defined(PIXEL_KERNELS_NEON)
+    available.push_back(&kNeonKernels);
+#endif
+    return available;
+}
+
+void FlipVertical(uint8_t* pixels, size_t stride, int height) {
+    const PixelKernels& kernels = GetPixelKernels();
+    for (int top = 0, bottom = height - 1; top < bottom; top++, bottom--) {
+        kernels.swapBytes(pixels + stride * top, pixels + stride * bottom, stride);
+    }
+}
+
+void KeyBorder(uint8_t* pixels, int width, int height, size_t stride, uint32_t key) {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    const PixelKernels& kernels = GetPixelKernels();
+    kernels.keyRow(pixels, width, key);
+    if (height > 1) {
+        kernels.keyRow(pixels + stride * (height - 1), width, key);
+    }
+    // 中间各行只有首尾两个像素在边上
+    for (int y = 1; y < height - 1; y++) {
+        uint8_t* row = pixels + stride * y;
+        KeyRowScalar(row, 1, key);
+        if (width > 1) {
+            KeyRowScalar(row + static_cast<size_t>(width - 1) * 4, 1, key);
+        }
+    }
+}
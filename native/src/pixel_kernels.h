@@ -0,0 +1,40 @@
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 32 位像素行处理内核。像素按内存顺序为 B G R A（小端 uint32 即 0xAARRGGBB），
+// 交换红蓝后同样适用于 RGBA。count 为像素数，dst 与 src 可以相同（原地处理）。
+// 各指令集实现与标量版本逐位一致：
+// - premultiply:   c' = round(c * a / 255)，alpha 不变
+// - unpremultiply: c' = min(255, (c * 255 + a / 2) / a)，a 为 0 时颜色置 0
+struct PixelKernels {
+    const char* name;
+    // 用 src 的 alpha 替换 dst 的 alpha，颜色保持不变
+    void (*mergeAlpha)(uint8_t* dst, const uint8_t* src, size_t count);
+    // 交换第 0 和第 2 字节（BGRA <-> RGBA）
+    void (*swizzle)(uint8_t* dst, const uint8_t* src, size_t count);
+    void (*premultiply)(uint8_t* dst, const uint8_t* src, size_t count);
+    void (*unpremultiply)(uint8_t* dst, const uint8_t* src, size_t count);
+    // 颜色（忽略 alpha）等于 key 的像素 alpha 置 0
+    void (*keyRow)(uint8_t* row, size_t count, uint32_t key);
+    // 交换两段等长内存
+    void (*swapBytes)(uint8_t* a, uint8_t* b, size_t bytes);
+};
+
+// 运行时按 CPU 选择的最佳实现（AVX2 > SSE2 > 标量；ARM64 上为 NEON），首次调用时检测
+const PixelKernels& GetPixelKernels();
+// 标量参考实现
+const PixelKernels& GetScalarPixelKernels();
+// 当前 CPU 可用的全部实现（标量在前），供基准测试对比
+std::vector<const PixelKernels*> GetAvailablePixelKernels();
+
+// 以下为使用最佳实现的整图操作，stride 为行字节数
+
+void FlipVertical(uint8_t* pixels, size_t stride, int height);
+// 只处理四条边上的像素：颜色等于 key 的像素变为透明
+void KeyBorder(uint8_t* pixels, int width, int height, size_t stride, uint32_t key);
+
+#endif
@@ -0,0 +1,724 @@
+#include "png_codec.h"
+
+#include <cstring>
+
+#include "pixel_kernels.h"
+
+namespace {
+
+const uint8_t kPngSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+// 图像尺寸上限，防止损坏的文件导致超大分配
+const uint32_t kMaxDimension = 16384;
+
+uint32_t ReadBe32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+// ---------------------------------------------------------------------------
+// inflate（RFC 1951）
+
+const int kMaxBits = 15;
+
+// 范式 Huffman 码表。码长不超过 kFastBits 的符号直接查表，其余逐位解码
+const int kFastBits = 9;
+
+struct Huffman {
+    uint16_t count[kMaxBits + 1];
+    uint16_t symbol[288];
+    int16_t fast[1 << kFastBits]; // (symbol << 4) | length，-1 表示需要逐位解码
+};
+
+// 按 LSB 优先读取比特，64 位缓冲区一次补充多个字节
+struct BitReader {
+    const uint8_t* data;
+    size_t size;
+    size_t pos = 0;
+    uint64_t buffer = 0;
+    int count = 0;
+    int overrun = 0; // 越过输入末尾补充的零字节数
+
+    BitReader(const uint8_t* d, size_t s) : data(d), size(s) {}
+
+    void Refill() {
+        while (count <= 56) {
+            uint64_t byte = 0;
+            if (pos < size) {
+                byte = data[pos++];
+            } else {
+                overrun++;
+            }
+            buffer |= byte << count;
+            count += 8;
+        }
+    }
+    uint32_t Peek(int bits) {
+        if (count < bits) {
+            Refill();
+        }
+        return static_cast<uint32_t>(buffer & ((1ull << bits) - 1));
+    }
+    void Consume(int bits) {
+        buffer >>= bits;
+        count -= bits;
+    }
+    uint32_t Read(int bits) {
+        uint32_t value = Peek(bits);
+        Consume(bits);
+        return value;
+    }
+    // 已消耗的比特超出了真实输入
+    bool Overrun() const { return overrun * 8 > count; }
+    // 丢弃到字节边界，并把缓冲区中未消耗的整字节退回输入
+    void AlignToByte() {
+        Consume(count % 8);
+        pos -= count / 8 - overrun;
+        overrun = 0;
+        buffer = 0;
+        count = 0;
+    }
+};
+
+bool BuildHuffman(Huffman& h, const uint8_t* lengths, int n) {
+    memset(h.count, 0, sizeof(h.count));
+    for (int s = 0; s < n; s++) {
+        h.count[lengths[s]]++;
+    }
+    if (h.count[0] == n) {
+        // 没有任何码（只可能出现在距离码表中）
+        memset(h.fast, 0xff, sizeof(h.fast));
+        return true;
+    }
+
+    // 码空间不能被超额分配；不完整的码表是允许的
+    int left = 1;
+    for (int len = 1; len <= kMaxBits; len++) {
+        left <<= 1;
+        left -= h.count[len];
+        if (left < 0) {
+            return false;
+        }
+    }
+
+    uint16_t offsets[kMaxBits + 1];
+    offsets[1] = 0;
+    for (int len = 1; len < kMaxBits; len++) {
+        offsets[len + 1] = offsets[len] + h.count[len];
+    }
+    for (int s = 0; s < n; s++) {
+        if (lengths[s] != 0) {
+            h.symbol[offsets[lengths[s]]++] = static_cast<uint16_t>(s);
+        }
+    }
+
+    // 快速表：把范式码按位反转后填入所有后缀
+    memset(h.fast, 0xff, sizeof(h.fast));
+    int code = 0;
+    int nextCode[kMaxBits + 1];
+    for (int len = 1; len <= kMaxBits; len++) {
+        code = (code + (len > 1 ? h.count[len - 1] : 0)) << 1;
+        nextCode[len] = code;
+    }
+    for (int s = 0; s < n; s++) {
+        int len = lengths[s];
+        if (len == 0) {
+            continue;
+        }
+        int value = nextCode[len]++;
+        if (len > kFastBits) {
+            continue;
+        }
+        int reversed = 0;
+        for (int i = 0; i < len; i++) {
+            reversed |= ((value >> i) & 1) << (len - 1 - i);
+        }
+        for (int k = reversed; k < (1 << kFastBits); k += 1 << len) {
+            h.fast[k] = static_cast<int16_t>((s << 4) | len);
+        }
+    }
+    return true;
+}
+
+int DecodeSymbol(BitReader& in, const Huffman& h) {
+    uint32_t bits = in.Peek(kMaxBits);
+    int16_t entry = h.fast[bits & ((1 << kFastBits) - 1)];
+    if (entry >= 0) {
+        in.Consume(entry & 15);
+        return entry >> 4;
+    }
+
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (int len = 1; len <= kMaxBits; len++) {
+        code |= (bits >> (len - 1)) & 1;
+        int count = h.count[len];
+        if (code - first < count) {
+            in.Consume(len);
+            return h.symbol[index + code - first];
+        }
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+const uint16_t kLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                   35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const uint8_t kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                   3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const uint16_t kDistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                     257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                     8193, 12289, 16385, 24577 };
+const uint8_t kDistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                     7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+bool InflateCodes(BitReader& in, const Huffman& literals, const Huffman& distances, std::vector<uint8_t>& out) {
+    while (true) {
+        int symbol = DecodeSymbol(in, literals);
+        if (symbol < 0 || in.Overrun()) {
+            return false;
+        }
+        if (symbol < 256) {
+            out.push_back(static_cast<uint8_t>(symbol));
+            continue;
+        }
+        if (symbol == 256) {
+            return true;
+        }
+
+        symbol -= 257;
+        if (symbol >= 29) {
+            return false;
+        }
+        size_t length = kLengthBase[symbol] + in.Read(kLengthExtra[symbol]);
+
+        int distanceSymbol = DecodeSymbol(in, distances);
+        if (distanceSymbol < 0 || distanceSymbol >= 30) {
+            return false;
+        }
+        size_t distance = kDistanceBase[distanceSymbol] + in.Read(kDistanceExtra[distanceSymbol]);
+        if (distance > out.size()) {
+            return false;
+        }
+
+        // 源区间可能与目标重叠，逐字节复制
+        size_t from = out.size() - distance;
+        out.resize(out.size() + length);
+        uint8_t* dst = out.data() + out.size() - length;
+        const uint8_t* src = out.data() + from;
+        for (size_t i = 0; i < length; i++) {
+            dst[i] = src[i];
+        }
+    }
+}
+
+bool InflateFixed(BitReader& in, std::vector<uint8_t>& out) {
+    static Huffman literals;
+    static Huffman distances;
+    static bool built = [] {
+        uint8_t lengths[288];
+        int s = 0;
+        for (; s < 144; s++) lengths[s] = 8;
+        for (; s < 256; s++) lengths[s] = 9;
+        for (; s < 280; s++) lengths[s] = 7;
+        for (; s < 288; s++) lengths[s] = 8;
+        BuildHuffman(literals, lengths, 288);
+        for (s = 0; s < 30; s++) lengths[s] = 5;
+        BuildHuffman(distances, lengths, 30);
+        return true;
+    }();
+    (void)built;
+    return InflateCodes(in, literals, distances, out);
+}
+
+bool InflateDynamic(BitReader& in, std::vector<uint8_t>& out) {
+    static const uint8_t kOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    int literalCount = static_cast<int>(in.Read(5)) + 257;
+    int distanceCount = static_cast<int>(in.Read(5)) + 1;
+    int codeCount = static_cast<int>(in.Read(4)) + 4;
+    if (literalCount > 286 || distanceCount > 30) {
+        return false;
+    }
+
+    uint8_t lengths[320] = {};
+    for (int i = 0; i < codeCount; i++) {
+        lengths[kOrder[i]] = static_cast<uint8_t>(in.Read(3));
+    }
+    Huffman lengthCode;
+    if (!BuildHuffman(lengthCode, lengths, 19)) {
+        return false;
+    }
+
+    int index = 0;
+    memset(lengths, 0, sizeof(lengths));
+    while (index < literalCount + distanceCount) {
+        int symbol = DecodeSymbol(in, lengthCode);
+        if (symbol < 0 || in.Overrun()) {
+            return false;
+        }
+        if (symbol < 16) {
+            lengths[index++] = static_cast<uint8_t>(symbol);
+            continue;
+        }
+
+        uint8_t value = 0;
+        int repeat = 0;
+        if (symbol == 16) {
+            if (index == 0) {
+                return false;
+            }
+            value = lengths[index - 1];
+            repeat = 3 + static_cast<int>(in.Read(2));
+        } else if (symbol == 17) {
+            repeat = 3 + static_cast<int>(in.Read(3));
+        } else {
+            repeat = 11 + static_cast<int>(in.Read(7));
+        }
+        if (index + repeat > literalCount + distanceCount) {
+            return false;
+        }
+        while (repeat-- > 0) {
+            lengths[index++] = value;
+        }
+    }
+    if (lengths[256] == 0) {
+        return false; // 缺少块结束符
+    }
+
+    Huffman literals;
+    Huffman distances;
+    if (!BuildHuffman(literals, lengths, literalCount) ||
+        !BuildHuffman(distances, lengths + literalCount, distanceCount)) {
+        return false;
+    }
+    return InflateCodes(in, literals, distances, out);
+}
+
+bool Inflate(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    BitReader in(data, size);
+    bool last = false;
+    while (!last) {
+        last = in.Read(1) != 0;
+        uint32_t type = in.Read(2);
+        bool ok = false;
+        if (type == 0) {
+            in.AlignToByte();
+            if (in.pos + 4 > size) {
+                return false;
+            }
+            uint32_t length = data[in.pos] | (data[in.pos + 1] << 8);
+            uint32_t check = data[in.pos + 2] | (data[in.pos + 3] << 8);
+            in.pos += 4;
+            if ((length ^ 0xffff) != check || in.pos + length > size) {
+                return false;
+            }
+            out.insert(out.end(), data + in.pos, data + in.pos + length);
+            in.pos += length;
+            ok = true;
+        } else if (type == 1) {
+            ok = InflateFixed(in, out);
+        } else if (type == 2) {
+            ok = InflateDynamic(in, out);
+        }
+        if (!ok || in.Overrun()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// PNG 解码
+
+struct PngHeader {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int bitDepth = 0;
+    int colorType = 0;
+    int interlace = 0;
+};
+
+int ChannelCount(int colorType) {
+    switch (colorType) {
+        case 0: return 1; // 灰度
+        case 2: return 3; // RGB
+        case 3: return 1; // 调色板
+        case 4: return 2; // 灰度 + alpha
+        case 6: return 4; // RGBA
+    }
+    return 0;
+}
+
+bool ValidDepth(int colorType, int depth) {
+    switch (colorType) {
+        case 0: return depth == 1 || depth == 2 || depth == 4 || depth == 8 || depth == 16;
+        case 3: return depth == 1 || depth == 2 || depth == 4 || depth == 8;
+        case 2: case 4: case 6: return depth == 8 || depth == 16;
+    }
+    return false;
+}
+
+uint8_t Paeth(uint8_t a, uint8_t b, uint8_t c) {
+    int p = a + b - c;
+    int pa = p > a ? p - a : a - p;
+    int pb = p > b ? p - b : b - p;
+    int pc = p > c ? p - c : c - p;
+    if (pa <= pb && pa <= pc) return a;
+    if (pb <= pc) return b;
+    return c;
+}
+
+bool Unfilter(uint8_t filter, uint8_t* row, const uint8_t* previous, size_t length, size_t bpp) {
+    switch (filter) {
+        case 0:
+            break;
+        case 1:
+            for (size_t i = bpp; i < length; i++) row[i] = static_cast<uint8_t>(row[i] + row[i - bpp]);
+            break;
+        case 2:
+            for (size_t i = 0; i < length; i++) row[i] = static_cast<uint8_t>(row[i] + previous[i]);
+            break;
+        case 3:
+            for (size_t i = 0; i < length; i++) {
+                int left = i >= bpp ? row[i - bpp] : 0;
+                row[i] = static_cast<uint8_t>(row[i] + ((left + previous[i]) >> 1));
+            }
+            break;
+        case 4:
+            for (size_t i = 0; i < length; i++) {
+                uint8_t left = i >= bpp ? row[i - bpp] : 0;
+                uint8_t upperLeft = i >= bpp ? previous[i - bpp] : 0;
+                row[i] = static_cast<uint8_t>(row[i] + Paeth(left, previous[i], upperLeft));
+            }
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+struct PngPalette {
+    uint8_t colors[256][4]; // BGRA
+    int count = 0;
+    bool hasKey = false;     // 灰度/RGB 的 tRNS 透明色
+    uint16_t key[3] = {};
+};
+
+// 第 x 个样本（位深 < 8 时按位打包）
+uint32_t Sample(const uint8_t* row, size_t index, int depth) {
+    switch (depth) {
+        case 16: return (row[index * 2] << 8) | row[index * 2 + 1];
+        case 8: return row[index];
+        default: {
+            size_t bit = index * depth;
+            int shift = 8 - depth - static_cast<int>(bit % 8);
+            return (row[bit / 8] >> shift) & ((1 << depth) - 1);
+        }
+    }
+}
+
+// 把一行已反滤波的数据转换为 BGRA，写到目标行的 x0, x0 + dx, ...
+void ConvertRow(const PngHeader& header, const PngPalette& palette, const uint8_t* row, uint32_t pixels,
+                uint8_t* target, uint32_t x0, uint32_t dx) {
+    int depth = header.bitDepth;
+    int channels = ChannelCount(header.colorType);
+    // 把样本缩放到 8 位：16 位取高字节，低位深按比例放大
+    auto scale = [depth](uint32_t value) -> uint8_t {
+        if (depth == 16) return static_cast<uint8_t>(value >> 8);
+        if (depth == 8) return static_cast<uint8_t>(value);
+        return static_cast<uint8_t>(value * 255 / ((1 << depth) - 1));
+    };
+
+    // 最常见的 8 位非隔行 RGBA 只需交换红蓝
+    if (header.colorType == 6 && depth == 8 && dx == 1) {
+        GetPixelKernels().swizzle(target + static_cast<size_t>(x0) * 4, row, pixels);
+        return;
+    }
+
+    for (uint32_t i = 0; i < pixels; i++) {
+        uint8_t* out = target + static_cast<size_t>(x0 + i * dx) * 4;
+        size_t base = static_cast<size_t>(i) * channels;
+        switch (header.colorType) {
+            case 0: {
+                uint32_t gray = Sample(row, base, depth);
+                out[0] = out[1] = out[2] = scale(gray);
+                out[3] = palette.hasKey && gray == palette.key[0] ? 0 : 255;
+                break;
+            }
+            case 2: {
+                uint32_t r = Sample(row, base, depth);
+                uint32_t g = Sample(row, base + 1, depth);
+                uint32_t b = Sample(row, base + 2, depth);
+                out[0] = scale(b);
+                out[1] = scale(g);
+                out[2] = scale(r);
+                out[3] = palette.hasKey && r == palette.key[0] && g == palette.key[1] && b == palette.key[2] ? 0 : 255;
+                break;
+            }
+            case 3: {
+                uint32_t index = Sample(row, base, depth);
+                memcpy(out, palette.colors[index], 4);
+                break;
+            }
+            case 4: {
+                out[0] = out[1] = out[2] = scale(Sample(row, base, depth));
+                out[3] = scale(Sample(row, base + 1, depth));
+                break;
+            }
+            case 6: {
+                out[0] = scale(Sample(row, base + 2, depth));
+                out[1] = scale(Sample(row, base + 1, depth));
+                out[2] = scale(Sample(row, base, depth));
+                out[3] = scale(Sample(row, base + 3, depth));
+                break;
+            }
+        }
+    }
+}
+
+} // namespace
+
+uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size) {
+    // slicing-by-8：table[k][n] 为字节 n 后再跟 k 个零字节的 CRC，每次处理 8 字节
+    static uint32_t table[8][256];
+    static bool built = [] {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            table[0][n] = c;
+        }
+        for (uint32_t n = 0; n < 256; n++) {
+            for (int k = 1; k < 8; k++) {
+                table[k][n] = table[0][table[k - 1][n] & 0xff] ^ (table[k - 1][n] >> 8);
+            }
+        }
+        return true;
+    }();
+    (void)built;
+
+    crc ^= 0xffffffffu;
+    while (size >= 8) {
+        uint32_t low = crc ^ (static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+                              (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24));
+        crc = table[7][low & 0xff] ^ table[6][(low >> 8) & 0xff] ^
+              table[5][(low >> 16) & 0xff] ^ table[4][low >> 24] ^
+              table[3][data[4]] ^ table[2][data[5]] ^ table[1][data[6]] ^ table[0][data[7]];
+        data += 8;
+        size -= 8;
+    }
+    for (size_t i = 0; i < size; i++) {
+        crc = table[0][(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc ^ 0xffffffffu;
+}
+
+uint32_t Adler32(uint32_t adler, const uint8_t* data, size_t size) {
+    uint32_t a = adler & 0xffff;
+    uint32_t b = adler >> 16;
+    while (size > 0) {
+        // 5552 是保证 b 不溢出的最大分段长度
+        size_t chunk = size < 5552 ? size : 5552;
+        size -= chunk;
+        // 每 16 字节：b 增加 16 * a 加上按位置加权的字节和，a 增加字节和，内层循环可向量化
+        for (; chunk >= 16; chunk -= 16, data += 16) {
+            uint32_t sum = 0;
+            uint32_t weighted = 0;
+            for (int i = 0; i < 16; i++) {
+                sum += data[i];
+                weighted += (16 - i) * data[i];
+            }
+            b += a * 16 + weighted;
+            a += sum;
+        }
+        while (chunk-- > 0) {
+            a += *data++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+bool ZlibDecompress(const uint8_t* data, size_t size, size_t expectedSize, std::vector<uint8_t>& output) {
+    if (size < 6) {
+        return false;
+    }
+    uint8_t cmf = data[0];
+    uint8_t flg = data[1];
+    if ((cmf & 0x0f) != 8 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20)) {
+        return false;
+    }
+
+    output.clear();
+    output.reserve(expectedSize);
+    if (!Inflate(data + 2, size - 6, output)) {
+        return false;
+    }
+    return Adler32(1, output.data(), output.size()) == ReadBe32(data + size - 4);
+}
+
+bool IsPngData(const uint8_t* data, size_t size) {
+    return size >= 8 && memcmp(data, kPngSignature, 8) == 0;
+}
+
+bool ReadPngSize(const uint8_t* data, size_t size, int& width, int& height) {
+    // 签名之后第一个块必须是 IHDR
+    if (!IsPngData(data, size) || size < 33 || memcmp(data + 12, "IHDR", 4) != 0) {
+        return false;
+    }
+    uint32_t w = ReadBe32(data + 16);
+    uint32_t h = ReadBe32(data + 20);
+    if (w == 0 || h == 0 || w > kMaxDimension || h > kMaxDimension) {
+        return false;
+    }
+    width = static_cast<int>(w);
+    height = static_cast<int>(h);
+    return true;
+}
+
+bool DecodePng(const uint8_t* data, size_t size, BgraImage& image) {
+    if (!IsPngData(data, size)) {
+        return false;
+    }
+
+    PngHeader header;
+    PngPalette palette;
+    std::vector<uint8_t> compressed;
+    const uint8_t* singleIdat = nullptr; // 只有一个 IDAT 时直接使用映射内存，不复制
+    size_t singleIdatSize = 0;
+    int idatCount = 0;
+    bool seenHeader = false;
+
+    size_t pos = 8;
+    while (pos + 12 <= size) {
+        uint32_t length = ReadBe32(data + pos);
+        const uint8_t* type = data + pos + 4;
+        const uint8_t* body = data + pos + 8;
+        if (length > size - pos - 12) {
+            return false;
+        }
+
+        if (memcmp(type, "IHDR", 4) == 0) {
+            if (length != 13) {
+                return false;
+            }
+            header.width = ReadBe32(body);
+            header.height = ReadBe32(body + 4);
+            header.bitDepth = body[8];
+            header.colorType = body[9];
+            header.interlace = body[12];
+            if (header.width == 0 || header.height == 0 || header.width > kMaxDimension ||
+                header.height > kMaxDimension || !ValidDepth(header.colorType, header.bitDepth) ||
+                body[10] != 0 || body[11] != 0 || header.interlace > 1) {
+                return false;
+            }
+            seenHeader = true;
+        } else if (memcmp(type, "PLTE", 4) == 0) {
+            if (length % 3 != 0 || length / 3 > 256) {
+                return false;
+            }
+            palette.count = static_cast<int>(length / 3);
+            for (int i = 0; i < palette.count; i++) {
+                palette.colors[i][0] = body[i * 3 + 2];
+                palette.colors[i][1] = body[i * 3 + 1];
+                palette.colors[i][2] = body[i * 3];
+                palette.colors[i][3] = 255;
+            }
+        } else if (memcmp(type, "tRNS", 4) == 0 && seenHeader) {
+            if (header.colorType == 3) {
+                for (uint32_t i = 0; i < length && i < 256; i++) {
+                    palette.colors[i][3] = body[i];
+                }
+            } else if (header.colorType == 0 && length >= 2) {
+                palette.hasKey = true;
+                palette.key[0] = static_cast<uint16_t>((body[0] << 8) | body[1]);
+            } else if (header.colorType == 2 && length >= 6) {
+                palette.hasKey = true;
+                for (int i = 0; i < 3; i++) {
+                    palette.key[i] = static_cast<uint16_t>((body[i * 2] << 8) | body[i * 2 + 1]);
+                }
+            }
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            if (idatCount == 0) {
+                singleIdat = body;
+                singleIdatSize = length;
+            } else {
+                if (idatCount == 1) {
+                    compressed.assign(singleIdat, singleIdat + singleIdatSize);
+                }
+                compressed.insert(compressed.end(), body, body + length);
+            }
+            idatCount++;
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+        pos += 12 + length;
+    }
+
+    if (!seenHeader || idatCount == 0 || (header.colorType == 3 && palette.count == 0)) {
+        return false;
+    }
+
+    int channels = ChannelCount(header.colorType);
+    size_t bitsPerPixel = static_cast<size_t>(channels) * header.bitDepth;
+    size_t bpp = bitsPerPixel >= 8 ? bitsPerPixel / 8 : 1;
+
+    // 各隔行扫描遍的起点和步长；非隔行图像只有一遍
+    static const uint32_t kAdam7[7][4] = {
+        { 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 },
+        { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 },
+    };
+    static const uint32_t kSinglePass[1][4] = { { 0, 0, 1, 1 } };
+    const uint32_t (*passes)[4] = header.interlace ? kAdam7 : kSinglePass;
+    int passCount = header.interlace ? 7 : 1;
+
+    size_t expected = 0;
+    for (int p = 0; p < passCount; p++) {
+        uint32_t pw = (header.width - passes[p][0] + passes[p][2] - 1) / passes[p][2];
+        uint32_t ph = (header.height - passes[p][1] + passes[p][3] - 1) / passes[p][3];
+        if (header.width > passes[p][0] && header.height > passes[p][1]) {
+            expected += static_cast<size_t>(ph) * (1 + (pw * bitsPerPixel + 7) / 8);
+        }
+    }
+
+    std::vector<uint8_t> raw;
+    const uint8_t* zlib = idatCount == 1 ? singleIdat : compressed.data();
+    size_t zlibSize = idatCount == 1 ? singleIdatSize : compressed.size();
+    if (!ZlibDecompress(zlib, zlibSize, expected, raw) || raw.size() < expected) {
+        return false;
+    }
+
+    image.Allocate(static_cast<int>(header.width), static_cast<int>(header.height));
+    uint8_t* cursor = raw.data();
+    std::vector<uint8_t> zero;
+    for (int p = 0; p < passCount; p++) {
+        uint32_t x0 = passes[p][0], y0 = passes[p][1], dx = passes[p][2], dy = passes[p][3];
+        if (header.width <= x0 || header.height <= y0) {
+            continue;
+        }
+        uint32_t pw = (header.width - x0 + dx - 1) / dx;
+        uint32_t ph = (header.height - y0 + dy - 1) / dy;
+        size_t rowBytes = (pw * bitsPerPixel + 7) / 8;
+        zero.assign(rowBytes, 0);
+
+        const uint8_t* previous = zero.data();
+        for (uint32_t j = 0; j < ph; j++) {
+            uint8_t filter = *cursor++;
+            if (!Unfilter(filter, cursor, previous, rowBytes, bpp)) {
+                return false;
+            }
+            ConvertRow(header, palette, cursor, pw, image.Row(static_cast<int>(y0 + j * dy)), x0, dx);
+            previous = cursor;
+            cursor += rowBytes;
+        }
+    }
+    return true;
+}
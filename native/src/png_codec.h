@@ -0,0 +1,25 @@
+#ifndef PNG_CODEC_H
+#define PNG_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bgra_image.h"
+
+// 数据是否以 PNG 签名开头
+bool IsPngData(const uint8_t* data, size_t size);
+
+// 只读取 IHDR 中的宽高，不解压像素
+bool ReadPngSize(const uint8_t* data, size_t size, int& width, int& height);
+
+// 解码为非预乘 BGRA，支持全部颜色类型、位深和 Adam7 隔行
+bool DecodePng(const uint8_t* data, size_t size, BgraImage& image);
+
+// zlib 流解压，expectedSize 仅用于预分配
+bool ZlibDecompress(const uint8_t* data, size_t size, size_t expectedSize, std::vector<uint8_t>& output);
+
+uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size);
+uint32_t Adler32(uint32_t adler, const uint8_t* data, size_t size);
+
+#endif
@@ -0,0 +1,882 @@
+#include "png_encoder.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "pixel_kernels.h"
+#include "png_codec.h"
+
+namespace {
+
+const uint8_t kPngSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+void PutBe32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+}
+
+void WriteBe32(std::vector<uint8_t>& out, uint32_t value) {
+    uint8_t bytes[4];
+    PutBe32(bytes, value);
+    out.insert(out.end(), bytes, bytes + 4);
+}
+
+// ---------------------------------------------------------------------------
+// deflate（RFC 1951）
+
+const int kWindowSize = 32768;
+const int kMinMatch = 3;
+const int kMaxMatch = 258;
+const size_t kMaxStoredBlock = 65535;
+// 每个块的符号数上限，超过后输出当前块并按后续数据重建 Huffman 表
+const size_t kBlockSymbols = 16384;
+
+const int kLitCodes = 286;
+const int kDistCodes = 30;
+const int kCodeLengthCodes = 19;
+const int kEndOfBlock = 256;
+
+const uint16_t kLengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const uint8_t kLengthExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const uint16_t kDistBase[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const uint8_t kDistExtra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+const uint8_t kCodeLengthOrder[kCodeLengthCodes] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// 匹配长度 -> 长度码序号，距离 -> 距离码（d - 1 < 256 时直接查表，否则查 256 + ((d - 1) >> 7)）
+struct CodeTables {
+    uint8_t lengthCode[kMaxMatch + 1];
+    uint8_t distCode[512];
+
+    CodeTables() {
+        for (int code = 0; code < 29; code++) {
+            int end = code == 28 ? kMaxMatch + 1 : kLengthBase[code + 1];
+            for (int length = kLengthBase[code]; length < end; length++) {
+                lengthCode[length] = static_cast<uint8_t>(code);
+            }
+        }
+        for (int code = 0; code < kDistCodes; code++) {
+            int end = kDistBase[code] + (1 << kDistExtra[code]);
+            for (int dist = kDistBase[code]; dist < end; dist++) {
+                int v = dist - 1;
+                distCode[v < 256 ? v : 256 + (v >> 7)] = static_cast<uint8_t>(code);
+            }
+        }
+    }
+
+    int DistCode(int dist) const {
+        int v = dist - 1;
+        return distCode[v < 256 ? v : 256 + (v >> 7)];
+    }
+};
+
+const CodeTables& Tables() {
+    static const CodeTables tables;
+    return tables;
+}
+
+// LSB 优先写入比特，64 位缓冲区满 32 位时一次输出 4 字节
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    // bits 不超过 32
+    void Put(uint32_t value, int bits) {
+        buffer_ |= static_cast<uint64_t>(value) << count_;
+        count_ += bits;
+        if (count_ >= 32) {
+            uint8_t bytes[4] = { static_cast<uint8_t>(buffer_), static_cast<uint8_t>(buffer_ >> 8),
+                                 static_cast<uint8_t>(buffer_ >> 16), static_cast<uint8_t>(buffer_ >> 24) };
+            out_.insert(out_.end(), bytes, bytes + 4);
+            buffer_ >>= 32;
+            count_ -= 32;
+        }
+    }
+
+    void AlignToByte() {
+        while (count_ > 0) {
+            out_.push_back(static_cast<uint8_t>(buffer_));
+            buffer_ >>= 8;
+            count_ = count_ > 8 ? count_ - 8 : 0;
+        }
+        buffer_ = 0;
+    }
+
+    std::vector<uint8_t>& Output() { return out_; }
+
+private:
+    std::vector<uint8_t>& out_;
+    uint64_t buffer_ = 0;
+    int count_ = 0;
+};
+
+// 由频率生成 Huffman 码长，最长不超过 maxBits。超出时把非零频率减半后重建，
+// 频率全部为 1 时树是平衡的，因此一定收敛
+void BuildLengths(const uint32_t* freq, int count, int maxBits, uint8_t* lengths) {
+    std::vector<uint32_t> weights(freq, freq + count);
+    std::vector<int> order;
+    std::vector<uint64_t> nodeWeight;
+    std::vector<int> parent;
+    std::vector<int> depth;
+    for (;;) {
+        std::fill(lengths, lengths + count, 0);
+        order.clear();
+        for (int i = 0; i < count; i++) {
+            if (weights[i] > 0) order.push_back(i);
+        }
+        if (order.empty()) return;
+        if (order.size() == 1) {
+            lengths[order[0]] = 1;
+            return;
+        }
+        std::stable_sort(order.begin(), order.end(), [&weights](int a, int b) { return weights[a] < weights[b]; });
+
+        // 双队列合并：叶子按权重有序，新建的内部节点权重单调不减
+        size_t leaves = order.size();
+        nodeWeight.assign(leaves * 2 - 1, 0);
+        parent.assign(leaves * 2 - 1, -1);
+        for (size_t i = 0; i < leaves; i++) nodeWeight[i] = weights[order[i]];
+        size_t nextLeaf = 0;
+        size_t nextInternal = leaves;
+        for (size_t node = leaves; node < leaves * 2 - 1; node++) {
+            size_t pick[2];
+            for (size_t& p : pick) {
+                if (nextLeaf < leaves && (nextInternal >= node || nodeWeight[nextLeaf] <= nodeWeight[nextInternal])) {
+                    p = nextLeaf++;
+                } else {
+                    p = nextInternal++;
+                }
+            }
+            nodeWeight[node] = nodeWeight[pick[0]] + nodeWeight[pick[1]];
+            parent[pick[0]] = static_cast<int>(node);
+            parent[pick[1]] = static_cast<int>(node);
+        }
+
+        // 父节点的序号总是大于子节点，从根向下计算深度
+        depth.assign(leaves * 2 - 1, 0);
+        int maxDepth = 0;
+        for (size_t node = leaves * 2 - 1; node-- > 0;) {
+            if (parent[node] >= 0) depth[node] = depth[parent[node]] + 1;
+            if (node < leaves) maxDepth = std::max(maxDepth, depth[node]);
+        }
+        if (maxDepth <= maxBits) {
+            for (size_t i = 0; i < leaves; i++) lengths[order[i]] = static_cast<uint8_t>(depth[i]);
+            return;
+        }
+        for (uint32_t& w : weights) {
+            if (w > 0) w = (w + 1) / 2;
+        }
+    }
+}
+
+// 范式 Huffman 编码，按 deflate 的 LSB 优先顺序预先反转
+void BuildCodes(const uint8_t* lengths, int count, uint16_t* codes) {
+    int lengthCount[16] = {};
+    for (int i = 0; i < count; i++) lengthCount[lengths[i]]++;
+    lengthCount[0] = 0;
+    int next[16] = {};
+    int code = 0;
+    for (int bits = 1; bits < 16; bits++) {
+        code = (code + lengthCount[bits - 1]) << 1;
+        next[bits] = code;
+    }
+    for (int i = 0; i < count; i++) {
+        int length = lengths[i];
+        if (length == 0) {
+            codes[i] = 0;
+            continue;
+        }
+        int value = next[length]++;
+        int reversed = 0;
+        for (int bit = 0; bit < length; bit++) {
+            reversed = (reversed << 1) | ((value >> bit) & 1);
+        }
+        codes[i] = static_cast<uint16_t>(reversed);
+    }
+}
+
+// 只有一个（或没有）符号时补足两个，保证码表完整，所有解码器都能接受
+void EnsureTwoCodes(uint32_t* freq, int count) {
+    int used = 0;
+    for (int i = 0; i < count; i++) {
+        if (freq[i] > 0) used++;
+    }
+    for (int i = 0; used < 2 && i < count; i++) {
+        if (freq[i] == 0) {
+            freq[i] = 1;
+            used++;
+        }
+    }
+}
+
+// dist 为 0 时 litLen 是字面字节，否则是匹配长度
+struct Symbol {
+    uint16_t litLen;
+    uint16_t dist;
+};
+
+void WriteStoredBlocks(BitWriter& writer, const uint8_t* data, size_t size, bool last) {
+    do {
+        size_t length = std::min(size, kMaxStoredBlock);
+        bool final = last && length == size;
+        writer.Put(final ? 1 : 0, 3);
+        writer.AlignToByte();
+        writer.Put(static_cast<uint32_t>(length) | (static_cast<uint32_t>(~length & 0xffff) << 16), 32);
+        writer.AlignToByte();
+        std::vector<uint8_t>& out = writer.Output();
+        out.insert(out.end(), data, data + length);
+        data += length;
+        size -= length;
+    } while (size > 0);
+}
+
+void WriteSymbols(BitWriter& writer, const Symbol* symbols, size_t count,
+                  const uint8_t* litLengths, const uint16_t* litCodes,
+                  const uint8_t* distLengths, const uint16_t* distCodes) {
+    const CodeTables& tables = Tables();
+    for (size_t i = 0; i < count; i++) {
+        const Symbol& s = symbols[i];
+        if (s.dist == 0) {
+            writer.Put(litCodes[s.litLen], litLengths[s.litLen]);
+            continue;
+        }
+        int lengthCode = tables.lengthCode[s.litLen];
+        writer.Put(litCodes[257 + lengthCode], litLengths[257 + lengthCode]);
+        if (kLengthExtra[lengthCode]) {
+            writer.Put(s.litLen - kLengthBase[lengthCode], kLengthExtra[lengthCode]);
+        }
+        int distCode = tables.DistCode(s.dist);
+        writer.Put(distCodes[distCode], distLengths[distCode]);
+        if (kDistExtra[distCode]) {
+            writer.Put(s.dist - kDistBase[distCode], kDistExtra[distCode]);
+        }
+    }
+    writer.Put(litCodes[kEndOfBlock], litLengths[kEndOfBlock]);
+}
+
+// 输出一个块：比较动态 Huffman、固定 Huffman 和存储三种方式的比特数，取最小者
+void WriteBlock(BitWriter& writer, const Symbol* symbols, size_t count,
+                const uint8_t* raw, size_t rawSize, bool last) {
+    const CodeTables& tables = Tables();
+    uint32_t litFreq[kLitCodes] = {};
+    uint32_t distFreq[kDistCodes] = {};
+    for (size_t i = 0; i < count; i++) {
+        if (symbols[i].dist == 0) {
+            litFreq[symbols[i].litLen]++;
+        } else {
+            litFreq[257 + tables.lengthCode[symbols[i].litLen]]++;
+            distFreq[tables.DistCode(symbols[i].dist)]++;
+        }
+    }
+    litFreq[kEndOfBlock] = 1;
+
+    uint64_t extraBits = 0;
+    for (int code = 0; code < 29; code++) extraBits += static_cast<uint64_t>(litFreq[257 + code]) * kLengthExtra[code];
+    for (int code = 0; code < kDistCodes; code++) extraBits += static_cast<uint64_t>(distFreq[code]) * kDistExtra[code];
+
+    // 固定 Huffman
+    uint8_t fixedLit[288];
+    uint8_t fixedDist[kDistCodes];
+    for (int i = 0; i < 288; i++) fixedLit[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+    std::fill(fixedDist, fixedDist + kDistCodes, 5);
+    uint64_t fixedBits = 3 + extraBits;
+    for (int i = 0; i < kLitCodes; i++) fixedBits += static_cast<uint64_t>(litFreq[i]) * fixedLit[i];
+    for (int i = 0; i < kDistCodes; i++) fixedBits += static_cast<uint64_t>(distFreq[i]) * 5;
+
+    // 动态 Huffman
+    EnsureTwoCodes(litFreq, kLitCodes);
+    EnsureTwoCodes(distFreq, kDistCodes);
+    uint8_t litLengths[kLitCodes];
+    uint8_t distLengths[kDistCodes];
+    BuildLengths(litFreq, kLitCodes, 15, litLengths);
+    BuildLengths(distFreq, kDistCodes, 15, distLengths);
+    int hlit = kLitCodes;
+    while (hlit > 257 && litLengths[hlit - 1] == 0) hlit--;
+    int hdist = kDistCodes;
+    while (hdist > 1 && distLengths[hdist - 1] == 0) hdist--;
+
+    // 码长序列的游程编码：16 重复前一个 3..6 次，17/18 为 3..10/11..138 个 0
+    uint8_t all[kLitCodes + kDistCodes];
+    std::memcpy(all, litLengths, hlit);
+    std::memcpy(all + hlit, distLengths, hdist);
+    int total = hlit + hdist;
+    uint8_t rle[kLitCodes + kDistCodes][2];
+    int rleCount = 0;
+    for (int i = 0; i < total;) {
+        uint8_t length = all[i];
+        int run = 1;
+        while (i + run < total && all[i + run] == length) run++;
+        i += run;
+        if (length == 0) {
+            while (run >= 11) {
+                int n = std::min(run, 138);
+                rle[rleCount][0] = 18;
+                rle[rleCount++][1] = static_cast<uint8_t>(n - 11);
+                run -= n;
+            }
+            if (run >= 3) {
+                rle[rleCount][0] = 17;
+                rle[rleCount++][1] = static_cast<uint8_t>(run - 3);
+                run = 0;
+            }
+        } else {
+            rle[rleCount][0] = length;
+            rle[rleCount++][1] = 0;
+            run--;
+            while (run >= 3) {
+                int n = std::min(run, 6);
+                rle[rleCount][0] = 16;
+                rle[rleCount++][1] = static_cast<uint8_t>(n - 3);
+                run -= n;
+            }
+        }
+        while (run-- > 0) {
+            rle[rleCount][0] = length;
+            rle[rleCount++][1] = 0;
+        }
+    }
+
+    uint32_t clFreq[kCodeLengthCodes] = {};
+    for (int i = 0; i < rleCount; i++) clFreq[rle[i][0]]++;
+    uint8_t clLengths[kCodeLengthCodes];
+    BuildLengths(clFreq, kCodeLengthCodes, 7, clLengths);
+    int hclen = kCodeLengthCodes;
+    while (hclen > 4 && clLengths[kCodeLengthOrder[hclen - 1]] == 0) hclen--;
+
+    const int clExtra[3] = { 2, 3, 7 };
+    uint64_t dynamicBits = 3 + 5 + 5 + 4 + 3 * static_cast<uint64_t>(hclen) + extraBits;
+    for (int i = 0; i < rleCount; i++) {
+        dynamicBits += clLengths[rle[i][0]] + (rle[i][0] >= 16 ? clExtra[rle[i][0] - 16] : 0);
+    }
+    for (int i = 0; i < kLitCodes; i++) dynamicBits += static_cast<uint64_t>(litFreq[i]) * litLengths[i];
+    for (int i = 0; i < kDistCodes; i++) dynamicBits += static_cast<uint64_t>(distFreq[i]) * distLengths[i];
+
+    uint64_t storedBlocks = std::max<size_t>(1, (rawSize + kMaxStoredBlock - 1) / kMaxStoredBlock);
+    uint64_t storedBits = storedBlocks * (3 + 7 + 32) + static_cast<uint64_t>(rawSize) * 8;
+
+    if (storedBits < dynamicBits && storedBits < fixedBits) {
+        WriteStoredBlocks(writer, raw, rawSize, last);
+        return;
+    }
+
+    uint16_t litCodes[288];
+    uint16_t distCodes[kDistCodes];
+    if (fixedBits <= dynamicBits) {
+        writer.Put(last ? 1 : 0, 1);
+        writer.Put(1, 2);
+        BuildCodes(fixedLit, 288, litCodes);
+        BuildCodes(fixedDist, kDistCodes, distCodes);
+        WriteSymbols(writer, symbols, count, fixedLit, litCodes, fixedDist, distCodes);
+        return;
+    }
+
+    writer.Put(last ? 1 : 0, 1);
+    writer.Put(2, 2);
+    writer.Put(hlit - 257, 5);
+    writer.Put(hdist - 1, 5);
+    writer.Put(hclen - 4, 4);
+    for (int i = 0; i < hclen; i++) writer.Put(clLengths[kCodeLengthOrder[i]], 3);
+    uint16_t clCodes[kCodeLengthCodes];
+    BuildCodes(clLengths, kCodeLengthCodes, clCodes);
+    for (int i = 0; i < rleCount; i++) {
+        int symbol = rle[i][0];
+        writer.Put(clCodes[symbol], clLengths[symbol]);
+        if (symbol >= 16) writer.Put(rle[i][1], clExtra[symbol - 16]);
+    }
+    BuildCodes(litLengths, kLitCodes, litCodes);
+    BuildCodes(distLengths, kDistCodes, distCodes);
+    WriteSymbols(writer, symbols, count, litLengths, litCodes, distLengths, distCodes);
+}
+
+int CountTrailingZeros(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+// a 与 b 的公共前缀长度，不超过 limit。每次比较 8 字节（目标平台均为小端序）
+int MatchLength(const uint8_t* a, const uint8_t* b, int limit) {
+    int length = 0;
+    while (length + 8 <= limit) {
+        uint64_t x, y;
+        std::memcpy(&x, a + length, 8);
+        std::memcpy(&y, b + length, 8);
+        if (x != y) {
+            return length + CountTrailingZeros(x ^ y) / 8;
+        }
+        length += 8;
+    }
+    while (length < limit && a[length] == b[length]) length++;
+    return length;
+}
+
+struct DeflateParams {
+    int maxChain;   // 每个位置最多比较的候选数
+    int goodLength; // 已有这么长的匹配时，只比较四分之一的候选
+    int lazyLength; // 当前匹配短于此长度时才检查下一位置能否更长（0 为贪心匹配）
+    int niceLength; // 找到这么长的匹配就停止搜索
+};
+
+DeflateParams GetDeflateParams(PngLevel level) {
+    switch (level) {
+        case PngLevel::Fast: return { 4, 4, 0, 32 };
+        case PngLevel::Small: return { 128, 8, 32, kMaxMatch };
+        default: return { 32, 8, 16, 128 };
+    }
+}
+
+// 哈希链 LZ77：head 为每个 3 字节哈希最近出现的位置，prev 按窗口回绕保存同一哈希的上一个位置
+class Deflater {
+public:
+    Deflater(const uint8_t* data, size_t size, PngLevel level, BitWriter& writer)
+        : data_(data), size_(size), params_(GetDeflateParams(level)), writer_(writer) {
+        // 小图像用较小的哈希表，避免初始化开销超过压缩本身
+        hashBits_ = 8;
+        while (hashBits_ < 15 && (static_cast<size_t>(1) << hashBits_) < size) hashBits_++;
+        head_.assign(static_cast<size_t>(1) << hashBits_, -1);
+        // 输入不足一个窗口时 prev 按输入大小分配，同样不会发生回绕
+        size_t window = 256;
+        while (window < static_cast<size_t>(kWindowSize) && window < size) window <<= 1;
+        windowMask_ = window - 1;
+        prev_.assign(window, -1);
+        symbols_.reserve(std::min(size, kBlockSymbols));
+    }
+
+    void Run() {
+        if (params_.lazyLength > 0) {
+            RunLazy();
+        } else {
+            RunGreedy();
+        }
+        WriteBlock(writer_, symbols_.data(), symbols_.size(), data_ + blockStart_, emitted_ - blockStart_, true);
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    DeflateParams params_;
+    BitWriter& writer_;
+    int hashBits_;
+    size_t windowMask_;
+    std::vector<int32_t> head_;
+    std::vector<int32_t> prev_;
+    std::vector<Symbol> symbols_;
+    size_t blockStart_ = 0; // 当前块第一个符号对应的输入位置
+    size_t emitted_ = 0;    // 已转换为符号的输入字节数
+
+    uint32_t Hash(size_t pos) const {
+        uint32_t v = (static_cast<uint32_t>(data_[pos]) << 16) | (static_cast<uint32_t>(data_[pos + 1]) << 8) | data_[pos + 2];
+        return (v * 2654435761u) >> (32 - hashBits_);
+    }
+
+    bool CanHash(size_t pos) const { return pos + kMinMatch <= size_; }
+
+    void Insert(size_t pos) {
+        uint32_t h = Hash(pos);
+        prev_[pos & windowMask_] = head_[h];
+        head_[h] = static_cast<int32_t>(pos);
+    }
+
+    // 查找比 minLength 更长的匹配，没有时返回 0。须在 Insert(pos) 之前调用
+    int FindMatch(size_t pos, int minLength, int& dist) const {
+        int limit = static_cast<int>(std::min<size_t>(kMaxMatch, size_ - pos));
+        int best = std::max(minLength, kMinMatch - 1);
+        if (limit <= best) return 0;
+        int found = 0;
+        int chain = minLength >= params_.goodLength ? params_.maxChain >> 2 : params_.maxChain;
+        int32_t candidate = head_[Hash(pos)];
+        const uint8_t* current = data_ + pos;
+        while (candidate >= 0 && pos - candidate <= static_cast<size_t>(kWindowSize) && chain-- > 0) {
+            const uint8_t* match = data_ + candidate;
+            if (match[best] == current[best] && match[0] == current[0]) {
+                int length = MatchLength(match, current, limit);
+                if (length > best) {
+                    best = length;
+                    found = length;
+                    dist = static_cast<int>(pos - candidate);
+                    if (length >= params_.niceLength || length == limit) break;
+                }
+            }
+            int32_t next = prev_[candidate & windowMask_];
+            if (next >= candidate) break;
+            candidate = next;
+        }
+        return found;
+    }
+
+    void EmitLiteral(uint8_t value) {
+        symbols_.push_back({ value, 0 });
+        emitted_ += 1;
+        FlushIfFull();
+    }
+
+    void EmitMatch(int length, int dist) {
+        symbols_.push_back({ static_cast<uint16_t>(length), static_cast<uint16_t>(dist) });
+        emitted_ += length;
+        FlushIfFull();
+    }
+
+    void FlushIfFull() {
+        if (symbols_.size() < kBlockSymbols) return;
+        WriteBlock(writer_, symbols_.data(), symbols_.size(), data_ + blockStart_, emitted_ - blockStart_, false);
+        symbols_.clear();
+        blockStart_ = emitted_;
+    }
+
+    void RunGreedy() {
+        size_t pos = 0;
+        while (pos < size_) {
+            int dist = 0;
+            int length = 0;
+            if (CanHash(pos)) {
+                length = FindMatch(pos, 0, dist);
+                Insert(pos);
+            }
+            if (length == 0) {
+                EmitLiteral(data_[pos]);
+                pos++;
+                continue;
+            }
+            EmitMatch(length, dist);
+            for (size_t p = pos + 1; p < pos + length && CanHash(p); p++) Insert(p);
+            pos += length;
+        }
+    }
+
+    void RunLazy() {
+        bool pending = false; // pos - 1 处的匹配尚未输出
+        int pendingLength = 0;
+        int pendingDist = 0;
+        size_t pos = 0;
+        while (pos < size_) {
+            int dist = 0;
+            int length = 0;
+            if (CanHash(pos)) {
+                if (pendingLength < params_.lazyLength) {
+                    length = FindMatch(pos, pendingLength, dist);
+                }
+                Insert(pos);
+            }
+            if (pending && pendingLength >= kMinMatch && length == 0) {
+                EmitMatch(pendingLength, pendingDist);
+                size_t end = pos - 1 + pendingLength;
+                for (size_t p = pos + 1; p < end && CanHash(p); p++) Insert(p);
+                pos = end;
+                pending = false;
+                pendingLength = 0;
+                continue;
+            }
+            if (pending) EmitLiteral(data_[pos - 1]);
+            pending = true;
+            pendingLength = length;
+            pendingDist = dist;
+            pos++;
+        }
+        if (pending) {
+            if (pendingLength >= kMinMatch) {
+                EmitMatch(pendingLength, pendingDist);
+            } else {
+                EmitLiteral(data_[size_ - 1]);
+            }
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// PNG 编码
+
+// 以 p = a + b - c 展开后的距离比较，没有分支，便于编译器向量化
+uint8_t Paeth(uint8_t a, uint8_t b, uint8_t c) {
+    int pa = std::abs(b - c);
+    int pb = std::abs(a - c);
+    int pc = std::abs(a + b - 2 * c);
+    uint8_t bc = pb <= pc ? b : c;
+    return pa <= pb && pa <= pc ? a : bc;
+}
+
+const uint32_t kFiltersFast = (1u << 0) | (1u << 1) | (1u << 2);
+const uint32_t kFiltersAll = 0x1f;
+
+template <int Filter>
+uint8_t Predict(uint8_t left, uint8_t up, uint8_t upperLeft) {
+    switch (Filter) {
+        case 1: return left;
+        case 2: return up;
+        case 3: return static_cast<uint8_t>((left + up) >> 1);
+        case 4: return Paeth(left, up, upperLeft);
+        default: return 0;
+    }
+}
+
+// 滤波一行到 out，返回输出字节（视为有符号数）的绝对值之和。
+// 第一个像素单独处理（左侧和左上按 0 计算），其余部分没有分支
+template <int Filter>
+uint64_t ApplyFilter(const uint8_t* row, const uint8_t* previous, size_t length, size_t bpp, uint8_t* out) {
+    uint32_t sum = 0;
+    size_t head = std::min(bpp, length);
+    for (size_t i = 0; i < head; i++) {
+        out[i] = static_cast<uint8_t>(row[i] - Predict<Filter>(0, previous[i], 0));
+        sum += std::abs(static_cast<int8_t>(out[i]));
+    }
+    for (size_t i = head; i < length; i++) {
+        uint8_t value = static_cast<uint8_t>(row[i] - Predict<Filter>(row[i - bpp], previous[i], previous[i - bpp]));
+        out[i] = value;
+        sum += std::abs(static_cast<int8_t>(value));
+    }
+    return sum;
+}
+
+// 对一行依次尝试 filters 中的滤波类型，取绝对值之和最小者，即 libpng 的经典启发式：
+// 和越小，残差越接近 0，deflate 越容易压缩
+void FilterRow(const uint8_t* row, const uint8_t* previous, size_t length, size_t bpp,
+               uint32_t filters, uint8_t* out, std::vector<uint8_t>& trial) {
+    typedef uint64_t (*FilterFunction)(const uint8_t*, const uint8_t*, size_t, size_t, uint8_t*);
+    static const FilterFunction functions[5] = {
+        ApplyFilter<0>, ApplyFilter<1>, ApplyFilter<2>, ApplyFilter<3>, ApplyFilter<4> };
+
+    trial.resize(length);
+    uint8_t* best = out + 1;
+    uint64_t bestSum = UINT64_MAX;
+    for (int filter = 0; filter < 5; filter++) {
+        if (!(filters & (1u << filter))) continue;
+        // 第一个候选直接写到输出，之后的写到 trial，更优时再复制
+        uint8_t* target = bestSum == UINT64_MAX ? best : trial.data();
+        uint64_t sum = functions[filter](row, previous, length, bpp, target);
+        if (sum < bestSum) {
+            if (target != best) std::memcpy(best, target, length);
+            bestSum = sum;
+            out[0] = static_cast<uint8_t>(filter);
+        }
+    }
+}
+
+bool IsOpaque(const BgraImage& image) {
+    const uint8_t* p = image.pixels.data();
+    size_t count = static_cast<size_t>(image.width) * image.height;
+    for (size_t i = 0; i < count; i++) {
+        if (p[i * 4 + 3] != 255) return false;
+    }
+    return true;
+}
+
+uint8_t ZlibFlags(PngLevel level) {
+    // FLEVEL 与 FCHECK，使 (0x78 << 8 | flags) 能被 31 整除
+    switch (level) {
+        case PngLevel::Stored: return 0x01;
+        case PngLevel::Fast: return 0x5e;
+        case PngLevel::Small: return 0xda;
+        default: return 0x9c;
+    }
+}
+
+void WriteChunkCrc(std::vector<uint8_t>& output, size_t typeOffset) {
+    WriteBe32(output, Crc32(0, output.data() + typeOffset, output.size() - typeOffset));
+}
+
+void WriteHeader(std::vector<uint8_t>& output, int width, int height, uint8_t colorType) {
+    output.insert(output.end(), kPngSignature, kPngSignature + 8);
+    WriteBe32(output, 13);
+    size_t start = output.size();
+    output.insert(output.end(), { 'I', 'H', 'D', 'R' });
+    WriteBe32(output, static_cast<uint32_t>(width));
+    WriteBe32(output, static_cast<uint32_t>(height));
+    output.insert(output.end(), { 8, colorType, 0, 0, 0 }); // 8 位，非隔行
+    WriteChunkCrc(output, start);
+}
+
+void WriteEnd(std::vector<uint8_t>& output) {
+    WriteBe32(output, 0);
+    size_t start = output.size();
+    output.insert(output.end(), { 'I', 'E', 'N', 'D' });
+    WriteChunkCrc(output, start);
+}
+
+// 存储级别：一次分配准确大小，像素直接转换到输出中，边写边计算 Adler32
+bool EncodePngStoredFast(const BgraImage& image, std::vector<uint8_t>& output) {
+    size_t pixelBytes = static_cast<size_t>(image.width) * 4;
+    size_t rawSize = (pixelBytes + 1) * image.height;
+    size_t blocks = (rawSize + kMaxStoredBlock - 1) / kMaxStoredBlock;
+    size_t zlibSize = 2 + rawSize + blocks * 5 + 4;
+    if (zlibSize > 0x7fffffffu) {
+        return false;
+    }
+
+    output.reserve(8 + 25 + 12 + zlibSize + 12);
+    WriteHeader(output, image.width, image.height, 6);
+    WriteBe32(output, static_cast<uint32_t>(zlibSize));
+    size_t start = output.size();
+    output.insert(output.end(), { 'I', 'D', 'A', 'T', 0x78, ZlibFlags(PngLevel::Stored) });
+    output.resize(start + 6 + zlibSize - 2);
+    uint8_t* out = output.data() + start + 6;
+
+    const PixelKernels& kernels = GetPixelKernels();
+    std::vector<uint8_t> spill; // 跨越存储块边界的行先转换到这里
+    uint32_t adler = 1;
+    size_t remaining = rawSize;
+    size_t blockLeft = 0;
+    auto append = [&](const uint8_t* data, size_t length) {
+        while (length > 0) {
+            if (blockLeft == 0) {
+                blockLeft = std::min(remaining, kMaxStoredBlock);
+                remaining -= blockLeft;
+                out[0] = remaining == 0 ? 1 : 0;
+                out[1] = static_cast<uint8_t>(blockLeft);
+                out[2] = static_cast<uint8_t>(blockLeft >> 8);
+                out[3] = static_cast<uint8_t>(~blockLeft);
+                out[4] = static_cast<uint8_t>(~blockLeft >> 8);
+                out += 5;
+            }
+            size_t n = std::min(length, blockLeft);
+            std::memcpy(out, data, n);
+            out += n;
+            data += n;
+            length -= n;
+            blockLeft -= n;
+        }
+    };
+
+    // 块头不计入 Adler32，因此按行而不是按输出区间计算
+    const uint8_t filterNone = 0;
+    for (int y = 0; y < image.height; y++) {
+        append(&filterNone, 1);
+        adler = Adler32(adler, &filterNone, 1);
+        if (blockLeft >= pixelBytes) {
+            kernels.swizzle(out, image.Row(y), image.width);
+            adler = Adler32(adler, out, pixelBytes);
+            out += pixelBytes;
+            blockLeft -= pixelBytes;
+        } else {
+            spill.resize(pixelBytes);
+            kernels.swizzle(spill.data(), image.Row(y), image.width);
+            adler = Adler32(adler, spill.data(), pixelBytes);
+            append(spill.data(), pixelBytes);
+        }
+    }
+
+    PutBe32(out, adler);
+    WriteChunkCrc(output, start);
+    WriteEnd(output);
+    return true;
+}
+
+} // namespace
+
+void ZlibCompress(const uint8_t* data, size_t size, PngLevel level, std::vector<uint8_t>& output) {
+    output.push_back(0x78);
+    output.push_back(ZlibFlags(level));
+    BitWriter writer(output);
+    if (level == PngLevel::Stored) {
+        WriteStoredBlocks(writer, data, size, true);
+    } else if (size == 0) {
+        // 只含块结束符的固定 Huffman 块
+        writer.Put(1, 1);
+        writer.Put(1, 2);
+        writer.Put(0, 7);
+    } else {
+        Deflater(data, size, level, writer).Run();
+    }
+    writer.AlignToByte();
+    WriteBe32(output, Adler32(1, data, size));
+}
+
+bool EncodePng(const BgraImage& image, PngLevel level, std::vector<uint8_t>& output) {
+    output.clear();
+    if (image.width <= 0 || image.height <= 0 ||
+        image.pixels.size() != static_cast<size_t>(image.width) * image.height * 4) {
+        return false;
+    }
+    if (level == PngLevel::Stored) {
+        return EncodePngStoredFast(image, output);
+    }
+
+    // 完全不透明时省掉 alpha 通道，解码结果相同
+    bool opaque = IsOpaque(image);
+    size_t bpp = opaque ? 3 : 4;
+    size_t rowBytes = static_cast<size_t>(image.width) * bpp;
+    std::vector<uint8_t> rows(rowBytes * image.height);
+    const PixelKernels& kernels = GetPixelKernels();
+    for (int y = 0; y < image.height; y++) {
+        const uint8_t* src = image.Row(y);
+        uint8_t* dst = rows.data() + rowBytes * y;
+        if (opaque) {
+            for (int x = 0; x < image.width; x++) {
+                dst[x * 3 + 0] = src[x * 4 + 2];
+                dst[x * 3 + 1] = src[x * 4 + 1];
+                dst[x * 3 + 2] = src[x * 4 + 0];
+            }
+        } else {
+            kernels.swizzle(dst, src, image.width);
+        }
+    }
+
+    auto filterImage = [&](uint32_t filters, std::vector<uint8_t>& filtered) {
+        filtered.resize((rowBytes + 1) * image.height);
+        std::vector<uint8_t> zeros(rowBytes, 0);
+        std::vector<uint8_t> trial;
+        for (int y = 0; y < image.height; y++) {
+            const uint8_t* row = rows.data() + rowBytes * y;
+            const uint8_t* previous = y > 0 ? row - rowBytes : zeros.data();
+            FilterRow(row, previous, rowBytes, bpp, filters, filtered.data() + (rowBytes + 1) * y, trial);
+        }
+    };
+
+    std::vector<uint8_t> filtered;
+    filterImage(level == PngLevel::Fast ? kFiltersFast : kFiltersAll, filtered);
+
+    // 逐行启发式对渐变有效，但扁平风格、带抗锯齿边的图标整图不滤波时 LZ77 能匹配到
+    // 重复的原始像素，往往小 20% 以上；五种滤波的 MSAD 选择又常输给 Fast 只在
+    // None/Sub/Up 中选择的结果。三种数据都先用 Fast 级别试压缩（搜索深度有限，
+    // 不会在短匹配很多的数据上退化），再以请求的级别压缩最小的一种
+    std::vector<uint8_t> best;
+    if (level != PngLevel::Fast) {
+        ZlibCompress(filtered.data(), filtered.size(), PngLevel::Fast, best);
+        const uint32_t probeFilters[] = { kFiltersFast, 1u << 0 };
+        std::vector<uint8_t> candidate;
+        std::vector<uint8_t> probe;
+        for (uint32_t filters : probeFilters) {
+            filterImage(filters, candidate);
+            probe.clear();
+            ZlibCompress(candidate.data(), candidate.size(), PngLevel::Fast, probe);
+            if (probe.size() < best.size()) {
+                best.swap(probe);
+                filtered.swap(candidate);
+            }
+        }
+    }
+
+    // 压缩结果直接写在 IDAT 长度和类型之后，完成后回填长度
+    output.reserve(8 + 25 + 12 + filtered.size() / 2 + 12);
+    WriteHeader(output, image.width, image.height, opaque ? 2 : 6);
+    size_t lengthOffset = output.size();
+    WriteBe32(output, 0);
+    output.insert(output.end(), { 'I', 'D', 'A', 'T' });
+    size_t dataOffset = output.size();
+    ZlibCompress(filtered.data(), filtered.size(), level, output);
+    // 更深的搜索在少数数据上反而更大，此时沿用试压缩结果（其中含 Fast 级别的输出），
+    // 保证级别越高输出不会越大
+    if (!best.empty() && output.size() - dataOffset > best.size()) {
+        output.resize(dataOffset);
+        output.insert(output.end(), best.begin(), best.end());
+    }
+
+    PutBe32(output.data() + lengthOffset, static_cast<uint32_t>(output.size() - dataOffset));
+    WriteChunkCrc(output, lengthOffset + 4);
+    WriteEnd(output);
+    return true;
+}
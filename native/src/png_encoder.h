@@ -0,0 +1,27 @@
+#ifndef PNG_ENCODER_H
+#define PNG_ENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bgra_image.h"
+
+// PNG 编码级别，数值越大耗时越长。Default 和 Small 的输出不会大于 Fast，
+// 但 Small 只是搜索更深，少数图像上会比 Default 略大
+enum class PngLevel {
+    Stored = 0,  // 不压缩：滤波类型 0 + 存储块，只做 BGRA -> RGBA 和校验和
+    Fast = 1,    // None/Sub/Up 中按行择优，哈希只查最近 4 个候选，贪心匹配
+    Default = 2, // 五种滤波按行择优、Fast 的三种滤波或整图不滤波（试压缩后取最小者），哈希链 32，惰性匹配；
+                 // 输出不会大于 Fast
+    Small = 3,   // 同 Default，哈希链 128，匹配到最长 258 字节才停止
+};
+
+// 编码为 8 位 PNG，解码后与 image 逐位一致。除 Stored 外，alpha 全为 255 时输出 RGB。
+// output 会被清空后按最坏情况一次预留，可直接移交给调用方
+bool EncodePng(const BgraImage& image, PngLevel level, std::vector<uint8_t>& output);
+
+// zlib 流压缩（RFC 1950/1951），level 含义同上，追加到 output 末尾
+void ZlibCompress(const uint8_t* data, size_t size, PngLevel level, std::vector<uint8_t>& output);
+
+#endif
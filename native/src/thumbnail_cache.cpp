@@ -0,0 +1,792 @@
+#include "thumbnail_cache.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <climits>
+#include <cstdlib>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kIndexMagic[8] = { 'T', 'H', 'U', 'M', 'B', 'I', 'D', 'X' };
+const uint32_t kIndexVersion = 1;
+
+std::atomic<uint32_t> g_tempSerial{ 0 };
+
+#ifdef _WIN32
+std::wstring Widen(const std::string& utf8) {
+    if (utf8.empty()) return L"";
+    int length = MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), (int)utf8.size(), NULL, 0);
+    std::wstring wide(length, 0);
+    MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), (int)utf8.size(), &wide[0], length);
+    return wide;
+}
+
+std::string Narrow(const wchar_t* wide) {
+    int length = WideCharToMultiByte(CP_UTF8, 0, wide, -1, NULL, 0, NULL, NULL);
+    if (length <= 1) return "";
+    std::string utf8(length - 1, 0);
+    WideCharToMultiByte(CP_UTF8, 0, wide, -1, &utf8[0], length, NULL, NULL);
+    return utf8;
+}
+#endif
+
+bool MakeDirectory(const std::string& path) {
+#ifdef _WIN32
+    return CreateDirectoryW(Widen(path).c_str(), NULL) || GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+bool RemoveFile(const std::string& path) {
+#ifdef _WIN32
+    return DeleteFileW(Widen(path).c_str()) != 0;
+#else
+    return unlink(path.c_str()) == 0;
+#endif
+}
+
+struct BlobFile {
+    std::string path;
+    uint64_t size;
+};
+
+// 列出 <directory>/<xx>/ 下的所有文件（包括中途退出遗留的临时文件）
+void ListBlobs(const std::string& directory, std::vector<BlobFile>& files) {
+#ifdef _WIN32
+    WIN32_FIND_DATAW group;
+    HANDLE outer = FindFirstFileW(Widen(directory + "/*").c_str(), &group);
+    if (outer == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    do {
+        if (group.cFileName[0] == L'.' || !(group.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+            continue;
+        }
+        std::string groupPath = directory + "/" + Narrow(group.cFileName);
+        WIN32_FIND_DATAW entry;
+        HANDLE inner = FindFirstFileW(Widen(groupPath + "/*").c_str(), &entry);
+        if (inner == INVALID_HANDLE_VALUE) {
+            continue;
+        }
+        do {
+            if (!(entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+                uint64_t size = (static_cast<uint64_t>(entry.nFileSizeHigh) << 32) | entry.nFileSizeLow;
+                files.push_back({ groupPath + "/" + Narrow(entry.cFileName), size });
+            }
+        } while (FindNextFileW(inner, &entry));
+        FindClose(inner);
+    } while (FindNextFileW(outer, &group));
+    FindClose(outer);
+#else
+    DIR* outer = opendir(directory.c_str());
+    if (!outer) {
+        return;
+    }
+    while (struct dirent* group = readdir(outer)) {
+        if (group->d_name[0] == '.') {
+            continue;
+        }
+        std::string groupPath = directory + "/" + group->d_name;
+        DIR* inner = opendir(groupPath.c_str());
+        if (!inner) {
+            continue;
+        }
+        while (struct dirent* entry = readdir(inner)) {
+            std::string path = groupPath + "/" + entry->d_name;
+            struct stat info;
+            if (entry->d_name[0] != '.' && stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode)) {
+                files.push_back({ path, static_cast<uint64_t>(info.st_size) });
+            }
+        }
+        closedir(inner);
+    }
+    closedir(outer);
+#endif
+}
+
+bool ReadWholeFile(const std::string& path, std::vector<uint8_t>& data) {
+#ifdef _WIN32
+    std::ifstream file(Widen(path), std::ios::binary);
+#else
+    std::ifstream file(path, std::ios::binary);
+#endif
+    if (!file) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
+
+// 先写同目录下的临时文件再 rename，读取方不会看到写了一半的文件
+bool WriteFileAtomic(const std::string& path, const uint8_t* data, size_t size) {
+    std::string tempPath = path + ".tmp" + std::to_string(g_tempSerial++);
+    {
+#ifdef _WIN32
+        std::ofstream file(Widen(tempPath), std::ios::binary | std::ios::trunc);
+#else
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+#endif
+        if (!file || !file.write(reinterpret_cast<const char*>(data), size)) {
+            file.close();
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+#ifdef _WIN32
+    if (!MoveFileExW(Widen(tempPath).c_str(), Widen(path).c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileW(Widen(tempPath).c_str());
+        return false;
+    }
+#else
+    if (rename(tempPath.c_str(), path.c_str()) != 0) {
+        unlink(tempPath.c_str());
+        return false;
+    }
+#endif
+    return true;
+}
+
+inline uint64_t Rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t Fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdull;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ull;
+    k ^= k >> 33;
+    return k;
+}
+
+void AppendBytes(std::string& buffer, const void* data, size_t size) {
+    buffer.append(static_cast<const char*>(data), size);
+}
+
+} // namespace
+
+ThumbnailKey Hash128(const void* data, size_t size, uint64_t seed) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    const size_t blocks = size / 16;
+    const uint64_t c1 = 0x87c37b91114253d5ull;
+    const uint64_t c2 = 0x4cf5ad432745937full;
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+
+    for (size_t i = 0; i < blocks; i++) {
+        uint64_t k1, k2;
+        memcpy(&k1, bytes + i * 16, 8);
+        memcpy(&k2, bytes + i * 16 + 8, 8);
+
+        k1 *= c1; k1 = Rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = Rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+        k2 *= c2; k2 = Rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = Rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    const uint8_t* tail = bytes + blocks * 16;
+    uint64_t k1 = 0, k2 = 0;
+    switch (size & 15) {
+        case 15: k2 ^= static_cast<uint64_t>(tail[14]) << 48; // fallthrough
+        case 14: k2 ^= static_cast<uint64_t>(tail[13]) << 40; // fallthrough
+        case 13: k2 ^= static_cast<uint64_t>(tail[12]) << 32; // fallthrough
+        case 12: k2 ^= static_cast<uint64_t>(tail[11]) << 24; // fallthrough
+        case 11: k2 ^= static_cast<uint64_t>(tail[10]) << 16; // fallthrough
+        case 10: k2 ^= static_cast<uint64_t>(tail[9]) << 8;   // fallthrough
+        case 9:
+            k2 ^= static_cast<uint64_t>(tail[8]);
+            k2 *= c2; k2 = Rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+            // fallthrough
+        case 8: k1 ^= static_cast<uint64_t>(tail[7]) << 56; // fallthrough
+        case 7: k1 ^= static_cast<uint64_t>(tail[6]) << 48; // fallthrough
+        case 6: k1 ^= static_cast<uint64_t>(tail[5]) << 40; // fallthrough
+        case 5: k1 ^= static_cast<uint64_t>(tail[4]) << 32; // fallthrough
+        case 4: k1 ^= static_cast<uint64_t>(tail[3]) << 24; // fallthrough
+        case 3: k1 ^= static_cast<uint64_t>(tail[2]) << 16; // fallthrough
+        case 2: k1 ^= static_cast<uint64_t>(tail[1]) << 8;  // fallthrough
+        case 1:
+            k1 ^= static_cast<uint64_t>(tail[0]);
+            k1 *= c1; k1 = Rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= size;
+    h2 ^= size;
+    h1 += h2;
+    h2 += h1;
+    h1 = Fmix64(h1);
+    h2 = Fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+
+    ThumbnailKey key;
+    key.high = h1;
+    key.low = h2;
+    return key;
+}
+
+ThumbnailCache::~ThumbnailCache() {
+    CloseIndex();
+}
+
+bool ThumbnailCache::MakeKey(const std::string& path, int size, uint32_t variant, ThumbnailKey& key) {
+    std::string material;
+    uint64_t identity[4];
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(Widen(path).c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    BY_HANDLE_FILE_INFORMATION info;
+    wchar_t finalPath[MAX_PATH * 2];
+    DWORD finalLength = GetFinalPathNameByHandleW(file, finalPath, MAX_PATH * 2, FILE_NAME_NORMALIZED);
+    bool ok = GetFileInformationByHandle(file, &info) != 0;
+    CloseHandle(file);
+    if (!ok) {
+        return false;
+    }
+    if (finalLength > 0 && finalLength < MAX_PATH * 2) {
+        AppendBytes(material, finalPath, finalLength * sizeof(wchar_t));
+    } else {
+        AppendBytes(material, path.data(), path.size());
+    }
+    identity[0] = info.dwVolumeSerialNumber;
+    identity[1] = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+    identity[2] = (static_cast<uint64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+    identity[3] = (static_cast<uint64_t>(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime;
+#else
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        return false;
+    }
+    char resolved[PATH_MAX];
+    if (realpath(path.c_str(), resolved)) {
+        AppendBytes(material, resolved, strlen(resolved));
+    } else {
+        AppendBytes(material, path.data(), path.size());
+    }
+    identity[0] = static_cast<uint64_t>(info.st_dev);
+    identity[1] = static_cast<uint64_t>(info.st_ino);
+    identity[2] = static_cast<uint64_t>(info.st_size);
+#ifdef __APPLE__
+    identity[3] = static_cast<uint64_t>(info.st_mtimespec.tv_sec) * 1000000000ull + info.st_mtimespec.tv_nsec;
+#else
+    identity[3] = static_cast<uint64_t>(info.st_mtim.tv_sec) * 1000000000ull + info.st_mtim.tv_nsec;
+#endif
+#endif
+
+    material.push_back('\0');
+    AppendBytes(material, identity, sizeof(identity));
+    AppendBytes(material, &size, sizeof(size));
+    AppendBytes(material, &variant, sizeof(variant));
+    key = Hash128(material.data(), material.size());
+    // 全 0 在索引中表示空槽
+    if (key.high == 0 && key.low == 0) {
+        key.low = 1;
+    }
+    return true;
+}
+
+void ThumbnailCache::SetMemoryBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    memoryBudget_ = bytes;
+    TrimMemory();
+}
+
+void ThumbnailCache::SetDiskBudget(uint64_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        diskBudget_ = bytes;
+    }
+    CollectDisk();
+}
+
+bool ThumbnailCache::SetDirectory(const std::string& directory) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        CloseIndex();
+        directory_.clear();
+        diskBytes_ = 0;
+        if (directory.empty()) {
+            return true;
+        }
+
+        if (!MakeDirectory(directory) || !MakeDirectory(directory + "/blobs")) {
+            return false;
+        }
+        directory_ = directory;
+        if (!OpenIndex(directory_ + "/index.bin") || !MapIndex(kInitialIndexCapacity, false)) {
+            CloseIndex();
+            directory_.clear();
+            return false;
+        }
+
+        // 已有的数据文件（包括索引不再引用的）都计入预算
+        std::vector<BlobFile> files;
+        ListBlobs(directory_ + "/blobs", files);
+        for (const auto& file : files) {
+            diskBytes_ += file.size;
+        }
+    }
+    CollectDisk();
+    return true;
+}
+
+ThumbnailData ThumbnailCache::Lookup(const ThumbnailKey& key) {
+    std::string blobPath;
+    uint64_t blobHigh = 0, blobLow = 0;
+    uint32_t blobSize = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            stats_.memoryHits++;
+            return it->second->data;
+        }
+
+        const IndexSlot* slot = index_ ? FindSlot(key) : nullptr;
+        if (!slot || (slot->keyHigh == 0 && slot->keyLow == 0)) {
+            stats_.misses++;
+            return nullptr;
+        }
+        blobHigh = slot->blobHigh;
+        blobLow = slot->blobLow;
+        blobSize = slot->size;
+        blobPath = BlobPath(blobHigh, blobLow);
+    }
+
+    // 在锁外读取数据文件，并用内容哈希校验
+    auto data = std::make_shared<std::vector<uint8_t>>();
+    bool valid = ReadWholeFile(blobPath, *data) && data->size() == blobSize;
+    if (valid) {
+        ThumbnailKey hash = Hash128(data->data(), data->size());
+        valid = hash.high == blobHigh && hash.low == blobLow;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!valid) {
+        stats_.misses++;
+        return nullptr;
+    }
+    stats_.diskHits++;
+    ThumbnailData result = data;
+    Remember(key, result);
+    return result;
+}
+
+void ThumbnailCache::Store(const ThumbnailKey& key, const std::vector<uint8_t>& data) {
+    ThumbnailData shared = std::make_shared<const std::vector<uint8_t>>(data);
+    std::string blobPath;
+    ThumbnailKey blob = Hash128(data.data(), data.size());
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.stores++;
+        Remember(key, shared);
+        if (!index_) {
+            return;
+        }
+        blobPath = BlobPath(blob.high, blob.low);
+    }
+
+    // 相同内容的数据文件已存在时不重复写入
+#ifdef _WIN32
+    bool present = GetFileAttributesW(Widen(blobPath).c_str()) != INVALID_FILE_ATTRIBUTES;
+#else
+    bool present = access(blobPath.c_str(), F_OK) == 0;
+#endif
+    if (!present) {
+        MakeDirectory(blobPath.substr(0, blobPath.rfind('/')));
+        if (!WriteFileAtomic(blobPath, data.data(), data.size())) {
+            return;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!index_) {
+            return;
+        }
+        if (!present) {
+            diskBytes_ += data.size();
+        }
+        if ((indexCount_ + 1) * 4 > Capacity() * 3) {
+            uint64_t capacity = Capacity() * 2;
+            // 达到上限时丢弃旧索引重新开始，数据文件仍可被新条目复用
+            if (capacity > kMaxIndexCapacity) {
+                capacity = kInitialIndexCapacity;
+                memset(Slots(), 0, sizeof(IndexSlot) * Capacity());
+                indexCount_ = 0;
+            }
+            if (!RebuildIndex(capacity)) {
+                return;
+            }
+        }
+
+        IndexSlot* slot = FindSlot(key);
+        if (!slot) {
+            return;
+        }
+        bool fresh = slot->keyHigh == 0 && slot->keyLow == 0;
+        // 先写数据字段，最后写键；中途崩溃留下的条目会在读取时因哈希不符被忽略
+        slot->blobHigh = blob.high;
+        slot->blobLow = blob.low;
+        slot->size = static_cast<uint32_t>(data.size());
+        slot->stamp = static_cast<uint64_t>(time(nullptr));
+        slot->keyHigh = key.high;
+        slot->keyLow = key.low;
+        if (fresh) {
+            indexCount_++;
+        }
+    }
+    CollectDisk();
+}
+
+void ThumbnailCache::Clear() {
+    std::string blobsDirectory;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lru_.clear();
+        entries_.clear();
+        memoryBytes_ = 0;
+        if (!index_) {
+            return;
+        }
+        memset(Slots(), 0, sizeof(IndexSlot) * Capacity());
+        indexCount_ = 0;
+        diskBytes_ = 0;
+        blobsDirectory = directory_ + "/blobs";
+    }
+
+    // 在锁外删除数据文件；同时写入的条目可能随之失效，读取时按未命中处理
+    std::vector<BlobFile> files;
+    ListBlobs(blobsDirectory, files);
+    for (const auto& file : files) {
+        RemoveFile(file.path);
+    }
+}
+
+ThumbnailCacheStats ThumbnailCache::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ThumbnailCacheStats stats = stats_;
+    stats.memoryBytes = memoryBytes_;
+    stats.memoryEntries = entries_.size();
+    stats.diskEntries = indexCount_;
+    stats.diskBytes = diskBytes_;
+    return stats;
+}
+
+// 调用方需持有 mutex_
+void ThumbnailCache::Remember(const ThumbnailKey& key, const ThumbnailData& data) {
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        memoryBytes_ -= it->second->data->size();
+        lru_.erase(it->second);
+        entries_.erase(it);
+    }
+    if (data->size() > memoryBudget_) {
+        return;
+    }
+
+    lru_.push_front({ key, data });
+    entries_[key] = lru_.begin();
+    memoryBytes_ += data->size();
+    TrimMemory();
+}
+
+// 调用方需持有 mutex_
+void ThumbnailCache::TrimMemory() {
+    while (memoryBytes_ > memoryBudget_ && !lru_.empty()) {
+        const MemoryEntry& oldest = lru_.back();
+        memoryBytes_ -= oldest.data->size();
+        entries_.erase(oldest.key);
+        lru_.pop_back();
+        stats_.evictions++;
+    }
+}
+
+// 线性探测，返回键所在的槽或第一个空槽；表满时返回 nullptr
+ThumbnailCache::IndexSlot* ThumbnailCache::FindSlot(const ThumbnailKey& key) const {
+    uint64_t capacity = Capacity();
+    IndexSlot* slots = Slots();
+    for (uint64_t probe = 0; probe < capacity; probe++) {
+        IndexSlot* slot = &slots[(key.low + probe) & (capacity - 1)];
+        if ((slot->keyHigh == key.high && slot->keyLow == key.low) || (slot->keyHigh == 0 && slot->keyLow == 0)) {
+            return slot;
+        }
+    }
+    return nullptr;
+}
+
+// 打开索引文件并独占锁定，另一个进程已打开同一目录时失败。调用方需持有 mutex_
+bool ThumbnailCache::OpenIndex(const std::string& path) {
+#ifdef _WIN32
+    // 不共享读写，其他进程打开时因共享冲突失败
+    HANDLE file = CreateFileW(Widen(path).c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    indexFile_ = file;
+#else
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        close(fd);
+        return false;
+    }
+    indexFd_ = fd;
+#endif
+    return true;
+}
+
+// 映射已打开的索引文件。reset 为 true 时按 capacity 重新初始化为空表。调用方需持有 mutex_
+bool ThumbnailCache::MapIndex(uint64_t capacity, bool reset) {
+    size_t expected = sizeof(IndexHeader) + sizeof(IndexSlot) * capacity;
+
+#ifdef _WIN32
+    HANDLE file = indexFile_;
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    size_t size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = indexFd_;
+    struct stat info;
+    fstat(fd, &info);
+    size_t size = static_cast<size_t>(info.st_size);
+#endif
+
+    // 已有文件沿用其容量；新建或损坏时按 capacity 重新初始化
+    bool fresh = reset || size < sizeof(IndexHeader);
+    if (!fresh) {
+        IndexHeader header;
+#ifdef _WIN32
+        LARGE_INTEGER origin;
+        origin.QuadPart = 0;
+        DWORD bytesRead = 0;
+        fresh = !SetFilePointerEx(file, origin, NULL, FILE_BEGIN) ||
+                !ReadFile(file, &header, sizeof(header), &bytesRead, NULL) || bytesRead != sizeof(header);
+#else
+        fresh = pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header));
+#endif
+        if (!fresh) {
+            bool valid = memcmp(header.magic, kIndexMagic, 8) == 0 && header.version == kIndexVersion &&
+                         header.slotSize == sizeof(IndexSlot) && header.capacity >= kInitialIndexCapacity &&
+                         header.capacity <= kMaxIndexCapacity && (header.capacity & (header.capacity - 1)) == 0 &&
+                         size == sizeof(IndexHeader) + sizeof(IndexSlot) * header.capacity;
+            if (valid) {
+                expected = size;
+            } else {
+                fresh = true;
+            }
+        }
+    }
+
+#ifdef _WIN32
+    LARGE_INTEGER target;
+    target.QuadPart = static_cast<LONGLONG>(expected);
+    if (fresh && (!SetFilePointerEx(file, target, NULL, FILE_BEGIN) || !SetEndOfFile(file))) {
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READWRITE, 0, 0, NULL);
+    void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, expected) : NULL;
+    if (!data) {
+        if (mapping) CloseHandle(mapping);
+        return false;
+    }
+    indexMapping_ = mapping;
+#else
+    if (fresh && (ftruncate(fd, 0) != 0 || ftruncate(fd, static_cast<off_t>(expected)) != 0)) {
+        return false;
+    }
+    void* data = mmap(nullptr, expected, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+#endif
+
+    index_ = static_cast<uint8_t*>(data);
+    indexSize_ = expected;
+    IndexHeader* header = reinterpret_cast<IndexHeader*>(index_);
+    if (fresh) {
+        memset(index_, 0, indexSize_);
+        memcpy(header->magic, kIndexMagic, 8);
+        header->version = kIndexVersion;
+        header->slotSize = sizeof(IndexSlot);
+        header->capacity = capacity;
+    }
+
+    // 条目数不写入文件，打开时重新统计，异常退出后也保持准确
+    indexCount_ = 0;
+    for (uint64_t i = 0; i < header->capacity; i++) {
+        if (Slots()[i].keyHigh != 0 || Slots()[i].keyLow != 0) {
+            indexCount_++;
+        }
+    }
+    return true;
+}
+
+// 只解除映射，文件和锁保留。调用方需持有 mutex_
+void ThumbnailCache::UnmapIndex() {
+    if (!index_) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(index_);
+    CloseHandle(indexMapping_);
+    indexMapping_ = nullptr;
+#else
+    munmap(index_, indexSize_);
+#endif
+    index_ = nullptr;
+    indexSize_ = 0;
+    indexCount_ = 0;
+}
+
+// 解除映射并关闭文件，释放锁。调用方需持有 mutex_
+void ThumbnailCache::CloseIndex() {
+    UnmapIndex();
+#ifdef _WIN32
+    if (indexFile_) {
+        CloseHandle(indexFile_);
+        indexFile_ = nullptr;
+    }
+#else
+    if (indexFd_ >= 0) {
+        close(indexFd_);
+        indexFd_ = -1;
+    }
+#endif
+}
+
+// 以新容量重建索引：在内存中重新散列，再原地重写同一个文件，锁始终不释放。
+// 中途退出留下的文件要么头部无效而整体重建，要么条目因哈希不符被忽略。调用方需持有 mutex_
+bool ThumbnailCache::RebuildIndex(uint64_t capacity, const std::unordered_set<ThumbnailKey, KeyHash>* keep) {
+    std::vector<IndexSlot> rebuilt(capacity, IndexSlot{});
+    uint64_t count = 0;
+    uint64_t oldCapacity = Capacity();
+    for (uint64_t i = 0; i < oldCapacity; i++) {
+        const IndexSlot& slot = Slots()[i];
+        if (slot.keyHigh == 0 && slot.keyLow == 0) {
+            continue;
+        }
+        if (keep && !keep->count(ThumbnailKey{ slot.blobHigh, slot.blobLow })) {
+            continue;
+        }
+        uint64_t position = slot.keyLow & (capacity - 1);
+        while (rebuilt[position].keyHigh != 0 || rebuilt[position].keyLow != 0) {
+            position = (position + 1) & (capacity - 1);
+        }
+        rebuilt[position] = slot;
+        count++;
+    }
+
+    // Windows 上被映射的文件不能改变大小，先解除映射
+    UnmapIndex();
+    if (!MapIndex(capacity, true)) {
+        // 无法重新映射时关闭磁盘层，释放锁
+        CloseIndex();
+        return false;
+    }
+    memcpy(Slots(), rebuilt.data(), sizeof(IndexSlot) * capacity);
+    indexCount_ = count;
+    return true;
+}
+
+// 数据文件总大小超出预算时回收：按数据文件最近一次被索引的时间从新到旧保留，直到预算的 3/4，
+// 其余条目从索引中移除，然后在锁外删除不再保留的数据文件（包括索引早已不引用的孤立文件）
+void ThumbnailCache::CollectDisk() {
+    std::unordered_set<std::string> keepPaths;
+    std::string blobsDirectory;
+    uint64_t startBytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!index_ || collecting_ || diskBytes_ <= diskBudget_) {
+            return;
+        }
+        collecting_ = true;
+        startBytes = diskBytes_;
+
+        struct Blob {
+            ThumbnailKey hash;
+            uint64_t size;
+            uint64_t stamp;
+        };
+        std::unordered_map<ThumbnailKey, Blob, KeyHash> blobs;
+        for (uint64_t i = 0; i < Capacity(); i++) {
+            const IndexSlot& slot = Slots()[i];
+            if (slot.keyHigh == 0 && slot.keyLow == 0) {
+                continue;
+            }
+            ThumbnailKey hash{ slot.blobHigh, slot.blobLow };
+            Blob& blob = blobs.emplace(hash, Blob{ hash, slot.size, 0 }).first->second;
+            blob.stamp = std::max(blob.stamp, slot.stamp);
+        }
+
+        std::vector<Blob> ordered;
+        ordered.reserve(blobs.size());
+        for (const auto& pair : blobs) {
+            ordered.push_back(pair.second);
+        }
+        std::sort(ordered.begin(), ordered.end(), [](const Blob& a, const Blob& b) { return a.stamp > b.stamp; });
+
+        std::unordered_set<ThumbnailKey, KeyHash> keep;
+        uint64_t target = diskBudget_ / 4 * 3;
+        uint64_t total = 0;
+        for (const auto& blob : ordered) {
+            if (total + blob.size > target) {
+                break;
+            }
+            total += blob.size;
+            keep.insert(blob.hash);
+            keepPaths.insert(BlobPath(blob.hash.high, blob.hash.low));
+        }
+        RebuildIndex(Capacity(), &keep);
+        blobsDirectory = directory_ + "/blobs";
+        stats_.diskCollections++;
+    }
+
+    // 同时写入的数据文件可能被删除，对应条目在读取时按未命中处理
+    std::vector<BlobFile> files;
+    ListBlobs(blobsDirectory, files);
+    uint64_t remaining = 0;
+    for (const auto& file : files) {
+        if (keepPaths.count(file.path) || !RemoveFile(file.path)) {
+            remaining += file.size;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 回收期间写入的字节另行计入
+    diskBytes_ = remaining + (diskBytes_ > startBytes ? diskBytes_ - startBytes : 0);
+    collecting_ = false;
+}
+
+std::string ThumbnailCache::BlobPath(uint64_t high, uint64_t low) const {
+    // 前两位十六进制作为子目录，避免单个目录下文件过多
+    char name[40];
+    snprintf(name, sizeof(name), "%016llx%016llx", static_cast<unsigned long long>(high),
+             static_cast<unsigned long long>(low));
+    return directory_ + "/blobs/" + std::string(name, 2) + "/" + std::string(name + 2);
+}
@@ -0,0 +1,140 @@
+#ifndef THUMBNAIL_CACHE_H
+#define THUMBNAIL_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// 缓存键：(规范路径, 文件身份, 请求尺寸, 变体) 的 128 位哈希
+struct ThumbnailKey {
+    uint64_t high = 0;
+    uint64_t low = 0;
+
+    bool operator==(const ThumbnailKey& other) const { return high == other.high && low == other.low; }
+};
+
+struct ThumbnailCacheStats {
+    uint64_t memoryHits = 0;
+    uint64_t diskHits = 0;
+    uint64_t misses = 0;
+    uint64_t stores = 0;
+    uint64_t evictions = 0;     // 因超出内存预算被淘汰的条目
+    uint64_t memoryBytes = 0;
+    uint64_t memoryEntries = 0;
+    uint64_t diskEntries = 0;
+    uint64_t diskBytes = 0;     // 数据文件总大小（估计值）
+    uint64_t diskCollections = 0; // 因超出磁盘预算进行的回收次数
+};
+
+using ThumbnailData = std::shared_ptr<const std::vector<uint8_t>>;
+
+// 两级缩略图缓存：
+// - 内存：按字节预算淘汰的 LRU
+// - 磁盘：<directory>/blobs/ 下按内容哈希命名的文件（相同图标只存一份），
+//   加上 mmap 的开放寻址索引 <directory>/index.bin（键 -> 内容哈希）。
+//   数据文件先写临时文件再 rename；读取时校验内容哈希，索引条目损坏只会导致未命中。
+//   数据文件总大小超出磁盘预算时，按最近写入时间保留到预算的 3/4，其余条目和文件删除。
+//   index.bin 在打开期间被独占锁定，同一目录只能由一个进程使用
+// 所有方法线程安全，除打开目录外磁盘读写不持有锁
+class ThumbnailCache {
+public:
+    static constexpr size_t kDefaultMemoryBudget = 64u << 20;
+    static constexpr uint64_t kDefaultDiskBudget = 256ull << 20;
+    static constexpr uint64_t kInitialIndexCapacity = 4096; // 必须是 2 的幂
+    static constexpr uint64_t kMaxIndexCapacity = 1u << 20;
+
+    ThumbnailCache() = default;
+    ~ThumbnailCache();
+    ThumbnailCache(const ThumbnailCache&) = delete;
+    ThumbnailCache& operator=(const ThumbnailCache&) = delete;
+
+    // 根据文件身份（inode/文件索引、大小、修改时间）生成键，文件不存在时返回 false。
+    // variant 区分同一尺寸下的不同输出（提取标志等）
+    static bool MakeKey(const std::string& path, int size, uint32_t variant, ThumbnailKey& key);
+
+    void SetMemoryBudget(size_t bytes);
+    void SetDiskBudget(uint64_t bytes);
+    // directory 为空时只使用内存缓存。目录已被其他进程使用时返回 false
+    bool SetDirectory(const std::string& directory);
+
+    ThumbnailData Lookup(const ThumbnailKey& key);
+    void Store(const ThumbnailKey& key, const std::vector<uint8_t>& data);
+    // 清空内存缓存、磁盘索引和数据文件
+    void Clear();
+    ThumbnailCacheStats GetStats();
+
+private:
+    struct KeyHash {
+        size_t operator()(const ThumbnailKey& key) const { return static_cast<size_t>(key.low ^ key.high); }
+    };
+    struct MemoryEntry {
+        ThumbnailKey key;
+        ThumbnailData data;
+    };
+
+    // 索引文件布局：64 字节头 + capacity 个 48 字节槽位
+    struct IndexHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t slotSize;
+        uint64_t capacity;
+        uint8_t reserved[40];
+    };
+    struct IndexSlot {
+        uint64_t keyHigh;
+        uint64_t keyLow;     // 与 keyHigh 同为 0 表示空槽；最后写入
+        uint64_t blobHigh;
+        uint64_t blobLow;
+        uint32_t size;
+        uint32_t reserved;
+        uint64_t stamp;      // 写入时间（Unix 秒）
+    };
+
+    std::mutex mutex_;
+    size_t memoryBudget_ = kDefaultMemoryBudget;
+    size_t memoryBytes_ = 0;
+    std::list<MemoryEntry> lru_; // 头部为最近使用
+    std::unordered_map<ThumbnailKey, std::list<MemoryEntry>::iterator, KeyHash> entries_;
+
+    std::string directory_;
+    uint8_t* index_ = nullptr;
+    size_t indexSize_ = 0;
+    uint64_t indexCount_ = 0;
+    uint64_t diskBudget_ = kDefaultDiskBudget;
+    uint64_t diskBytes_ = 0;     // 打开目录时统计，此后按写入和回收更新
+    bool collecting_ = false;
+#ifdef _WIN32
+    void* indexFile_ = nullptr;  // 打开期间持有，不共享写入
+    void* indexMapping_ = nullptr;
+#else
+    int indexFd_ = -1;           // 打开期间持有 flock 独占锁
+#endif
+
+    ThumbnailCacheStats stats_;
+
+    void Remember(const ThumbnailKey& key, const ThumbnailData& data);
+    void TrimMemory();
+
+    IndexSlot* Slots() const { return reinterpret_cast<IndexSlot*>(index_ + sizeof(IndexHeader)); }
+    uint64_t Capacity() const { return index_ ? reinterpret_cast<const IndexHeader*>(index_)->capacity : 0; }
+    IndexSlot* FindSlot(const ThumbnailKey& key) const;
+    bool OpenIndex(const std::string& path);
+    bool MapIndex(uint64_t capacity, bool reset);
+    void UnmapIndex();
+    void CloseIndex();
+    // keep 不为空时只保留数据文件在其中的条目
+    bool RebuildIndex(uint64_t capacity, const std::unordered_set<ThumbnailKey, KeyHash>* keep = nullptr);
+    void CollectDisk();
+    std::string BlobPath(uint64_t high, uint64_t low) const;
+};
+
+// MurmurHash3 x64 128
+ThumbnailKey Hash128(const void* data, size_t size, uint64_t seed = 0);
+
+#endif
@@ -0,0 +1,105 @@
+#include "thumbnail_pool.h"
+
+ThumbnailBatch::ThumbnailBatch(size_t count, size_t concurrency) {
+    if (concurrency == 0) {
+        concurrency = 1;
+    }
+    if (concurrency > count) {
+        concurrency = count;
+    }
+
+    // 按连续区间预先分配，同一目录下的文件大多落在同一线程，局部性更好
+    for (size_t i = 0; i < concurrency; i++) {
+        std::unique_ptr<Worker> worker(new Worker());
+        size_t begin = count * i / concurrency;
+        size_t end = count * (i + 1) / concurrency;
+        for (size_t index = begin; index < end; index++) {
+            worker->queue.push_back(index);
+        }
+        workers_.push_back(std::move(worker));
+    }
+}
+
+ThumbnailBatch::~ThumbnailBatch() {
+    Cancel();
+    // 环境销毁时 finish 可能来不及执行 Join，此时让线程自行结束
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            if (thread.get_id() == std::this_thread::get_id()) {
+                thread.detach();
+            } else {
+                thread.join();
+            }
+        }
+    }
+}
+
+void ThumbnailBatch::Start(ThreadHook threadInit, Task task, FinishHook finish) {
+    threadInit_ = std::move(threadInit);
+    task_ = std::move(task);
+    finish_ = std::move(finish);
+
+    if (workers_.empty()) {
+        if (finish_) {
+            finish_(false);
+        }
+        return;
+    }
+
+    running_ = workers_.size();
+    for (size_t i = 0; i < workers_.size(); i++) {
+        threads_.emplace_back(&ThumbnailBatch::Run, this, i);
+    }
+}
+
+void ThumbnailBatch::Cancel() {
+    cancelled_.store(true, std::memory_order_relaxed);
+}
+
+void ThumbnailBatch::Join() {
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void ThumbnailBatch::Run(size_t self) {
+    if (threadInit_) {
+        threadInit_();
+    }
+
+    size_t index;
+    while (!IsCancelled() && Take(self, index)) {
+        task_(index);
+    }
+
+    // 最后一个退出的线程负责通知完成
+    if (running_.fetch_sub(1, std::memory_order_acq_rel) == 1 && finish_) {
+        finish_(IsCancelled());
+    }
+}
+
+// 先取自己队列的头部，空了再从其他队列尾部窃取；任务不会再增加，全部为空即可退出
+bool ThumbnailBatch::Take(size_t self, size_t& index) {
+    {
+        Worker& own = *workers_[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.queue.empty()) {
+            index = own.queue.front();
+            own.queue.pop_front();
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < workers_.size(); offset++) {
+        Worker& victim = *workers_[(self + offset) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.queue.empty()) {
+            index = victim.queue.back();
+            victim.queue.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,56 @@
+#ifndef THUMBNAIL_POOL_H
+#define THUMBNAIL_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 一次批量提取：count 个任务由最多 concurrency 个线程并行处理。
+// 每个线程先领取一段连续下标，做完自己的部分后从其他线程队列尾部窃取，
+// 单个慢文件（网络盘、大型安装包）不会拖住整批。
+// threadInit 在每个工作线程开始时调用一次，用于初始化 COM/GDI+ 等线程相关的后端
+class ThumbnailBatch {
+public:
+    using ThreadHook = std::function<void()>;
+    using Task = std::function<void(size_t index)>;
+    // cancelled 为 true 时部分任务未执行
+    using FinishHook = std::function<void(bool cancelled)>;
+
+    ThumbnailBatch(size_t count, size_t concurrency);
+    ~ThumbnailBatch();
+    ThumbnailBatch(const ThumbnailBatch&) = delete;
+    ThumbnailBatch& operator=(const ThumbnailBatch&) = delete;
+
+    // finish 由最后退出的工作线程调用一次；count 为 0 时在调用线程上立即调用
+    void Start(ThreadHook threadInit, Task task, FinishHook finish);
+    // 已开始的任务会完成，尚未开始的任务被跳过
+    void Cancel();
+    bool IsCancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+    // 等待所有工作线程退出，不能在工作线程（包括 finish 回调）中调用
+    void Join();
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<size_t> queue;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> cancelled_{ false };
+    std::atomic<size_t> running_{ 0 };
+
+    ThreadHook threadInit_;
+    Task task_;
+    FinishHook finish_;
+
+    void Run(size_t self);
+    bool Take(size_t self, size_t& index);
+};
+
+#endif
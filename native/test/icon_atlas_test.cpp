@@ -0,0 +1,248 @@
+// 图标图集测试：在小页面上随机添加、替换（更小/更大）和移除图标，触发空闲槽位复用、重排和多页，
+// 每一步检查同页槽位互不重叠、槽位在页内且包含图标区域，并定期检查每个图标的像素和留白
+// 与源图一致（重叠或错位的绘制会覆盖其他图标）；另外检查原位替换只弄脏所在页、
+// 二进制索引与 Find 一致，以及超出页面的图标被拒绝。
+// 构建：node-gyp rebuild --build_tests=1，运行 build/Release/icon_atlas_test
+
+#include "../src/icon_atlas.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int kPageSize = 256;
+const int kPadding = 2;
+
+// 每个像素都不同的噪声图，任何错位或覆盖都能发现
+BgraImage MakeIcon(int width, int height, std::mt19937& rng) {
+    BgraImage image;
+    image.Allocate(width, height);
+    for (uint8_t& value : image.pixels) {
+        value = static_cast<uint8_t>(rng());
+    }
+    return image;
+}
+
+bool Overlaps(const AtlasRect& a, const AtlasRect& b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+// 布局不变量：槽位在页内且两两不重叠，图标区域为槽位内缩 padding 后的左上部分
+bool CheckLayout(const IconAtlas& atlas, const std::map<std::string, BgraImage>& icons, const char* step) {
+    int failures = g_failures;
+    CHECK(atlas.EntryCount() == icons.size(), "%s: %zu entries, expected %zu", step, atlas.EntryCount(),
+          icons.size());
+
+    std::vector<std::pair<const std::string*, const AtlasEntry*>> placed;
+    for (const auto& icon : icons) {
+        const AtlasEntry* entry = atlas.Find(icon.first);
+        CHECK(entry, "%s: %s missing", step, icon.first.c_str());
+        if (!entry) {
+            continue;
+        }
+        placed.push_back({ &icon.first, entry });
+        const AtlasRect& slot = entry->slot;
+        bool inPage = entry->page >= 0 && static_cast<size_t>(entry->page) < atlas.PageCount() && slot.x >= 0 &&
+                      slot.y >= 0 && slot.x + slot.width <= kPageSize &&
+                      slot.y + slot.height <= atlas.PageImage(entry->page).height;
+        CHECK(inPage, "%s: %s slot (%d,%d %dx%d) outside page %d", step, icon.first.c_str(), slot.x, slot.y,
+              slot.width, slot.height, entry->page);
+        bool inSlot = entry->width == icon.second.width && entry->height == icon.second.height &&
+                      entry->x == slot.x + kPadding && entry->y == slot.y + kPadding &&
+                      entry->width + kPadding * 2 <= slot.width && entry->height + kPadding * 2 <= slot.height;
+        CHECK(inSlot, "%s: %s rect (%d,%d %dx%d) not inside slot (%d,%d %dx%d)", step, icon.first.c_str(),
+              entry->x, entry->y, entry->width, entry->height, slot.x, slot.y, slot.width, slot.height);
+    }
+
+    for (size_t i = 0; i < placed.size(); i++) {
+        for (size_t j = i + 1; j < placed.size(); j++) {
+            const AtlasEntry& a = *placed[i].second;
+            const AtlasEntry& b = *placed[j].second;
+            CHECK(a.page != b.page || !Overlaps(a.slot, b.slot), "%s: %s and %s overlap on page %d", step,
+                  placed[i].first->c_str(), placed[j].first->c_str(), a.page);
+        }
+    }
+    return failures == g_failures;
+}
+
+// 图标像素与源图一致，留白为最近的边缘像素
+void CheckPixels(const IconAtlas& atlas, const std::map<std::string, BgraImage>& icons, const char* step) {
+    for (const auto& icon : icons) {
+        const AtlasEntry* entry = atlas.Find(icon.first);
+        if (!entry) {
+            continue;
+        }
+        const BgraImage& page = atlas.PageImage(entry->page);
+        const BgraImage& image = icon.second;
+        bool same = true;
+        for (int y = -kPadding; y < image.height + kPadding && same; y++) {
+            for (int x = -kPadding; x < image.width + kPadding && same; x++) {
+                int sourceX = std::max(0, std::min(x, image.width - 1));
+                int sourceY = std::max(0, std::min(y, image.height - 1));
+                const uint8_t* expected = image.Row(sourceY) + sourceX * 4;
+                const uint8_t* actual = page.Row(entry->y + y) + (entry->x + x) * 4;
+                same = memcmp(expected, actual, 4) == 0;
+            }
+        }
+        CHECK(same, "%s: pixels of %s differ", step, icon.first.c_str());
+    }
+}
+
+uint32_t ReadLe16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+uint32_t ReadLe32(const uint8_t* p) {
+    return ReadLe16(p) | (ReadLe16(p + 2) << 16);
+}
+
+void CheckIndex(const IconAtlas& atlas, const std::map<std::string, BgraImage>& icons) {
+    std::vector<uint8_t> index;
+    atlas.BuildIndex(index);
+    size_t count = icons.size();
+    size_t pages = atlas.PageCount();
+    size_t entriesStart = 16 + pages * 4;
+    bool valid = index.size() >= entriesStart + count * 16 && memcmp(index.data(), "ATLS", 4) == 0 &&
+                 ReadLe16(&index[4]) == 1 && ReadLe16(&index[6]) == pages && ReadLe32(&index[8]) == count;
+    CHECK(valid, "index header");
+    if (!valid) {
+        return;
+    }
+    size_t idsStart = entriesStart + count * 16;
+    CHECK(index.size() == idsStart + ReadLe32(&index[12]), "index size %zu", index.size());
+    for (size_t p = 0; p < pages; p++) {
+        CHECK(ReadLe16(&index[16 + p * 4]) == static_cast<uint32_t>(atlas.PageImage(p).width) &&
+              ReadLe16(&index[18 + p * 4]) == static_cast<uint32_t>(atlas.PageImage(p).height),
+              "index page %zu size", p);
+    }
+
+    // 条目按 id 排序，与 std::map 的遍历顺序相同
+    size_t i = 0;
+    for (const auto& icon : icons) {
+        const uint8_t* record = &index[entriesStart + i * 16];
+        const AtlasEntry* entry = atlas.Find(icon.first);
+        uint32_t length = ReadLe16(record + 10);
+        uint32_t offset = ReadLe32(record + 12);
+        bool same = entry && ReadLe16(record) == static_cast<uint32_t>(entry->page) &&
+                    ReadLe16(record + 2) == static_cast<uint32_t>(entry->x) &&
+                    ReadLe16(record + 4) == static_cast<uint32_t>(entry->y) &&
+                    ReadLe16(record + 6) == static_cast<uint32_t>(entry->width) &&
+                    ReadLe16(record + 8) == static_cast<uint32_t>(entry->height) &&
+                    idsStart + offset + length <= index.size() &&
+                    std::string(reinterpret_cast<const char*>(&index[idsStart + offset]), length) == icon.first;
+        CHECK(same, "index entry %zu (%s)", i, icon.first.c_str());
+        i++;
+    }
+}
+
+void TestRandomOperations() {
+    IconAtlas atlas(kPageSize, kPadding);
+    std::map<std::string, BgraImage> icons;
+    std::mt19937 rng(13);
+    size_t maxPages = 0;
+
+    for (int step = 0; step < 4000; step++) {
+        std::string id = "icon-" + std::to_string(rng() % 150);
+        unsigned action = rng() % 100;
+        char label[64];
+        if (action < 30 && icons.count(id)) {
+            snprintf(label, sizeof(label), "step %d remove %s", step, id.c_str());
+            CHECK(atlas.Remove(id), "%s", label);
+            icons.erase(id);
+        } else {
+            // 大多为常见图标尺寸，偶尔出现接近整页的大图标
+            int width = action < 95 ? 4 + static_cast<int>(rng() % 60) : 100 + static_cast<int>(rng() % 150);
+            int height = action < 95 ? 4 + static_cast<int>(rng() % 60) : 100 + static_cast<int>(rng() % 150);
+            snprintf(label, sizeof(label), "step %d set %s %dx%d", step, id.c_str(), width, height);
+            BgraImage image = MakeIcon(width, height, rng);
+            CHECK(atlas.Set(id, image), "%s", label);
+            icons[id] = std::move(image);
+        }
+        maxPages = std::max(maxPages, atlas.PageCount());
+
+        if (!CheckLayout(atlas, icons, label)) {
+            return;
+        }
+        if (step % 50 == 0) {
+            CheckPixels(atlas, icons, label);
+        }
+    }
+    CheckPixels(atlas, icons, "final");
+    CheckIndex(atlas, icons);
+    std::printf("random operations: %zu icons on %zu pages (at most %zu)\n", icons.size(), atlas.PageCount(),
+                maxPages);
+
+    // 全部移除后不留页面
+    for (const auto& icon : icons) {
+        atlas.Remove(icon.first);
+    }
+    CHECK(atlas.PageCount() == 0 && atlas.EntryCount() == 0, "%zu pages left", atlas.PageCount());
+}
+
+void TestDirtyPages() {
+    IconAtlas atlas(kPageSize, kPadding);
+    std::map<std::string, BgraImage> icons;
+    std::mt19937 rng(29);
+    for (int i = 0; i < 60; i++) {
+        std::string id = "icon-" + std::to_string(i);
+        icons[id] = MakeIcon(40, 40, rng);
+        atlas.Set(id, icons[id]);
+    }
+    CHECK(atlas.PageCount() >= 2, "expected several pages, got %zu", atlas.PageCount());
+    atlas.MarkClean();
+
+    // 不大于原槽位的替换原位进行，其他图标位置不变，只有所在页变脏
+    const AtlasEntry before = *atlas.Find("icon-42");
+    std::map<std::string, AtlasEntry> others;
+    for (const auto& icon : icons) {
+        others[icon.first] = *atlas.Find(icon.first);
+    }
+    icons["icon-42"] = MakeIcon(30, 35, rng);
+    CHECK(atlas.Set("icon-42", icons["icon-42"]), "replace smaller");
+    const AtlasEntry* after = atlas.Find("icon-42");
+    CHECK(after->page == before.page && after->x == before.x && after->y == before.y &&
+          after->slot.width == before.slot.width, "in-place replacement moved the icon");
+    for (size_t p = 0; p < atlas.PageCount(); p++) {
+        CHECK(atlas.IsPageDirty(p) == (static_cast<int>(p) == before.page), "page %zu dirty flag", p);
+    }
+    for (const auto& item : others) {
+        const AtlasEntry* entry = atlas.Find(item.first);
+        CHECK(item.first == "icon-42" || (entry->page == item.second.page && entry->x == item.second.x &&
+                                          entry->y == item.second.y), "%s moved", item.first.c_str());
+    }
+    CheckLayout(atlas, icons, "dirty");
+    CheckPixels(atlas, icons, "dirty");
+}
+
+void TestRejects() {
+    IconAtlas atlas(kPageSize, kPadding);
+    std::mt19937 rng(31);
+    CHECK(!atlas.Set("big", MakeIcon(kPageSize - kPadding * 2 + 1, 10, rng)), "oversized icon accepted");
+    CHECK(atlas.Set("fits", MakeIcon(kPageSize - kPadding * 2, kPageSize - kPadding * 2, rng)), "full page icon");
+    BgraImage empty;
+    CHECK(!atlas.Set("empty", empty), "empty icon accepted");
+    CHECK(!atlas.Remove("missing"), "removed missing icon");
+    CHECK(atlas.EntryCount() == 1 && atlas.PageCount() == 1, "unexpected entries after rejects");
+}
+
+} // namespace
+
+int main() {
+    TestRandomOperations();
+    TestDirtyPages();
+    TestRejects();
+
+    if (g_failures > 0) {
+        std::printf("%d failure(s)\n", g_failures);
+        return 1;
+    }
+    std::printf("icon_atlas_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,388 @@
+// PE/ICO 图标解析测试：在内存中构造 .ico 和最小的 PE32+ 镜像（.rsrc 中的 RT_GROUP_ICON + RT_ICON），
+// 候选覆盖 32 位带 alpha、24 位和 8 位调色板 DIB（AND 掩码）以及目录尺寸不可信的 PNG，
+// 检查候选列表、SelectBest 的选择和解码结果逐位一致；再对截断和随机损坏的文件反复打开解码，
+// 配合 -fsanitize=address 检查越界读取。
+// 构建：node-gyp rebuild --build_tests=1，运行 build/Release/icon_extractor_test
+
+#include "../src/icon_extractor.h"
+#include "../src/png_encoder.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 测试文件写在当前目录，结束时删除
+const char* const kTempPath = "icon_extractor_test.tmp";
+
+void AppendLe16(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void AppendLe32(std::vector<uint8_t>& out, uint32_t value) {
+    AppendLe16(out, value & 0xffff);
+    AppendLe16(out, value >> 16);
+}
+
+void PutLe16(std::vector<uint8_t>& out, size_t offset, uint32_t value) {
+    out[offset] = static_cast<uint8_t>(value);
+    out[offset + 1] = static_cast<uint8_t>(value >> 8);
+}
+
+void PutLe32(std::vector<uint8_t>& out, size_t offset, uint32_t value) {
+    PutLe16(out, offset, value & 0xffff);
+    PutLe16(out, offset + 2, value >> 16);
+}
+
+bool WriteFile(const std::vector<uint8_t>& data) {
+    FILE* file = std::fopen(kTempPath, "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = data.empty() || std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+// 一个图标候选：目录中的宽高和色深，以及图像数据（DIB 或 PNG）
+struct Payload {
+    int width;
+    int height;
+    int bitCount;
+    std::vector<uint8_t> data;
+};
+
+// BITMAPINFOHEADER + 调色板 + 自下而上的 XOR 位图 + AND 掩码（alpha 为 0 处置位），高度字段为两者之和。
+// 8 位时 image 的颜色必须都在 palette（BGRX）中
+std::vector<uint8_t> MakeDib(const BgraImage& image, int bitCount, const std::vector<uint32_t>& palette) {
+    std::vector<uint8_t> dib;
+    AppendLe32(dib, 40);
+    AppendLe32(dib, static_cast<uint32_t>(image.width));
+    AppendLe32(dib, static_cast<uint32_t>(image.height * 2));
+    AppendLe16(dib, 1);
+    AppendLe16(dib, static_cast<uint32_t>(bitCount));
+    for (int i = 0; i < 6; i++) {
+        AppendLe32(dib, i == 4 ? static_cast<uint32_t>(palette.size()) : 0);
+    }
+    for (uint32_t color : palette) {
+        AppendLe32(dib, color);
+    }
+
+    size_t xorStride = ((static_cast<size_t>(image.width) * bitCount + 31) / 32) * 4;
+    size_t andStride = ((static_cast<size_t>(image.width) + 31) / 32) * 4;
+    for (int y = image.height - 1; y >= 0; y--) {
+        std::vector<uint8_t> row(xorStride, 0);
+        const uint8_t* src = image.Row(y);
+        for (int x = 0; x < image.width; x++) {
+            const uint8_t* p = src + x * 4;
+            if (bitCount == 32) {
+                std::copy(p, p + 4, row.begin() + x * 4);
+            } else if (bitCount == 24) {
+                std::copy(p, p + 3, row.begin() + x * 3);
+            } else {
+                uint32_t color = p[0] | (p[1] << 8) | (p[2] << 16);
+                for (size_t i = 0; i < palette.size(); i++) {
+                    if (palette[i] == color) {
+                        row[x] = static_cast<uint8_t>(i);
+                    }
+                }
+            }
+        }
+        dib.insert(dib.end(), row.begin(), row.end());
+    }
+    for (int y = image.height - 1; y >= 0; y--) {
+        std::vector<uint8_t> row(andStride, 0);
+        for (int x = 0; x < image.width; x++) {
+            if (image.Row(y)[x * 4 + 3] == 0) {
+                row[x / 8] |= static_cast<uint8_t>(0x80 >> (x % 8));
+            }
+        }
+        dib.insert(dib.end(), row.begin(), row.end());
+    }
+    return dib;
+}
+
+// 32 位：每个像素独立的 alpha；24 位和 8 位：alpha 只有 0 和 255，由 AND 掩码表示
+void MakeImages(std::vector<BgraImage>& images, std::vector<Payload>& payloads) {
+    BgraImage alpha;
+    alpha.Allocate(32, 32);
+    for (int y = 0; y < 32; y++) {
+        for (int x = 0; x < 32; x++) {
+            uint8_t* p = alpha.Row(y) + x * 4;
+            p[0] = static_cast<uint8_t>(x * 8);
+            p[1] = static_cast<uint8_t>(y * 8);
+            p[2] = static_cast<uint8_t>(x ^ y);
+            p[3] = static_cast<uint8_t>((x + y) * 4);
+        }
+    }
+
+    BgraImage masked;
+    masked.Allocate(20, 20);
+    for (int y = 0; y < 20; y++) {
+        for (int x = 0; x < 20; x++) {
+            uint8_t* p = masked.Row(y) + x * 4;
+            p[0] = static_cast<uint8_t>(x * 12);
+            p[1] = static_cast<uint8_t>(200 - y * 5);
+            p[2] = 77;
+            p[3] = ((x / 4 + y / 4) & 1) ? 255 : 0;
+        }
+    }
+
+    const std::vector<uint32_t> palette = { 0x000000, 0xff0000, 0x00ff00, 0x123456 };
+    BgraImage paletted;
+    paletted.Allocate(16, 16);
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 16; x++) {
+            uint32_t color = palette[(x + y) % 4];
+            uint8_t* p = paletted.Row(y) + x * 4;
+            p[0] = static_cast<uint8_t>(color);
+            p[1] = static_cast<uint8_t>(color >> 8);
+            p[2] = static_cast<uint8_t>(color >> 16);
+            p[3] = x < 4 ? 0 : 255;
+        }
+    }
+
+    BgraImage large;
+    large.Allocate(48, 48);
+    for (int y = 0; y < 48; y++) {
+        for (int x = 0; x < 48; x++) {
+            uint8_t* p = large.Row(y) + x * 4;
+            p[0] = static_cast<uint8_t>(x * 5);
+            p[1] = static_cast<uint8_t>(y * 5);
+            p[2] = static_cast<uint8_t>(255 - x - y);
+            p[3] = static_cast<uint8_t>(x * y % 256);
+        }
+    }
+
+    images = { alpha, masked, paletted, large };
+    payloads.clear();
+    payloads.push_back({ 32, 32, 32, MakeDib(alpha, 32, {}) });
+    payloads.push_back({ 20, 20, 24, MakeDib(masked, 24, {}) });
+    payloads.push_back({ 16, 16, 8, MakeDib(paletted, 8, palette) });
+    // 目录中写 0（即 256），真实尺寸以 IHDR 为准
+    std::vector<uint8_t> png;
+    EncodePng(large, PngLevel::Fast, png);
+    payloads.push_back({ 0, 0, 32, png });
+}
+
+// ICONDIR + ICONDIRENTRY[]，图像依次排在目录之后
+std::vector<uint8_t> MakeIco(const std::vector<Payload>& payloads) {
+    std::vector<uint8_t> ico;
+    AppendLe16(ico, 0);
+    AppendLe16(ico, 1);
+    AppendLe16(ico, static_cast<uint32_t>(payloads.size()));
+    uint32_t offset = static_cast<uint32_t>(6 + payloads.size() * 16);
+    for (const auto& payload : payloads) {
+        ico.push_back(static_cast<uint8_t>(payload.width));
+        ico.push_back(static_cast<uint8_t>(payload.height));
+        ico.push_back(0);
+        ico.push_back(0);
+        AppendLe16(ico, 1);
+        AppendLe16(ico, static_cast<uint32_t>(payload.bitCount));
+        AppendLe32(ico, static_cast<uint32_t>(payload.data.size()));
+        AppendLe32(ico, offset);
+        offset += static_cast<uint32_t>(payload.data.size());
+    }
+    for (const auto& payload : payloads) {
+        ico.insert(ico.end(), payload.data.begin(), payload.data.end());
+    }
+    return ico;
+}
+
+// IMAGE_RESOURCE_DIRECTORY，条目全部为数字 ID
+void WriteResourceDirectory(std::vector<uint8_t>& section, size_t offset,
+                            const std::vector<std::pair<uint32_t, uint32_t>>& entries) {
+    PutLe16(section, offset + 14, static_cast<uint32_t>(entries.size()));
+    for (size_t i = 0; i < entries.size(); i++) {
+        PutLe32(section, offset + 16 + i * 8, entries[i].first);
+        PutLe32(section, offset + 20 + i * 8, entries[i].second);
+    }
+}
+
+// 最小的 PE32+ 镜像：DOS 头、COFF 头、带 16 个数据目录的可选头和唯一的 .rsrc 节。
+// 资源树为 类型 / ID / 语言 三层，RT_GROUP_ICON 1 按 ID 1..n 引用各个 RT_ICON
+std::vector<uint8_t> MakePe(const std::vector<Payload>& payloads) {
+    const uint32_t kSectionRva = 0x1000;
+    const uint32_t kSectionOffset = 0x200;
+    const uint32_t kSubdirectory = 0x80000000u;
+    uint32_t count = static_cast<uint32_t>(payloads.size());
+
+    // 各部分相对节起点的偏移
+    uint32_t iconTypes = 16 + 2 * 8;
+    uint32_t groupTypes = iconTypes + 16 + count * 8;
+    uint32_t languages = groupTypes + 16 + 8;      // count + 1 个语言目录，各 24 字节
+    uint32_t dataEntries = languages + (count + 1) * 24;
+    uint32_t groupData = dataEntries + (count + 1) * 16;
+    uint32_t payloadOffset = (groupData + 6 + count * 14 + 3) & ~3u;
+
+    std::vector<uint8_t> section(payloadOffset, 0);
+    WriteResourceDirectory(section, 0, { { 3, iconTypes | kSubdirectory }, { 14, groupTypes | kSubdirectory } });
+    std::vector<std::pair<uint32_t, uint32_t>> icons;
+    for (uint32_t i = 0; i < count; i++) {
+        icons.push_back({ i + 1, (languages + i * 24) | kSubdirectory });
+    }
+    WriteResourceDirectory(section, iconTypes, icons);
+    WriteResourceDirectory(section, groupTypes, { { 1, (languages + count * 24) | kSubdirectory } });
+    for (uint32_t i = 0; i <= count; i++) {
+        WriteResourceDirectory(section, languages + i * 24, { { 0x409, dataEntries + i * 16 } });
+    }
+
+    PutLe16(section, groupData + 2, 1);
+    PutLe16(section, groupData + 4, count);
+    for (uint32_t i = 0; i < count; i++) {
+        const Payload& payload = payloads[i];
+        size_t entry = groupData + 6 + i * 14;
+        section[entry] = static_cast<uint8_t>(payload.width);
+        section[entry + 1] = static_cast<uint8_t>(payload.height);
+        PutLe16(section, entry + 4, 1);
+        PutLe16(section, entry + 6, static_cast<uint32_t>(payload.bitCount));
+        PutLe32(section, entry + 8, static_cast<uint32_t>(payload.data.size()));
+        PutLe16(section, entry + 12, i + 1);
+
+        PutLe32(section, dataEntries + i * 16, kSectionRva + static_cast<uint32_t>(section.size()));
+        PutLe32(section, dataEntries + i * 16 + 4, static_cast<uint32_t>(payload.data.size()));
+        section.insert(section.end(), payload.data.begin(), payload.data.end());
+        section.resize((section.size() + 3) & ~static_cast<size_t>(3), 0);
+    }
+    PutLe32(section, dataEntries + count * 16, kSectionRva + groupData);
+    PutLe32(section, dataEntries + count * 16 + 4, 6 + count * 14);
+
+    std::vector<uint8_t> pe(kSectionOffset, 0);
+    pe[0] = 'M';
+    pe[1] = 'Z';
+    PutLe32(pe, 0x3c, 0x40);
+    pe[0x40] = 'P';
+    pe[0x41] = 'E';
+    size_t coff = 0x44;
+    PutLe16(pe, coff, 0x8664);
+    PutLe16(pe, coff + 2, 1);
+    PutLe16(pe, coff + 16, 112 + 16 * 8);
+    PutLe16(pe, coff + 18, 0x22);
+    size_t optional = coff + 20;
+    PutLe16(pe, optional, 0x20b);
+    PutLe32(pe, optional + 108, 16);
+    PutLe32(pe, optional + 112 + 2 * 8, kSectionRva);
+    PutLe32(pe, optional + 112 + 2 * 8 + 4, static_cast<uint32_t>(section.size()));
+    size_t table = optional + 112 + 16 * 8;
+    std::copy_n(".rsrc", 5, pe.begin() + table);
+    PutLe32(pe, table + 8, static_cast<uint32_t>(section.size()));
+    PutLe32(pe, table + 12, kSectionRva);
+    PutLe32(pe, table + 16, static_cast<uint32_t>(section.size()));
+    PutLe32(pe, table + 20, kSectionOffset);
+
+    pe.insert(pe.end(), section.begin(), section.end());
+    return pe;
+}
+
+// 打开 data 并检查候选、SelectBest 和解码结果
+void CheckContainer(const char* name, const std::vector<uint8_t>& data, const std::vector<BgraImage>& images) {
+    IconFile file;
+    bool opened = WriteFile(data) && file.Open(kTempPath);
+    CHECK(opened, "%s: open", name);
+    if (!opened) {
+        return;
+    }
+
+    const std::vector<IconEntry>& entries = file.Entries();
+    CHECK(entries.size() == images.size(), "%s: %zu entries", name, entries.size());
+    if (entries.size() != images.size()) {
+        return;
+    }
+    const int bitCounts[] = { 32, 24, 8, 32 };
+    for (size_t i = 0; i < entries.size(); i++) {
+        const IconEntry& entry = entries[i];
+        CHECK(entry.width == images[i].width && entry.height == images[i].height, "%s: entry %zu is %dx%d",
+              name, i, entry.width, entry.height);
+        CHECK(entry.bitCount == bitCounts[i], "%s: entry %zu bitCount %d", name, i, entry.bitCount);
+        CHECK(entry.png == (i == 3), "%s: entry %zu png flag", name, i);
+
+        BgraImage decoded;
+        bool same = DecodeIconEntry(entry, decoded) && decoded.width == images[i].width &&
+                    decoded.height == images[i].height && decoded.pixels == images[i].pixels;
+        CHECK(same, "%s: entry %zu decode", name, i);
+    }
+
+    // 不小于请求的最小候选，都不够大时取最大的
+    const int requests[][2] = { { 1, 16 }, { 16, 16 }, { 17, 20 }, { 20, 20 }, { 21, 32 },
+                                { 32, 32 }, { 33, 48 }, { 48, 48 }, { 256, 48 } };
+    for (const auto& request : requests) {
+        const IconEntry* best = file.SelectBest(request[0]);
+        CHECK(best && best->width == request[1], "%s: SelectBest(%d) = %d, expected %d", name, request[0],
+              best ? best->width : 0, request[1]);
+    }
+}
+
+// 每个前缀以及随机改写若干字节后都不能越界；能打开时解码所有候选
+void CheckDamaged(const char* name, const std::vector<uint8_t>& data) {
+    std::mt19937 rng(5);
+    size_t step = data.size() / 300 + 1;
+    for (size_t length = 0; length < data.size(); length += step) {
+        std::vector<uint8_t> truncated(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(length));
+        IconFile file;
+        if (WriteFile(truncated) && file.Open(kTempPath)) {
+            for (const auto& entry : file.Entries()) {
+                BgraImage image;
+                DecodeIconEntry(entry, image);
+            }
+        }
+    }
+
+    // 改写集中在目录和头部，payload 内部的损坏只影响像素值
+    size_t header = std::min<size_t>(data.size(), 0x300);
+    for (int round = 0; round < 300; round++) {
+        std::vector<uint8_t> damaged = data;
+        for (int i = 0; i < 4; i++) {
+            damaged[rng() % header] = static_cast<uint8_t>(rng());
+        }
+        IconFile file;
+        if (WriteFile(damaged) && file.Open(kTempPath)) {
+            for (const auto& entry : file.Entries()) {
+                BgraImage image;
+                DecodeIconEntry(entry, image);
+            }
+        }
+    }
+    std::printf("%s: damaged inputs done\n", name);
+}
+
+void TestRejects() {
+    IconFile file;
+    CHECK(!file.Open("icon_extractor_test.missing"), "missing file opened");
+    CHECK(WriteFile({}) && !file.Open(kTempPath), "empty file opened");
+    std::vector<uint8_t> text = { 'h', 'e', 'l', 'l', 'o', '\n' };
+    CHECK(WriteFile(text) && !file.Open(kTempPath), "text file opened");
+
+    CHECK(IsIconContainerPath("C:/Games/Game.EXE"), ".EXE not recognized");
+    CHECK(IsIconContainerPath("shell32.dll"), ".dll not recognized");
+    CHECK(IsIconContainerPath("app.ico"), ".ico not recognized");
+    CHECK(!IsIconContainerPath("image.png"), ".png recognized");
+    CHECK(!IsIconContainerPath("exe"), "bare name recognized");
+}
+
+} // namespace
+
+int main() {
+    std::vector<BgraImage> images;
+    std::vector<Payload> payloads;
+    MakeImages(images, payloads);
+    std::vector<uint8_t> ico = MakeIco(payloads);
+    std::vector<uint8_t> pe = MakePe(payloads);
+
+    CheckContainer("ico", ico, images);
+    CheckContainer("pe", pe, images);
+    CheckDamaged("ico", ico);
+    CheckDamaged("pe", pe);
+    TestRejects();
+    std::remove(kTempPath);
+
+    if (g_failures > 0) {
+        std::printf("%d failure(s)\n", g_failures);
+        return 1;
+    }
+    std::printf("icon_extractor_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,277 @@
+// QOI 与原始 RGBA 格式测试：
+// - QOI 编码结果交给按规范（qoiformat.org）独立实现的参考解码器，与源像素逐位一致，
+//   覆盖长游程、索引命中、DIFF/LUMA 和 alpha 变化；手写的数据流覆盖每种操作码和 3 通道文件
+// - 截断的 QOI 必须被拒绝，随机数据不能越界（配合 -fsanitize=address）
+// - 原始 RGBA 的头部布局、预乘公式和还原误差
+// - DecodeThumbnail 按数据头分派，以及格式名和扩展名的解析
+// 构建：node-gyp rebuild --build_tests=1，运行 build/Release/image_formats_test
+
+#include "../src/image_formats.h"
+#include "../src/png_encoder.h"
+#include "test_util.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace {
+
+// 按规范逐字实现的 QOI 解码器，输出 BGRA，不做任何快速路径
+bool ReferenceDecodeQoi(const std::vector<uint8_t>& data, BgraImage& image) {
+    if (data.size() < 22 || memcmp(data.data(), "qoif", 4) != 0) {
+        return false;
+    }
+    auto be32 = [&data](size_t offset) {
+        return (static_cast<uint32_t>(data[offset]) << 24) | (data[offset + 1] << 16) | (data[offset + 2] << 8) |
+               data[offset + 3];
+    };
+    int width = static_cast<int>(be32(4));
+    int height = static_cast<int>(be32(8));
+    image.Allocate(width, height);
+
+    uint8_t index[64][4] = {};
+    uint8_t px[4] = { 0, 0, 0, 255 }; // r g b a
+    size_t pos = 14;
+    size_t chunksEnd = data.size() - 8;
+    int run = 0;
+    for (size_t i = 0; i < image.pixels.size(); i += 4) {
+        if (run > 0) {
+            run--;
+        } else if (pos < chunksEnd) {
+            uint8_t b1 = data[pos++];
+            if (b1 == 0xfe) {
+                px[0] = data[pos++];
+                px[1] = data[pos++];
+                px[2] = data[pos++];
+            } else if (b1 == 0xff) {
+                px[0] = data[pos++];
+                px[1] = data[pos++];
+                px[2] = data[pos++];
+                px[3] = data[pos++];
+            } else if ((b1 & 0xc0) == 0x00) {
+                memcpy(px, index[b1], 4);
+            } else if ((b1 & 0xc0) == 0x40) {
+                px[0] = static_cast<uint8_t>(px[0] + ((b1 >> 4) & 3) - 2);
+                px[1] = static_cast<uint8_t>(px[1] + ((b1 >> 2) & 3) - 2);
+                px[2] = static_cast<uint8_t>(px[2] + (b1 & 3) - 2);
+            } else if ((b1 & 0xc0) == 0x80) {
+                uint8_t b2 = data[pos++];
+                int vg = (b1 & 0x3f) - 32;
+                px[0] = static_cast<uint8_t>(px[0] + vg - 8 + ((b2 >> 4) & 0x0f));
+                px[1] = static_cast<uint8_t>(px[1] + vg);
+                px[2] = static_cast<uint8_t>(px[2] + vg - 8 + (b2 & 0x0f));
+            } else {
+                run = b1 & 0x3f;
+            }
+            memcpy(index[(px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64], px, 4);
+        } else {
+            return false;
+        }
+        image.pixels[i] = px[2];
+        image.pixels[i + 1] = px[1];
+        image.pixels[i + 2] = px[0];
+        image.pixels[i + 3] = px[3];
+    }
+    return pos == chunksEnd && memcmp(data.data() + chunksEnd, "\0\0\0\0\0\0\0\1", 8) == 0;
+}
+
+void TestQoiRoundTrip() {
+    const int sizes[][2] = { { 1, 1 }, { 1, 9 }, { 9, 1 }, { 7, 5 }, { 64, 64 }, { 100, 37 }, { 256, 3 } };
+    const Pattern patterns[] = { Pattern::Noise, Pattern::Smooth, Pattern::Runs, Pattern::Palette,
+                                 Pattern::AlphaSteps };
+    std::mt19937 rng(3);
+
+    for (const auto& size : sizes) {
+        for (Pattern pattern : patterns) {
+            BgraImage image = MakeImage(size[0], size[1], pattern, rng);
+            std::vector<uint8_t> encoded;
+            bool encodedOk = EncodeQoi(image, encoded) && IsQoiData(encoded.data(), encoded.size());
+            CHECK(encodedOk, "encode %dx%d %s", size[0], size[1], PatternName(pattern));
+            if (!encodedOk) {
+                continue;
+            }
+            CHECK(encoded[12] == 4 && encoded[13] == 0, "%dx%d %s: channels %d colorspace %d", size[0], size[1],
+                  PatternName(pattern), encoded[12], encoded[13]);
+
+            BgraImage reference;
+            bool conforms = ReferenceDecodeQoi(encoded, reference) && reference.pixels == image.pixels;
+            CHECK(conforms, "reference decode %dx%d %s", size[0], size[1], PatternName(pattern));
+
+            BgraImage decoded;
+            bool same = DecodeQoi(encoded.data(), encoded.size(), decoded) && decoded.width == image.width &&
+                        decoded.height == image.height && decoded.pixels == image.pixels;
+            CHECK(same, "round trip %dx%d %s", size[0], size[1], PatternName(pattern));
+
+            // 每个数据块至少产生一个像素，任何截断都会缺少像素
+            size_t step = encoded.size() / 64 + 1;
+            for (size_t length = 0; length < encoded.size(); length += step) {
+                BgraImage truncated;
+                CHECK(!DecodeQoi(encoded.data(), length, truncated), "%dx%d %s: accepted %zu of %zu bytes",
+                      size[0], size[1], PatternName(pattern), length, encoded.size());
+            }
+        }
+    }
+}
+
+// 手写的 2x3、3 通道数据流：RGB、DIFF、LUMA、INDEX、RUN 各一次
+void TestQoiOpcodes() {
+    std::vector<uint8_t> data = { 'q', 'o', 'i', 'f', 0, 0, 0, 2, 0, 0, 0, 3, 3, 0 };
+    const uint8_t chunks[] = {
+        0xfe, 10, 20, 30,      // RGB (10, 20, 30)
+        0x40 | 3 << 4 | 1 << 2 | 2, // DIFF dr=+1 dg=-1 db=0 -> (11, 19, 30)
+        0x80 | 40, 0x9b,       // LUMA dg=+8 dr-dg=+1 db-dg=+3 -> (20, 27, 41)
+        0x00 | ((10 * 3 + 20 * 5 + 30 * 7 + 255 * 11) % 64), // INDEX -> (10, 20, 30)
+        0xc0 | 1,              // RUN 2
+    };
+    data.insert(data.end(), std::begin(chunks), std::end(chunks));
+    data.insert(data.end(), { 0, 0, 0, 0, 0, 0, 0, 1 });
+
+    const uint8_t expected[6][3] = { { 10, 20, 30 }, { 11, 19, 30 }, { 20, 27, 41 },
+                                     { 10, 20, 30 }, { 10, 20, 30 }, { 10, 20, 30 } };
+    BgraImage image;
+    bool decoded = DecodeQoi(data.data(), data.size(), image) && image.width == 2 && image.height == 3;
+    CHECK(decoded, "hand-written stream");
+    for (int i = 0; decoded && i < 6; i++) {
+        const uint8_t* p = image.pixels.data() + i * 4;
+        CHECK(p[2] == expected[i][0] && p[1] == expected[i][1] && p[0] == expected[i][2] && p[3] == 255,
+              "pixel %d = (%d, %d, %d, %d)", i, p[2], p[1], p[0], p[3]);
+    }
+
+    // 通道数、色彩空间和尺寸非法
+    std::vector<uint8_t> bad = data;
+    bad[12] = 5;
+    CHECK(!DecodeQoi(bad.data(), bad.size(), image), "channels 5 accepted");
+    bad = data;
+    bad[13] = 2;
+    CHECK(!DecodeQoi(bad.data(), bad.size(), image), "colorspace 2 accepted");
+    bad = data;
+    bad[7] = 0;
+    CHECK(!DecodeQoi(bad.data(), bad.size(), image), "zero width accepted");
+    bad = data;
+    bad[4] = 0x7f;
+    CHECK(!DecodeQoi(bad.data(), bad.size(), image), "huge width accepted");
+
+    // 游程超出图像
+    bad = data;
+    bad[14 + 7] = 0xc0 | 61;
+    CHECK(!DecodeQoi(bad.data(), bad.size(), image), "overlong run accepted");
+}
+
+// 随机数据块只需要不越界
+void TestQoiGarbage() {
+    std::mt19937 rng(9);
+    for (int round = 0; round < 2000; round++) {
+        std::vector<uint8_t> data = { 'q', 'o', 'i', 'f', 0, 0, 0, static_cast<uint8_t>(1 + rng() % 40),
+                                      0, 0, 0, static_cast<uint8_t>(1 + rng() % 40), 4, 0 };
+        size_t length = rng() % 300;
+        for (size_t i = 0; i < length; i++) {
+            data.push_back(static_cast<uint8_t>(rng()));
+        }
+        BgraImage image;
+        DecodeQoi(data.data(), data.size(), image);
+    }
+}
+
+void TestRawRgba() {
+    std::mt19937 rng(21);
+    BgraImage image = MakeImage(37, 11, Pattern::Noise, rng);
+    // 固定几个 alpha 边界值
+    image.pixels[3] = 0;
+    image.pixels[7] = 255;
+    image.pixels[11] = 1;
+
+    std::vector<uint8_t> encoded;
+    bool encodedOk = EncodeRawRgba(image, encoded) && IsRawRgbaData(encoded.data(), encoded.size());
+    CHECK(encodedOk, "raw encode");
+    if (!encodedOk) {
+        return;
+    }
+    CHECK(encoded.size() == kRawRgbaHeaderSize + 37 * 11 * 4, "raw size %zu", encoded.size());
+    const uint8_t header[16] = { 'R', 'G', 'B', 'A', 37, 0, 0, 0, 11, 0, 0, 0, kRawRgbaPremultiplied, 0, 0, 0 };
+    CHECK(memcmp(encoded.data(), header, sizeof(header)) == 0, "raw header");
+
+    bool premultiplied = true;
+    for (size_t i = 0; i < image.pixels.size(); i += 4) {
+        const uint8_t* src = image.pixels.data() + i;
+        const uint8_t* out = encoded.data() + kRawRgbaHeaderSize + i;
+        uint32_t a = src[3];
+        // RGBA 顺序，c' = round(c * a / 255)
+        premultiplied = premultiplied && out[0] == (src[2] * a + 127) / 255 && out[1] == (src[1] * a + 127) / 255 &&
+                        out[2] == (src[0] * a + 127) / 255 && out[3] == a;
+    }
+    CHECK(premultiplied, "raw pixels are not premultiplied RGBA");
+
+    // 还原误差不超过预乘时丢失的精度：255 / a / 2 + 1
+    BgraImage decoded;
+    bool decodedOk = DecodeRawRgba(encoded.data(), encoded.size(), decoded) && decoded.width == 37 &&
+                     decoded.height == 11;
+    CHECK(decodedOk, "raw decode");
+    for (size_t i = 0; decodedOk && i < image.pixels.size(); i += 4) {
+        const uint8_t* src = image.pixels.data() + i;
+        const uint8_t* out = decoded.pixels.data() + i;
+        int a = src[3];
+        CHECK(out[3] == a, "raw alpha at %zu", i / 4);
+        for (int c = 0; c < 3; c++) {
+            int tolerance = a == 0 ? 0 : 255 / a / 2 + 1;
+            int expected = a == 0 ? 0 : src[c];
+            CHECK(std::abs(out[c] - expected) <= tolerance, "raw pixel %zu channel %d: %d vs %d", i / 4, c,
+                  out[c], expected);
+        }
+    }
+
+    CHECK(!DecodeRawRgba(encoded.data(), encoded.size() - 1, decoded), "short raw buffer accepted");
+    CHECK(!DecodeRawRgba(encoded.data(), kRawRgbaHeaderSize - 1, decoded), "short raw header accepted");
+}
+
+void TestDispatch() {
+    std::mt19937 rng(17);
+    BgraImage image = MakeImage(19, 23, Pattern::AlphaSteps, rng);
+    for (int i = 0; i < 19 * 23; i++) {
+        image.pixels[i * 4 + 3] = 255; // 不透明时三种格式都无损
+    }
+
+    std::vector<uint8_t> png, qoi, raw;
+    EncodePng(image, PngLevel::Fast, png);
+    EncodeQoi(image, qoi);
+    EncodeRawRgba(image, raw);
+    const std::vector<uint8_t>* buffers[] = { &png, &qoi, &raw };
+    const char* names[] = { "png", "qoi", "rgba" };
+    for (int i = 0; i < 3; i++) {
+        BgraImage decoded;
+        bool same = DecodeThumbnail(buffers[i]->data(), buffers[i]->size(), decoded) &&
+                    decoded.pixels == image.pixels;
+        CHECK(same, "DecodeThumbnail %s", names[i]);
+    }
+    BgraImage decoded;
+    const uint8_t junk[] = "not an image at all";
+    CHECK(!DecodeThumbnail(junk, sizeof(junk), decoded), "junk accepted");
+
+    ThumbnailFormat format = ThumbnailFormat::Png;
+    CHECK(ParseThumbnailFormat("QOI", format) && format == ThumbnailFormat::Qoi, "parse QOI");
+    CHECK(ParseThumbnailFormat("rgba", format) && format == ThumbnailFormat::Rgba, "parse rgba");
+    CHECK(ParseThumbnailFormat("png", format) && format == ThumbnailFormat::Png, "parse png");
+    CHECK(!ParseThumbnailFormat("xpng", format) && !ParseThumbnailFormat("", format), "parse invalid");
+    CHECK(ThumbnailFormatFromPath("/tmp/a.QOI", format) && format == ThumbnailFormat::Qoi, "path .QOI");
+    CHECK(ThumbnailFormatFromPath("icon.rgba", format) && format == ThumbnailFormat::Rgba, "path .rgba");
+    CHECK(!ThumbnailFormatFromPath("icon.bmp", format) && !ThumbnailFormatFromPath("qoi", format), "path invalid");
+}
+
+} // namespace
+
+int main() {
+    TestQoiRoundTrip();
+    TestQoiOpcodes();
+    TestQoiGarbage();
+    TestRawRgba();
+    TestDispatch();
+
+    if (g_failures > 0) {
+        std::printf("%d failure(s)\n", g_failures);
+        return 1;
+    }
+    std::printf("image_formats_test: ok\n");
+    return 0;
+}
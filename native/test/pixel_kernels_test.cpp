@@ -0,0 +1,269 @@
+// 像素内核测试：标量实现按头文件中的公式穷举全部 (颜色, alpha) 组合；
+// 当前 CPU 可用的每个指令集实现与标量版本逐字节比较，覆盖各种像素数（向量宽度前后的尾部）、
+// 非对齐起始地址、原地与非原地处理，并检查写出范围之外的字节不被改动。
+// 另外用逐像素的参考实现检查 FlipVertical 和 KeyBorder（含行间填充字节）。
+// 构建：node-gyp rebuild --build_tests=1，运行 build/Release/pixel_kernels_test
+
+#include "../src/pixel_kernels.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+// 写出范围前后各留的哨兵字节
+const size_t kGuard = 64;
+const uint8_t kGuardByte = 0xA5;
+
+// 随机像素，alpha 偏向 0 和 255 以覆盖特殊分支；部分像素的颜色等于 key
+std::vector<uint8_t> RandomPixels(size_t count, uint32_t key, std::mt19937& rng) {
+    std::vector<uint8_t> pixels(count * 4);
+    for (size_t i = 0; i < count; i++) {
+        uint8_t* p = &pixels[i * 4];
+        uint32_t value = rng();
+        if (rng() % 4 == 0) {
+            value = (value & 0xFF000000u) | (key & 0x00FFFFFFu);
+        }
+        memcpy(p, &value, 4);
+        switch (rng() % 4) {
+        case 0: p[3] = 0; break;
+        case 1: p[3] = 255; break;
+        default: break;
+        }
+    }
+    return pixels;
+}
+
+// 把数据放在缓冲区中偏移 offset 字节处，前后填哨兵
+std::vector<uint8_t> Place(const std::vector<uint8_t>& data, size_t offset) {
+    std::vector<uint8_t> buffer(kGuard + offset + data.size() + kGuard, kGuardByte);
+    std::copy(data.begin(), data.end(), buffer.begin() + kGuard + offset);
+    return buffer;
+}
+
+enum class Op { MergeAlpha, Swizzle, Premultiply, Unpremultiply };
+
+const char* OpName(Op op) {
+    switch (op) {
+    case Op::MergeAlpha: return "mergeAlpha";
+    case Op::Swizzle: return "swizzle";
+    case Op::Premultiply: return "premultiply";
+    default: return "unpremultiply";
+    }
+}
+
+void Run(const PixelKernels& kernels, Op op, uint8_t* dst, const uint8_t* src, size_t count) {
+    switch (op) {
+    case Op::MergeAlpha: kernels.mergeAlpha(dst, src, count); break;
+    case Op::Swizzle: kernels.swizzle(dst, src, count); break;
+    case Op::Premultiply: kernels.premultiply(dst, src, count); break;
+    case Op::Unpremultiply: kernels.unpremultiply(dst, src, count); break;
+    }
+}
+
+void TestScalarFormulas() {
+    const PixelKernels& scalar = GetScalarPixelKernels();
+    // 每个像素的三个颜色通道都取 c，alpha 取 a，穷举 256 * 256 种组合
+    std::vector<uint8_t> src(256 * 256 * 4);
+    for (int a = 0; a < 256; a++) {
+        for (int c = 0; c < 256; c++) {
+            uint8_t* p = &src[(a * 256 + c) * 4];
+            p[0] = p[1] = p[2] = static_cast<uint8_t>(c);
+            p[3] = static_cast<uint8_t>(a);
+        }
+    }
+    std::vector<uint8_t> premultiplied(src.size());
+    std::vector<uint8_t> unpremultiplied(src.size());
+    scalar.premultiply(premultiplied.data(), src.data(), 256 * 256);
+    scalar.unpremultiply(unpremultiplied.data(), src.data(), 256 * 256);
+
+    int premultiplyErrors = 0;
+    int unpremultiplyErrors = 0;
+    for (int a = 0; a < 256; a++) {
+        for (int c = 0; c < 256; c++) {
+            size_t i = (a * 256 + c) * 4;
+            // c * a 的两倍为偶数而 255 为奇数，不会恰好落在 .5 上
+            int expected = (c * a + 127) / 255;
+            if (premultiplied[i] != expected || premultiplied[i + 2] != expected || premultiplied[i + 3] != a) {
+                premultiplyErrors++;
+            }
+            expected = a == 0 ? 0 : std::min(255, (c * 255 + a / 2) / a);
+            if (unpremultiplied[i] != expected || unpremultiplied[i + 2] != expected ||
+                unpremultiplied[i + 3] != a) {
+                unpremultiplyErrors++;
+            }
+        }
+    }
+    CHECK(premultiplyErrors == 0, "scalar premultiply: %d values differ from the formula", premultiplyErrors);
+    CHECK(unpremultiplyErrors == 0, "scalar unpremultiply: %d values differ from the formula", unpremultiplyErrors);
+
+    // 指令集实现也在全部组合上与标量比较
+    for (const PixelKernels* kernels : GetAvailablePixelKernels()) {
+        std::vector<uint8_t> out(src.size());
+        kernels->premultiply(out.data(), src.data(), 256 * 256);
+        CHECK(out == premultiplied, "%s premultiply differs on the exhaustive table", kernels->name);
+        kernels->unpremultiply(out.data(), src.data(), 256 * 256);
+        CHECK(out == unpremultiplied, "%s unpremultiply differs on the exhaustive table", kernels->name);
+    }
+}
+
+// 像素数覆盖 0、向量宽度附近的尾部和较长的行
+std::vector<size_t> Counts() {
+    std::vector<size_t> counts;
+    for (size_t count = 0; count <= 70; count++) {
+        counts.push_back(count);
+    }
+    for (size_t count : { 127, 128, 129, 255, 256, 257, 1023, 4099 }) {
+        counts.push_back(count);
+    }
+    return counts;
+}
+
+void CompareRowKernel(const PixelKernels& kernels, Op op, std::mt19937& rng) {
+    const PixelKernels& scalar = GetScalarPixelKernels();
+    for (size_t count : Counts()) {
+        // 偏移 1、3 字节使像素起点不对齐
+        for (size_t offset : { 0, 1, 3, 4, 12, 20 }) {
+            std::vector<uint8_t> src = RandomPixels(count, 0, rng);
+            std::vector<uint8_t> dst = RandomPixels(count, 0, rng);
+
+            // 非原地：dst 原有内容对 mergeAlpha 有意义，两边使用相同的初值
+            std::vector<uint8_t> expected = Place(dst, offset);
+            std::vector<uint8_t> actual = expected;
+            std::vector<uint8_t> source = Place(src, (offset + 1) % 8);
+            const uint8_t* from = source.data() + kGuard + (offset + 1) % 8;
+            Run(scalar, op, expected.data() + kGuard + offset, from, count);
+            Run(kernels, op, actual.data() + kGuard + offset, from, count);
+            CHECK(actual == expected, "%s %s: count %zu offset %zu differs from scalar", kernels.name, OpName(op),
+                  count, offset);
+
+            // 原地
+            expected = Place(src, offset);
+            actual = expected;
+            uint8_t* row = expected.data() + kGuard + offset;
+            Run(scalar, op, row, row, count);
+            row = actual.data() + kGuard + offset;
+            Run(kernels, op, row, row, count);
+            CHECK(actual == expected, "%s %s in place: count %zu offset %zu differs from scalar", kernels.name,
+                  OpName(op), count, offset);
+        }
+    }
+}
+
+void CompareKeyRow(const PixelKernels& kernels, std::mt19937& rng) {
+    const PixelKernels& scalar = GetScalarPixelKernels();
+    for (size_t count : Counts()) {
+        for (size_t offset : { 0, 1, 4, 12 }) {
+            // key 的 alpha 字节应被忽略
+            uint32_t key = rng();
+            std::vector<uint8_t> expected = Place(RandomPixels(count, key, rng), offset);
+            std::vector<uint8_t> actual = expected;
+            scalar.keyRow(expected.data() + kGuard + offset, count, key);
+            kernels.keyRow(actual.data() + kGuard + offset, count, key);
+            CHECK(actual == expected, "%s keyRow: count %zu offset %zu differs from scalar", kernels.name, count,
+                  offset);
+        }
+    }
+}
+
+void CompareSwapBytes(const PixelKernels& kernels, std::mt19937& rng) {
+    // 字节数不必是 4 的倍数
+    for (size_t bytes : { 0, 1, 3, 15, 16, 17, 31, 32, 33, 63, 64, 65, 255, 256, 257, 1000, 4099 }) {
+        for (size_t offset : { 0, 1, 7 }) {
+            std::vector<uint8_t> first(bytes);
+            std::vector<uint8_t> second(bytes);
+            for (uint8_t& value : first) {
+                value = static_cast<uint8_t>(rng());
+            }
+            for (uint8_t& value : second) {
+                value = static_cast<uint8_t>(rng());
+            }
+            std::vector<uint8_t> a = Place(first, offset);
+            std::vector<uint8_t> b = Place(second, (offset + 3) % 8);
+            kernels.swapBytes(a.data() + kGuard + offset, b.data() + kGuard + (offset + 3) % 8, bytes);
+            CHECK(a == Place(second, offset) && b == Place(first, (offset + 3) % 8),
+                  "%s swapBytes: %zu bytes offset %zu", kernels.name, bytes, offset);
+        }
+    }
+}
+
+void TestKernelsMatchScalar() {
+    std::mt19937 rng(21);
+    for (const PixelKernels* kernels : GetAvailablePixelKernels()) {
+        std::printf("checking %s\n", kernels->name);
+        for (Op op : { Op::MergeAlpha, Op::Swizzle, Op::Premultiply, Op::Unpremultiply }) {
+            CompareRowKernel(*kernels, op, rng);
+        }
+        CompareKeyRow(*kernels, rng);
+        CompareSwapBytes(*kernels, rng);
+    }
+}
+
+void TestFlipVertical() {
+    std::mt19937 rng(5);
+    for (int height : { 0, 1, 2, 3, 8, 33 }) {
+        for (int width : { 1, 7, 40 }) {
+            // 行间多出 12 字节填充，翻转按整行（含填充）进行
+            size_t stride = static_cast<size_t>(width) * 4 + 12;
+            std::vector<uint8_t> image(stride * height);
+            for (uint8_t& value : image) {
+                value = static_cast<uint8_t>(rng());
+            }
+            std::vector<uint8_t> flipped = image;
+            FlipVertical(flipped.data(), stride, height);
+            bool same = true;
+            for (int y = 0; y < height; y++) {
+                same = same && memcmp(&flipped[stride * y], &image[stride * (height - 1 - y)], stride) == 0;
+            }
+            CHECK(same, "FlipVertical %dx%d", width, height);
+        }
+    }
+}
+
+void TestKeyBorder() {
+    std::mt19937 rng(7);
+    const uint32_t key = 0x00FF00FF;
+    for (int height : { 1, 2, 3, 17 }) {
+        for (int width : { 1, 2, 5, 33 }) {
+            size_t stride = static_cast<size_t>(width) * 4 + 8;
+            std::vector<uint8_t> image(stride * height);
+            for (int y = 0; y < height; y++) {
+                std::vector<uint8_t> row = RandomPixels(width, key, rng);
+                std::copy(row.begin(), row.end(), image.begin() + stride * y);
+                std::fill(image.begin() + stride * y + width * 4, image.begin() + stride * (y + 1), kGuardByte);
+            }
+            std::vector<uint8_t> expected = image;
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    uint8_t* p = &expected[stride * y + x * 4];
+                    bool border = x == 0 || y == 0 || x == width - 1 || y == height - 1;
+                    if (border && p[0] == 0xFF && p[1] == 0x00 && p[2] == 0xFF) {
+                        p[3] = 0;
+                    }
+                }
+            }
+            KeyBorder(image.data(), width, height, stride, key);
+            CHECK(image == expected, "KeyBorder %dx%d", width, height);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    TestScalarFormulas();
+    TestKernelsMatchScalar();
+    TestFlipVertical();
+    TestKeyBorder();
+
+    if (g_failures > 0) {
+        std::printf("%d failure(s)\n", g_failures);
+        return 1;
+    }
+    std::printf("pixel_kernels_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,127 @@
+// PNG 编码器往返测试：各级别的输出交给系统 libpng（简化 API）和 zlib 解码，
+// 要求与源像素逐位一致，覆盖不透明/带 alpha 的图像、奇数尺寸和单行单列。
+// 同时检查 Default/Small 不大于 Fast。
+// 构建：node-gyp rebuild --build_tests=1，运行 build/Release/png_encoder_test（需要 libpng 和 zlib）
+
+#include "../src/png_encoder.h"
+#include "test_util.h"
+
+#include <png.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+bool DecodeWithLibpng(const std::vector<uint8_t>& data, BgraImage& image) {
+    png_image decoder = {};
+    decoder.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_memory(&decoder, data.data(), data.size())) {
+        std::printf("libpng: %s\n", decoder.message);
+        return false;
+    }
+    decoder.format = PNG_FORMAT_BGRA;
+    image.Allocate(static_cast<int>(decoder.width), static_cast<int>(decoder.height));
+    if (!png_image_finish_read(&decoder, nullptr, image.pixels.data(), 0, nullptr)) {
+        std::printf("libpng: %s\n", decoder.message);
+        return false;
+    }
+    return true;
+}
+
+void TestRoundTrip() {
+    const int sizes[][2] = { { 1, 1 }, { 1, 7 }, { 7, 1 }, { 3, 5 }, { 17, 13 }, { 33, 31 },
+                             { 48, 48 }, { 127, 129 }, { 256, 256 }, { 5, 600 } };
+    const Pattern patterns[] = { Pattern::Noise, Pattern::Circle, Pattern::Gradient,
+                                 Pattern::Transparent, Pattern::Flat };
+    const PngLevel levels[] = { PngLevel::Stored, PngLevel::Fast, PngLevel::Default, PngLevel::Small };
+    std::mt19937 rng(7);
+
+    for (const auto& size : sizes) {
+        for (Pattern pattern : patterns) {
+            BgraImage image = MakeImage(size[0], size[1], pattern, rng);
+            size_t fastSize = 0;
+            for (PngLevel level : levels) {
+                std::vector<uint8_t> encoded;
+                bool encodedOk = EncodePng(image, level, encoded);
+                CHECK(encodedOk, "encode %dx%d %s level %d", size[0], size[1], PatternName(pattern),
+                      static_cast<int>(level));
+                if (!encodedOk) {
+                    continue;
+                }
+
+                BgraImage decoded;
+                bool same = DecodeWithLibpng(encoded, decoded) && decoded.width == image.width &&
+                            decoded.height == image.height && decoded.pixels == image.pixels;
+                CHECK(same, "round trip %dx%d %s level %d", size[0], size[1], PatternName(pattern),
+                      static_cast<int>(level));
+
+                if (level == PngLevel::Fast) {
+                    fastSize = encoded.size();
+                } else if (level != PngLevel::Stored) {
+                    CHECK(encoded.size() <= fastSize, "%dx%d %s level %d: %zu bytes > Fast %zu",
+                          size[0], size[1], PatternName(pattern), static_cast<int>(level),
+                          encoded.size(), fastSize);
+                }
+            }
+        }
+    }
+}
+
+void TestInvalidImage() {
+    BgraImage image;
+    std::vector<uint8_t> encoded;
+    CHECK(!EncodePng(image, PngLevel::Default, encoded), "empty image accepted");
+    image.Allocate(4, 4);
+    image.pixels.resize(10);
+    CHECK(!EncodePng(image, PngLevel::Default, encoded), "short pixel buffer accepted");
+}
+
+// 长重复、短匹配密集和随机数据，包括空输入和跨越存储块上限的长度
+void TestZlib() {
+    std::mt19937 rng(11);
+    const size_t lengths[] = { 0, 1, 3, 258, 259, 65535, 65536, 200000 };
+    const PngLevel levels[] = { PngLevel::Stored, PngLevel::Fast, PngLevel::Default, PngLevel::Small };
+
+    for (size_t length : lengths) {
+        for (int kind = 0; kind < 3; kind++) {
+            std::vector<uint8_t> data(length);
+            for (size_t i = 0; i < length; i++) {
+                data[i] = kind == 0 ? static_cast<uint8_t>(rng())
+                        : kind == 1 ? static_cast<uint8_t>(i % 7)
+                                    : static_cast<uint8_t>((rng() % 4) * 60);
+            }
+            for (PngLevel level : levels) {
+                std::vector<uint8_t> compressed;
+                ZlibCompress(data.data(), data.size(), level, compressed);
+
+                std::vector<uint8_t> inflated(length + 1);
+                uLongf inflatedSize = static_cast<uLongf>(inflated.size());
+                int result = uncompress(inflated.data(), &inflatedSize, compressed.data(),
+                                        static_cast<uLong>(compressed.size()));
+                inflated.resize(inflatedSize);
+                CHECK(result == Z_OK && inflated == data, "zlib length %zu kind %d level %d: %d",
+                      length, kind, static_cast<int>(level), result);
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    TestRoundTrip();
+    TestInvalidImage();
+    TestZlib();
+
+    if (g_failures > 0) {
+        std::printf("%d failure(s)\n", g_failures);
+        return 1;
+    }
+    std::printf("png_encoder_test: ok\n");
+    return 0;
+}
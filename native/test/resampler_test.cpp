@@ -0,0 +1,234 @@
+// 缩放测试：按滤波器定义在浮点预乘空间中写一个逐像素的标量参考实现，
+// 与定点（x86 上为 SSE2）卷积的结果比较，覆盖 Box/Lanczos3 缩小、双线性放大、单边不变和各种宽高比。
+// 结果再预乘后与参考值相差不超过 kTolerance，且较大输出的每个通道平均偏差接近 0（发现舍入偏置）。
+// 另外检查一次遍历的 ResizeBgraToFitSizes 与逐个 ResizeBgraToFit 的结果逐字节相同。
+// 构建：node-gyp rebuild --build_tests=1，运行 build/Release/resampler_test
+
+#include "../src/bgra_image.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+// 定点权重和 8 位中间结果的误差：中间值舍入经垂直卷积放大（Lanczos 权重绝对值之和略大于 1），再加最终舍入
+const double kTolerance = 2.0;
+const double kMaxMeanError = 0.25;
+const double kPi = 3.14159265358979323846;
+
+const char* FilterName(ResampleFilter filter) {
+    return filter == ResampleFilter::Box ? "box" : "lanczos3";
+}
+
+double Sinc(double x) {
+    return x == 0.0 ? 1.0 : std::sin(x * kPi) / (x * kPi);
+}
+
+// 一个输出的归一化权重，只保存 [first, first + values.size()) 部分，其余源像素的权重为 0
+struct Weights {
+    int first = 0;
+    std::vector<double> values;
+};
+
+// 输出 i 对源像素 s 的权重（一维），按滤波器的定义对每个源像素逐项计算
+std::vector<Weights> ReferenceWeights(int sourceSize, int targetSize, ResampleFilter filter) {
+    std::vector<Weights> weights(targetSize);
+    double scale = static_cast<double>(sourceSize) / targetSize;
+    for (int i = 0; i < targetSize; i++) {
+        std::vector<double> row(sourceSize, 0.0);
+        if (targetSize < sourceSize && filter == ResampleFilter::Box) {
+            // 覆盖的源区间 [i * scale, (i + 1) * scale) 与每个源像素的重叠长度
+            double start = i * scale;
+            double end = (i + 1) * scale;
+            for (int s = 0; s < sourceSize; s++) {
+                row[s] = std::max(0.0, std::min<double>(end, s + 1) - std::max<double>(start, s));
+            }
+        } else if (targetSize < sourceSize) {
+            double center = (i + 0.5) * scale;
+            for (int s = 0; s < sourceSize; s++) {
+                double x = (s + 0.5 - center) / scale;
+                row[s] = std::fabs(x) < 3.0 ? Sinc(x) * Sinc(x / 3.0) : 0.0;
+            }
+        } else {
+            // 像素中心对齐，越界时取边缘像素
+            double center = std::max(0.0, std::min((i + 0.5) * scale - 0.5, sourceSize - 1.0));
+            int left = static_cast<int>(center);
+            double fraction = center - left;
+            row[left] += 1.0 - fraction;
+            row[std::min(left + 1, sourceSize - 1)] += fraction;
+        }
+        double sum = 0.0;
+        for (double w : row) {
+            sum += w;
+        }
+        int first = 0;
+        int last = sourceSize;
+        while (row[first] == 0.0) first++;
+        while (row[last - 1] == 0.0) last--;
+        weights[i].first = first;
+        for (int s = first; s < last; s++) {
+            weights[i].values.push_back(row[s] / sum);
+        }
+    }
+    return weights;
+}
+
+// 参考结果（预乘，浮点），每一维卷积后钳位到 [0, 255]
+std::vector<double> ReferenceResize(const BgraImage& source, int width, int height, ResampleFilter filter) {
+    std::vector<Weights> columns = ReferenceWeights(source.width, width, filter);
+    std::vector<Weights> rows = ReferenceWeights(source.height, height, filter);
+
+    std::vector<double> premultiplied(source.pixels.size());
+    for (size_t i = 0; i < source.pixels.size(); i += 4) {
+        int a = source.pixels[i + 3];
+        for (int c = 0; c < 3; c++) {
+            premultiplied[i + c] = (source.pixels[i + c] * a + 127) / 255;
+        }
+        premultiplied[i + 3] = a;
+    }
+
+    std::vector<double> horizontal(static_cast<size_t>(width) * source.height * 4, 0.0);
+    for (int y = 0; y < source.height; y++) {
+        for (int x = 0; x < width; x++) {
+            for (int c = 0; c < 4; c++) {
+                double sum = 0.0;
+                for (size_t k = 0; k < columns[x].values.size(); k++) {
+                    size_t s = columns[x].first + k;
+                    sum += columns[x].values[k] * premultiplied[(static_cast<size_t>(y) * source.width + s) * 4 + c];
+                }
+                horizontal[(static_cast<size_t>(y) * width + x) * 4 + c] = std::max(0.0, std::min(255.0, sum));
+            }
+        }
+    }
+
+    std::vector<double> result(static_cast<size_t>(width) * height * 4, 0.0);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            for (int c = 0; c < 4; c++) {
+                double sum = 0.0;
+                for (size_t k = 0; k < rows[y].values.size(); k++) {
+                    size_t s = rows[y].first + k;
+                    sum += rows[y].values[k] * horizontal[(s * width + x) * 4 + c];
+                }
+                result[(static_cast<size_t>(y) * width + x) * 4 + c] = std::max(0.0, std::min(255.0, sum));
+            }
+        }
+    }
+    return result;
+}
+
+// 平滑渐变叠加噪声，alpha 含整块透明、半透明和不透明区域
+BgraImage MakeSource(int width, int height, std::mt19937& rng) {
+    BgraImage image;
+    image.Allocate(width, height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t* p = image.Row(y) + x * 4;
+            p[0] = static_cast<uint8_t>(x * 255 / std::max(1, width - 1));
+            p[1] = static_cast<uint8_t>(y * 255 / std::max(1, height - 1));
+            p[2] = static_cast<uint8_t>(rng());
+            int band = (x * 4 / width + y * 4 / height) % 4;
+            p[3] = band == 0 ? 0 : (band == 1 ? 255 : static_cast<uint8_t>(rng()));
+        }
+    }
+    return image;
+}
+
+// 结果再预乘后与参考比较。颜色大于 alpha 的参考值经过反预乘和再预乘后变为 alpha，先按此钳位
+void CompareWithReference(const BgraImage& source, const BgraImage& actual, ResampleFilter filter) {
+    std::vector<double> expected = ReferenceResize(source, actual.width, actual.height, filter);
+    double maxError = 0.0;
+    double errorSum[4] = {};
+    for (size_t i = 0; i < actual.pixels.size(); i += 4) {
+        int a = actual.pixels[i + 3];
+        for (int c = 0; c < 4; c++) {
+            double value = c == 3 ? a : (actual.pixels[i + c] * a + 127) / 255;
+            double reference = c == 3 ? expected[i + 3] : std::min(expected[i + c], static_cast<double>(a));
+            double error = value - reference;
+            maxError = std::max(maxError, std::fabs(error));
+            errorSum[c] += error;
+        }
+    }
+    size_t pixels = actual.pixels.size() / 4;
+    CHECK(maxError <= kTolerance, "%s %dx%d -> %dx%d: max error %.2f", FilterName(filter), source.width,
+          source.height, actual.width, actual.height, maxError);
+    // 像素太少时平均值没有意义
+    for (int c = 0; c < 4 && pixels >= 256; c++) {
+        double mean = errorSum[c] / pixels;
+        CHECK(std::fabs(mean) <= kMaxMeanError, "%s %dx%d -> %dx%d: channel %d mean error %.3f", FilterName(filter),
+              source.width, source.height, actual.width, actual.height, c, mean);
+    }
+}
+
+void TestAgainstReference() {
+    std::mt19937 rng(22);
+    const int shapes[][2] = { { 256, 256 }, { 300, 170 }, { 37, 91 }, { 64, 64 }, { 5, 3 } };
+    const int sizes[][2] = { { 1, 1 }, { 16, 16 }, { 32, 20 }, { 48, 48 }, { 64, 91 }, { 100, 37 }, { 400, 300 } };
+    for (const auto& shape : shapes) {
+        BgraImage source = MakeSource(shape[0], shape[1], rng);
+        for (const auto& size : sizes) {
+            for (ResampleFilter filter : { ResampleFilter::Box, ResampleFilter::Lanczos3 }) {
+                BgraImage target;
+                CHECK(ResizeBgra(source, size[0], size[1], target, filter), "ResizeBgra failed");
+                CHECK(target.width == size[0] && target.height == size[1], "target size %dx%d", target.width,
+                      target.height);
+                if (target.width == size[0] && target.height == size[1]) {
+                    CompareWithReference(source, target, filter);
+                }
+            }
+        }
+    }
+}
+
+bool SameImage(const BgraImage& a, const BgraImage& b) {
+    return a.width == b.width && a.height == b.height && a.pixels == b.pixels;
+}
+
+void TestFitSizesMatchesSingle() {
+    std::mt19937 rng(23);
+    // 包含与源图相同的尺寸（直接复制）和大于源图的尺寸（放大）
+    const std::vector<int> sizes = { 16, 24, 32, 48, 64, 96, 128, 256, 300 };
+    const int shapes[][2] = { { 256, 256 }, { 300, 128 }, { 90, 256 }, { 1, 40 } };
+    for (const auto& shape : shapes) {
+        BgraImage source = MakeSource(shape[0], shape[1], rng);
+        for (ResampleFilter filter : { ResampleFilter::Box, ResampleFilter::Lanczos3 }) {
+            std::vector<BgraImage> targets;
+            CHECK(ResizeBgraToFitSizes(source, sizes, targets, filter), "ResizeBgraToFitSizes failed");
+            CHECK(targets.size() == sizes.size(), "%zu targets", targets.size());
+            for (size_t i = 0; i < targets.size() && i < sizes.size(); i++) {
+                BgraImage single;
+                ResizeBgraToFit(source, sizes[i], single, filter);
+                CHECK(SameImage(targets[i], single), "%s %dx%d size %d differs from ResizeBgraToFit",
+                      FilterName(filter), shape[0], shape[1], sizes[i]);
+                int width, height;
+                FitBgraSize(source, sizes[i], width, height);
+                CHECK(std::max(width, height) == sizes[i] && targets[i].width == width &&
+                      targets[i].height == height, "size %d gave %dx%d", sizes[i], targets[i].width,
+                      targets[i].height);
+            }
+        }
+    }
+
+    BgraImage source = MakeSource(8, 8, rng);
+    std::vector<BgraImage> targets;
+    CHECK(!ResizeBgraToFitSizes(source, { 16, 0 }, targets, ResampleFilter::Box), "size 0 accepted");
+    CHECK(!ResizeBgraToFitSizes(BgraImage(), { 16 }, targets, ResampleFilter::Box), "empty source accepted");
+}
+
+} // namespace
+
+int main() {
+    TestAgainstReference();
+    TestFitSizesMatchesSingle();
+
+    if (g_failures > 0) {
+        std::printf("%d failure(s)\n", g_failures);
+        return 1;
+    }
+    std::printf("resampler_test: ok\n");
+    return 0;
+}
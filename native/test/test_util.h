@@ -0,0 +1,125 @@
+// native/test 下各测试共用的断言宏和测试图像生成。
+// 每个测试是单独的可执行文件，这里的定义只会被一个翻译单元包含
+
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include "../src/bgra_image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+inline int g_failures = 0;
+
+// 失败时打印位置和消息并计数，不中断当前测试，main 根据 g_failures 返回结果
+#define CHECK(condition, ...)                                      \
+    do {                                                           \
+        if (!(condition)) {                                        \
+            std::printf("FAIL %s:%d: ", __FILE__, __LINE__);       \
+            std::printf(__VA_ARGS__);                              \
+            std::printf("\n");                                     \
+            g_failures++;                                          \
+        }                                                          \
+    } while (0)
+
+enum class Pattern {
+    Noise,       // 四个通道都是随机值
+    Smooth,      // 缓变颜色带少量噪声，QOI 编码为 DIFF/LUMA
+    Runs,        // 长于 62 像素的色带，部分全透明
+    Palette,     // 从五种颜色中随机取，反复命中 QOI 索引
+    AlphaSteps,  // 颜色不变，alpha 逐像素变化
+    Circle,      // 抗锯齿边的圆，四角全透明
+    Gradient,    // 完全不透明的渐变（PNG 编码为 RGB）
+    Transparent, // 全透明
+    Flat,        // 扁平色块，两种 alpha 交替
+};
+
+inline const char* PatternName(Pattern pattern) {
+    switch (pattern) {
+        case Pattern::Noise: return "noise";
+        case Pattern::Smooth: return "smooth";
+        case Pattern::Runs: return "runs";
+        case Pattern::Palette: return "palette";
+        case Pattern::AlphaSteps: return "alpha-steps";
+        case Pattern::Circle: return "circle";
+        case Pattern::Gradient: return "gradient";
+        case Pattern::Transparent: return "transparent";
+        default: return "flat";
+    }
+}
+
+inline BgraImage MakeImage(int width, int height, Pattern pattern, std::mt19937& rng) {
+    static const uint8_t kPalette[5][4] = {
+        { 0, 0, 0, 255 }, { 255, 255, 255, 255 }, { 30, 60, 90, 128 }, { 0, 0, 0, 0 }, { 200, 10, 10, 255 } };
+    BgraImage image;
+    image.Allocate(width, height);
+    for (int y = 0; y < height; y++) {
+        uint8_t* row = image.Row(y);
+        for (int x = 0; x < width; x++) {
+            uint8_t* p = row + x * 4;
+            switch (pattern) {
+                case Pattern::Noise:
+                    for (int c = 0; c < 4; c++) {
+                        p[c] = static_cast<uint8_t>(rng());
+                    }
+                    break;
+                case Pattern::Smooth:
+                    p[0] = static_cast<uint8_t>(x + y);
+                    p[1] = static_cast<uint8_t>(x * 3 + (rng() % 3));
+                    p[2] = static_cast<uint8_t>(y * 2 + x / 4 * 20);
+                    p[3] = 255;
+                    break;
+                case Pattern::Runs: {
+                    int band = (y * width + x) / 150;
+                    p[0] = static_cast<uint8_t>(band * 40);
+                    p[1] = static_cast<uint8_t>(band * 90);
+                    p[2] = 7;
+                    p[3] = band % 3 == 0 ? 0 : 255;
+                    break;
+                }
+                case Pattern::Palette:
+                    memcpy(p, kPalette[rng() % 5], 4);
+                    break;
+                case Pattern::AlphaSteps:
+                    p[0] = 100;
+                    p[1] = 150;
+                    p[2] = 200;
+                    p[3] = static_cast<uint8_t>(x * 17 + y);
+                    break;
+                case Pattern::Circle: {
+                    double dx = x + 0.5 - width / 2.0;
+                    double dy = y + 0.5 - height / 2.0;
+                    double edge = std::min(width, height) / 2.0 - std::sqrt(dx * dx + dy * dy);
+                    double alpha = std::max(0.0, std::min(1.0, edge));
+                    p[0] = static_cast<uint8_t>(x * 255 / width);
+                    p[1] = static_cast<uint8_t>(y * 255 / height);
+                    p[2] = 160;
+                    p[3] = static_cast<uint8_t>(alpha * 255.0 + 0.5);
+                    break;
+                }
+                case Pattern::Gradient:
+                    p[0] = static_cast<uint8_t>(x);
+                    p[1] = static_cast<uint8_t>(y);
+                    p[2] = static_cast<uint8_t>(x ^ y);
+                    p[3] = 255;
+                    break;
+                case Pattern::Transparent:
+                    p[0] = p[1] = p[2] = p[3] = 0;
+                    break;
+                case Pattern::Flat:
+                    p[0] = static_cast<uint8_t>((x / 8) * 30);
+                    p[1] = static_cast<uint8_t>((y / 8) * 30);
+                    p[2] = static_cast<uint8_t>(((x + y) / 8) * 20);
+                    p[3] = ((x / 16 + y / 16) & 1) ? 255 : 200;
+                    break;
+            }
+        }
+    }
+    return image;
+}
+
+#endif
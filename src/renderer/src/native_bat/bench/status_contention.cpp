@@ -0,0 +1,189 @@
+// 状态查询争用基准：在监控线程空闲和繁忙两种情况下测量 GetAppStatus / GetAllRunningApps 的延迟分布。
+// 作为对照，同样的负载下再测一次改用快照之前的做法：写入方在互斥锁内更新状态表，读取方加锁复制记录
+//
+// 构建（Linux）：node-gyp rebuild --build_bench=1
+// 运行：
+//   build/Release/status_contention [短命进程路径，默认 /bin/true] [读线程数，默认 4]
+
+#include "app_launcher.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int kLaunchCount = 400;
+constexpr int kReadsPerThread = 200000;
+
+struct Percentiles {
+  double p50 = 0.0;
+  double p99 = 0.0;
+  double max = 0.0;
+};
+
+Percentiles Summarize(std::vector<double>& samples) {
+  Percentiles result;
+  if (samples.empty()) {
+    return result;
+  }
+  std::sort(samples.begin(), samples.end());
+  result.p50 = samples[samples.size() / 2];
+  result.p99 = samples[samples.size() * 99 / 100];
+  result.max = samples.back();
+  return result;
+}
+
+// 对照组：互斥锁保护的状态表，查询时加锁并复制记录
+class LockedStatusTable {
+public:
+  void Update(const LauncherEvent& event) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    LaunchRecord& record = records_[event.appId];
+    record.appId = event.appId;
+    record.processId = event.processId;
+    record.status = event.type == LauncherEventType::Launched ? "running" : "completed";
+    record.exitCode = event.exitCode;
+    record.duration = event.duration;
+  }
+
+  LaunchRecord Get(const std::string& appId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = records_.find(appId);
+    return it != records_.end() ? it->second : LaunchRecord();
+  }
+
+  std::map<std::string, LaunchRecord> GetAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records_;
+  }
+
+private:
+  std::mutex mutex_;
+  std::map<std::string, LaunchRecord> records_;
+};
+
+// 一次查询：i % 8 == 0 时查询全部，否则查询单个应用，返回值只用于防止调用被优化掉
+using ReadFunction = std::function<size_t(const std::string& appId, bool all)>;
+
+// 多个读线程并发查询，返回所有调用的耗时（纳秒）
+std::vector<double> RunReaders(const ReadFunction& read, int threadCount, const std::atomic<int>& launched) {
+  std::vector<std::vector<double>> perThread(threadCount);
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < threadCount; t++) {
+    threads.emplace_back([&read, &launched, &perThread, t] {
+      std::vector<double>& samples = perThread[t];
+      samples.reserve(kReadsPerThread);
+      size_t sink = 0;
+
+      for (int i = 0; i < kReadsPerThread; i++) {
+        int current = launched.load(std::memory_order_relaxed);
+        std::string appId = "bench-" + std::to_string(current > 0 ? i % current : 0);
+
+        auto begin = std::chrono::steady_clock::now();
+        sink += read(appId, i % 8 == 0);
+        auto end = std::chrono::steady_clock::now();
+
+        samples.push_back(std::chrono::duration<double, std::nano>(end - begin).count());
+      }
+
+      if (sink == static_cast<size_t>(-1)) {
+        printf("unreachable\n");
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<double> all;
+  for (auto& samples : perThread) {
+    all.insert(all.end(), samples.begin(), samples.end());
+  }
+  return all;
+}
+
+void Report(const char* label, std::vector<double>& samples) {
+  Percentiles result = Summarize(samples);
+  printf("%-28s calls=%zu p50=%.0fns p99=%.0fns max=%.0fns\n",
+         label, samples.size(), result.p50, result.p99, result.max);
+}
+
+// 持续启动立即退出的进程，让监控线程不断处理退出事件
+void RunChurn(AppLauncher& launcher, const std::string& executable, std::atomic<int>& launched,
+              const std::atomic<bool>& stop) {
+  for (int i = 0; i < kLaunchCount && !stop; i++) {
+    AppInfo appInfo;
+    appInfo.appId = "bench-" + std::to_string(i);
+    appInfo.executablePath = executable;
+    std::string errorMsg;
+    if (launcher.LaunchApp(appInfo, errorMsg)) {
+      launched++;
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::string executable = argc > 1 ? argv[1] : "/bin/true";
+  int readers = argc > 2 ? atoi(argv[2]) : 4;
+
+  AppLauncher launcher;
+  LockedStatusTable table;
+  // 监听器在产生事件的线程中同步调用，对照组的写入与旧实现一样发生在启动和监控线程上
+  launcher.SetEventListener([&table](const LauncherEvent& event) {
+    if (event.type == LauncherEventType::Launched || event.type == LauncherEventType::Exited ||
+        event.type == LauncherEventType::Crashed) {
+      table.Update(event);
+    }
+  });
+
+  ReadFunction snapshotRead = [&launcher](const std::string& appId, bool all) -> size_t {
+    if (all) {
+      return launcher.GetAllRunningApps()->records.size();
+    }
+    AppStatusView status = launcher.GetAppStatus(appId);
+    return status.record ? status.record->processId : 0;
+  };
+  ReadFunction lockedRead = [&table](const std::string& appId, bool all) -> size_t {
+    if (all) {
+      return table.GetAll().size();
+    }
+    return table.Get(appId).processId;
+  };
+
+  // 监控线程空闲
+  std::atomic<int> launched{ 0 };
+  std::vector<double> idle = RunReaders(snapshotRead, readers, launched);
+  Report("snapshot, monitor idle", idle);
+  std::vector<double> lockedIdle = RunReaders(lockedRead, readers, launched);
+  Report("mutex, monitor idle", lockedIdle);
+
+  // 两组在相同的退出负载下各测一次。上一轮的会话都已结束，同一 appId 可以再次启动
+  const struct {
+    const char* label;
+    const ReadFunction* read;
+  } runs[] = {
+    { "snapshot, exit churn", &snapshotRead },
+    { "mutex, exit churn", &lockedRead },
+  };
+  for (const auto& run : runs) {
+    std::atomic<int> churnLaunched{ 0 };
+    std::atomic<bool> stop{ false };
+    std::thread churn([&] { RunChurn(launcher, executable, churnLaunched, stop); });
+    std::vector<double> busy = RunReaders(*run.read, readers, churnLaunched);
+    stop = true;
+    churn.join();
+    Report(run.label, busy);
+    printf("launched=%d\n", churnLaunched.load());
+  }
+  return 0;
+}
@@ -1,10 +1,16 @@
 {
+  "variables": {
+    "build_bench%": 0
+  },
   "targets": [
     {
       "target_name": "app_launcher",
       "sources": [
         "src/app_launcher_bindings.cpp",
-        "src/app_launcher.cpp"
+        "src/app_launcher.cpp",
+        "src/session_journal.cpp",
+        "src/app_prefetcher.cpp",
+        "src/launch_scheduler.cpp"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")"
@@ -37,7 +43,14 @@
         }],
         ["OS=='linux'", {
           "sources": [
-            "src/app_launcher_linux.cpp"
+            "src/app_launcher_linux.cpp",
+            "src/cgroup_v2.cpp",
+            "src/process_sampler.cpp",
+            "src/launch_tracer.cpp",
+            "src/focus_controller.cpp",
+            "src/hang_detector.cpp",
+            "src/output_capture.cpp",
+            "src/crash_reporter.cpp"
           ],
           "libraries": [
             "-lX11"
@@ -45,5 +58,34 @@
         }]
       ]
     }
+  ],
+  "conditions": [
+    ["build_bench!=0 and OS=='linux'", {
+      "targets": [
+        {
+          "target_name": "status_contention",
+          "type": "executable",
+          "sources": [
+            "bench/status_contention.cpp",
+            "src/app_launcher.cpp",
+            "src/app_launcher_linux.cpp",
+            "src/session_journal.cpp",
+            "src/app_prefetcher.cpp",
+            "src/launch_scheduler.cpp",
+            "src/cgroup_v2.cpp",
+            "src/process_sampler.cpp",
+            "src/launch_tracer.cpp",
+            "src/focus_controller.cpp",
+            "src/hang_detector.cpp",
+            "src/output_capture.cpp",
+            "src/crash_reporter.cpp"
+          ],
+          "include_dirs": ["src"],
+          "libraries": ["-pthread"],
+          "cflags!": ["-fno-exceptions"],
+          "cflags_cc!": ["-fno-exceptions"]
+        }
+      ]
+    }]
   ]
-}
\ No newline at end of file
+}
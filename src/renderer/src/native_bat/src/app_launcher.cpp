@@ -6,6 +6,8 @@
 #include <fstream>
 #include <chrono>
 #include <ctime>
+#include <cstring>
+#include <algorithm>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -17,51 +19,225 @@
 #else
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/resource.h>
 #include <signal.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <cerrno>
 #include <unistd.h>
 #include <dirent.h>
 #endif
 
-AppLauncher::AppLauncher() {
+#ifdef __linux__
+#include <sched.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#endif
+
+#ifdef __APPLE__
+#include <crt_externs.h>
+#define environ (*_NSGetEnviron())
+#elif !defined(_WIN32)
+extern char** environ;
+#endif
+
+namespace {
+
+// 进程仍在运行（包括无响应）
+bool IsActiveStatus(const std::string& status) {
+  return status == "running" || status == "hung";
+}
+
+double WallClockMs() {
+  return std::chrono::duration<double, std::milli>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+AppLauncher::AppLauncher()
+  : snapshot_(std::make_shared<StatusSnapshot>()) {
+#ifdef __linux__
+  sampler_.SetSink([this](const std::string& appId, uint32_t processId, const ResourceSample& sample) {
+    OnSample(appId, processId, sample);
+  });
+  tracer_.SetSink([this](const std::string& appId, uint32_t processId, LaunchPhase phase, double offsetMs) {
+    RecordLaunchPhase(appId, processId, phase, offsetMs);
+  });
+  output_.SetSink([this](const std::string& appId, uint32_t processId, double offsetMs) {
+    RecordLaunchPhase(appId, processId, LaunchPhase::FirstOutput, offsetMs);
+  });
+  hangDetector_.SetSink([this](const std::string& appId, uint32_t processId, bool hung, HangReason reason, double stalledMs) {
+    OnHang(appId, processId, hung, reason, stalledMs);
+  });
+  crashReporter_.SetSink([this](const std::string& appId, uint32_t processId, const std::string& path) {
+    OnCrashReport(appId, processId, path);
+  });
+  // epoll 或 eventfd 不可用时监控线程退回轮询，进程都登记在 polledProcesses_ 中
+  InitMonitor();
+#endif
   monitorThread_ = std::thread(&AppLauncher::MonitorProcesses, this);
 }
 
 AppLauncher::~AppLauncher() {
+  // 先等待进行中的启动完成，之后不会再有新的进程登记
+  scheduler_.Shutdown();
+
   stopMonitor_ = true;
+  WakeMonitor();
   if (monitorThread_.joinable()) {
     monitorThread_.join();
   }
+#ifdef __linux__
+  ShutdownMonitor();
+#endif
 }
 
 bool AppLauncher::LaunchApp(const AppInfo& appInfo, std::string& errorMsg) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  LaunchTimeline timeline;
+  timeline.entry = appInfo.traceEntry > 0.0 ? appInfo.traceEntry : MonotonicMs();
 
-  // 检查是否已经在运行
-  if (runningApps_.find(appInfo.appId) != runningApps_.end()) {
-    errorMsg = "Application is already running";
-    return false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // 检查是否已经在运行。已结束的记录保留供状态查询，不阻止再次启动
+    auto runningIt = runningApps_.find(appInfo.appId);
+    if (runningIt != runningApps_.end() && IsActiveStatus(runningIt->second.status)) {
+      errorMsg = "Application is already running";
+      return false;
+    }
+    if (!launchingApps_.insert(appInfo.appId).second) {
+      errorMsg = "Application is already launching";
+      return false;
+    }
+    timeline.lockAcquired = MonotonicMs() - timeline.entry;
   }
 
+  // 预读与创建进程并行进行，加载器缺页时数据可能已在页缓存中
+  if (appInfo.prefetch) {
+    PrefetchOptions options;
+    options.extraPaths = appInfo.prefetchPaths;
+    std::string appId = appInfo.appId;
+    prefetcher_.Prefetch(appInfo.executablePath, options, [this, appId](const PrefetchResult& result) {
+      RecordPrefetch(appId, result);
+    });
+  }
+
+  // 创建进程期间不持有锁，避免阻塞状态查询
+  uint32_t processId = 0;
+  int outputFds[2] = { -1, -1 };
   bool success = false;
 
 #ifdef _WIN32
-  success = LaunchAppWindows(appInfo, errorMsg);
+  success = LaunchAppWindows(appInfo, processId, timeline, errorMsg);
+#elif defined(__linux__)
+  // 每次启动放入独立的 cgroup，用于跟踪整棵进程树
+  int cgroupProcsFd = -1;
+  std::string cgroupPath = PrepareSessionCgroup(cgroupProcsFd);
+  if (!cgroupPath.empty()) {
+    ApplyCgroupLimits(cgroupPath, appInfo.profile);
+  }
+  success = LaunchAppUnix(appInfo, cgroupProcsFd, processId, timeline, outputFds, errorMsg);
+  if (cgroupProcsFd >= 0) {
+    close(cgroupProcsFd);
+  }
+  if (!success && !cgroupPath.empty()) {
+    rmdir(cgroupPath.c_str());
+  }
 #else
-  success = LaunchAppUnix(appInfo, errorMsg);
+  success = LaunchAppUnix(appInfo, -1, processId, timeline, outputFds, errorMsg);
 #endif
 
-  if (success) {
-    LaunchRecord record;
-    record.appId = appInfo.appId;
-    record.startTime = GetCurrentTimeString();
-    record.status = "running";
+#ifdef __linux__
+  std::vector<FocusController::Target> focusTargets;
+  std::shared_ptr<TreeMembers> members;
+#endif
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto prefetchIt = pendingPrefetch_.find(appInfo.appId);
+    bool registering = false;
 
-    runningApps_[appInfo.appId] = record;
+    if (success) {
+      LaunchRecord record;
+      record.appId = appInfo.appId;
+      record.startTime = GetCurrentTimeString();
+      record.status = "running";
+      record.processId = processId;
+      record.startTimestamp = std::chrono::duration<double, std::milli>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+      record.launchLatency = timeline.execSucceeded - timeline.forked;
+      record.timeline = timeline;
+      if (prefetchIt != pendingPrefetch_.end()) {
+        record.prefetchBytes = static_cast<double>(prefetchIt->second.bytes);
+        record.prefetchTime = prefetchIt->second.duration;
+      }
+
+      runningApps_[appInfo.appId] = record;
+      PublishSnapshot();
+      JournalSessionEvent(JournalEventType::Launch, record);
+      EmitSessionEvent(record);
+      appProcesses_[appInfo.appId] = processId;
+#ifdef __linux__
+      if (appInfo.foreground) {
+        // 在登记新进程之前收集，前台应用本身不在其中
+        for (const auto& pair : trees_) {
+          FocusController::Target target;
+          target.processId = pair.first;
+          target.cgroupPath = pair.second.cgroupPath;
+          target.processes.push_back(pair.first);
+          target.processes.insert(target.processes.end(), pair.second.descendants.begin(), pair.second.descendants.end());
+          focusTargets.push_back(target);
+        }
+      }
+      // 采样、跟踪和专注模式的登记在锁外进行，期间进程结束时监控线程推迟收尾，
+      // appId 也继续留在 launchingApps_ 中，同一应用的下一次启动不会与登记交错
+      registeringProcesses_.insert(processId);
+      registering = true;
+      members = WatchProcess(appInfo.appId, processId, cgroupPath);
+#endif
+    }
+    if (prefetchIt != pendingPrefetch_.end()) {
+      pendingPrefetch_.erase(prefetchIt);
+    }
+    if (!registering) {
+      launchingApps_.erase(appInfo.appId);
+    }
+  }
+
+#ifdef __linux__
+  if (success) {
+    RegisterSession(appInfo, processId, cgroupPath, members, timeline.entry, outputFds, focusTargets);
   }
+#endif
 
   return success;
 }
 
+std::shared_future<LaunchOutcome> AppLauncher::ScheduleLaunch(const AppInfo& appInfo, LaunchScheduler::Completion done) {
+  return scheduler_.Submit(appInfo.appId, [this, appInfo] {
+    LaunchOutcome outcome;
+    outcome.success = LaunchApp(appInfo, outcome.errorMsg);
+    if (!outcome.success) {
+      // 重复请求（例如双击）在上一次启动完成后才到达时应用已在运行，与进行中的启动一样合并到现有会话
+      AppStatusView status = GetAppStatus(appInfo.appId);
+      if (status.record && IsActiveStatus(status.record->status)) {
+        outcome.success = true;
+        outcome.coalesced = true;
+        outcome.errorMsg.clear();
+      }
+    }
+    return outcome;
+  }, std::move(done));
+}
+
+void AppLauncher::SetLaunchConcurrency(uint32_t concurrency) {
+  scheduler_.SetConcurrency(concurrency);
+}
+
+LaunchSchedulerStats AppLauncher::GetLaunchSchedulerStats() const {
+  return scheduler_.GetStats();
+}
+
 bool AppLauncher::TerminateApp(const std::string& appId, std::string& errorMsg) {
   std::lock_guard<std::mutex> lock(mutex_);
 
@@ -76,17 +252,27 @@ bool AppLauncher::TerminateApp(const std::string& appId, std::string& errorMsg)
 #ifdef _WIN32
   success = TerminateAppWindows(it->second);
 #else
+#ifdef __linux__
+  // 被冻结或停止的进程收不到 SIGTERM，先恢复
+  focus_.Restore(it->second);
+#endif
   success = TerminateAppUnix(it->second);
+#ifdef __linux__
+  // 同时结束启动器派生出的其他后代进程
+  SignalProcessTree(it->second, SIGTERM);
+#endif
 #endif
 
   if (success) {
     // 更新记录状态
     auto recordIt = runningApps_.find(appId);
     if (recordIt != runningApps_.end()) {
-      recordIt->second.endTime = GetCurrentTimeString();
-      recordIt->second.duration = CalculateDuration(recordIt->second.startTime, recordIt->second.endTime);
+      FinishRecord(recordIt->second);
       recordIt->second.status = "completed";
       recordIt->second.exitCode = 0;
+      PublishSnapshot();
+      JournalSessionEvent(JournalEventType::Exit, recordIt->second);
+      EmitSessionEvent(recordIt->second);
     }
 
     appProcesses_.erase(it);
@@ -98,26 +284,99 @@ bool AppLauncher::TerminateApp(const std::string& appId, std::string& errorMsg)
   return success;
 }
 
-LaunchRecord AppLauncher::GetAppStatus(const std::string& appId) {
-  std::lock_guard<std::mutex> lock(mutex_);
+AppStatusView AppLauncher::GetAppStatus(const std::string& appId) const {
+  AppStatusView view;
+  view.snapshot = std::atomic_load(&snapshot_);
 
-  auto it = runningApps_.find(appId);
-  if (it != runningApps_.end()) {
-    return it->second;
+  auto it = view.snapshot->records.find(appId);
+  if (it != view.snapshot->records.end()) {
+    view.record = &it->second;
   }
+  return view;
+}
+
+StatusSnapshotPtr AppLauncher::GetAllRunningApps() const {
+  return std::atomic_load(&snapshot_);
+}
+
+void AppLauncher::PublishSnapshot() {
+  // 复制发生在写入方，只在记录变化（启动、退出、无响应、恢复、启动阶段、预读和崩溃报告完成）时调用，
+  // 每个会话至多十几次，频率远低于查询
+  auto snapshot = std::make_shared<StatusSnapshot>();
+  snapshot->records = runningApps_;
+  std::atomic_store(&snapshot_, StatusSnapshotPtr(std::move(snapshot)));
+}
+
+std::vector<ResourceSample> AppLauncher::GetResourceSeries(const std::string& appId) {
+#ifdef __linux__
+  return sampler_.GetSeries(appId);
+#else
+  return std::vector<ResourceSample>();
+#endif
+}
+
+std::string AppLauncher::TailOutput(const std::string& appId, size_t bytes) {
+#ifdef __linux__
+  return output_.Tail(appId, bytes);
+#else
+  (void)appId;
+  (void)bytes;
+  return "";
+#endif
+}
 
-  return LaunchRecord(); // 返回空记录
+void AppLauncher::SetOutputLog(const std::string& directory, uint64_t maxBytes, uint32_t maxFiles) {
+#ifdef __linux__
+  output_.SetLogDirectory(directory, maxBytes, maxFiles);
+#else
+  (void)directory;
+  (void)maxBytes;
+  (void)maxFiles;
+#endif
 }
 
-std::vector<LaunchRecord> AppLauncher::GetAllRunningApps() {
+void AppLauncher::SetCrashReportDirectory(const std::string& directory) {
+#ifdef __linux__
+  crashReporter_.SetDirectory(directory);
+  // maps 快照只在需要崩溃报告时采集
+  sampler_.SetCaptureSnapshot(!directory.empty());
+#else
+  (void)directory;
+#endif
+}
+
+void AppLauncher::OnCrashReport(const std::string& appId, uint32_t processId, const std::string& path) {
   std::lock_guard<std::mutex> lock(mutex_);
 
-  std::vector<LaunchRecord> records;
-  for (const auto& pair : runningApps_) {
-    records.push_back(pair.second);
+  auto it = runningApps_.find(appId);
+  if (it == runningApps_.end() || it->second.processId != processId) {
+    return; // 已被重新启动，报告文件仍保留在目录中
   }
+  it->second.crashReport = path;
+  // 报告是崩溃状态的最后一部分，每次崩溃只发布一次
+  PublishSnapshot();
 
-  return records;
+  LauncherEvent event;
+  event.type = LauncherEventType::CrashReport;
+  event.appId = appId;
+  event.processId = processId;
+  event.timestamp = WallClockMs();
+  event.path = path;
+  EmitEvent(event);
+}
+
+void AppLauncher::SetHangWindow(uint32_t windowMs) {
+#ifdef __linux__
+  hangDetector_.SetWindow(windowMs);
+#else
+  (void)windowMs;
+#endif
+}
+
+void AppLauncher::SetSampleInterval(uint32_t intervalMs) {
+#ifdef __linux__
+  sampler_.SetInterval(intervalMs);
+#endif
 }
 
 std::string AppLauncher::GetAppIcon(const std::string& appPath) {
@@ -128,66 +387,309 @@ std::string AppLauncher::GetAppIcon(const std::string& appPath) {
 #endif
 }
 
-void AppLauncher::MonitorProcesses() {
-  while (!stopMonitor_) {
-    std::this_thread::sleep_for(std::chrono::seconds(2));
+std::optional<LaunchRecord> AppLauncher::RecordProcessExit(const std::string& appId, uint32_t processId,
+                                                           const ExitInfo& exitInfo) {
+  auto recordIt = runningApps_.find(appId);
+  if (recordIt == runningApps_.end() || recordIt->second.processId != processId) {
+    return std::nullopt; // 已被重新启动
+  }
 
-    std::lock_guard<std::mutex> lock(mutex_);
+  LaunchRecord& record = recordIt->second;
+  record.exitCode = exitInfo.exitCode;
+  record.exitSignal = exitInfo.exitSignal;
+  record.coreDumped = exitInfo.coreDumped;
+  record.userCpuTime = exitInfo.userCpuTime;
+  record.systemCpuTime = exitInfo.systemCpuTime;
+  record.maxRss = exitInfo.maxRss;
+  record.minorFaults = exitInfo.minorFaults;
+  record.majorFaults = exitInfo.majorFaults;
+
+  auto it = appProcesses_.find(appId);
+  if (it == appProcesses_.end() || it->second != processId) {
+    PublishSnapshot();
+    return std::nullopt; // 已由 TerminateApp 结束，只补充退出详情
+  }
+
+  FinishRecord(record);
+  bool crashed = exitInfo.exitCode != 0 || exitInfo.exitSignal != 0;
+  record.status = crashed ? "crashed" : "completed";
+  PublishSnapshot();
+  JournalSessionEvent(JournalEventType::Exit, record);
+  EmitSessionEvent(record);
+
+  appProcesses_.erase(it);
+  if (crashed) {
+    return record;
+  }
+  return std::nullopt;
+}
+
+void AppLauncher::JournalSessionEvent(JournalEventType type, const LaunchRecord& record) {
+  if (!journal_.IsOpen()) {
+    return;
+  }
+
+  JournalRecord entry;
+  entry.type = static_cast<uint32_t>(type);
+  entry.processId = record.processId;
+  entry.timestamp = std::chrono::duration<double, std::milli>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+  entry.startTime = record.startTimestamp;
+  strncpy(entry.appId, record.appId.c_str(), sizeof(entry.appId) - 1);
+
+  if (type == JournalEventType::Exit) {
+    entry.exitCode = record.exitCode;
+    entry.exitSignal = record.exitSignal;
+    entry.status = record.status == "crashed" ? 2 : 1;
+    entry.values[0] = record.duration;
+    entry.values[1] = record.userCpuTime;
+    entry.values[2] = record.systemCpuTime;
+    entry.values[3] = static_cast<double>(record.maxRss);
+  }
+
+  journal_.Append(entry);
+}
+
+void AppLauncher::PrefetchApp(const std::string& executablePath, const PrefetchOptions& options, AppPrefetcher::Completion done) {
+  prefetcher_.Prefetch(executablePath, options, std::move(done));
+}
 
-    for (auto it = appProcesses_.begin(); it != appProcesses_.end(); ) {
-      uint32_t processId = it->second;
-      std::string appId = it->first;
+void AppLauncher::RecordLaunchPhase(const std::string& appId, uint32_t processId, LaunchPhase phase, double offsetMs) {
+  std::lock_guard<std::mutex> lock(mutex_);
 
-      bool isRunning = false;
+  auto it = runningApps_.find(appId);
+  if (it == runningApps_.end() || it->second.processId != processId) {
+    return;
+  }
+
+  LaunchTimeline& timeline = it->second.timeline;
+  switch (phase) {
+    case LaunchPhase::LoaderDone: timeline.loaderDone = offsetMs; break;
+    case LaunchPhase::FirstOutput: timeline.firstOutput = offsetMs; break;
+    case LaunchPhase::FirstCpuBurst: timeline.firstCpuBurst = offsetMs; break;
+  }
+  PublishSnapshot();
+}
+
+void AppLauncher::RecordPrefetch(const std::string& appId, const PrefetchResult& result) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = runningApps_.find(appId);
+  if (it != runningApps_.end() && IsActiveStatus(it->second.status)) {
+    it->second.prefetchBytes = static_cast<double>(result.bytes);
+    it->second.prefetchTime = result.duration;
+    PublishSnapshot();
+    return;
+  }
+
+  // 进程尚未创建完成，由 LaunchApp 写入记录
+  if (launchingApps_.count(appId)) {
+    pendingPrefetch_[appId] = result;
+  }
+}
+
+bool AppLauncher::SetFocusOptions(const FocusOptions& options, std::string& errorMsg) {
+#ifdef __linux__
+  (void)errorMsg;
+  focus_.SetOptions(options);
+  return true;
+#else
+  (void)options;
+  errorMsg = "Focus mode is only supported on Linux";
+  return false;
+#endif
+}
+
+FocusState AppLauncher::GetFocusState() const {
+#ifdef __linux__
+  return focus_.GetState();
+#else
+  return FocusState();
+#endif
+}
+
+void AppLauncher::EndFocus() {
+#ifdef __linux__
+  focus_.Disengage();
+#endif
+}
+
+void AppLauncher::SetEventListener(LauncherEventListener listener) {
+  std::shared_ptr<const LauncherEventListener> next;
+  if (listener) {
+    next = std::make_shared<const LauncherEventListener>(std::move(listener));
+  }
+  std::atomic_store(&listener_, next);
+}
+
+void AppLauncher::EmitEvent(const LauncherEvent& event) {
+  std::shared_ptr<const LauncherEventListener> listener = std::atomic_load(&listener_);
+  if (listener) {
+    (*listener)(event);
+  }
+}
+
+void AppLauncher::EmitSessionEvent(const LaunchRecord& record) {
+  LauncherEvent event;
+  event.type = record.status == "running" ? LauncherEventType::Launched :
+               record.status == "crashed" ? LauncherEventType::Crashed : LauncherEventType::Exited;
+  event.appId = record.appId;
+  event.processId = record.processId;
+  event.timestamp = std::chrono::duration<double, std::milli>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+  event.exitCode = record.exitCode;
+  event.exitSignal = record.exitSignal;
+  event.duration = record.duration;
+  EmitEvent(event);
+}
+
+bool AppLauncher::OpenJournal(const std::string& path, int syncIntervalMs, bool includeSamples, std::string& errorMsg) {
+  if (!journal_.Open(path, syncIntervalMs, errorMsg)) {
+    return false;
+  }
+
+  journalSamples_ = includeSamples;
+  return true;
+}
+
+void AppLauncher::OnSample(const std::string& appId, uint32_t processId, const ResourceSample& sample) {
+  if (journalSamples_) {
+    JournalRecord entry;
+    entry.type = static_cast<uint32_t>(JournalEventType::Sample);
+    entry.processId = processId;
+    entry.timestamp = sample.timestamp;
+    entry.values[0] = sample.cpuPercent;
+    entry.values[1] = sample.rss;
+    entry.values[2] = sample.readBytes;
+    entry.values[3] = sample.writeBytes;
+    strncpy(entry.appId, appId.c_str(), sizeof(entry.appId) - 1);
+    journal_.Append(entry);
+  }
+
+  LauncherEvent event;
+  event.type = LauncherEventType::Sample;
+  event.appId = appId;
+  event.processId = processId;
+  event.timestamp = sample.timestamp;
+  event.sample = sample;
+  EmitEvent(event);
+}
+
+void AppLauncher::OnHang(const std::string& appId, uint32_t processId, bool hung, HangReason reason, double stalledMs) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = runningApps_.find(appId);
+  if (it == runningApps_.end() || it->second.processId != processId || !IsActiveStatus(it->second.status)) {
+    return;
+  }
+
+  LaunchRecord& record = it->second;
+  double now = WallClockMs();
+  if (hung) {
+    if (record.status == "hung") {
+      return;
+    }
+#ifdef __linux__
+    // 专注模式冻结或停止的应用本来就不会推进
+    if (focus_.IsDemoted(processId)) {
+      return;
+    }
+#endif
+    record.status = "hung";
+    record.hungSince = now - stalledMs;
+    record.hangReason = reason == HangReason::UninterruptibleSleep ? "uninterruptible" : "no-progress";
+  }
+  else {
+    if (record.status != "hung") {
+      return;
+    }
+    record.hungDuration += (now - record.hungSince) / 1000.0;
+    record.hungSince = 0.0;
+    record.hangReason.clear();
+    record.status = "running";
+  }
+  PublishSnapshot();
+
+  LauncherEvent event;
+  event.type = hung ? LauncherEventType::Hung : LauncherEventType::Recovered;
+  event.appId = appId;
+  event.processId = processId;
+  event.timestamp = now;
+  event.duration = stalledMs / 1000.0;
+  EmitEvent(event);
+}
+
+std::vector<JournalRecord> AppLauncher::DrainJournal(size_t maxRecords) {
+  return journal_.Drain(maxRecords);
+}
+
+void AppLauncher::AcknowledgeJournal(uint64_t sequence) {
+  journal_.Acknowledge(sequence);
+}
+
+void AppLauncher::FlushJournal() {
+  journal_.Flush();
+}
+
+#ifndef __linux__
+void AppLauncher::WakeMonitor() {
+  monitorCv_.notify_all();
+}
+
+void AppLauncher::MonitorProcesses() {
+  struct ProcessState {
+    std::string appId;
+    uint32_t processId;
+    bool isRunning;
+    ExitInfo exitInfo;
+  };
 
+  while (!stopMonitor_) {
+    std::vector<ProcessState> states;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      monitorCv_.wait_for(lock, std::chrono::seconds(2), [this] { return stopMonitor_.load(); });
+      if (stopMonitor_) {
+        break;
+      }
+
+      for (const auto& pair : appProcesses_) {
+        states.push_back({ pair.first, pair.second, true, ExitInfo() });
+      }
+    }
+
+    // 在锁外检查进程状态，避免系统调用阻塞查询
+    for (auto& state : states) {
 #ifdef _WIN32
-      HANDLE process = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, processId);
+      HANDLE process = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, state.processId);
       if (process) {
         DWORD exitCode;
         if (GetExitCodeProcess(process, &exitCode)) {
-          isRunning = (exitCode == STILL_ACTIVE);
+          state.isRunning = (exitCode == STILL_ACTIVE);
+          if (!state.isRunning) {
+            state.exitInfo.exitCode = static_cast<int>(exitCode);
+          }
         }
         CloseHandle(process);
       }
-#else
-      // 检查进程是否存在
-      if (kill(processId, 0) == 0) {
-        isRunning = true;
+      else {
+        state.isRunning = false;
       }
+#else
+      // 回收已退出的子进程，避免僵尸进程被误判为运行中
+      state.isRunning = !ReapProcess(state.processId, state.exitInfo);
 #endif
+    }
 
-      if (!isRunning) {
-        // 进程已结束
-        auto recordIt = runningApps_.find(appId);
-        if (recordIt != runningApps_.end()) {
-          recordIt->second.endTime = GetCurrentTimeString();
-          recordIt->second.duration = CalculateDuration(recordIt->second.startTime, recordIt->second.endTime);
-          recordIt->second.status = "completed";
-
-          // 尝试获取退出代码
-#ifdef _WIN32
-          HANDLE process = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, processId);
-          if (process) {
-            DWORD exitCode;
-            if (GetExitCodeProcess(process, &exitCode) && exitCode != STILL_ACTIVE) {
-              recordIt->second.exitCode = exitCode;
-              if (exitCode != 0) {
-                recordIt->second.status = "crashed";
-              }
-            }
-            CloseHandle(process);
-          }
-#endif
-        }
-
-        it = appProcesses_.erase(it);
-      }
-      else {
-        ++it;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& state : states) {
+      if (!state.isRunning) {
+        RecordProcessExit(state.appId, state.processId, state.exitInfo);
       }
     }
   }
 }
+#endif
 
 std::string AppLauncher::GetCurrentTimeString() {
   auto now = std::chrono::system_clock::now();
@@ -215,10 +717,103 @@ double AppLauncher::CalculateDuration(const std::string& startTime, const std::s
   return std::difftime(endT, startT);
 }
 
+void AppLauncher::FinishRecord(LaunchRecord& record) {
+  record.endTime = GetCurrentTimeString();
+  if (record.hungSince > 0.0) {
+    record.hungDuration += (WallClockMs() - record.hungSince) / 1000.0;
+    record.hungSince = 0.0;
+    record.hangReason.clear();
+  }
+  double duration = CalculateDuration(record.startTime, record.endTime) - record.hungDuration;
+  record.duration = duration > 0.0 ? duration : 0.0;
+}
+
 // Windows 特定实现
 #ifdef _WIN32
 
-bool AppLauncher::LaunchAppWindows(const AppInfo& appInfo, std::string& errorMsg) {
+namespace {
+
+// 按 CommandLineToArgvW 的规则为参数加引号
+void AppendQuotedArg(std::string& cmdLine, const std::string& arg) {
+  if (!arg.empty() && arg.find_first_of(" \t\n\v\"") == std::string::npos) {
+    cmdLine += arg;
+    return;
+  }
+
+  cmdLine += '"';
+  size_t backslashes = 0;
+  for (char c : arg) {
+    if (c == '\\') {
+      backslashes++;
+      continue;
+    }
+    if (c == '"') {
+      cmdLine.append(backslashes * 2 + 1, '\\');
+    }
+    else {
+      cmdLine.append(backslashes, '\\');
+    }
+    backslashes = 0;
+    cmdLine += c;
+  }
+  cmdLine.append(backslashes * 2, '\\');
+  cmdLine += '"';
+}
+
+// 以当前环境为基础合并覆盖项，生成 CreateProcess 需要的环境块
+std::vector<char> BuildEnvironmentBlock(const std::map<std::string, std::string>& overrides) {
+  std::map<std::string, std::string> merged;
+  LPCH strings = GetEnvironmentStringsA();
+  for (LPCH entry = strings; entry && *entry; entry += strlen(entry) + 1) {
+    // 以 '=' 开头的是驱动器当前目录等隐藏变量
+    const char* equals = strchr(entry + 1, '=');
+    if (equals) {
+      merged[std::string(entry, equals - entry)] = equals + 1;
+    }
+  }
+  if (strings) {
+    FreeEnvironmentStringsA(strings);
+  }
+  for (const auto& pair : overrides) {
+    merged[pair.first] = pair.second;
+  }
+
+  std::vector<char> block;
+  for (const auto& pair : merged) {
+    block.insert(block.end(), pair.first.begin(), pair.first.end());
+    block.push_back('=');
+    block.insert(block.end(), pair.second.begin(), pair.second.end());
+    block.push_back('\0');
+  }
+  block.push_back('\0');
+  return block;
+}
+
+// 把 nice 值映射到最接近的优先级类
+DWORD NiceToPriorityClass(int nice) {
+  if (nice <= -15) return HIGH_PRIORITY_CLASS;
+  if (nice < 0) return ABOVE_NORMAL_PRIORITY_CLASS;
+  if (nice == 0) return NORMAL_PRIORITY_CLASS;
+  if (nice < 15) return BELOW_NORMAL_PRIORITY_CLASS;
+  return IDLE_PRIORITY_CLASS;
+}
+
+} // namespace
+
+bool AppLauncher::LaunchAppWindows(const AppInfo& appInfo, uint32_t& processId, LaunchTimeline& timeline, std::string& errorMsg) {
+  const LaunchProfile& profile = appInfo.profile;
+
+  DWORD_PTR affinityMask = 0;
+  for (int cpu : profile.cpuAffinity) {
+    if (cpu < 0 || cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+      errorMsg = "Invalid CPU in affinity: " + std::to_string(cpu);
+      return false;
+    }
+    affinityMask |= static_cast<DWORD_PTR>(1) << cpu;
+  }
+
+  timeline.forked = MonotonicMs() - timeline.entry;
+
   STARTUPINFO si;
   PROCESS_INFORMATION pi;
 
@@ -227,18 +822,35 @@ bool AppLauncher::LaunchAppWindows(const AppInfo& appInfo, std::string& errorMsg
   ZeroMemory(&pi, sizeof(pi));
 
   // 创建可修改的字符串
-  std::vector<char> cmdLine(appInfo.executablePath.begin(), appInfo.executablePath.end());
+  std::string commandLine;
+  AppendQuotedArg(commandLine, appInfo.executablePath);
+  for (const auto& arg : profile.args) {
+    commandLine += ' ';
+    AppendQuotedArg(commandLine, arg);
+  }
+  std::vector<char> cmdLine(commandLine.begin(), commandLine.end());
   cmdLine.push_back('\0');
 
+  std::vector<char> environment;
+  if (!profile.env.empty()) {
+    environment = BuildEnvironmentBlock(profile.env);
+  }
+
+  // 先挂起主线程，设置好亲和性和优先级后再恢复
+  DWORD creationFlags = CREATE_SUSPENDED;
+  if (profile.nice) {
+    creationFlags |= NiceToPriorityClass(*profile.nice);
+  }
+
   if (!CreateProcess(
     NULL,           // 应用程序名
     cmdLine.data(), // 命令行
     NULL,           // 进程安全属性
     NULL,           // 线程安全属性
     FALSE,          // 继承句柄
-    0,              // 创建标志
-    NULL,           // 环境变量
-    NULL,           // 当前目录
+    creationFlags,  // 创建标志
+    environment.empty() ? NULL : environment.data(), // 环境变量
+    profile.cwd.empty() ? NULL : profile.cwd.c_str(), // 当前目录
     &si,            // STARTUPINFO
     &pi             // PROCESS_INFORMATION
   )) {
@@ -246,7 +858,17 @@ bool AppLauncher::LaunchAppWindows(const AppInfo& appInfo, std::string& errorMsg
     return false;
   }
 
-  appProcesses_[appInfo.appId] = pi.dwProcessId;
+  if (affinityMask != 0 && !SetProcessAffinityMask(pi.hProcess, affinityMask)) {
+    errorMsg = "Failed to set CPU affinity. Error code: " + std::to_string(GetLastError());
+    TerminateProcess(pi.hProcess, 1);
+    CloseHandle(pi.hProcess);
+    CloseHandle(pi.hThread);
+    return false;
+  }
+
+  ResumeThread(pi.hThread);
+  processId = pi.dwProcessId;
+  timeline.execSucceeded = MonotonicMs() - timeline.entry;
 
   CloseHandle(pi.hProcess);
   CloseHandle(pi.hThread);
@@ -273,29 +895,370 @@ std::string AppLauncher::GetAppIconWindows(const std::string& appPath) {
 #else
 
 // Unix (Linux/macOS) 特定实现
-bool AppLauncher::LaunchAppUnix(const AppInfo& appInfo, std::string& errorMsg) {
+
+namespace {
+
+// 子进程通过状态管道回传失败的步骤和 errno
+enum SpawnStage : int {
+  kStageExec = 0,
+  kStageChdir,
+  kStageAffinity,
+  kStageScheduler,
+  kStageNice,
+  kStageIoPriority,
+  kStageThp,
+};
+
+struct SpawnFailure {
+  int stage;
+  int error;
+};
+
+const char* SpawnStageMessage(int stage) {
+  switch (stage) {
+    case kStageChdir: return "Failed to change directory";
+    case kStageAffinity: return "Failed to set CPU affinity";
+    case kStageScheduler: return "Failed to set scheduling policy";
+    case kStageNice: return "Failed to set nice value";
+    case kStageIoPriority: return "Failed to set I/O priority";
+    case kStageThp: return "Failed to disable transparent huge pages";
+    default: return "Failed to execute";
+  }
+}
+
+// fork 前准备好的启动配置。vfork 的子进程只使用这里的数据，不分配内存
+struct SpawnPlan {
+  std::vector<char*> argv;
+  std::vector<std::string> envStrings;
+  std::vector<char*> envp;     // 为空时继承 environ
+  const char* cwd = nullptr;
+  bool setNice = false;
+  int nice = 0;
+#ifdef __linux__
+  bool setAffinity = false;
+  cpu_set_t affinity;
+  bool setScheduler = false;
+  int schedPolicy = SCHED_OTHER;
+  struct sched_param schedParam {};
+  int ioPriority = -1;
+  bool disableThp = false;
+#endif
+};
+
+bool PrepareSpawnPlan(const AppInfo& appInfo, SpawnPlan& plan, std::string& errorMsg) {
+  const LaunchProfile& profile = appInfo.profile;
+
+  plan.argv.push_back(const_cast<char*>(appInfo.executablePath.c_str()));
+  for (const auto& arg : profile.args) {
+    plan.argv.push_back(const_cast<char*>(arg.c_str()));
+  }
+  plan.argv.push_back(nullptr);
+
+  if (!profile.env.empty()) {
+    for (char** entry = environ; entry && *entry; entry++) {
+      const char* equals = strchr(*entry, '=');
+      std::string key = equals ? std::string(*entry, equals - *entry) : std::string(*entry);
+      if (profile.env.find(key) == profile.env.end()) {
+        plan.envStrings.push_back(*entry);
+      }
+    }
+    for (const auto& pair : profile.env) {
+      plan.envStrings.push_back(pair.first + "=" + pair.second);
+    }
+    for (auto& entry : plan.envStrings) {
+      plan.envp.push_back(&entry[0]);
+    }
+    plan.envp.push_back(nullptr);
+  }
+
+  if (!profile.cwd.empty()) {
+    plan.cwd = profile.cwd.c_str();
+  }
+  if (profile.nice) {
+    plan.setNice = true;
+    plan.nice = *profile.nice;
+  }
+
+#ifdef __linux__
+  if (!profile.cpuAffinity.empty()) {
+    CPU_ZERO(&plan.affinity);
+    for (int cpu : profile.cpuAffinity) {
+      if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        errorMsg = "Invalid CPU in affinity: " + std::to_string(cpu);
+        return false;
+      }
+      CPU_SET(cpu, &plan.affinity);
+    }
+    plan.setAffinity = true;
+  }
+
+  if (!profile.schedPolicy.empty()) {
+    static const std::map<std::string, int> policies = {
+      { "other", SCHED_OTHER }, { "batch", SCHED_BATCH }, { "idle", SCHED_IDLE },
+      { "fifo", SCHED_FIFO }, { "rr", SCHED_RR },
+    };
+    auto it = policies.find(profile.schedPolicy);
+    if (it == policies.end()) {
+      errorMsg = "Unknown scheduling policy: " + profile.schedPolicy;
+      return false;
+    }
+    plan.setScheduler = true;
+    plan.schedPolicy = it->second;
+    bool realtime = it->second == SCHED_FIFO || it->second == SCHED_RR;
+    plan.schedParam.sched_priority = realtime ? profile.schedPriority : 0;
+  }
+
+  if (!profile.ioClass.empty()) {
+    // linux/ioprio.h: class << 13 | level
+    static const std::map<std::string, int> classes = {
+      { "realtime", 1 }, { "best-effort", 2 }, { "idle", 3 },
+    };
+    auto it = classes.find(profile.ioClass);
+    if (it == classes.end()) {
+      errorMsg = "Unknown I/O class: " + profile.ioClass;
+      return false;
+    }
+    int level = it->second == 3 ? 0 : std::min(std::max(profile.ioLevel, 0), 7);
+    plan.ioPriority = (it->second << 13) | level;
+  }
+
+  plan.disableThp = profile.disableThp;
+#else
+  if (!profile.cpuAffinity.empty() || !profile.schedPolicy.empty() || !profile.ioClass.empty() || profile.disableThp) {
+    errorMsg = "CPU affinity, scheduling policy, I/O class and THP settings are only supported on Linux";
+    return false;
+  }
+#endif
+
+  return true;
+}
+
+// 在子进程中应用启动配置，失败时返回对应步骤
+int ApplySpawnPlan(const SpawnPlan& plan) {
+  if (plan.cwd && chdir(plan.cwd) != 0) {
+    return kStageChdir;
+  }
+#ifdef __linux__
+  if (plan.setAffinity && sched_setaffinity(0, sizeof(plan.affinity), &plan.affinity) != 0) {
+    return kStageAffinity;
+  }
+  if (plan.setScheduler && sched_setscheduler(0, plan.schedPolicy, &plan.schedParam) != 0) {
+    return kStageScheduler;
+  }
+#endif
+  if (plan.setNice && setpriority(PRIO_PROCESS, 0, plan.nice) != 0) {
+    return kStageNice;
+  }
+#ifdef __linux__
+  if (plan.ioPriority >= 0 && syscall(SYS_ioprio_set, 1 /* IOPRIO_WHO_PROCESS */, 0, plan.ioPriority) != 0) {
+    return kStageIoPriority;
+  }
+  if (plan.disableThp && prctl(PR_SET_THP_DISABLE, 1, 0, 0, 0) != 0) {
+    return kStageThp;
+  }
+#endif
+  return -1;
+}
+
+} // namespace
+bool AppLauncher::LaunchAppUnix(const AppInfo& appInfo, int cgroupProcsFd, uint32_t& processId, LaunchTimeline& timeline,
+                                int outputFds[2], std::string& errorMsg) {
+  // 子进程在启动配置或 exec 失败时通过该管道回传 SpawnFailure；exec 成功后写端随 CLOEXEC 关闭
+  int statusPipe[2];
+#ifdef __linux__
+  if (pipe2(statusPipe, O_CLOEXEC) != 0) {
+#else
+  if (pipe(statusPipe) != 0 ||
+      fcntl(statusPipe[0], F_SETFD, FD_CLOEXEC) != 0 ||
+      fcntl(statusPipe[1], F_SETFD, FD_CLOEXEC) != 0) {
+#endif
+    errorMsg = "Failed to create status pipe: " + std::string(strerror(errno));
+    return false;
+  }
+
+#ifdef __linux__
+  // 捕获输出时 stdout/stderr 各用一根管道，读端交给 OutputCapture。
+  // 捕获线程未能启动时不创建管道，否则读端被关闭后子进程写输出会收到 SIGPIPE
+  int outputPipes[2][2] = { { -1, -1 }, { -1, -1 } };
+  if (appInfo.captureOutput && output_.IsRunning()) {
+    for (auto& outputPipe : outputPipes) {
+      if (pipe2(outputPipe, O_CLOEXEC) != 0) {
+        outputPipe[0] = outputPipe[1] = -1;
+      }
+    }
+  }
+#endif
+
+  // vfork 之后子进程不能分配内存，参数需提前准备好
+  SpawnPlan plan;
+  if (!PrepareSpawnPlan(appInfo, plan, errorMsg)) {
+    close(statusPipe[0]);
+    close(statusPipe[1]);
+#ifdef __linux__
+    for (auto& outputPipe : outputPipes) {
+      if (outputPipe[0] >= 0) {
+        close(outputPipe[0]);
+        close(outputPipe[1]);
+      }
+    }
+#endif
+    return false;
+  }
+  const char* path = appInfo.executablePath.c_str();
+
+  // 屏蔽信号，防止父进程的信号处理函数在共享地址空间的子进程中运行
+  sigset_t allSignals, oldMask;
+  sigfillset(&allSignals);
+  pthread_sigmask(SIG_SETMASK, &allSignals, &oldMask);
+
+  timeline.forked = MonotonicMs() - timeline.entry;
+#ifdef __linux__
+  // vfork 不复制父进程页表，避免 fork 大内存的 Electron 主进程
+  pid_t pid = vfork();
+#else
   pid_t pid = fork();
+#endif
 
   if (pid == 0) {
-    // 子进程
-    execl(appInfo.executablePath.c_str(), appInfo.executablePath.c_str(), NULL);
-    exit(1); // 如果exec失败
+    // 子进程：恢复默认信号处理后再解除屏蔽
+    for (int sig = 1; sig < NSIG; sig++) {
+      struct sigaction sa;
+      if (sigaction(sig, nullptr, &sa) == 0 && sa.sa_handler != SIG_IGN && sa.sa_handler != SIG_DFL) {
+        sa.sa_handler = SIG_DFL;
+        sigaction(sig, &sa, nullptr);
+      }
+    }
+    sigprocmask(SIG_SETMASK, &oldMask, nullptr);
+
+    // 新会话：整棵进程树共享会话 ID，并可通过进程组统一发送信号
+    setsid();
+    if (cgroupProcsFd >= 0) {
+      ssize_t ignored = write(cgroupProcsFd, "0", 1);
+      (void)ignored;
+    }
+#ifdef __linux__
+    // dup2 后的 fd 不带 CLOEXEC，管道原始 fd 会在 exec 时关闭
+    if (outputPipes[0][1] >= 0) {
+      dup2(outputPipes[0][1], STDOUT_FILENO);
+    }
+    if (outputPipes[1][1] >= 0) {
+      dup2(outputPipes[1][1], STDERR_FILENO);
+    }
+#endif
+
+    SpawnFailure failure = { ApplySpawnPlan(plan), 0 };
+    if (failure.stage < 0) {
+      failure.stage = kStageExec;
+      if (plan.envp.empty()) {
+        execv(path, plan.argv.data());
+      }
+      else {
+        execve(path, plan.argv.data(), plan.envp.data());
+      }
+    }
+    failure.error = errno;
+    ssize_t ignored = write(statusPipe[1], &failure, sizeof(failure));
+    (void)ignored;
+    _exit(127);
   }
-  else if (pid > 0) {
-    // 父进程
-    appProcesses_[appInfo.appId] = pid;
-    return true;
+
+  int forkErrno = errno;
+  pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+  close(statusPipe[1]);
+#ifdef __linux__
+  for (auto& outputPipe : outputPipes) {
+    if (outputPipe[1] >= 0) {
+      close(outputPipe[1]);
+    }
   }
-  else {
-    errorMsg = "Failed to fork process";
+  auto closeOutputs = [&outputPipes] {
+    for (auto& outputPipe : outputPipes) {
+      if (outputPipe[0] >= 0) {
+        close(outputPipe[0]);
+      }
+    }
+  };
+#endif
+
+  if (pid < 0) {
+    close(statusPipe[0]);
+#ifdef __linux__
+    closeOutputs();
+#endif
+    errorMsg = "Failed to fork process: " + std::string(strerror(forkErrno));
+    return false;
+  }
+
+  // 读到 EOF 表示 exec 成功，读到失败信息表示启动配置或 exec 失败
+  SpawnFailure failure = { kStageExec, 0 };
+  ssize_t bytes;
+  do {
+    bytes = read(statusPipe[0], &failure, sizeof(failure));
+  } while (bytes < 0 && errno == EINTR);
+  close(statusPipe[0]);
+
+  timeline.execSucceeded = MonotonicMs() - timeline.entry;
+
+  if (bytes == sizeof(failure)) {
+    waitpid(pid, nullptr, 0);
+#ifdef __linux__
+    closeOutputs();
+#endif
+    errorMsg = std::string(SpawnStageMessage(failure.stage)) + " for " + appInfo.executablePath + ": " + strerror(failure.error);
     return false;
   }
+
+  processId = static_cast<uint32_t>(pid);
+#ifdef __linux__
+  outputFds[0] = outputPipes[0][0];
+  outputFds[1] = outputPipes[1][0];
+#endif
+  return true;
 }
 
 bool AppLauncher::TerminateAppUnix(uint32_t processId) {
+  // 子进程启动时调用了 setsid，优先向整个进程组发送信号
+  if (kill(-static_cast<pid_t>(processId), SIGTERM) == 0) {
+    return true;
+  }
   return kill(processId, SIGTERM) == 0;
 }
 
+bool AppLauncher::ReapProcess(uint32_t processId, ExitInfo& exitInfo) {
+  int status = 0;
+  struct rusage usage {};
+  pid_t result = wait4(static_cast<pid_t>(processId), &status, WNOHANG, &usage);
+
+  if (result == 0) {
+    return false; // 仍在运行
+  }
+  if (result < 0) {
+    // ECHILD：已被其他地方回收或不是子进程，无法获取退出详情
+    return errno != EINTR;
+  }
+
+  if (WIFEXITED(status)) {
+    exitInfo.exitCode = WEXITSTATUS(status);
+  }
+  else if (WIFSIGNALED(status)) {
+    exitInfo.exitSignal = WTERMSIG(status);
+    exitInfo.exitCode = 128 + exitInfo.exitSignal;
+#ifdef WCOREDUMP
+    exitInfo.coreDumped = WCOREDUMP(status) != 0;
+#endif
+  }
+
+  exitInfo.userCpuTime = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+  exitInfo.systemCpuTime = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+  exitInfo.maxRss = usage.ru_maxrss;
+  exitInfo.minorFaults = usage.ru_minflt;
+  exitInfo.majorFaults = usage.ru_majflt;
+#ifdef __APPLE__
+  exitInfo.maxRss /= 1024; // macOS 以字节为单位
+#endif
+  return true;
+}
+
 std::string AppLauncher::GetAppIconUnix(const std::string& appPath) {
   // Unix系统图标处理
   return ""; // 占位符
@@ -9,11 +9,60 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
+#include <set>
+#include <optional>
+#include <memory>
+#include <functional>
+
+#include "process_sampler.h"
+#include "session_journal.h"
+#include "app_prefetcher.h"
+#include "launch_tracer.h"
+#include "focus_controller.h"
+#include "launch_scheduler.h"
+#include "hang_detector.h"
+#include "output_capture.h"
+#include "crash_reporter.h"
+
+// 启动配置，在 fork 与 exec 之间由子进程应用；未设置的项继承启动器的值
+struct LaunchProfile {
+  std::vector<std::string> args;              // 不含 argv[0]
+  std::map<std::string, std::string> env;     // 覆盖或追加到启动器的环境变量
+  std::string cwd;
+  std::vector<int> cpuAffinity;               // 允许运行的 CPU 编号
+  std::optional<int> nice;                    // -20 ~ 19
+  std::string schedPolicy;                    // "other" | "batch" | "idle" | "fifo" | "rr"（仅 Linux）
+  int schedPriority = 0;                      // fifo/rr 的优先级
+  std::string ioClass;                        // "realtime" | "best-effort" | "idle"（仅 Linux）
+  int ioLevel = 4;                            // 0（最高）~ 7
+  bool disableThp = false;                    // PR_SET_THP_DISABLE，进程及其子进程不使用透明大页
+  std::optional<uint32_t> cpuWeight;          // cgroup v2 cpu.weight（1 ~ 10000）
+  std::optional<uint64_t> memoryHigh;         // cgroup v2 memory.high（字节）
+};
 
 struct AppInfo {
   std::string appId;
   std::string executablePath;
   std::string iconPath; // 可选的图标路径
+  LaunchProfile profile;
+  bool prefetch = false; // 启动的同时在后台预读可执行文件和依赖库
+  std::vector<std::string> prefetchPaths; // 一并预读的数据文件或目录
+  bool captureOutput = false; // 由启动器接管 stdout/stderr，写入环形缓冲区和日志并记录首次输出时间（仅 Linux）
+  bool foreground = false;    // 运行期间进入专注模式，降级其他应用和后台进程（仅 Linux）
+  double traceEntry = 0.0;    // 调用方进入时刻（MonotonicMs），0 表示以 LaunchApp 入口为准
+};
+
+// 进程退出信息（由回收线程通过 wait4 填充）
+struct ExitInfo {
+  int exitCode = 0;
+  int exitSignal = 0;       // 终止信号，0 表示正常退出
+  bool coreDumped = false;
+  double userCpuTime = 0.0;   // 用户态 CPU 时间（秒）
+  double systemCpuTime = 0.0; // 内核态 CPU 时间（秒）
+  long maxRss = 0;            // 峰值常驻内存（KB）
+  long minorFaults = 0;
+  long majorFaults = 0;
 };
 
 struct LaunchRecord {
@@ -21,27 +70,133 @@ struct LaunchRecord {
   std::string startTime;
   std::string endTime;
   double duration = 0.0;
-  std::string status; // "running", "completed", "crashed"
+  std::string status; // "running", "hung", "completed", "crashed"
   int exitCode = 0;
   uint32_t processId = 0;
+  double startTimestamp = 0.0; // 启动时间（Unix 毫秒）
+  double launchLatency = 0.0;  // 从 fork 到 exec 成功的耗时（毫秒）
+  LaunchTimeline timeline;     // 启动各阶段时间
+
+  // 退出详情与资源统计
+  int exitSignal = 0;
+  bool coreDumped = false;
+  double userCpuTime = 0.0;
+  double systemCpuTime = 0.0;
+  long maxRss = 0;
+  long minorFaults = 0;
+  long majorFaults = 0;
+
+  // 启动时预读（AppInfo::prefetch），完成后填充
+  double prefetchBytes = 0.0;
+  double prefetchTime = 0.0; // 毫秒
+
+  // 无响应检测（仅 Linux）。duration 不包含无响应的时间
+  double hungDuration = 0.0;  // 已结束的无响应时间累计（秒）
+  double hungSince = 0.0;     // 当前无响应的开始时间（Unix 毫秒），0 表示未处于无响应状态
+  std::string hangReason;     // 当前无响应的原因："uninterruptible" | "no-progress"
+
+  // 崩溃报告文件路径，异常退出后由后台线程写入完成时填充（仅 Linux）
+  std::string crashReport;
+};
+
+// 运行状态表的不可变快照。写入方在 mutex_ 内修改记录后整体替换，
+// 读取方只做一次原子加载，不会被监控线程阻塞
+struct StatusSnapshot {
+  std::map<std::string, LaunchRecord> records;
 };
 
+using StatusSnapshotPtr = std::shared_ptr<const StatusSnapshot>;
+
+// 单个应用的状态：持有所在快照，record 指向其中的记录（应用不存在时为空），不复制记录
+struct AppStatusView {
+  StatusSnapshotPtr snapshot;
+  const LaunchRecord* record = nullptr;
+};
+
+enum class LauncherEventType {
+  Launched,
+  Exited,
+  Crashed,
+  Sample,
+  Hung,
+  Recovered,
+  CrashReport,
+};
+
+// 推送给订阅方的事件
+struct LauncherEvent {
+  LauncherEventType type = LauncherEventType::Launched;
+  std::string appId;
+  uint32_t processId = 0;
+  double timestamp = 0.0; // Unix 毫秒
+  int exitCode = 0;
+  int exitSignal = 0;
+  double duration = 0.0;  // Exited/Crashed 为会话时长；Hung 为判定时已停滞的秒数
+  ResourceSample sample;  // 仅 Sample 事件
+  std::string path;       // 仅 CrashReport 事件，报告文件路径
+};
+
+// 在产生事件的线程（调用方、监控线程或采样线程）中同步调用，实现必须快速返回且不能回调 AppLauncher
+using LauncherEventListener = std::function<void(const LauncherEvent& event)>;
+
 class AppLauncher {
 public:
   AppLauncher();
   ~AppLauncher();
 
-  // 启动应用程序
+  // 启动应用程序（可在工作线程调用，创建进程期间不持有锁）
   bool LaunchApp(const AppInfo& appInfo, std::string& errorMsg);
 
+  // 交给启动调度器排队执行，同一 appId 正在启动时合并为同一个结果，已在运行时返回现有会话
+  std::shared_future<LaunchOutcome> ScheduleLaunch(const AppInfo& appInfo, LaunchScheduler::Completion done = nullptr);
+  void SetLaunchConcurrency(uint32_t concurrency);
+  LaunchSchedulerStats GetLaunchSchedulerStats() const;
+
   // 终止应用程序
   bool TerminateApp(const std::string& appId, std::string& errorMsg);
 
-  // 获取运行状态
-  LaunchRecord GetAppStatus(const std::string& appId);
+  // 获取运行状态（读取快照，不加锁也不分配内存）
+  AppStatusView GetAppStatus(const std::string& appId) const;
+
+  // 获取所有运行中的应用，返回共享快照而不复制记录
+  StatusSnapshotPtr GetAllRunningApps() const;
+
+  // 获取资源采样序列（按时间顺序，仅 Linux）
+  std::vector<ResourceSample> GetResourceSeries(const std::string& appId);
+
+  // 设置资源采样间隔（毫秒）
+  void SetSampleInterval(uint32_t intervalMs);
+
+  // 停滞多久判定为无响应（毫秒），0 表示关闭检测（仅 Linux）
+  void SetHangWindow(uint32_t windowMs);
+
+  // 最近 bytes 字节的捕获输出（需要 captureOutput，仅 Linux）
+  std::string TailOutput(const std::string& appId, size_t bytes);
+  // 捕获输出的日志目录与轮转设置，directory 为空时只保留内存缓冲区
+  void SetOutputLog(const std::string& directory, uint64_t maxBytes, uint32_t maxFiles);
 
-  // 获取所有运行中的应用
-  std::vector<LaunchRecord> GetAllRunningApps();
+  // 异常退出时把崩溃现场写入该目录，为空时关闭（仅 Linux）
+  void SetCrashReportDirectory(const std::string& directory);
+
+  // 打开会话日志，启动/退出（以及可选的采样）事件会追加写入
+  bool OpenJournal(const std::string& path, int syncIntervalMs, bool includeSamples, std::string& errorMsg);
+
+  // 读取尚未确认的日志记录，写入数据库后调用 AcknowledgeJournal
+  std::vector<JournalRecord> DrainJournal(size_t maxRecords);
+  void AcknowledgeJournal(uint64_t sequence);
+  void FlushJournal();
+
+  // 预读可执行文件及其依赖，完成后在线程池线程中回调
+  void PrefetchApp(const std::string& executablePath, const PrefetchOptions& options, AppPrefetcher::Completion done);
+
+  // 专注模式（仅 Linux）。设置 statePath 时会先恢复上次异常退出遗留的降级
+  bool SetFocusOptions(const FocusOptions& options, std::string& errorMsg);
+  FocusState GetFocusState() const;
+  // 提前结束专注模式并恢复所有降级
+  void EndFocus();
+
+  // 设置事件监听器，传入空函数取消
+  void SetEventListener(LauncherEventListener listener);
 
   // 获取应用程序图标（返回base64编码的图标数据）
   std::string GetAppIcon(const std::string& appPath);
@@ -49,27 +204,147 @@ public:
 private:
   std::map<std::string, LaunchRecord> runningApps_;
   std::map<std::string, uint32_t> appProcesses_; // appId -> processId
+  std::set<std::string> launchingApps_;          // 正在创建进程或登记会话的应用
   std::mutex mutex_;
 
+  // 最新发布的快照，只能通过 std::atomic_load/atomic_store 访问
+  StatusSnapshotPtr snapshot_;
+  // 修改 runningApps_ 后调用（需持有 mutex_）
+  void PublishSnapshot();
+
+  // 会话日志需比采样线程和监控线程存活更久
+  SessionJournal journal_;
+  std::atomic<bool> journalSamples_{ false };
+  void JournalSessionEvent(JournalEventType type, const LaunchRecord& record);
+  void OnSample(const std::string& appId, uint32_t processId, const ResourceSample& sample);
+  void OnHang(const std::string& appId, uint32_t processId, bool hung, HangReason reason, double stalledMs);
+  void OnCrashReport(const std::string& appId, uint32_t processId, const std::string& path);
+
+  // 只能通过 std::atomic_load/atomic_store 访问
+  std::shared_ptr<const LauncherEventListener> listener_;
+  void EmitEvent(const LauncherEvent& event);
+  // 根据记录状态发出 launched/exited/crashed 事件
+  void EmitSessionEvent(const LaunchRecord& record);
+
   // 监控进程状态的线程
   std::thread monitorThread_;
   std::atomic<bool> stopMonitor_{ false };
+  // 轮询模式下监控线程在此等待（Linux 上只在 epoll 不可用时使用）
+  std::condition_variable monitorCv_;
 
   void MonitorProcesses();
+  void WakeMonitor();
+  // 标记进程已结束并更新记录（调用方需持有 mutex_）。会话异常结束时返回记录的副本，
+  // 崩溃现场在释放锁之后收集
+  std::optional<LaunchRecord> RecordProcessExit(const std::string& appId, uint32_t processId, const ExitInfo& exitInfo);
   std::string GetCurrentTimeString();
   double CalculateDuration(const std::string& startTime, const std::string& endTime);
+  // 填写 endTime 和 duration，扣除无响应时间
+  void FinishRecord(LaunchRecord& record);
+
+  std::map<std::string, PrefetchResult> pendingPrefetch_; // 记录创建前已完成的启动预读
+  void RecordPrefetch(const std::string& appId, const PrefetchResult& result);
+  // 跟踪线程回调，写入对应记录的 timeline
+  void RecordLaunchPhase(const std::string& appId, uint32_t processId, LaunchPhase phase, double offsetMs);
+
+  // 预读线程池在回调中访问上面的成员，需先于它们析构
+  AppPrefetcher prefetcher_;
+
+#ifdef __linux__
+  // Linux: pidfd + epoll 事件驱动监控，eventfd 用于唤醒/停止监控线程
+  enum class WatchKind { Process, CgroupEvents };
+  struct WatchedProcess {
+    std::string appId;
+    uint32_t processId = 0;     // 被监听的进程，CgroupEvents 时为 0
+    uint32_t rootProcessId = 0; // 所属启动的根进程
+    WatchKind kind = WatchKind::Process;
+  };
+
+  // 扫描模式下已发现且尚未退出的后代，供采样线程在根进程退出后查找存活进程
+  struct TreeMembers {
+    std::mutex mutex;
+    std::set<uint32_t> processes;
+  };
+
+  // 一次启动对应的整棵进程树，最后一个后代退出后会话才结束
+  struct ProcessTree {
+    std::string appId;
+    bool rootExited = false;
+    ExitInfo rootExit;
+    std::string cgroupPath;         // 为空时退回扫描模式，定期沿 /proc/<pid>/task/*/children 查找后代
+    int eventsFd = -1;              // cgroup.events
+    std::set<uint32_t> descendants; // 扫描模式下发现并监听的后代进程
+    std::shared_ptr<TreeMembers> members;
+  };
+
+  std::map<int, WatchedProcess> watchedFds_; // fd -> 监听对象
+  std::map<uint32_t, ProcessTree> trees_;    // 根进程 -> 进程树
+  std::map<uint32_t, std::string> polledProcesses_; // 内核不支持 pidfd 时退回轮询
+  int epollFd_ = -1;
+  int wakeFd_ = -1;
+  bool pidfdSupported_ = false;
+  std::atomic<uint32_t> cgroupSerial_{ 0 };
+  std::once_flag subreaperOnce_;
+  std::atomic<bool> subreaper_{ false };
+  std::map<uint32_t, double> strayZombies_; // 不属于任何会话的僵尸子进程 -> 首次发现时间，只由监控线程访问
+  ProcessSampler sampler_;
+  LaunchTracer tracer_;
+  OutputCapture output_;
+  FocusController focus_;
+  HangDetector hangDetector_;
+  CrashReporter crashReporter_;
+
+  bool InitMonitor();
+  void ShutdownMonitor();
+  std::string PrepareSessionCgroup(int& procsFd);
+  void ApplyCgroupLimits(const std::string& cgroupPath, const LaunchProfile& profile);
+  // 返回扫描模式下该树的后代集合（其他模式下为空集合）
+  std::shared_ptr<TreeMembers> WatchProcess(const std::string& appId, uint32_t processId, const std::string& cgroupPath);
+  void HandleEvents(const std::vector<int>& readyFds);
+  // 扫描模式下查找新的后代，并认领或回收被重新挂到本进程下的孤儿
+  void ScanDescendants();
+  // 根进程退出后为采样和无响应检测找出树中仍存活的进程，只读取 cgroup 和 members，不使用 mutex_
+  static std::function<uint32_t(uint32_t)> MakeTreeResolver(uint32_t rootProcessId, const std::string& cgroupPath,
+                                                            std::shared_ptr<TreeMembers> members);
+  void SignalProcessTree(uint32_t rootProcessId, int signal);
+  // 收集崩溃现场并交给 crashReporter_。会读取输出管道和采样数据，调用方不能持有 mutex_
+  void SubmitCrashReport(const LaunchRecord& record);
+  // 会话结束后在锁外执行：异常结束时先提交崩溃报告，再停止采样、跟踪和专注模式降级
+  struct SessionEnd {
+    std::string appId;
+    uint32_t processId = 0;
+    std::optional<LaunchRecord> crashed;
+  };
+  void FinishSession(const SessionEnd& end);
+  // 在锁外登记采样、跟踪、输出捕获和专注模式，完成后执行登记期间被推迟的收尾
+  void RegisterSession(const AppInfo& appInfo, uint32_t processId, const std::string& cgroupPath,
+                       std::shared_ptr<TreeMembers> members, double entry, const int outputFds[2],
+                       const std::vector<FocusController::Target>& focusTargets);
+  // 根进程仍在登记时把收尾放入 deferredEnds_，否则追加到 ends（调用方需持有 mutex_）
+  void QueueSessionEnd(SessionEnd end, std::vector<SessionEnd>& ends);
+  std::set<uint32_t> registeringProcesses_;       // 正在锁外登记的根进程
+  std::map<uint32_t, SessionEnd> deferredEnds_;   // 登记完成前已结束的会话
+  void PollProcesses();
+#endif
 
 #ifdef _WIN32
   // Windows specific functions
-  bool LaunchAppWindows(const AppInfo& appInfo, std::string& errorMsg);
+  bool LaunchAppWindows(const AppInfo& appInfo, uint32_t& processId, LaunchTimeline& timeline, std::string& errorMsg);
   bool TerminateAppWindows(uint32_t processId);
   std::string GetAppIconWindows(const std::string& appPath);
 #else
   // Linux/macOS specific functions  
-  bool LaunchAppUnix(const AppInfo& appInfo, std::string& errorMsg);
+  // outputFds 返回 stdout/stderr 管道读端（未捕获时为 -1）
+  bool LaunchAppUnix(const AppInfo& appInfo, int cgroupProcsFd, uint32_t& processId, LaunchTimeline& timeline,
+                     int outputFds[2], std::string& errorMsg);
   bool TerminateAppUnix(uint32_t processId);
   std::string GetAppIconUnix(const std::string& appPath);
+  // 非阻塞回收子进程，进程已结束时返回 true 并填充退出信息
+  static bool ReapProcess(uint32_t processId, ExitInfo& exitInfo);
 #endif
+
+  // 调度线程调用 LaunchApp，需最先析构
+  LaunchScheduler scheduler_;
 };
 
 #endif // APP_LAUNCHER_H
@@ -1,29 +1,461 @@
 #define _CRT_SECURE_NO_WARNINGS 1
 #include <napi.h>
 #include "app_launcher.h"
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <algorithm>
+
+// 把监控线程和采样线程产生的事件批量投递到 JS 线程。
+// JS 忙时事件在队列中累积，下一次回调一次性交付；同一应用未交付的采样只保留最新一条，
+// 队列超过上限时丢弃采样事件，启动/退出事件始终保留
+class EventStream : public std::enable_shared_from_this<EventStream> {
+public:
+  static constexpr size_t kMaxPending = 4096;
+
+  EventStream(Napi::Env env, Napi::Function callback);
+
+  void Push(const LauncherEvent& event);
+  void Close();
+
+private:
+  std::mutex mutex_;
+  std::vector<LauncherEvent> pending_;
+  std::map<std::string, size_t> pendingSamples_; // appId -> pending_ 中的位置
+  size_t dropped_ = 0;
+  bool scheduled_ = false;
+  bool closed_ = false;
+  Napi::ThreadSafeFunction tsfn_;
+
+  void Deliver(Napi::Env env, Napi::Function callback);
+};
 
 class AppLauncherWrapper : public Napi::ObjectWrap<AppLauncherWrapper> {
 public:
   static Napi::Object Init(Napi::Env env, Napi::Object exports);
   AppLauncherWrapper(const Napi::CallbackInfo& info);
+  ~AppLauncherWrapper();
 
 private:
   AppLauncher launcher_;
+  std::shared_ptr<EventStream> events_;
+
+  // appId 驻留表，只在 JS 线程访问。索引在实例生命周期内保持不变
+  std::map<std::string, uint32_t> internIndex_;
+  std::vector<std::string> internedIds_;
+  uint32_t InternAppId(const std::string& appId);
 
   Napi::Value LaunchApp(const Napi::CallbackInfo& info);
+  Napi::Value LaunchAppAsync(const Napi::CallbackInfo& info);
   Napi::Value TerminateApp(const Napi::CallbackInfo& info);
   Napi::Value GetAppStatus(const Napi::CallbackInfo& info);
   Napi::Value GetAllRunningApps(const Napi::CallbackInfo& info);
+  Napi::Value GetStatusBatch(const Napi::CallbackInfo& info);
+  Napi::Value InternAppIds(const Napi::CallbackInfo& info);
+  Napi::Value GetInternedAppIds(const Napi::CallbackInfo& info);
   Napi::Value GetAppIcon(const Napi::CallbackInfo& info);
+  Napi::Value GetResourceSeries(const Napi::CallbackInfo& info);
+  Napi::Value SetSampleInterval(const Napi::CallbackInfo& info);
+  Napi::Value SetHangWindow(const Napi::CallbackInfo& info);
+  Napi::Value TailOutput(const Napi::CallbackInfo& info);
+  Napi::Value SetOutputLog(const Napi::CallbackInfo& info);
+  Napi::Value SetCrashReportDir(const Napi::CallbackInfo& info);
+  Napi::Value OpenJournal(const Napi::CallbackInfo& info);
+  Napi::Value DrainJournal(const Napi::CallbackInfo& info);
+  Napi::Value AckJournal(const Napi::CallbackInfo& info);
+  Napi::Value FlushJournal(const Napi::CallbackInfo& info);
+  Napi::Value PrefetchApp(const Napi::CallbackInfo& info);
+  Napi::Value Subscribe(const Napi::CallbackInfo& info);
+  Napi::Value Unsubscribe(const Napi::CallbackInfo& info);
+  Napi::Value SetFocusOptions(const Napi::CallbackInfo& info);
+  Napi::Value GetFocusState(const Napi::CallbackInfo& info);
+  Napi::Value EndFocus(const Napi::CallbackInfo& info);
+  Napi::Value SetLaunchConcurrency(const Napi::CallbackInfo& info);
+  Napi::Value GetLaunchStats(const Napi::CallbackInfo& info);
+};
+
+static Napi::Object TimelineToObject(Napi::Env env, const LaunchTimeline& timeline) {
+  Napi::Object obj = Napi::Object::New(env);
+  obj.Set("entry", timeline.entry);
+  obj.Set("lockAcquired", timeline.lockAcquired);
+  obj.Set("forked", timeline.forked);
+  obj.Set("execSucceeded", timeline.execSucceeded);
+  obj.Set("loaderDone", timeline.loaderDone);
+  obj.Set("firstOutput", timeline.firstOutput);
+  obj.Set("firstCpuBurst", timeline.firstCpuBurst);
+  return obj;
+}
+
+static Napi::Object RecordToObject(Napi::Env env, const LaunchRecord& record) {
+  Napi::Object obj = Napi::Object::New(env);
+  obj.Set("appId", record.appId);
+  obj.Set("startTime", record.startTime);
+  obj.Set("endTime", record.endTime);
+  obj.Set("duration", record.duration);
+  obj.Set("status", record.status);
+  obj.Set("exitCode", record.exitCode);
+  obj.Set("processId", record.processId);
+  obj.Set("launchLatency", record.launchLatency);
+  obj.Set("timeline", TimelineToObject(env, record.timeline));
+  obj.Set("exitSignal", record.exitSignal);
+  obj.Set("coreDumped", record.coreDumped);
+  obj.Set("userCpuTime", record.userCpuTime);
+  obj.Set("systemCpuTime", record.systemCpuTime);
+  obj.Set("maxRss", static_cast<double>(record.maxRss));
+  obj.Set("minorFaults", static_cast<double>(record.minorFaults));
+  obj.Set("majorFaults", static_cast<double>(record.majorFaults));
+  obj.Set("prefetchBytes", record.prefetchBytes);
+  obj.Set("prefetchTime", record.prefetchTime);
+  obj.Set("hungDuration", record.hungDuration);
+  if (record.status == "hung") {
+    obj.Set("hungSince", record.hungSince);
+    obj.Set("hangReason", record.hangReason);
+  }
+  if (!record.crashReport.empty()) {
+    obj.Set("crashReport", record.crashReport);
+  }
+  return obj;
+}
+
+static std::vector<std::string> ToStringArray(Napi::Value value) {
+  std::vector<std::string> result;
+  if (value.IsArray()) {
+    Napi::Array array = value.As<Napi::Array>();
+    for (uint32_t i = 0; i < array.Length(); i++) {
+      result.push_back(array.Get(i).ToString());
+    }
+  }
+  return result;
+}
+
+// 启动配置 { args?, env?, cwd?, cpuAffinity?, nice?, schedPolicy?, schedPriority?, ioClass?, ioLevel?,
+// disableThp?, cpuWeight?, memoryHigh? }
+static void ParseLaunchProfile(Napi::Value value, LaunchProfile& profile) {
+  if (!value.IsObject()) {
+    return;
+  }
+
+  Napi::Object object = value.As<Napi::Object>();
+  profile.args = ToStringArray(object.Get("args"));
+
+  Napi::Value env = object.Get("env");
+  if (env.IsObject()) {
+    Napi::Object envObject = env.As<Napi::Object>();
+    Napi::Array keys = envObject.GetPropertyNames();
+    for (uint32_t i = 0; i < keys.Length(); i++) {
+      std::string key = keys.Get(i).ToString();
+      profile.env[key] = envObject.Get(key).ToString();
+    }
+  }
+
+  if (object.Get("cwd").IsString()) {
+    profile.cwd = object.Get("cwd").As<Napi::String>().Utf8Value();
+  }
+
+  Napi::Value affinity = object.Get("cpuAffinity");
+  if (affinity.IsArray()) {
+    Napi::Array array = affinity.As<Napi::Array>();
+    for (uint32_t i = 0; i < array.Length(); i++) {
+      profile.cpuAffinity.push_back(array.Get(i).As<Napi::Number>().Int32Value());
+    }
+  }
+
+  if (object.Get("nice").IsNumber()) {
+    profile.nice = object.Get("nice").As<Napi::Number>().Int32Value();
+  }
+  if (object.Get("schedPolicy").IsString()) {
+    profile.schedPolicy = object.Get("schedPolicy").As<Napi::String>().Utf8Value();
+  }
+  if (object.Get("schedPriority").IsNumber()) {
+    profile.schedPriority = object.Get("schedPriority").As<Napi::Number>().Int32Value();
+  }
+  if (object.Get("ioClass").IsString()) {
+    profile.ioClass = object.Get("ioClass").As<Napi::String>().Utf8Value();
+  }
+  if (object.Get("ioLevel").IsNumber()) {
+    profile.ioLevel = object.Get("ioLevel").As<Napi::Number>().Int32Value();
+  }
+  if (object.Get("disableThp").IsBoolean()) {
+    profile.disableThp = object.Get("disableThp").As<Napi::Boolean>().Value();
+  }
+  if (object.Get("cpuWeight").IsNumber()) {
+    profile.cpuWeight = object.Get("cpuWeight").As<Napi::Number>().Uint32Value();
+  }
+  if (object.Get("memoryHigh").IsNumber()) {
+    profile.memoryHigh = static_cast<uint64_t>(object.Get("memoryHigh").As<Napi::Number>().DoubleValue());
+  }
+}
+
+// launchApp/launchAppAsync 的可选参数
+// { prefetch?: boolean, prefetchPaths?: string[], captureOutput?: boolean, foreground?: boolean, profile?: object }
+static void ParseLaunchOptions(Napi::Value value, AppInfo& appInfo) {
+  if (!value.IsObject()) {
+    return;
+  }
+
+  Napi::Object options = value.As<Napi::Object>();
+  if (options.Get("prefetch").IsBoolean()) {
+    appInfo.prefetch = options.Get("prefetch").As<Napi::Boolean>().Value();
+  }
+  appInfo.prefetchPaths = ToStringArray(options.Get("prefetchPaths"));
+  if (options.Get("captureOutput").IsBoolean()) {
+    appInfo.captureOutput = options.Get("captureOutput").As<Napi::Boolean>().Value();
+  }
+  if (options.Get("foreground").IsBoolean()) {
+    appInfo.foreground = options.Get("foreground").As<Napi::Boolean>().Value();
+  }
+  ParseLaunchProfile(options.Get("profile"), appInfo.profile);
+}
+
+// 等待预读线程池完成，结果通过 Promise 返回
+class PrefetchWorker : public Napi::AsyncWorker {
+public:
+  PrefetchWorker(Napi::Env env, Napi::Object owner, AppLauncher& launcher,
+                 const std::string& executablePath, const PrefetchOptions& options)
+    : Napi::AsyncWorker(env),
+      deferred_(Napi::Promise::Deferred::New(env)),
+      launcher_(launcher),
+      executablePath_(executablePath),
+      options_(options) {
+    owner_ = Napi::Persistent(owner);
+  }
+
+  Napi::Promise GetPromise() const { return deferred_.Promise(); }
+
+protected:
+  void Execute() override {
+    std::promise<PrefetchResult> done;
+    std::future<PrefetchResult> future = done.get_future();
+    launcher_.PrefetchApp(executablePath_, options_, [&done](const PrefetchResult& result) {
+      done.set_value(result);
+    });
+    result_ = future.get();
+  }
+
+  void OnOK() override {
+    Napi::Env env = Env();
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("files", result_.files);
+    obj.Set("bytes", static_cast<double>(result_.bytes));
+    obj.Set("duration", result_.duration);
+    deferred_.Resolve(obj);
+  }
+
+  void OnError(const Napi::Error& error) override {
+    deferred_.Reject(error.Value());
+  }
+
+private:
+  Napi::Promise::Deferred deferred_;
+  Napi::ObjectReference owner_;
+  AppLauncher& launcher_;
+  std::string executablePath_;
+  PrefetchOptions options_;
+  PrefetchResult result_;
+};
+
+// getStatusBatch 的定长记录（小端），JS 端通过 DataView 按 kStatusRecordSize 步长读取
+struct StatusBatchRecord {
+  uint32_t appIndex;   // 驻留索引，见 internAppIds/getInternedAppIds
+  uint32_t processId;
+  uint64_t startNs;    // 启动时间（Unix 纳秒）
+  double duration;     // 秒，运行中为已运行时长；均不含无响应时间
+  uint32_t state;      // StatusBatchState
+  int32_t exitCode;
+};
+
+static_assert(sizeof(StatusBatchRecord) == 32, "StatusBatchRecord layout is part of the JS API");
+
+enum StatusBatchState : uint32_t {
+  kStateNotRunning = 0,
+  kStateRunning = 1,
+  kStateCompleted = 2,
+  kStateCrashed = 3,
+  kStateHung = 4,
+};
+
+static uint32_t StatusToState(const std::string& status) {
+  if (status == "running") {
+    return kStateRunning;
+  }
+  if (status == "completed") {
+    return kStateCompleted;
+  }
+  if (status == "crashed") {
+    return kStateCrashed;
+  }
+  if (status == "hung") {
+    return kStateHung;
+  }
+  return kStateNotRunning;
+}
+
+static void FillBatchRecord(StatusBatchRecord& out, uint32_t appIndex, const LaunchRecord* record, double nowMs) {
+  memset(&out, 0, sizeof(out));
+  out.appIndex = appIndex;
+  if (!record) {
+    return;
+  }
+
+  out.processId = record->processId;
+  out.startNs = static_cast<uint64_t>(record->startTimestamp * 1e6);
+  out.state = StatusToState(record->status);
+  out.exitCode = record->exitCode;
+  if (out.state == kStateRunning || out.state == kStateHung) {
+    double hungMs = record->hungDuration * 1000.0 + (record->hungSince > 0.0 ? nowMs - record->hungSince : 0.0);
+    out.duration = std::max(0.0, (nowMs - record->startTimestamp - hungMs) / 1000.0);
+  }
+  else {
+    out.duration = record->duration;
+  }
+}
+
+static const char* EventTypeName(LauncherEventType type) {
+  switch (type) {
+    case LauncherEventType::Launched: return "launched";
+    case LauncherEventType::Exited: return "exited";
+    case LauncherEventType::Crashed: return "crashed";
+    case LauncherEventType::Sample: return "sample";
+    case LauncherEventType::Hung: return "hung";
+    case LauncherEventType::Recovered: return "recovered";
+    case LauncherEventType::CrashReport: return "crashReport";
+  }
+  return "unknown";
+}
+
+static Napi::Object EventToObject(Napi::Env env, const LauncherEvent& event) {
+  Napi::Object obj = Napi::Object::New(env);
+  obj.Set("type", EventTypeName(event.type));
+  obj.Set("appId", event.appId);
+  obj.Set("processId", event.processId);
+  obj.Set("timestamp", event.timestamp);
+
+  if (event.type == LauncherEventType::Sample) {
+    obj.Set("cpuPercent", event.sample.cpuPercent);
+    obj.Set("rss", event.sample.rss);
+    obj.Set("readBytes", event.sample.readBytes);
+    obj.Set("writeBytes", event.sample.writeBytes);
+  }
+  else if (event.type == LauncherEventType::Hung || event.type == LauncherEventType::Recovered) {
+    obj.Set("duration", event.duration);
+  }
+  else if (event.type == LauncherEventType::CrashReport) {
+    obj.Set("path", event.path);
+  }
+  else if (event.type != LauncherEventType::Launched) {
+    obj.Set("exitCode", event.exitCode);
+    obj.Set("exitSignal", event.exitSignal);
+    obj.Set("duration", event.duration);
+  }
+  return obj;
+}
+
+EventStream::EventStream(Napi::Env env, Napi::Function callback) {
+  tsfn_ = Napi::ThreadSafeFunction::New(env, callback, "AppLauncherEvents", 0, 1);
+  // 订阅本身不阻止进程退出
+  tsfn_.Unref(env);
+}
+
+void EventStream::Push(const LauncherEvent& event) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_) {
+    return;
+  }
+
+  if (event.type == LauncherEventType::Sample) {
+    auto it = pendingSamples_.find(event.appId);
+    if (it != pendingSamples_.end()) {
+      pending_[it->second] = event;
+      return;
+    }
+    if (pending_.size() >= kMaxPending) {
+      dropped_++;
+      return;
+    }
+    pendingSamples_.emplace(event.appId, pending_.size());
+  }
+  pending_.push_back(event);
+
+  // 已有待执行的回调时只入队，由该回调一并交付
+  if (!scheduled_) {
+    auto self = shared_from_this();
+    scheduled_ = tsfn_.NonBlockingCall([self](Napi::Env env, Napi::Function callback) {
+      self->Deliver(env, callback);
+    }) == napi_ok;
+  }
+}
+
+void EventStream::Close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_) {
+    return;
+  }
+  closed_ = true;
+  tsfn_.Release();
+}
+
+void EventStream::Deliver(Napi::Env env, Napi::Function callback) {
+  std::vector<LauncherEvent> events;
+  size_t dropped = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events.swap(pending_);
+    pendingSamples_.clear();
+    dropped = dropped_;
+    dropped_ = 0;
+    scheduled_ = false;
+  }
+
+  if (events.empty() || env == nullptr || callback.IsEmpty()) {
+    return;
+  }
+
+  Napi::Array batch = Napi::Array::New(env, events.size());
+  for (size_t i = 0; i < events.size(); i++) {
+    batch[static_cast<uint32_t>(i)] = EventToObject(env, events[i]);
+  }
+  callback.Call({ batch, Napi::Number::New(env, static_cast<double>(dropped)) });
+}
+
+// launchAppAsync 的等待状态。调度线程写入 outcome 后通过 ThreadSafeFunction 回到 JS 线程完成 Promise
+struct LaunchCompletion {
+  Napi::Promise::Deferred deferred;
+  Napi::ObjectReference owner; // 防止启动过程中 launcher 被回收
+  std::string appId;
+  LaunchOutcome outcome;
 };
 
 Napi::Object AppLauncherWrapper::Init(Napi::Env env, Napi::Object exports) {
   Napi::Function func = DefineClass(env, "AppLauncher", {
       InstanceMethod("launchApp", &AppLauncherWrapper::LaunchApp),
+      InstanceMethod("launchAppAsync", &AppLauncherWrapper::LaunchAppAsync),
       InstanceMethod("terminateApp", &AppLauncherWrapper::TerminateApp),
       InstanceMethod("getAppStatus", &AppLauncherWrapper::GetAppStatus),
       InstanceMethod("getAllRunningApps", &AppLauncherWrapper::GetAllRunningApps),
-      InstanceMethod("getAppIcon", &AppLauncherWrapper::GetAppIcon)
+      InstanceMethod("getStatusBatch", &AppLauncherWrapper::GetStatusBatch),
+      InstanceMethod("internAppIds", &AppLauncherWrapper::InternAppIds),
+      InstanceMethod("getInternedAppIds", &AppLauncherWrapper::GetInternedAppIds),
+      StaticValue("STATUS_RECORD_SIZE", Napi::Number::New(env, sizeof(StatusBatchRecord))),
+      InstanceMethod("getAppIcon", &AppLauncherWrapper::GetAppIcon),
+      InstanceMethod("getResourceSeries", &AppLauncherWrapper::GetResourceSeries),
+      InstanceMethod("setSampleInterval", &AppLauncherWrapper::SetSampleInterval),
+      InstanceMethod("setHangWindow", &AppLauncherWrapper::SetHangWindow),
+      InstanceMethod("tailOutput", &AppLauncherWrapper::TailOutput),
+      InstanceMethod("setOutputLog", &AppLauncherWrapper::SetOutputLog),
+      InstanceMethod("setCrashReportDir", &AppLauncherWrapper::SetCrashReportDir),
+      InstanceMethod("openJournal", &AppLauncherWrapper::OpenJournal),
+      InstanceMethod("drainJournal", &AppLauncherWrapper::DrainJournal),
+      InstanceMethod("ackJournal", &AppLauncherWrapper::AckJournal),
+      InstanceMethod("flushJournal", &AppLauncherWrapper::FlushJournal),
+      InstanceMethod("prefetchApp", &AppLauncherWrapper::PrefetchApp),
+      InstanceMethod("subscribe", &AppLauncherWrapper::Subscribe),
+      InstanceMethod("unsubscribe", &AppLauncherWrapper::Unsubscribe),
+      InstanceMethod("setFocusOptions", &AppLauncherWrapper::SetFocusOptions),
+      InstanceMethod("getFocusState", &AppLauncherWrapper::GetFocusState),
+      InstanceMethod("endFocus", &AppLauncherWrapper::EndFocus),
+      InstanceMethod("setLaunchConcurrency", &AppLauncherWrapper::SetLaunchConcurrency),
+      InstanceMethod("getLaunchStats", &AppLauncherWrapper::GetLaunchStats)
     });
 
   exports.Set("AppLauncher", func);
@@ -34,7 +466,15 @@ AppLauncherWrapper::AppLauncherWrapper(const Napi::CallbackInfo& info)
   : Napi::ObjectWrap<AppLauncherWrapper>(info) {
 }
 
+AppLauncherWrapper::~AppLauncherWrapper() {
+  launcher_.SetEventListener(nullptr);
+  if (events_) {
+    events_->Close();
+  }
+}
+
 Napi::Value AppLauncherWrapper::LaunchApp(const Napi::CallbackInfo& info) {
+  double entry = MonotonicMs();
   Napi::Env env = info.Env();
 
   if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
@@ -48,6 +488,10 @@ Napi::Value AppLauncherWrapper::LaunchApp(const Napi::CallbackInfo& info) {
   AppInfo appInfo;
   appInfo.appId = appId;
   appInfo.executablePath = executablePath;
+  appInfo.traceEntry = entry;
+  if (info.Length() > 2) {
+    ParseLaunchOptions(info[2], appInfo);
+  }
 
   std::string errorMsg;
   bool success = launcher_.LaunchApp(appInfo, errorMsg);
@@ -61,6 +505,52 @@ Napi::Value AppLauncherWrapper::LaunchApp(const Napi::CallbackInfo& info) {
   }
 }
 
+Napi::Value AppLauncherWrapper::LaunchAppAsync(const Napi::CallbackInfo& info) {
+  // 入口时间在 JS 线程记录，调度排队时间也计入时间线
+  double entry = MonotonicMs();
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+    Napi::TypeError::New(env, "String expected").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  AppInfo appInfo;
+  appInfo.appId = info[0].As<Napi::String>();
+  appInfo.executablePath = info[1].As<Napi::String>();
+  appInfo.traceEntry = entry;
+  if (info.Length() > 2) {
+    ParseLaunchOptions(info[2], appInfo);
+  }
+
+  auto* completion = new LaunchCompletion{
+    Napi::Promise::Deferred::New(env), Napi::Persistent(info.This().As<Napi::Object>()), appInfo.appId, LaunchOutcome() };
+  Napi::Promise promise = completion->deferred.Promise();
+
+  Napi::ThreadSafeFunction tsfn = Napi::ThreadSafeFunction::New(
+    env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}), "launchAppAsync", 0, 1);
+  AppLauncher* launcher = &launcher_;
+
+  launcher_.ScheduleLaunch(appInfo, [tsfn, completion, launcher](const LaunchOutcome& outcome) {
+    completion->outcome = outcome;
+    tsfn.BlockingCall(completion, [launcher](Napi::Env env, Napi::Function, LaunchCompletion* completion) {
+      if (completion->outcome.success) {
+        AppStatusView status = launcher->GetAppStatus(completion->appId);
+        Napi::Object record = RecordToObject(env, status.record ? *status.record : LaunchRecord());
+        record.Set("coalesced", Napi::Boolean::New(env, completion->outcome.coalesced));
+        completion->deferred.Resolve(record);
+      }
+      else {
+        completion->deferred.Reject(Napi::Error::New(env, completion->outcome.errorMsg).Value());
+      }
+      delete completion;
+    });
+    tsfn.Release();
+  });
+
+  return promise;
+}
+
 Napi::Value AppLauncherWrapper::TerminateApp(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
@@ -91,36 +581,308 @@ Napi::Value AppLauncherWrapper::GetAppStatus(const Napi::CallbackInfo& info) {
   }
 
   std::string appId = info[0].As<Napi::String>();
-  LaunchRecord record = launcher_.GetAppStatus(appId);
 
-  Napi::Object result = Napi::Object::New(env);
-  result.Set("appId", record.appId);
-  result.Set("startTime", record.startTime);
-  result.Set("endTime", record.endTime);
-  result.Set("duration", record.duration);
-  result.Set("status", record.status);
-  result.Set("exitCode", record.exitCode);
-  result.Set("processId", record.processId);
+  // 直接从快照转换，避免复制记录
+  AppStatusView status = launcher_.GetAppStatus(appId);
+  if (!status.record) {
+    return RecordToObject(env, LaunchRecord());
+  }
 
-  return result;
+  return RecordToObject(env, *status.record);
 }
 
 Napi::Value AppLauncherWrapper::GetAllRunningApps(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  auto records = launcher_.GetAllRunningApps();
+  StatusSnapshotPtr snapshot = launcher_.GetAllRunningApps();
+  Napi::Array result = Napi::Array::New(env, snapshot->records.size());
+
+  uint32_t index = 0;
+  for (const auto& pair : snapshot->records) {
+    result[index++] = RecordToObject(env, pair.second);
+  }
+
+  return result;
+}
+
+uint32_t AppLauncherWrapper::InternAppId(const std::string& appId) {
+  auto it = internIndex_.find(appId);
+  if (it != internIndex_.end()) {
+    return it->second;
+  }
+
+  uint32_t index = static_cast<uint32_t>(internedIds_.size());
+  internIndex_.emplace(appId, index);
+  internedIds_.push_back(appId);
+  return index;
+}
+
+// internAppIds(appIds: string[]): Uint32Array，返回每个 appId 的驻留索引
+Napi::Value AppLauncherWrapper::InternAppIds(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, "Array expected").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Array appIds = info[0].As<Napi::Array>();
+  Napi::Uint32Array result = Napi::Uint32Array::New(env, appIds.Length());
+  for (uint32_t i = 0; i < appIds.Length(); i++) {
+    result[i] = InternAppId(appIds.Get(i).ToString());
+  }
+
+  return result;
+}
+
+Napi::Value AppLauncherWrapper::GetInternedAppIds(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Napi::Array result = Napi::Array::New(env, internedIds_.size());
+  for (size_t i = 0; i < internedIds_.size(); i++) {
+    result[static_cast<uint32_t>(i)] = internedIds_[i];
+  }
+
+  return result;
+}
+
+// getStatusBatch(appIds?: string[] | Uint32Array): ArrayBuffer
+// 不传参数时返回全部记录；传入驻留索引（Uint32Array）可避免每次转换字符串。
+// 每条记录 STATUS_RECORD_SIZE 字节，顺序与传入的 appIds 一致
+Napi::Value AppLauncherWrapper::GetStatusBatch(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  StatusSnapshotPtr snapshot = launcher_.GetAllRunningApps();
+  double nowMs = std::chrono::duration<double, std::milli>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+
+  auto lookup = [&snapshot](const std::string& appId) -> const LaunchRecord* {
+    auto it = snapshot->records.find(appId);
+    return it == snapshot->records.end() ? nullptr : &it->second;
+  };
+
+  if (info.Length() > 0 && info[0].IsTypedArray()) {
+    if (info[0].As<Napi::TypedArray>().TypedArrayType() != napi_uint32_array) {
+      Napi::TypeError::New(env, "Uint32Array expected").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    Napi::Uint32Array indices = info[0].As<Napi::Uint32Array>();
+    Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, indices.ElementLength() * sizeof(StatusBatchRecord));
+    StatusBatchRecord* records = static_cast<StatusBatchRecord*>(buffer.Data());
+
+    for (size_t i = 0; i < indices.ElementLength(); i++) {
+      uint32_t index = indices[i];
+      const LaunchRecord* record = index < internedIds_.size() ? lookup(internedIds_[index]) : nullptr;
+      FillBatchRecord(records[i], index, record, nowMs);
+    }
+    return buffer;
+  }
+
+  if (info.Length() > 0 && info[0].IsArray()) {
+    Napi::Array appIds = info[0].As<Napi::Array>();
+    Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, appIds.Length() * sizeof(StatusBatchRecord));
+    StatusBatchRecord* records = static_cast<StatusBatchRecord*>(buffer.Data());
+
+    for (uint32_t i = 0; i < appIds.Length(); i++) {
+      std::string appId = appIds.Get(i).ToString();
+      FillBatchRecord(records[i], InternAppId(appId), lookup(appId), nowMs);
+    }
+    return buffer;
+  }
+
+  Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, snapshot->records.size() * sizeof(StatusBatchRecord));
+  StatusBatchRecord* records = static_cast<StatusBatchRecord*>(buffer.Data());
+
+  size_t i = 0;
+  for (const auto& pair : snapshot->records) {
+    FillBatchRecord(records[i++], InternAppId(pair.first), &pair.second, nowMs);
+  }
+  return buffer;
+}
+
+Napi::Value AppLauncherWrapper::GetAppIcon(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "String expected").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string appPath = info[0].As<Napi::String>();
+  std::string iconData = launcher_.GetAppIcon(appPath);
+
+  return Napi::String::New(env, iconData);
+}
+
+// 返回 Float64Array，每个采样占 5 个元素：[timestamp, cpuPercent, rss, readBytes, writeBytes]
+Napi::Value AppLauncherWrapper::GetResourceSeries(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "String expected").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string appId = info[0].As<Napi::String>();
+  auto series = launcher_.GetResourceSeries(appId);
+
+  const size_t stride = sizeof(ResourceSample) / sizeof(double);
+  Napi::Float64Array result = Napi::Float64Array::New(env, series.size() * stride);
+  if (!series.empty()) {
+    memcpy(result.Data(), series.data(), series.size() * sizeof(ResourceSample));
+  }
+
+  return result;
+}
+
+Napi::Value AppLauncherWrapper::SetSampleInterval(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Number expected").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  launcher_.SetSampleInterval(info[0].As<Napi::Number>().Uint32Value());
+  return env.Undefined();
+}
+
+// setHangWindow(ms)：停滞多久判定为无响应，0 关闭检测
+Napi::Value AppLauncherWrapper::SetHangWindow(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Number expected").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  launcher_.SetHangWindow(info[0].As<Napi::Number>().Uint32Value());
+  return env.Undefined();
+}
+
+// tailOutput(appId, bytes): Buffer，最近 bytes 字节的捕获输出
+Napi::Value AppLauncherWrapper::TailOutput(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsNumber()) {
+    Napi::TypeError::New(env, "String and number expected").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string appId = info[0].As<Napi::String>();
+  int64_t bytes = info[1].As<Napi::Number>().Int64Value();
+  std::string output = launcher_.TailOutput(appId, bytes > 0 ? static_cast<size_t>(bytes) : 0);
+  return Napi::Buffer<char>::Copy(env, output.data(), output.size());
+}
+
+// setOutputLog(directory, { maxBytes?: number, maxFiles?: number })
+Napi::Value AppLauncherWrapper::SetOutputLog(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "String expected").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string directory = info[0].As<Napi::String>();
+  double maxBytes = static_cast<double>(OutputCapture::kDefaultMaxLogBytes);
+  uint32_t maxFiles = OutputCapture::kDefaultMaxLogFiles;
+  if (info.Length() > 1 && info[1].IsObject()) {
+    Napi::Object options = info[1].As<Napi::Object>();
+    if (options.Get("maxBytes").IsNumber()) {
+      maxBytes = options.Get("maxBytes").As<Napi::Number>().DoubleValue();
+    }
+    if (options.Get("maxFiles").IsNumber()) {
+      maxFiles = options.Get("maxFiles").As<Napi::Number>().Uint32Value();
+    }
+  }
+
+  launcher_.SetOutputLog(directory, static_cast<uint64_t>(maxBytes), maxFiles);
+  return env.Undefined();
+}
+
+// setCrashReportDir(directory)：异常退出时在该目录写入崩溃报告，传空串关闭
+Napi::Value AppLauncherWrapper::SetCrashReportDir(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "String expected").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  launcher_.SetCrashReportDirectory(info[0].As<Napi::String>());
+  return env.Undefined();
+}
+
+// openJournal(path, { syncIntervalMs?: number, includeSamples?: boolean })
+Napi::Value AppLauncherWrapper::OpenJournal(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "String expected").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string path = info[0].As<Napi::String>();
+  int syncIntervalMs = 20;
+  bool includeSamples = false;
+
+  if (info.Length() > 1 && info[1].IsObject()) {
+    Napi::Object options = info[1].As<Napi::Object>();
+    if (options.Get("syncIntervalMs").IsNumber()) {
+      syncIntervalMs = options.Get("syncIntervalMs").As<Napi::Number>().Int32Value();
+    }
+    if (options.Get("includeSamples").IsBoolean()) {
+      includeSamples = options.Get("includeSamples").As<Napi::Boolean>().Value();
+    }
+  }
+
+  std::string errorMsg;
+  if (!launcher_.OpenJournal(path, syncIntervalMs, includeSamples, errorMsg)) {
+    Napi::Error::New(env, errorMsg).ThrowAsJavaScriptException();
+    return Napi::Boolean::New(env, false);
+  }
+
+  return Napi::Boolean::New(env, true);
+}
+
+Napi::Value AppLauncherWrapper::DrainJournal(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  size_t maxRecords = 256;
+  if (info.Length() > 0 && info[0].IsNumber()) {
+    maxRecords = info[0].As<Napi::Number>().Uint32Value();
+  }
+
+  auto records = launcher_.DrainJournal(maxRecords);
   Napi::Array result = Napi::Array::New(env, records.size());
 
   for (size_t i = 0; i < records.size(); i++) {
-    const auto& record = records[i];
+    const JournalRecord& record = records[i];
     Napi::Object obj = Napi::Object::New(env);
-    obj.Set("appId", record.appId);
-    obj.Set("startTime", record.startTime);
-    obj.Set("endTime", record.endTime);
-    obj.Set("duration", record.duration);
-    obj.Set("status", record.status);
-    obj.Set("exitCode", record.exitCode);
+    obj.Set("sequence", static_cast<double>(record.sequence));
+    obj.Set("type", record.type == static_cast<uint32_t>(JournalEventType::Launch) ? "launch" :
+                    record.type == static_cast<uint32_t>(JournalEventType::Exit) ? "exit" : "sample");
+    obj.Set("appId", std::string(record.appId));
     obj.Set("processId", record.processId);
+    obj.Set("timestamp", record.timestamp);
+    obj.Set("startTime", record.startTime);
+
+    if (record.type == static_cast<uint32_t>(JournalEventType::Exit)) {
+      obj.Set("status", record.status == 2 ? "crashed" : "completed");
+      obj.Set("exitCode", record.exitCode);
+      obj.Set("exitSignal", record.exitSignal);
+      obj.Set("duration", record.values[0]);
+      obj.Set("userCpuTime", record.values[1]);
+      obj.Set("systemCpuTime", record.values[2]);
+      obj.Set("maxRss", record.values[3]);
+    }
+    else if (record.type == static_cast<uint32_t>(JournalEventType::Sample)) {
+      obj.Set("cpuPercent", record.values[0]);
+      obj.Set("rss", record.values[1]);
+      obj.Set("readBytes", record.values[2]);
+      obj.Set("writeBytes", record.values[3]);
+    }
 
     result[i] = obj;
   }
@@ -128,7 +890,26 @@ Napi::Value AppLauncherWrapper::GetAllRunningApps(const Napi::CallbackInfo& info
   return result;
 }
 
-Napi::Value AppLauncherWrapper::GetAppIcon(const Napi::CallbackInfo& info) {
+Napi::Value AppLauncherWrapper::AckJournal(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Number expected").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  launcher_.AcknowledgeJournal(static_cast<uint64_t>(info[0].As<Napi::Number>().Int64Value()));
+  return env.Undefined();
+}
+
+Napi::Value AppLauncherWrapper::FlushJournal(const Napi::CallbackInfo& info) {
+  launcher_.FlushJournal();
+  return info.Env().Undefined();
+}
+
+// prefetchApp(path, { includeLibraries?: boolean, extraPaths?: string[], maxBytes?: number })
+// => Promise<{ files, bytes, duration }>
+Napi::Value AppLauncherWrapper::PrefetchApp(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
   if (info.Length() < 1 || !info[0].IsString()) {
@@ -136,10 +917,174 @@ Napi::Value AppLauncherWrapper::GetAppIcon(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
-  std::string appPath = info[0].As<Napi::String>();
-  std::string iconData = launcher_.GetAppIcon(appPath);
+  PrefetchOptions options;
+  if (info.Length() > 1 && info[1].IsObject()) {
+    Napi::Object obj = info[1].As<Napi::Object>();
+    if (obj.Get("includeLibraries").IsBoolean()) {
+      options.includeLibraries = obj.Get("includeLibraries").As<Napi::Boolean>().Value();
+    }
+    options.extraPaths = ToStringArray(obj.Get("extraPaths"));
+    if (obj.Get("maxBytes").IsNumber()) {
+      options.maxBytes = static_cast<uint64_t>(obj.Get("maxBytes").As<Napi::Number>().Int64Value());
+    }
+  }
 
-  return Napi::String::New(env, iconData);
+  PrefetchWorker* worker = new PrefetchWorker(env, info.This().As<Napi::Object>(), launcher_,
+                                              info[0].As<Napi::String>(), options);
+  Napi::Promise promise = worker->GetPromise();
+  worker->Queue();
+  return promise;
+}
+
+// subscribe(callback: (events: LauncherEvent[], dropped: number) => void)
+// 再次调用会替换之前的订阅
+Napi::Value AppLauncherWrapper::Subscribe(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsFunction()) {
+    Napi::TypeError::New(env, "Function expected").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (events_) {
+    events_->Close();
+  }
+  events_ = std::make_shared<EventStream>(env, info[0].As<Napi::Function>());
+
+  std::shared_ptr<EventStream> stream = events_;
+  launcher_.SetEventListener([stream](const LauncherEvent& event) {
+    stream->Push(event);
+  });
+
+  return env.Undefined();
+}
+
+Napi::Value AppLauncherWrapper::Unsubscribe(const Napi::CallbackInfo& info) {
+  launcher_.SetEventListener(nullptr);
+  if (events_) {
+    events_->Close();
+    events_.reset();
+  }
+  return info.Env().Undefined();
+}
+
+// setFocusOptions({ mode?: 'throttle' | 'freeze', cpuWeight?: number, cpuMaxPercent?: number,
+//                   stopFallback?: boolean, backgroundProcesses?: string[], statePath?: string })
+Napi::Value AppLauncherWrapper::SetFocusOptions(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Object expected").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Object object = info[0].As<Napi::Object>();
+  FocusOptions options;
+  if (object.Get("mode").IsString()) {
+    std::string mode = object.Get("mode").As<Napi::String>().Utf8Value();
+    if (mode == "freeze") {
+      options.mode = FocusMode::Freeze;
+    }
+    else if (mode != "throttle") {
+      Napi::TypeError::New(env, "Unknown focus mode: " + mode).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+  if (object.Get("cpuWeight").IsNumber()) {
+    options.cpuWeight = object.Get("cpuWeight").As<Napi::Number>().Uint32Value();
+  }
+  if (object.Get("cpuMaxPercent").IsNumber()) {
+    options.cpuMaxPercent = object.Get("cpuMaxPercent").As<Napi::Number>().Uint32Value();
+  }
+  if (object.Get("stopFallback").IsBoolean()) {
+    options.stopFallback = object.Get("stopFallback").As<Napi::Boolean>().Value();
+  }
+  options.backgroundProcesses = ToStringArray(object.Get("backgroundProcesses"));
+  if (object.Get("statePath").IsString()) {
+    options.statePath = object.Get("statePath").As<Napi::String>().Utf8Value();
+  }
+
+  std::string errorMsg;
+  if (!launcher_.SetFocusOptions(options, errorMsg)) {
+    Napi::Error::New(env, errorMsg).ThrowAsJavaScriptException();
+    return Napi::Boolean::New(env, false);
+  }
+
+  return Napi::Boolean::New(env, true);
+}
+
+static const char* DemotionMethodName(FocusDemotion::Method method) {
+  switch (method) {
+    case FocusDemotion::Method::CgroupThrottle: return "throttle";
+    case FocusDemotion::Method::CgroupFreeze: return "freeze";
+    default: return "signal";
+  }
+}
+
+// { active, foreground: number[], demotions: [{ method, ownerProcessId, processId, cgroupPath }], unthrottled: number[] }
+Napi::Value AppLauncherWrapper::GetFocusState(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  FocusState state = launcher_.GetFocusState();
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("active", Napi::Boolean::New(env, state.active));
+
+  Napi::Array foreground = Napi::Array::New(env, state.foreground.size());
+  for (size_t i = 0; i < state.foreground.size(); i++) {
+    foreground.Set(static_cast<uint32_t>(i), Napi::Number::New(env, state.foreground[i]));
+  }
+  result.Set("foreground", foreground);
+
+  Napi::Array demotions = Napi::Array::New(env, state.demotions.size());
+  for (size_t i = 0; i < state.demotions.size(); i++) {
+    const FocusDemotion& demotion = state.demotions[i];
+    Napi::Object item = Napi::Object::New(env);
+    item.Set("method", Napi::String::New(env, DemotionMethodName(demotion.method)));
+    item.Set("ownerProcessId", Napi::Number::New(env, demotion.ownerProcessId));
+    item.Set("processId", Napi::Number::New(env, demotion.processId));
+    item.Set("cgroupPath", Napi::String::New(env, demotion.cgroupPath));
+    demotions.Set(static_cast<uint32_t>(i), item);
+  }
+  result.Set("demotions", demotions);
+
+  Napi::Array unthrottled = Napi::Array::New(env, state.unthrottled.size());
+  for (size_t i = 0; i < state.unthrottled.size(); i++) {
+    unthrottled.Set(static_cast<uint32_t>(i), Napi::Number::New(env, state.unthrottled[i]));
+  }
+  result.Set("unthrottled", unthrottled);
+
+  return result;
+}
+
+Napi::Value AppLauncherWrapper::EndFocus(const Napi::CallbackInfo& info) {
+  launcher_.EndFocus();
+  return info.Env().Undefined();
+}
+
+Napi::Value AppLauncherWrapper::SetLaunchConcurrency(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Number expected").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  launcher_.SetLaunchConcurrency(info[0].As<Napi::Number>().Uint32Value());
+  return env.Undefined();
+}
+
+// { concurrency, queued, running, submitted, coalesced }
+Napi::Value AppLauncherWrapper::GetLaunchStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  LaunchSchedulerStats stats = launcher_.GetLaunchSchedulerStats();
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("concurrency", Napi::Number::New(env, stats.concurrency));
+  result.Set("queued", Napi::Number::New(env, stats.queued));
+  result.Set("running", Napi::Number::New(env, stats.running));
+  result.Set("submitted", Napi::Number::New(env, static_cast<double>(stats.submitted)));
+  result.Set("coalesced", Napi::Number::New(env, static_cast<double>(stats.coalesced)));
+  return result;
 }
 
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
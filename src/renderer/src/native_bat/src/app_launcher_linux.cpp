@@ -0,0 +1,725 @@
+#include "app_launcher.h"
+#include "cgroup_v2.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+namespace {
+
+// 退回轮询时的检查间隔
+constexpr int kPollIntervalMs = 2000;
+// 扫描模式下查找新后代的间隔
+constexpr int kDescendantScanMs = 100;
+// 不属于任何会话的子进程保持僵尸状态超过该时间后由启动器回收。libuv 和 Chromium 只按各自的 pid
+// 在收到 SIGCHLD 后立即回收，超过这个时间仍未回收的只能是被重新挂到本进程下的孤儿
+constexpr double kStrayReapMs = 10000.0;
+constexpr int kMaxEvents = 32;
+
+int PidfdOpen(pid_t pid) {
+  return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+}
+
+// 列出进程的直接子进程（只扫描 /proc/<pid>/task/*/children，不遍历整个 /proc）
+std::vector<uint32_t> ListChildren(uint32_t processId) {
+  std::vector<uint32_t> children;
+  char path[320];
+  snprintf(path, sizeof(path), "/proc/%u/task", processId);
+  DIR* dir = opendir(path);
+  if (!dir) {
+    return children;
+  }
+
+  while (dirent* entry = readdir(dir)) {
+    if (entry->d_name[0] == '.') {
+      continue;
+    }
+    snprintf(path, sizeof(path), "/proc/%u/task/%s/children", processId, entry->d_name);
+    FILE* file = fopen(path, "re");
+    if (!file) {
+      continue;
+    }
+    unsigned int childId;
+    while (fscanf(file, "%u", &childId) == 1) {
+      children.push_back(childId);
+    }
+    fclose(file);
+  }
+  closedir(dir);
+  return children;
+}
+
+// 读取 /proc/<pid>/stat 中的进程状态和会话 ID
+bool ReadProcessStat(uint32_t processId, char& state, uint32_t& sessionId) {
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/%u/stat", processId);
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  char buffer[512];
+  ssize_t bytes = read(fd, buffer, sizeof(buffer) - 1);
+  close(fd);
+  if (bytes <= 0) {
+    return false;
+  }
+  buffer[bytes] = '\0';
+
+  // comm 可能包含空格，从最后一个 ')' 之后开始解析
+  const char* fields = strrchr(buffer, ')');
+  int session = -1;
+  if (!fields || sscanf(fields + 2, "%c %*d %*d %d", &state, &session) != 2) {
+    return false;
+  }
+  sessionId = static_cast<uint32_t>(session);
+  return true;
+}
+
+} // namespace
+
+bool AppLauncher::InitMonitor() {
+  epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epollFd_ < 0) {
+    return false;
+  }
+
+  wakeFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (wakeFd_ < 0) {
+    close(epollFd_);
+    epollFd_ = -1;
+    return false;
+  }
+
+  epoll_event ev{};
+  ev.events = EPOLLIN;
+  ev.data.fd = wakeFd_;
+  if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev) != 0) {
+    ShutdownMonitor();
+    return false;
+  }
+
+  int probe = PidfdOpen(getpid());
+  pidfdSupported_ = probe >= 0;
+  if (probe >= 0) {
+    close(probe);
+  }
+
+  return true;
+}
+
+void AppLauncher::ShutdownMonitor() {
+  for (const auto& pair : watchedFds_) {
+    close(pair.first);
+  }
+  watchedFds_.clear();
+  trees_.clear();
+
+  if (wakeFd_ >= 0) {
+    close(wakeFd_);
+    wakeFd_ = -1;
+  }
+  if (epollFd_ >= 0) {
+    close(epollFd_);
+    epollFd_ = -1;
+  }
+}
+
+void AppLauncher::WakeMonitor() {
+  if (wakeFd_ >= 0) {
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeFd_, &one, sizeof(one));
+    (void)ignored;
+  }
+  else {
+    monitorCv_.notify_all();
+  }
+}
+
+// 为一次启动创建 cgroup v2 叶子节点，子进程在 exec 前写入 procsFd 加入其中。
+// 无法使用 cgroup 时退回扫描模式：由监控线程沿子进程列表跟踪后代，并在创建进程前成为子进程收割者，
+// 启动器脚本派生后立即退出时孤儿后代会被重新挂到本进程下
+std::string AppLauncher::PrepareSessionCgroup(int& procsFd) {
+  procsFd = -1;
+  if (!pidfdSupported_) {
+    return "";
+  }
+
+  char name[64];
+  snprintf(name, sizeof(name), "radish-%d-%u", static_cast<int>(getpid()), cgroupSerial_++);
+  std::string path = CgroupCreateLeaf(name);
+  if (!path.empty()) {
+    procsFd = CgroupOpenFile(path, "cgroup.procs", O_WRONLY);
+    if (procsFd >= 0) {
+      return path;
+    }
+    CgroupRemove(path);
+  }
+
+  std::call_once(subreaperOnce_, [this] {
+    subreaper_ = prctl(PR_SET_CHILD_SUBREAPER, 1) == 0;
+  });
+  return "";
+}
+
+// 启动配置中的 cgroup 限制。控制器未启用时写入失败，按尽力而为处理
+void AppLauncher::ApplyCgroupLimits(const std::string& cgroupPath, const LaunchProfile& profile) {
+  if (profile.cpuWeight) {
+    CgroupWriteFile(cgroupPath, "cpu.weight", std::to_string(*profile.cpuWeight));
+  }
+  if (profile.memoryHigh) {
+    CgroupWriteFile(cgroupPath, "memory.high", std::to_string(*profile.memoryHigh));
+  }
+}
+
+// 调用方需持有 mutex_
+std::shared_ptr<AppLauncher::TreeMembers> AppLauncher::WatchProcess(const std::string& appId, uint32_t processId,
+                                                                    const std::string& cgroupPath) {
+  int pidfd = epollFd_ >= 0 ? PidfdOpen(static_cast<pid_t>(processId)) : -1;
+  if (pidfd >= 0) {
+    ProcessTree& tree = trees_[processId];
+    tree = ProcessTree();
+    tree.appId = appId;
+    tree.cgroupPath = cgroupPath;
+    tree.members = std::make_shared<TreeMembers>();
+
+    // 先登记再加入 epoll，保证监控线程收到事件时能找到对应记录
+    watchedFds_[pidfd] = WatchedProcess{ appId, processId, processId, WatchKind::Process };
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = pidfd;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, pidfd, &ev) == 0) {
+      // populated 变化时 cgroup.events 产生 EPOLLPRI
+      if (!cgroupPath.empty()) {
+        tree.eventsFd = CgroupOpenFile(cgroupPath, "cgroup.events", O_RDONLY);
+        if (tree.eventsFd >= 0) {
+          watchedFds_[tree.eventsFd] = WatchedProcess{ appId, 0, processId, WatchKind::CgroupEvents };
+          ev.events = EPOLLPRI;
+          ev.data.fd = tree.eventsFd;
+          epoll_ctl(epollFd_, EPOLL_CTL_ADD, tree.eventsFd, &ev);
+        }
+      }
+      else {
+        // 监控线程可能正无限期等待，唤醒后按扫描间隔查找后代
+        WakeMonitor();
+      }
+      return tree.members;
+    }
+
+    watchedFds_.erase(pidfd);
+    trees_.erase(processId);
+    close(pidfd);
+  }
+
+  // 内核不支持 pidfd（< 5.3）或 epoll 不可用时退回轮询，只跟踪直接子进程
+  CgroupRemove(cgroupPath);
+  polledProcesses_[processId] = appId;
+  WakeMonitor();
+  return std::make_shared<TreeMembers>();
+}
+
+// cgroup 模式取 cgroup.procs 中的进程（僵尸进程不在其中）；扫描模式取监控线程已发现且尚未退出的后代
+std::function<uint32_t(uint32_t)> AppLauncher::MakeTreeResolver(uint32_t rootProcessId, const std::string& cgroupPath,
+                                                                std::shared_ptr<TreeMembers> members) {
+  return [rootProcessId, cgroupPath, members](uint32_t exitedProcessId) -> uint32_t {
+    std::vector<uint32_t> candidates;
+    if (!cgroupPath.empty()) {
+      candidates = CgroupReadProcs(cgroupPath);
+    }
+    else {
+      std::lock_guard<std::mutex> lock(members->mutex);
+      candidates.assign(members->processes.begin(), members->processes.end());
+    }
+    for (uint32_t processId : candidates) {
+      if (processId != exitedProcessId && processId != rootProcessId) {
+        return processId;
+      }
+    }
+    return 0;
+  };
+}
+
+// 调用方需持有 mutex_
+void AppLauncher::SignalProcessTree(uint32_t rootProcessId, int signal) {
+  auto it = trees_.find(rootProcessId);
+  if (it == trees_.end()) {
+    return;
+  }
+
+  const ProcessTree& tree = it->second;
+  if (!tree.cgroupPath.empty()) {
+    for (uint32_t processId : CgroupReadProcs(tree.cgroupPath)) {
+      kill(static_cast<pid_t>(processId), signal);
+    }
+  }
+  for (uint32_t processId : tree.descendants) {
+    kill(static_cast<pid_t>(processId), signal);
+  }
+}
+
+void AppLauncher::MonitorProcesses() {
+  // 没有 epoll 时只能定期回收 polledProcesses_ 中的进程
+  if (epollFd_ < 0) {
+    while (!stopMonitor_) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        monitorCv_.wait_for(lock, std::chrono::milliseconds(kPollIntervalMs), [this] { return stopMonitor_.load(); });
+      }
+      if (stopMonitor_) {
+        break;
+      }
+      PollProcesses();
+    }
+    return;
+  }
+
+  epoll_event events[kMaxEvents];
+  auto lastScan = std::chrono::steady_clock::now();
+
+  while (!stopMonitor_) {
+    bool poll = false;
+    bool scanning = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      poll = !polledProcesses_.empty();
+      scanning = std::any_of(trees_.begin(), trees_.end(),
+                             [](const std::pair<const uint32_t, ProcessTree>& pair) { return pair.second.cgroupPath.empty(); });
+    }
+    // 成为收割者后孤儿随时可能被挂到本进程下，没有扫描模式的进程树时也低频检查
+    int scanInterval = scanning ? kDescendantScanMs : (subreaper_ ? kPollIntervalMs : -1);
+    int timeout = scanInterval >= 0 ? scanInterval : (poll ? kPollIntervalMs : -1);
+
+    int count = epoll_wait(epollFd_, events, kMaxEvents, timeout);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+
+    std::vector<int> readyFds;
+    for (int i = 0; i < count; i++) {
+      int fd = events[i].data.fd;
+      if (fd == wakeFd_) {
+        uint64_t value;
+        ssize_t ignored = read(wakeFd_, &value, sizeof(value));
+        (void)ignored;
+        continue;
+      }
+      readyFds.push_back(fd);
+    }
+
+    if (stopMonitor_) {
+      break;
+    }
+
+    if (!readyFds.empty()) {
+      HandleEvents(readyFds);
+    }
+
+    // 事件频繁时也按间隔扫描，不随每次唤醒进行
+    auto now = std::chrono::steady_clock::now();
+    if (scanInterval >= 0 && now - lastScan >= std::chrono::milliseconds(scanInterval)) {
+      lastScan = now;
+      ScanDescendants();
+    }
+
+    if (poll) {
+      PollProcesses();
+    }
+  }
+}
+
+// 扫描模式：从树中仍存活的进程出发，沿子进程列表找出新的后代并监听其 pidfd，
+// 后代调用 setsid 也能跟踪。本进程是收割者时再检查自己的子进程：按会话 ID 认领
+// 父进程退出前未被扫描到的后代（启动器脚本派生后立即退出），其余孤儿退出后回收，不留下僵尸进程
+void AppLauncher::ScanDescendants() {
+  std::vector<std::pair<uint32_t, std::vector<uint32_t>>> trees; // 根进程, 已知的存活进程
+  std::set<uint32_t> tracked; // 所有进程树的根进程和已知后代，以及轮询的进程
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& pair : polledProcesses_) {
+      tracked.insert(pair.first);
+    }
+    for (const auto& pair : trees_) {
+      tracked.insert(pair.first);
+      tracked.insert(pair.second.descendants.begin(), pair.second.descendants.end());
+      if (!pair.second.cgroupPath.empty()) {
+        continue;
+      }
+      std::vector<uint32_t> known(pair.second.descendants.begin(), pair.second.descendants.end());
+      if (!pair.second.rootExited) {
+        known.push_back(pair.first);
+      }
+      trees.emplace_back(pair.first, std::move(known));
+    }
+  }
+
+  struct Descendant {
+    uint32_t rootProcessId;
+    uint32_t processId;
+    int pidfd;
+  };
+  std::vector<Descendant> found;
+  for (const auto& tree : trees) {
+    std::vector<uint32_t> pending = tree.second;
+    while (!pending.empty()) {
+      uint32_t parent = pending.back();
+      pending.pop_back();
+      for (uint32_t child : ListChildren(parent)) {
+        if (!tracked.insert(child).second) {
+          continue;
+        }
+        pending.push_back(child);
+        int pidfd = PidfdOpen(static_cast<pid_t>(child));
+        if (pidfd >= 0) {
+          found.push_back(Descendant{ tree.first, child, pidfd });
+        }
+      }
+    }
+  }
+
+  if (subreaper_) {
+    double now = MonotonicMs();
+    std::map<uint32_t, double> zombies;
+    for (uint32_t child : ListChildren(static_cast<uint32_t>(getpid()))) {
+      char state = 0;
+      uint32_t sessionId = 0;
+      if (tracked.count(child) || !ReadProcessStat(child, state, sessionId)) {
+        continue;
+      }
+      if (state == 'Z') {
+        auto since = strayZombies_.find(child);
+        double first = since != strayZombies_.end() ? since->second : now;
+        if (now - first < kStrayReapMs) {
+          zombies[child] = first;
+        }
+        else {
+          siginfo_t info{};
+          waitid(P_PID, static_cast<id_t>(child), &info, WEXITED | WNOHANG);
+        }
+        continue;
+      }
+      auto tree = std::find_if(trees.begin(), trees.end(),
+                               [sessionId](const std::pair<uint32_t, std::vector<uint32_t>>& item) { return item.first == sessionId; });
+      if (sessionId == child || tree == trees.end()) {
+        continue;
+      }
+      int pidfd = PidfdOpen(static_cast<pid_t>(child));
+      if (pidfd >= 0) {
+        found.push_back(Descendant{ tree->first, child, pidfd });
+      }
+    }
+    // 已被其他代码回收的不再记录
+    strayZombies_.swap(zombies);
+  }
+
+  if (found.empty()) {
+    return;
+  }
+
+  std::vector<int> adoptedFds;
+  std::vector<int> unusedFds;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& descendant : found) {
+      auto it = trees_.find(descendant.rootProcessId);
+      if (it == trees_.end() || !it->second.descendants.insert(descendant.processId).second) {
+        unusedFds.push_back(descendant.pidfd);
+        continue;
+      }
+      {
+        std::lock_guard<std::mutex> membersLock(it->second.members->mutex);
+        it->second.members->processes.insert(descendant.processId);
+      }
+      watchedFds_[descendant.pidfd] =
+        WatchedProcess{ it->second.appId, descendant.processId, descendant.rootProcessId, WatchKind::Process };
+      adoptedFds.push_back(descendant.pidfd);
+    }
+  }
+
+  // 已经退出的后代加入后立即可读，由下一次 HandleEvents 处理
+  for (int fd : adoptedFds) {
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev);
+  }
+  for (int fd : unusedFds) {
+    close(fd);
+  }
+}
+
+// pidfd 可读说明进程已结束；cgroup.events 可读说明 populated 可能变化。
+// 所有系统调用都在锁外执行，锁内只更新表
+void AppLauncher::HandleEvents(const std::vector<int>& readyFds) {
+  std::vector<std::pair<int, WatchedProcess>> exited;
+  std::set<uint32_t> changedRoots;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int fd : readyFds) {
+      auto it = watchedFds_.find(fd);
+      if (it == watchedFds_.end()) {
+        continue;
+      }
+      if (it->second.kind == WatchKind::CgroupEvents) {
+        changedRoots.insert(it->second.rootProcessId);
+        continue;
+      }
+      exited.emplace_back(fd, it->second);
+      watchedFds_.erase(it);
+    }
+  }
+
+  // 先从表中移除再关闭，避免 fd 号被新的 pidfd 复用后误删
+  std::vector<ExitInfo> exitInfos(exited.size());
+  for (size_t i = 0; i < exited.size(); i++) {
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, exited[i].first, nullptr);
+    close(exited[i].first);
+    ReapProcess(exited[i].second.processId, exitInfos[i]);
+  }
+
+  // 更新进程树，找出根进程已退出、需要确认是否还有后代的树
+  std::vector<std::pair<uint32_t, int>> cgroupTrees; // 根进程, cgroup.events
+  std::vector<uint32_t> scannedTrees;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < exited.size(); i++) {
+      const WatchedProcess& process = exited[i].second;
+      auto it = trees_.find(process.rootProcessId);
+      if (it == trees_.end()) {
+        continue;
+      }
+      if (process.processId == process.rootProcessId) {
+        it->second.rootExited = true;
+        it->second.rootExit = exitInfos[i];
+      }
+      else {
+        it->second.descendants.erase(process.processId);
+        std::lock_guard<std::mutex> membersLock(it->second.members->mutex);
+        it->second.members->processes.erase(process.processId);
+      }
+      changedRoots.insert(process.rootProcessId);
+    }
+
+    for (uint32_t root : changedRoots) {
+      auto it = trees_.find(root);
+      if (it == trees_.end() || !it->second.rootExited) {
+        continue;
+      }
+      if (it->second.eventsFd >= 0) {
+        cgroupTrees.emplace_back(root, it->second.eventsFd);
+      }
+      else {
+        scannedTrees.push_back(root);
+      }
+    }
+  }
+
+  std::vector<uint32_t> finishedRoots;
+  for (const auto& tree : cgroupTrees) {
+    if (CgroupReadPopulated(tree.second) <= 0) {
+      finishedRoots.push_back(tree.first);
+    }
+  }
+
+  // 扫描模式下退出进程的子进程刚被挂到本进程下，先认领再判断会话是否结束
+  if (!scannedTrees.empty()) {
+    ScanDescendants();
+  }
+
+  std::vector<std::pair<uint32_t, ProcessTree>> finished;
+  std::vector<SessionEnd> ends;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 扫描模式：已发现的后代都退出后会话结束
+    for (uint32_t root : scannedTrees) {
+      auto it = trees_.find(root);
+      if (it != trees_.end() && it->second.descendants.empty()) {
+        finishedRoots.push_back(root);
+      }
+    }
+
+    for (uint32_t root : finishedRoots) {
+      auto it = trees_.find(root);
+      if (it == trees_.end()) {
+        continue;
+      }
+      QueueSessionEnd(SessionEnd{ it->second.appId, root, RecordProcessExit(it->second.appId, root, it->second.rootExit) },
+                      ends);
+      if (it->second.eventsFd >= 0) {
+        watchedFds_.erase(it->second.eventsFd);
+      }
+      finished.emplace_back(root, it->second);
+      trees_.erase(it);
+    }
+  }
+
+  for (const auto& item : finished) {
+    const ProcessTree& tree = item.second;
+    if (tree.eventsFd >= 0) {
+      epoll_ctl(epollFd_, EPOLL_CTL_DEL, tree.eventsFd, nullptr);
+      close(tree.eventsFd);
+    }
+    CgroupRemove(tree.cgroupPath);
+  }
+  for (const SessionEnd& end : ends) {
+    FinishSession(end);
+  }
+}
+
+// 调用方需持有 mutex_
+void AppLauncher::QueueSessionEnd(SessionEnd end, std::vector<SessionEnd>& ends) {
+  if (registeringProcesses_.count(end.processId)) {
+    uint32_t processId = end.processId;
+    deferredEnds_[processId] = std::move(end);
+    return;
+  }
+  ends.push_back(std::move(end));
+}
+
+void AppLauncher::RegisterSession(const AppInfo& appInfo, uint32_t processId, const std::string& cgroupPath,
+                                  std::shared_ptr<TreeMembers> members, double entry, const int outputFds[2],
+                                  const std::vector<FocusController::Target>& focusTargets) {
+  sampler_.Track(appInfo.appId, processId, MakeTreeResolver(processId, cgroupPath, members));
+  hangDetector_.Track(appInfo.appId, processId, MakeTreeResolver(processId, cgroupPath, members));
+  tracer_.Track(appInfo.appId, processId, entry);
+  output_.Track(appInfo.appId, processId, entry, outputFds[0], outputFds[1]);
+  if (appInfo.foreground) {
+    focus_.Engage(processId, focusTargets);
+  }
+  else {
+    // 专注模式期间启动的其他应用同样降级
+    FocusController::Target target;
+    target.processId = processId;
+    target.cgroupPath = cgroupPath;
+    target.processes.push_back(processId);
+    focus_.Admit(target);
+  }
+
+  std::optional<SessionEnd> deferred;
+  std::vector<uint32_t> exitedTargets;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    registeringProcesses_.erase(processId);
+    launchingApps_.erase(appInfo.appId);
+    pendingPrefetch_.erase(appInfo.appId);
+    auto it = deferredEnds_.find(processId);
+    if (it != deferredEnds_.end()) {
+      deferred = std::move(it->second);
+      deferredEnds_.erase(it);
+    }
+    for (const auto& target : focusTargets) {
+      if (trees_.count(target.processId) == 0) {
+        exitedTargets.push_back(target.processId);
+      }
+    }
+  }
+
+  // 收集之后结束的应用可能在 Engage 之前已执行 OnProcessExit，留下的降级在这里丢弃
+  for (uint32_t target : exitedTargets) {
+    focus_.OnProcessExit(target);
+  }
+  if (deferred) {
+    FinishSession(*deferred);
+  }
+}
+
+void AppLauncher::FinishSession(const SessionEnd& end) {
+  // 采样数据和输出缓冲区要在 Untrack 之前取出
+  if (end.crashed) {
+    SubmitCrashReport(*end.crashed);
+  }
+  sampler_.Untrack(end.appId, end.processId);
+  hangDetector_.Untrack(end.processId);
+  tracer_.Untrack(end.processId);
+  focus_.OnProcessExit(end.processId);
+}
+
+void AppLauncher::SubmitCrashReport(const LaunchRecord& record) {
+  if (!crashReporter_.IsEnabled()) {
+    return;
+  }
+
+  CrashReport report;
+  report.appId = record.appId;
+  report.processId = record.processId;
+  report.startTime = record.startTime;
+  report.endTime = record.endTime;
+  report.startTimestamp = record.startTimestamp;
+  report.endTimestamp = std::chrono::duration<double, std::milli>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+  report.duration = record.duration;
+  report.exitCode = record.exitCode;
+  report.exitSignal = record.exitSignal;
+  report.coreDumped = record.coreDumped;
+  report.userCpuTime = record.userCpuTime;
+  report.systemCpuTime = record.systemCpuTime;
+  report.maxRss = record.maxRss;
+  report.minorFaults = record.minorFaults;
+  report.majorFaults = record.majorFaults;
+
+  // 进程已退出，快照和采样序列都停留在最后一次采样
+  report.snapshot = sampler_.GetSnapshot(record.appId, record.processId);
+  std::vector<ResourceSample> series = sampler_.GetSeries(record.appId);
+  size_t first = series.size() > CrashReporter::kMaxSamples ? series.size() - CrashReporter::kMaxSamples : 0;
+  report.samples.assign(series.begin() + static_cast<std::ptrdiff_t>(first), series.end());
+  // 退出时管道里可能还有捕获线程没读到的最后输出
+  output_.Flush(record.appId);
+  report.output = output_.Tail(record.appId, CrashReporter::kOutputBytes);
+
+  crashReporter_.Submit(std::move(report));
+}
+
+void AppLauncher::PollProcesses() {
+  std::map<uint32_t, std::string> targets;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    targets = polledProcesses_;
+  }
+
+  // 在锁外回收已退出的进程（包括已被 TerminateApp 结束的进程）
+  std::vector<std::pair<uint32_t, ExitInfo>> exited;
+  for (const auto& target : targets) {
+    ExitInfo exitInfo;
+    if (ReapProcess(target.first, exitInfo)) {
+      exited.emplace_back(target.first, exitInfo);
+    }
+  }
+
+  if (exited.empty()) {
+    return;
+  }
+
+  std::vector<SessionEnd> ends;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& item : exited) {
+      const std::string& appId = targets[item.first];
+      QueueSessionEnd(SessionEnd{ appId, item.first, RecordProcessExit(appId, item.first, item.second) }, ends);
+      polledProcesses_.erase(item.first);
+    }
+  }
+
+  for (const SessionEnd& end : ends) {
+    FinishSession(end);
+  }
+}
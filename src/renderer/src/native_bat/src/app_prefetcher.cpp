@@ -0,0 +1,605 @@
+#define _CRT_SECURE_NO_WARNINGS 1
+#include "app_prefetcher.h"
+
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <set>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <elf.h>
+#include <glob.h>
+#endif
+
+namespace {
+
+double NowMs() {
+  return std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct PrefetchState {
+  std::atomic<size_t> pending{ 0 };
+  std::atomic<uint32_t> files{ 0 };
+  std::atomic<uint64_t> bytes{ 0 };
+  std::atomic<uint64_t> budget{ 0 };
+  double startTime = 0.0;
+  AppPrefetcher::Completion done;
+
+  void Finish() {
+    PrefetchResult result;
+    result.files = files;
+    result.bytes = bytes;
+    result.duration = NowMs() - startTime;
+    if (done) {
+      done(result);
+    }
+  }
+};
+
+#ifndef _WIN32
+
+void CollectDirectory(const std::string& path, int depth, std::vector<std::string>& files) {
+  DIR* dir = opendir(path.c_str());
+  if (!dir) {
+    return;
+  }
+
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != nullptr && files.size() < AppPrefetcher::kMaxFiles) {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+      continue;
+    }
+
+    std::string child = path + "/" + entry->d_name;
+    struct stat st;
+    if (stat(child.c_str(), &st) != 0) {
+      continue;
+    }
+    if (S_ISREG(st.st_mode)) {
+      files.push_back(child);
+    }
+    else if (S_ISDIR(st.st_mode) && depth > 0) {
+      CollectDirectory(child, depth - 1, files);
+    }
+  }
+  closedir(dir);
+}
+
+#endif
+
+#ifdef __linux__
+
+// 可执行文件或共享库的动态链接信息
+struct ElfInfo {
+  int elfClass = 0;
+  std::string interpreter;
+  std::vector<std::string> needed;
+  std::vector<std::string> rpath;
+  std::vector<std::string> runpath;
+};
+
+std::vector<std::string> SplitSearchPath(const std::string& value, const std::string& origin) {
+  std::vector<std::string> paths;
+  size_t begin = 0;
+  while (begin <= value.size()) {
+    size_t end = value.find(':', begin);
+    if (end == std::string::npos) {
+      end = value.size();
+    }
+
+    std::string path = value.substr(begin, end - begin);
+    for (const char* token : { "${ORIGIN}", "$ORIGIN" }) {
+      size_t pos;
+      while ((pos = path.find(token)) != std::string::npos) {
+        path.replace(pos, strlen(token), origin);
+      }
+    }
+    if (!path.empty()) {
+      paths.push_back(path);
+    }
+    begin = end + 1;
+  }
+  return paths;
+}
+
+template <class Ehdr, class Phdr, class Dyn>
+bool ParseElf(const uint8_t* data, size_t size, const std::string& origin, ElfInfo& info) {
+  const Ehdr* ehdr = reinterpret_cast<const Ehdr*>(data);
+  if (size < sizeof(Ehdr) || ehdr->e_phentsize != sizeof(Phdr) ||
+      ehdr->e_phoff + static_cast<uint64_t>(ehdr->e_phnum) * sizeof(Phdr) > size) {
+    return false;
+  }
+
+  const Phdr* phdrs = reinterpret_cast<const Phdr*>(data + ehdr->e_phoff);
+  const Phdr* dynamic = nullptr;
+  for (size_t i = 0; i < ehdr->e_phnum; i++) {
+    const Phdr& phdr = phdrs[i];
+    if (phdr.p_type == PT_INTERP && phdr.p_offset + phdr.p_filesz <= size) {
+      const char* interp = reinterpret_cast<const char*>(data + phdr.p_offset);
+      info.interpreter.assign(interp, strnlen(interp, phdr.p_filesz));
+    }
+    else if (phdr.p_type == PT_DYNAMIC) {
+      dynamic = &phdr;
+    }
+  }
+
+  if (!dynamic) {
+    return true; // 静态链接
+  }
+  if (dynamic->p_offset + dynamic->p_filesz > size) {
+    return false;
+  }
+
+  // DT_STRTAB 是虚拟地址，需要通过 PT_LOAD 段换算成文件偏移
+  auto toOffset = [&](uint64_t address, uint64_t& offset) {
+    for (size_t i = 0; i < ehdr->e_phnum; i++) {
+      const Phdr& phdr = phdrs[i];
+      if (phdr.p_type == PT_LOAD && address >= phdr.p_vaddr && address < phdr.p_vaddr + phdr.p_filesz) {
+        offset = address - phdr.p_vaddr + phdr.p_offset;
+        return true;
+      }
+    }
+    return false;
+  };
+
+  const Dyn* entries = reinterpret_cast<const Dyn*>(data + dynamic->p_offset);
+  size_t count = dynamic->p_filesz / sizeof(Dyn);
+  uint64_t strtab = 0;
+  std::vector<uint64_t> needed;
+  int64_t rpath = -1, runpath = -1;
+
+  for (size_t i = 0; i < count && entries[i].d_tag != DT_NULL; i++) {
+    switch (entries[i].d_tag) {
+      case DT_NEEDED: needed.push_back(entries[i].d_un.d_val); break;
+      case DT_STRTAB: strtab = entries[i].d_un.d_ptr; break;
+      case DT_RPATH: rpath = static_cast<int64_t>(entries[i].d_un.d_val); break;
+      case DT_RUNPATH: runpath = static_cast<int64_t>(entries[i].d_un.d_val); break;
+      default: break;
+    }
+  }
+
+  uint64_t strOffset = 0;
+  if (!toOffset(strtab, strOffset) || strOffset >= size) {
+    return false;
+  }
+
+  auto readString = [&](uint64_t index) {
+    if (strOffset + index >= size) {
+      return std::string();
+    }
+    const char* str = reinterpret_cast<const char*>(data + strOffset + index);
+    return std::string(str, strnlen(str, size - strOffset - index));
+  };
+
+  for (uint64_t index : needed) {
+    std::string name = readString(index);
+    if (!name.empty()) {
+      info.needed.push_back(name);
+    }
+  }
+  if (rpath >= 0) {
+    info.rpath = SplitSearchPath(readString(rpath), origin);
+  }
+  if (runpath >= 0) {
+    info.runpath = SplitSearchPath(readString(runpath), origin);
+  }
+  return true;
+}
+
+bool ReadElfInfo(const std::string& path, ElfInfo& info) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < EI_NIDENT) {
+    close(fd);
+    return false;
+  }
+
+  size_t size = static_cast<size_t>(st.st_size);
+  void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return false;
+  }
+
+  const uint8_t* data = static_cast<const uint8_t*>(addr);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  const uint8_t hostData = ELFDATA2LSB;
+#else
+  const uint8_t hostData = ELFDATA2MSB;
+#endif
+
+  bool ok = false;
+  if (memcmp(data, ELFMAG, SELFMAG) == 0 && data[EI_DATA] == hostData) {
+    size_t slash = path.rfind('/');
+    std::string origin = slash == std::string::npos ? "." : path.substr(0, slash);
+
+    info.elfClass = data[EI_CLASS];
+    if (info.elfClass == ELFCLASS64) {
+      ok = ParseElf<Elf64_Ehdr, Elf64_Phdr, Elf64_Dyn>(data, size, origin, info);
+    }
+    else if (info.elfClass == ELFCLASS32) {
+      ok = ParseElf<Elf32_Ehdr, Elf32_Phdr, Elf32_Dyn>(data, size, origin, info);
+    }
+  }
+
+  munmap(addr, size);
+  return ok;
+}
+
+void ParseLdSoConf(const std::string& path, int depth, std::vector<std::string>& dirs) {
+  std::ifstream file(path);
+  std::string line;
+  while (std::getline(file, line)) {
+    size_t comment = line.find('#');
+    if (comment != std::string::npos) {
+      line.erase(comment);
+    }
+    size_t begin = line.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+      continue;
+    }
+    size_t end = line.find_last_not_of(" \t\r");
+    line = line.substr(begin, end - begin + 1);
+
+    if (line.compare(0, 8, "include ") == 0) {
+      if (depth <= 0) {
+        continue;
+      }
+      std::string pattern = line.substr(8);
+      pattern.erase(0, pattern.find_first_not_of(" \t"));
+      if (!pattern.empty() && pattern[0] != '/') {
+        pattern = "/etc/" + pattern;
+      }
+
+      glob_t matches;
+      if (glob(pattern.c_str(), 0, nullptr, &matches) == 0) {
+        for (size_t i = 0; i < matches.gl_pathc; i++) {
+          ParseLdSoConf(matches.gl_pathv[i], depth - 1, dirs);
+        }
+      }
+      globfree(&matches);
+    }
+    else if (line[0] == '/') {
+      dirs.push_back(line);
+    }
+  }
+}
+
+// /etc/ld.so.conf 中的目录加上默认目录，进程内只解析一次
+const std::vector<std::string>& SystemLibraryDirs() {
+  static const std::vector<std::string> dirs = [] {
+    std::vector<std::string> result;
+    ParseLdSoConf("/etc/ld.so.conf", 4, result);
+    for (const char* dir : { "/lib64", "/usr/lib64", "/lib", "/usr/lib" }) {
+      result.push_back(dir);
+    }
+    return result;
+  }();
+  return dirs;
+}
+
+// 按动态加载器的顺序查找依赖库：DT_RPATH（无 DT_RUNPATH 时）、LD_LIBRARY_PATH、DT_RUNPATH、系统目录。
+// 跳过 ELF class 不匹配的候选（例如 64 位进程搜索到 32 位库）
+bool ResolveLibrary(const std::string& name, const ElfInfo& requester, const ElfInfo& executable,
+                    std::string& resolved, ElfInfo& info) {
+  auto tryPath = [&](const std::string& candidate) {
+    ElfInfo candidateInfo;
+    if (!ReadElfInfo(candidate, candidateInfo) || candidateInfo.elfClass != executable.elfClass) {
+      return false;
+    }
+    resolved = candidate;
+    info = std::move(candidateInfo);
+    return true;
+  };
+
+  if (name.find('/') != std::string::npos) {
+    return tryPath(name);
+  }
+
+  std::vector<std::string> dirs;
+  if (requester.runpath.empty()) {
+    dirs.insert(dirs.end(), requester.rpath.begin(), requester.rpath.end());
+    if (&requester != &executable) {
+      dirs.insert(dirs.end(), executable.rpath.begin(), executable.rpath.end());
+    }
+  }
+  const char* libraryPath = getenv("LD_LIBRARY_PATH");
+  if (libraryPath) {
+    auto envDirs = SplitSearchPath(libraryPath, ".");
+    dirs.insert(dirs.end(), envDirs.begin(), envDirs.end());
+  }
+  dirs.insert(dirs.end(), requester.runpath.begin(), requester.runpath.end());
+  const auto& systemDirs = SystemLibraryDirs();
+  dirs.insert(dirs.end(), systemDirs.begin(), systemDirs.end());
+
+  for (const auto& dir : dirs) {
+    if (tryPath(dir + "/" + name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// 同一个库可能经由不同的符号链接路径被引用（例如 /lib64 与 /lib/x86_64-linux-gnu）
+std::string CanonicalPath(const std::string& path) {
+  char* real = realpath(path.c_str(), nullptr);
+  if (!real) {
+    return path;
+  }
+  std::string result(real);
+  free(real);
+  return result;
+}
+
+void CollectLibraries(const std::string& executablePath, std::set<std::string>& seen, std::vector<std::string>& files) {
+  ElfInfo executable;
+  if (!ReadElfInfo(executablePath, executable)) {
+    return;
+  }
+
+  seen.insert(CanonicalPath(executablePath));
+  if (!executable.interpreter.empty() && seen.insert(CanonicalPath(executable.interpreter)).second) {
+    files.push_back(executable.interpreter);
+  }
+
+  // 广度优先遍历依赖，与加载器的加载顺序一致
+  std::vector<ElfInfo> objects;
+  objects.push_back(executable);
+  std::set<std::string> resolvedNames;
+
+  for (size_t i = 0; i < objects.size() && files.size() < AppPrefetcher::kMaxFiles; i++) {
+    std::vector<std::string> needed = objects[i].needed;
+    for (const auto& name : needed) {
+      if (!resolvedNames.insert(name).second) {
+        continue;
+      }
+
+      std::string resolved;
+      ElfInfo info;
+      if (!ResolveLibrary(name, objects[i], executable, resolved, info)) {
+        continue;
+      }
+      if (seen.insert(CanonicalPath(resolved)).second) {
+        files.push_back(resolved);
+        objects.push_back(std::move(info));
+      }
+    }
+  }
+}
+
+#endif // __linux__
+
+#ifdef __linux__
+
+// 脚本的 #! 解释器路径，不是脚本时返回空字符串
+std::string ReadShebang(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  char buffer[256] = {};
+  file.read(buffer, sizeof(buffer) - 1);
+  if (buffer[0] != '#' || buffer[1] != '!') {
+    return "";
+  }
+
+  std::string line(buffer + 2, strcspn(buffer + 2, "\r\n"));
+  size_t begin = line.find_first_not_of(" \t");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  size_t end = line.find_first_of(" \t", begin);
+  return line.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+}
+
+#endif
+
+} // namespace
+
+AppPrefetcher::AppPrefetcher() {
+}
+
+AppPrefetcher::~AppPrefetcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void AppPrefetcher::Prefetch(const std::string& executablePath, const PrefetchOptions& options, Completion done) {
+  auto state = std::make_shared<PrefetchState>();
+  state->startTime = NowMs();
+  state->budget = options.maxBytes;
+  state->done = std::move(done);
+
+  Post([this, state, executablePath, options] {
+    std::vector<std::string> files = CollectFiles(executablePath, options);
+    if (files.empty()) {
+      state->Finish();
+      return;
+    }
+
+    // 每个文件单独提交，网络文件系统上可以并行等待
+    state->pending = files.size();
+    for (const auto& file : files) {
+      Post([state, file] {
+        uint64_t bytes = PrefetchFile(file, state->budget);
+        if (bytes > 0) {
+          state->files++;
+          state->bytes += bytes;
+        }
+        if (--state->pending == 0) {
+          state->Finish();
+        }
+      });
+    }
+  });
+}
+
+std::vector<std::string> AppPrefetcher::CollectFiles(const std::string& executablePath, const PrefetchOptions& options) {
+  std::vector<std::string> files;
+  std::set<std::string> seen;
+
+  files.push_back(executablePath);
+  seen.insert(executablePath);
+
+#ifdef __linux__
+  if (options.includeLibraries) {
+    // 启动脚本预读其解释器
+    std::string interpreter = ReadShebang(executablePath);
+    if (!interpreter.empty() && seen.insert(interpreter).second) {
+      files.push_back(interpreter);
+      CollectLibraries(interpreter, seen, files);
+    }
+    else {
+      CollectLibraries(executablePath, seen, files);
+    }
+  }
+#endif
+
+  for (const auto& path : options.extraPaths) {
+    if (files.size() >= kMaxFiles) {
+      break;
+    }
+#ifdef _WIN32
+    if (seen.insert(path).second) {
+      files.push_back(path);
+    }
+#else
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+      continue;
+    }
+    if (S_ISDIR(st.st_mode)) {
+      std::vector<std::string> children;
+      CollectDirectory(path, 4, children);
+      for (const auto& child : children) {
+        if (files.size() < kMaxFiles && seen.insert(child).second) {
+          files.push_back(child);
+        }
+      }
+    }
+    else if (seen.insert(path).second) {
+      files.push_back(path);
+    }
+#endif
+  }
+
+  return files;
+}
+
+void AppPrefetcher::Post(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(task));
+    // 首次使用时才创建线程
+    if (workers_.empty()) {
+      for (size_t i = 0; i < kThreadCount; i++) {
+        workers_.emplace_back(&AppPrefetcher::Run, this);
+      }
+    }
+  }
+  cv_.notify_one();
+}
+
+void AppPrefetcher::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    // 退出前执行完已提交的任务，保证每个 Prefetch 的回调都会被调用
+    if (queue_.empty()) {
+      return;
+    }
+
+    std::function<void()> task = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+    task();
+    lock.lock();
+  }
+}
+
+uint64_t AppPrefetcher::PrefetchFile(const std::string& path, std::atomic<uint64_t>& budget) {
+#ifdef _WIN32
+  int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, NULL, 0);
+  std::wstring widePath(length, 0);
+  MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &widePath[0], length);
+
+  HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return 0;
+  }
+
+  LARGE_INTEGER fileSize;
+  GetFileSizeEx(file, &fileSize);
+  uint64_t size = static_cast<uint64_t>(fileSize.QuadPart);
+#else
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return 0;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    close(fd);
+    return 0;
+  }
+  uint64_t size = static_cast<uint64_t>(st.st_size);
+#endif
+
+  // 从总预算中扣除
+  uint64_t available = budget.load();
+  uint64_t length;
+  do {
+    length = size < available ? size : available;
+  } while (length > 0 && !budget.compare_exchange_weak(available, available - length));
+
+  if (length > 0) {
+#ifdef _WIN32
+    // Windows 没有只提交预读的接口，顺序读取让缓存管理器装入页缓存
+    std::vector<char> buffer(1 << 20);
+    uint64_t remaining = length;
+    DWORD bytesRead = 0;
+    while (remaining > 0 && ReadFile(file, buffer.data(), static_cast<DWORD>(buffer.size()), &bytesRead, NULL) && bytesRead > 0) {
+      remaining -= bytesRead < remaining ? bytesRead : remaining;
+    }
+#elif defined(__linux__)
+    if (readahead(fd, 0, static_cast<size_t>(length)) != 0) {
+      posix_fadvise(fd, 0, static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+    }
+#elif defined(__APPLE__)
+    struct radvisory advice;
+    advice.ra_offset = 0;
+    advice.ra_count = static_cast<int>(length < INT32_MAX ? length : INT32_MAX);
+    fcntl(fd, F_RDADVISE, &advice);
+#else
+    posix_fadvise(fd, 0, static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+#endif
+  }
+
+#ifdef _WIN32
+  CloseHandle(file);
+#else
+  close(fd);
+#endif
+  return length;
+}
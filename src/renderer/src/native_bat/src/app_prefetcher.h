@@ -0,0 +1,57 @@
+#pragma once
+#ifndef APP_PREFETCHER_H
+#define APP_PREFETCHER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+
+struct PrefetchOptions {
+  bool includeLibraries = true;          // 解析 ELF 的 PT_INTERP 和 DT_NEEDED（递归）
+  std::vector<std::string> extraPaths;   // 额外预读的数据文件或目录
+  uint64_t maxBytes = 512ull << 20;      // 单次预读的字节上限
+};
+
+struct PrefetchResult {
+  uint32_t files = 0;
+  uint64_t bytes = 0;       // 提交预读的字节数
+  double duration = 0.0;    // 从开始解析到所有预读完成的耗时（毫秒）
+};
+
+// 在后台线程池中把可执行文件及其依赖读入页缓存，使磁盘读取与用户点击到进程启动的过程重叠
+class AppPrefetcher {
+public:
+  static constexpr size_t kThreadCount = 4;
+  static constexpr size_t kMaxFiles = 512;
+
+  AppPrefetcher();
+  ~AppPrefetcher();
+
+  // 异步预读，完成后在线程池线程中调用 done
+  using Completion = std::function<void(const PrefetchResult& result)>;
+  void Prefetch(const std::string& executablePath, const PrefetchOptions& options, Completion done);
+
+  // 解析需要预读的文件（可执行文件、加载器、依赖库、额外文件），不做 I/O 以外的副作用
+  static std::vector<std::string> CollectFiles(const std::string& executablePath, const PrefetchOptions& options);
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> queue_;
+  std::vector<std::thread> workers_;
+  bool stop_ = false;
+
+  void Post(std::function<void()> task);
+  void Run();
+
+  // 提交单个文件的预读，从 budget 中扣除并返回提交的字节数
+  static uint64_t PrefetchFile(const std::string& path, std::atomic<uint64_t>& budget);
+};
+
+#endif // APP_PREFETCHER_H
@@ -0,0 +1,114 @@
+#include "cgroup_v2.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
+#include <linux/magic.h>
+#include <unistd.h>
+
+namespace {
+
+const char kCgroupRoot[] = "/sys/fs/cgroup";
+
+} // namespace
+
+std::string CgroupSelfPath() {
+  std::ifstream file("/proc/self/cgroup");
+  std::string line;
+  while (std::getline(file, line)) {
+    // cgroup v2 统一层级的格式为 "0::/path"
+    if (line.compare(0, 3, "0::") == 0) {
+      std::string path = line.substr(3);
+      path = path == "/" ? std::string(kCgroupRoot) : kCgroupRoot + path;
+
+      // 混合模式下 /sys/fs/cgroup 不是 cgroup2 文件系统
+      struct statfs fs;
+      if (statfs(path.c_str(), &fs) != 0 || fs.f_type != CGROUP2_SUPER_MAGIC) {
+        return "";
+      }
+      return path;
+    }
+  }
+  return "";
+}
+
+std::string CgroupCreateLeaf(const std::string& name) {
+  std::string parent = CgroupSelfPath();
+  if (parent.empty() || access(parent.c_str(), W_OK) != 0) {
+    return "";
+  }
+
+  std::string path = parent + "/" + name;
+  if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+    return "";
+  }
+  return path;
+}
+
+bool CgroupRemove(const std::string& path) {
+  return !path.empty() && rmdir(path.c_str()) == 0;
+}
+
+bool CgroupWriteFile(const std::string& path, const char* file, const std::string& value) {
+  int fd = CgroupOpenFile(path, file, O_WRONLY);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = write(fd, value.data(), value.size()) == static_cast<ssize_t>(value.size());
+  close(fd);
+  return ok;
+}
+
+bool CgroupReadFile(const std::string& path, const char* file, std::string& value) {
+  int fd = CgroupOpenFile(path, file, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  char buffer[256];
+  ssize_t bytes = read(fd, buffer, sizeof(buffer));
+  close(fd);
+  if (bytes < 0) {
+    return false;
+  }
+  value.assign(buffer, static_cast<size_t>(bytes));
+  while (!value.empty() && value.back() == '\n') {
+    value.pop_back();
+  }
+  return true;
+}
+
+int CgroupOpenFile(const std::string& path, const char* file, int flags) {
+  std::string filePath = path + "/" + file;
+  return open(filePath.c_str(), flags | O_CLOEXEC);
+}
+
+int CgroupReadPopulated(int eventsFd) {
+  char buffer[256];
+  ssize_t bytes = pread(eventsFd, buffer, sizeof(buffer) - 1, 0);
+  if (bytes <= 0) {
+    return -1;
+  }
+  buffer[bytes] = '\0';
+
+  const char* field = strstr(buffer, "populated ");
+  if (!field) {
+    return -1;
+  }
+  return atoi(field + 10);
+}
+
+std::vector<uint32_t> CgroupReadProcs(const std::string& path) {
+  std::vector<uint32_t> processes;
+  std::ifstream file(path + "/cgroup.procs");
+  uint32_t processId;
+  while (file >> processId) {
+    processes.push_back(processId);
+  }
+  return processes;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#ifndef CGROUP_V2_H
+#define CGROUP_V2_H
+
+#ifdef __linux__
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// cgroup v2 辅助函数，所有路径均为 /sys/fs/cgroup 下的绝对路径
+
+// 当前进程所在的 cgroup 目录，不是 cgroup v2 统一层级时返回空字符串
+std::string CgroupSelfPath();
+
+// 在当前进程的 cgroup 下创建会话叶子节点，失败时返回空字符串
+std::string CgroupCreateLeaf(const std::string& name);
+
+// 删除空的叶子节点
+bool CgroupRemove(const std::string& path);
+
+// 写入 cgroup 接口文件，例如 cpu.weight、cgroup.freeze
+bool CgroupWriteFile(const std::string& path, const char* file, const std::string& value);
+
+// 读取 cgroup 接口文件内容（去掉末尾换行），失败时返回 false
+bool CgroupReadFile(const std::string& path, const char* file, std::string& value);
+
+// 打开 cgroup 接口文件（O_CLOEXEC），用于 fork 后写入或 epoll 监听
+int CgroupOpenFile(const std::string& path, const char* file, int flags);
+
+// 读取 cgroup.events 的 populated 字段；读取失败返回 -1
+int CgroupReadPopulated(int eventsFd);
+
+// 读取 cgroup.procs 中的所有进程
+std::vector<uint32_t> CgroupReadProcs(const std::string& path);
+
+#endif // __linux__
+
+#endif // CGROUP_V2_H
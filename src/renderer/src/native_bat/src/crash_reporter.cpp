@@ -0,0 +1,327 @@
+#include "crash_reporter.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+
+#include <csignal>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace {
+
+std::string ReadFirstLine(const char* path) {
+  std::ifstream file(path);
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+// appId 可能包含路径分隔符等字符，只保留安全字符
+std::string SafeFileName(const std::string& appId) {
+  std::string name;
+  for (char c : appId) {
+    bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                c == '-' || c == '_' || c == '.';
+    name += safe ? c : '_';
+  }
+  if (name.empty() || name[0] == '.') {
+    name = "_" + name;
+  }
+  return name;
+}
+
+// strsignal 使用共享的静态缓冲区，不是线程安全的，报告线程改用固定的名称表
+const char* SignalName(int signal) {
+  switch (signal) {
+    case SIGHUP: return "SIGHUP";
+    case SIGINT: return "SIGINT";
+    case SIGQUIT: return "SIGQUIT";
+    case SIGILL: return "SIGILL";
+    case SIGTRAP: return "SIGTRAP";
+    case SIGABRT: return "SIGABRT";
+    case SIGBUS: return "SIGBUS";
+    case SIGFPE: return "SIGFPE";
+    case SIGKILL: return "SIGKILL";
+    case SIGUSR1: return "SIGUSR1";
+    case SIGSEGV: return "SIGSEGV";
+    case SIGUSR2: return "SIGUSR2";
+    case SIGPIPE: return "SIGPIPE";
+    case SIGALRM: return "SIGALRM";
+    case SIGTERM: return "SIGTERM";
+    case SIGCHLD: return "SIGCHLD";
+    case SIGCONT: return "SIGCONT";
+    case SIGSTOP: return "SIGSTOP";
+    case SIGTSTP: return "SIGTSTP";
+    case SIGTTIN: return "SIGTTIN";
+    case SIGTTOU: return "SIGTTOU";
+    case SIGURG: return "SIGURG";
+    case SIGXCPU: return "SIGXCPU";
+    case SIGXFSZ: return "SIGXFSZ";
+    case SIGVTALRM: return "SIGVTALRM";
+    case SIGPROF: return "SIGPROF";
+    case SIGWINCH: return "SIGWINCH";
+    case SIGIO: return "SIGIO";
+    case SIGPWR: return "SIGPWR";
+    case SIGSYS: return "SIGSYS";
+    default: return "unknown";
+  }
+}
+
+std::string FormatNumber(const char* format, double value) {
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), format, value);
+  return buffer;
+}
+
+} // namespace
+
+CrashReporter::CrashReporter() {
+  thread_ = std::thread(&CrashReporter::Run, this);
+}
+
+CrashReporter::~CrashReporter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void CrashReporter::SetDirectory(const std::string& directory) {
+  if (!directory.empty()) {
+    mkdir(directory.c_str(), 0755);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  directory_ = directory;
+}
+
+bool CrashReporter::IsEnabled() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !directory_.empty();
+}
+
+void CrashReporter::SetSink(ReportSink sink) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  sink_ = std::move(sink);
+}
+
+bool CrashReporter::Submit(CrashReport report) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (directory_.empty() || pending_.size() >= kMaxPending) {
+      return false;
+    }
+    pending_.push_back(std::move(report));
+  }
+  cv_.notify_all();
+  return true;
+}
+
+void CrashReporter::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+    // 退出前写完已排队的报告
+    if (pending_.empty()) {
+      break;
+    }
+
+    CrashReport report = std::move(pending_.front());
+    pending_.pop_front();
+    std::string directory = directory_;
+    ReportSink sink = sink_;
+    lock.unlock();
+
+    std::string path = ReportPath(directory, report);
+    bool written = WriteReport(path, Format(report));
+    if (written && sink) {
+      sink(report.appId, report.processId, path);
+    }
+
+    lock.lock();
+  }
+}
+
+std::string CrashReporter::Format(const CrashReport& report) {
+  std::string corePattern;
+  std::string coreLocation = ResolveCoreLocation(report, corePattern);
+  const ProcessSnapshot& snapshot = report.snapshot;
+
+  std::string content = "# crash report v1\n";
+  content += "appId: " + report.appId + "\n";
+  content += "processId: " + std::to_string(report.processId) + "\n";
+  content += "command: " + snapshot.comm + "\n";
+  content += "executable: " + snapshot.executable + "\n";
+  content += "cwd: " + snapshot.cwd + "\n";
+  content += "startTime: " + report.startTime + "\n";
+  content += "endTime: " + report.endTime + "\n";
+  content += "duration: " + FormatNumber("%.3f", report.duration) + "\n";
+  content += "exitCode: " + std::to_string(report.exitCode) + "\n";
+  if (report.exitSignal != 0) {
+    content += "signal: " + std::to_string(report.exitSignal) + " (" + SignalName(report.exitSignal) + ")\n";
+  }
+  else {
+    content += "signal: 0\n";
+  }
+  content += std::string("coreDumped: ") + (report.coreDumped ? "yes" : "no") + "\n";
+  content += "corePattern: " + corePattern + "\n";
+  content += "coreLocation: " + coreLocation + "\n";
+  content += "userCpuTime: " + FormatNumber("%.3f", report.userCpuTime) + "\n";
+  content += "systemCpuTime: " + FormatNumber("%.3f", report.systemCpuTime) + "\n";
+  content += "maxRss: " + std::to_string(report.maxRss) + " KB\n";
+  content += "minorFaults: " + std::to_string(report.minorFaults) + "\n";
+  content += "majorFaults: " + std::to_string(report.majorFaults) + "\n";
+
+  content += "\n[samples] " + std::to_string(report.samples.size()) + "\n";
+  content += "timestamp cpuPercent rss readBytes writeBytes\n";
+  for (const auto& sample : report.samples) {
+    char line[160];
+    snprintf(line, sizeof(line), "%.0f %.1f %.0f %.0f %.0f\n", sample.timestamp, sample.cpuPercent,
+             sample.rss, sample.readBytes, sample.writeBytes);
+    content += line;
+  }
+
+  content += "\n[maps] " + FormatNumber("%.0f", snapshot.timestamp) + " " + std::to_string(snapshot.maps.size()) + "\n";
+  content += snapshot.maps;
+  if (!snapshot.maps.empty() && snapshot.maps.back() != '\n') {
+    content += '\n';
+  }
+
+  // 输出可能包含任意字节，按长度截取，不做转义
+  content += "\n[output] " + std::to_string(report.output.size()) + "\n";
+  content += report.output;
+  return content;
+}
+
+// 先写临时文件再 rename，读取方只会看到完整的报告
+bool CrashReporter::WriteReport(const std::string& path, const std::string& content) {
+  std::string tempPath = path + ".tmp";
+  int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+
+  const char* data = content.data();
+  size_t remaining = content.size();
+  bool ok = true;
+  while (remaining > 0) {
+    ssize_t result = write(fd, data, remaining);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      ok = false;
+      break;
+    }
+    data += result;
+    remaining -= static_cast<size_t>(result);
+  }
+  ok = ok && fsync(fd) == 0;
+  close(fd);
+
+  if (!ok || rename(tempPath.c_str(), path.c_str()) != 0) {
+    unlink(tempPath.c_str());
+    return false;
+  }
+  return true;
+}
+
+// 按 core(5) 展开 core_pattern。以 '|' 开头时 core 交给处理程序（如 systemd-coredump），
+// 只能给出处理程序本身
+std::string CrashReporter::ResolveCoreLocation(const CrashReport& report, std::string& corePattern) {
+  corePattern = ReadFirstLine("/proc/sys/kernel/core_pattern");
+  if (!report.coreDumped) {
+    return "";
+  }
+
+  std::string pattern = corePattern.empty() ? "core" : corePattern;
+  if (pattern[0] == '|') {
+    size_t end = pattern.find(' ');
+    return "pipe:" + pattern.substr(1, end == std::string::npos ? std::string::npos : end - 1);
+  }
+
+  const ProcessSnapshot& snapshot = report.snapshot;
+  std::string pid = std::to_string(report.processId);
+  std::string location;
+  bool hasPid = false;
+  for (size_t i = 0; i < pattern.size(); i++) {
+    if (pattern[i] != '%' || i + 1 >= pattern.size()) {
+      location += pattern[i];
+      continue;
+    }
+
+    char specifier = pattern[++i];
+    switch (specifier) {
+      case '%': location += '%'; break;
+      case 'p': case 'P': case 'i': case 'I':
+        location += pid;
+        hasPid = true;
+        break;
+      case 'u': location += std::to_string(getuid()); break;
+      case 'g': location += std::to_string(getgid()); break;
+      case 's': location += std::to_string(report.exitSignal); break;
+      case 't': location += std::to_string(static_cast<long long>(report.endTimestamp / 1000.0)); break;
+      case 'e': location += snapshot.comm; break;
+      case 'f': {
+        size_t slash = snapshot.executable.rfind('/');
+        location += slash == std::string::npos ? snapshot.executable : snapshot.executable.substr(slash + 1);
+        break;
+      }
+      case 'E': {
+        std::string escaped = snapshot.executable;
+        for (char& c : escaped) {
+          if (c == '/') {
+            c = '!';
+          }
+        }
+        location += escaped;
+        break;
+      }
+      case 'h': {
+        char host[256] = {};
+        gethostname(host, sizeof(host) - 1);
+        location += host;
+        break;
+      }
+      case 'c': {
+        struct rlimit limit;
+        if (getrlimit(RLIMIT_CORE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+          location += std::to_string(static_cast<unsigned long long>(limit.rlim_cur));
+        }
+        else {
+          location += "unlimited";
+        }
+        break;
+      }
+      default:
+        // 无法从外部得知的字段（如 %d）保留原样
+        location += '%';
+        location += specifier;
+        break;
+    }
+  }
+
+  if (!hasPid && ReadFirstLine("/proc/sys/kernel/core_uses_pid") == "1") {
+    location += "." + pid;
+  }
+  // 相对路径相对于进程崩溃时的工作目录
+  if (!location.empty() && location[0] != '/' && !snapshot.cwd.empty()) {
+    location = snapshot.cwd + "/" + location;
+  }
+  return location;
+}
+
+std::string CrashReporter::ReportPath(const std::string& directory, const CrashReport& report) {
+  return directory + "/" + SafeFileName(report.appId) + "-" +
+         FormatNumber("%.0f", report.startTimestamp) + "-" + std::to_string(report.processId) + ".crash";
+}
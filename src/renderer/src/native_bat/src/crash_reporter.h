@@ -0,0 +1,82 @@
+#pragma once
+#ifndef CRASH_REPORTER_H
+#define CRASH_REPORTER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+
+#include "process_sampler.h"
+
+// 一次异常退出的现场信息，由启动器在回收进程时收集
+struct CrashReport {
+  std::string appId;
+  uint32_t processId = 0;
+  std::string startTime;
+  std::string endTime;
+  double startTimestamp = 0.0; // Unix 毫秒
+  double endTimestamp = 0.0;   // Unix 毫秒
+  double duration = 0.0;       // 秒
+  int exitCode = 0;
+  int exitSignal = 0;
+  bool coreDumped = false;
+  double userCpuTime = 0.0;
+  double systemCpuTime = 0.0;
+  long maxRss = 0;
+  long minorFaults = 0;
+  long majorFaults = 0;
+
+  ProcessSnapshot snapshot;            // 最后一次采样时的 maps 等
+  std::vector<ResourceSample> samples; // 最后 kMaxSamples 个采样
+  std::string output;                  // 最后 kOutputBytes 字节的捕获输出
+};
+
+#ifdef __linux__
+
+// 在后台线程中把崩溃现场写成单个文本文件：<directory>/<appId>-<startTimestamp>-<pid>.crash。
+// 先写临时文件再 rename，读取方不会看到写了一半的报告
+class CrashReporter {
+public:
+  static constexpr size_t kOutputBytes = 64 * 1024;
+  static constexpr size_t kMaxSamples = 120;
+  static constexpr size_t kMaxPending = 16; // 写盘跟不上时丢弃新的报告
+
+  // 报告写入完成后调用（在写入线程中，不持有内部锁）
+  using ReportSink = std::function<void(const std::string& appId, uint32_t processId, const std::string& path)>;
+
+  CrashReporter();
+  ~CrashReporter();
+
+  // directory 为空时关闭崩溃报告
+  void SetDirectory(const std::string& directory);
+  bool IsEnabled();
+  void SetSink(ReportSink sink);
+
+  // 排队写入，队列已满或未启用时返回 false
+  bool Submit(CrashReport report);
+
+private:
+  std::deque<CrashReport> pending_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread thread_;
+  bool stop_ = false;
+  std::string directory_;
+  ReportSink sink_;
+
+  void Run();
+  static std::string Format(const CrashReport& report);
+  static bool WriteReport(const std::string& path, const std::string& content);
+  // 根据 core_pattern 推算 core 文件位置，未生成 core 时返回空串
+  static std::string ResolveCoreLocation(const CrashReport& report, std::string& corePattern);
+  static std::string ReportPath(const std::string& directory, const CrashReport& report);
+};
+
+#endif // __linux__
+
+#endif // CRASH_REPORTER_H
@@ -0,0 +1,452 @@
+#include "focus_controller.h"
+#include "cgroup_v2.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t kCpuMaxPeriodUs = 100000;
+
+const char* MethodName(FocusDemotion::Method method) {
+  switch (method) {
+    case FocusDemotion::Method::CgroupThrottle: return "throttle";
+    case FocusDemotion::Method::CgroupFreeze: return "freeze";
+    default: return "signal";
+  }
+}
+
+bool ParseMethod(const std::string& name, FocusDemotion::Method& method) {
+  if (name == "throttle") {
+    method = FocusDemotion::Method::CgroupThrottle;
+  }
+  else if (name == "freeze") {
+    method = FocusDemotion::Method::CgroupFreeze;
+  }
+  else if (name == "signal") {
+    method = FocusDemotion::Method::Signal;
+  }
+  else {
+    return false;
+  }
+  return true;
+}
+
+// /proc/<pid>/stat 的第 22 个字段（开机后的启动时间），进程不存在时返回 0
+uint64_t ReadStartTime(uint32_t processId) {
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/%u/stat", processId);
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return 0;
+  }
+  char buffer[1024];
+  ssize_t bytes = read(fd, buffer, sizeof(buffer) - 1);
+  close(fd);
+  if (bytes <= 0) {
+    return 0;
+  }
+  buffer[bytes] = '\0';
+
+  // comm 可能包含空格，从最后一个 ')' 之后开始解析
+  const char* p = strrchr(buffer, ')');
+  if (!p) {
+    return 0;
+  }
+  unsigned long long startTime = 0;
+  if (sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu",
+             &startTime) != 1) {
+    return 0;
+  }
+  return startTime;
+}
+
+// 进程名与配置匹配：comm（截断为 15 字节）或可执行文件名
+bool MatchesProcessName(uint32_t processId, const std::vector<std::string>& names) {
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/%u/comm", processId);
+  std::string comm;
+  {
+    std::ifstream file(path);
+    std::getline(file, comm);
+  }
+
+  snprintf(path, sizeof(path), "/proc/%u/exe", processId);
+  char target[4096];
+  ssize_t length = readlink(path, target, sizeof(target) - 1);
+  std::string exeName;
+  if (length > 0) {
+    target[length] = '\0';
+    const char* slash = strrchr(target, '/');
+    exeName = slash ? slash + 1 : target;
+  }
+
+  for (const auto& name : names) {
+    if (name.empty()) {
+      continue;
+    }
+    if (name == exeName || name == comm || (comm.size() == 15 && name.compare(0, 15, comm) == 0)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+FocusController::~FocusController() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  RestoreAll();
+  Persist();
+}
+
+void FocusController::SetOptions(const FocusOptions& options) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // 尚未降级任何对象时，文件中的条目只可能来自上一次异常退出
+  if (demotions_.empty() && !options.statePath.empty()) {
+    RecoverFile(options.statePath);
+  }
+  if (!options_.statePath.empty() && options_.statePath != options.statePath) {
+    unlink(options_.statePath.c_str());
+  }
+
+  options_ = options;
+  if (options_.cpuWeight < 1) {
+    options_.cpuWeight = 1;
+  }
+  else if (options_.cpuWeight > 10000) {
+    options_.cpuWeight = 10000;
+  }
+  Persist();
+}
+
+FocusOptions FocusController::GetOptions() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return options_;
+}
+
+FocusState FocusController::GetState() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  FocusState state;
+  state.active = !foreground_.empty();
+  state.foreground.assign(foreground_.begin(), foreground_.end());
+  state.demotions = demotions_;
+  state.unthrottled.assign(unthrottled_.begin(), unthrottled_.end());
+  return state;
+}
+
+void FocusController::Engage(uint32_t foregroundProcessId, const std::vector<Target>& targets) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  bool active = !foreground_.empty();
+  foreground_.insert(foregroundProcessId);
+  if (active) {
+    return;
+  }
+
+  std::set<uint32_t> protectedProcesses = { static_cast<uint32_t>(getpid()), foregroundProcessId };
+  std::set<uint32_t> skippedProcesses = protectedProcesses;
+  for (const auto& target : targets) {
+    Demote(target, protectedProcesses);
+
+    // 被跟踪应用已按所属 cgroup 或进程树处理，扫描外部进程时跳过
+    skippedProcesses.insert(target.processes.begin(), target.processes.end());
+    if (!target.cgroupPath.empty()) {
+      for (uint32_t processId : CgroupReadProcs(target.cgroupPath)) {
+        skippedProcesses.insert(processId);
+      }
+    }
+  }
+  DemoteExternal(skippedProcesses);
+  Persist();
+}
+
+void FocusController::Admit(const Target& target) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (foreground_.empty()) {
+    return;
+  }
+
+  std::set<uint32_t> protectedProcesses(foreground_.begin(), foreground_.end());
+  protectedProcesses.insert(static_cast<uint32_t>(getpid()));
+  Demote(target, protectedProcesses);
+  Persist();
+}
+
+void FocusController::Disengage() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  foreground_.clear();
+  RestoreAll();
+  Persist();
+}
+
+void FocusController::Restore(uint32_t processId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  unthrottled_.erase(processId);
+  bool changed = false;
+  for (auto it = demotions_.begin(); it != demotions_.end(); ) {
+    if (it->ownerProcessId == processId) {
+      Undo(*it);
+      it = demotions_.erase(it);
+      changed = true;
+    }
+    else {
+      ++it;
+    }
+  }
+  if (changed) {
+    Persist();
+  }
+}
+
+bool FocusController::IsDemoted(uint32_t processId) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& demotion : demotions_) {
+    if (demotion.ownerProcessId == processId) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void FocusController::OnProcessExit(uint32_t processId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  bool changed = false;
+  if (foreground_.erase(processId) > 0 && foreground_.empty()) {
+    RestoreAll();
+    changed = true;
+  }
+
+  // 进程树已全部退出，cgroup 也随之删除，无需恢复
+  unthrottled_.erase(processId);
+  for (auto it = demotions_.begin(); it != demotions_.end(); ) {
+    if (it->ownerProcessId == processId) {
+      it = demotions_.erase(it);
+      changed = true;
+    }
+    else {
+      ++it;
+    }
+  }
+
+  if (changed) {
+    Persist();
+  }
+}
+
+// 调用方需持有 mutex_
+void FocusController::Demote(const Target& target, const std::set<uint32_t>& protectedProcesses) {
+  if (!target.cgroupPath.empty()) {
+    FocusDemotion demotion;
+    demotion.ownerProcessId = target.processId;
+    demotion.cgroupPath = target.cgroupPath;
+
+    // cpu 控制器未在叶子节点启用时 cpu.weight 不存在
+    if (options_.mode == FocusMode::Throttle &&
+        CgroupReadFile(target.cgroupPath, "cpu.weight", demotion.savedWeight) &&
+        CgroupWriteFile(target.cgroupPath, "cpu.weight", std::to_string(options_.cpuWeight))) {
+      if (options_.cpuMaxPercent > 0 && CgroupReadFile(target.cgroupPath, "cpu.max", demotion.savedMax)) {
+        uint64_t quota = static_cast<uint64_t>(kCpuMaxPeriodUs) * options_.cpuMaxPercent / 100;
+        if (quota < 1000) {
+          quota = 1000;
+        }
+        if (!CgroupWriteFile(target.cgroupPath, "cpu.max", std::to_string(quota) + " " + std::to_string(kCpuMaxPeriodUs))) {
+          demotion.savedMax.clear();
+        }
+      }
+      demotion.method = FocusDemotion::Method::CgroupThrottle;
+      demotions_.push_back(demotion);
+      return;
+    }
+  }
+
+  // 限流失败时冻结或停止会把降低优先级变成完全暂停，只在配置允许时退回，否则记录下来供查询
+  if (options_.mode == FocusMode::Throttle && !options_.stopFallback) {
+    unthrottled_.insert(target.processId);
+    return;
+  }
+
+  if (!target.cgroupPath.empty()) {
+    FocusDemotion demotion;
+    demotion.ownerProcessId = target.processId;
+    demotion.cgroupPath = target.cgroupPath;
+    if (CgroupWriteFile(target.cgroupPath, "cgroup.freeze", "1")) {
+      demotion.method = FocusDemotion::Method::CgroupFreeze;
+      demotions_.push_back(demotion);
+      return;
+    }
+  }
+
+  // 没有可写的 cgroup 时退回 SIGSTOP/SIGCONT
+  std::set<uint32_t> processes(target.processes.begin(), target.processes.end());
+  if (!target.cgroupPath.empty()) {
+    for (uint32_t processId : CgroupReadProcs(target.cgroupPath)) {
+      processes.insert(processId);
+    }
+  }
+  for (uint32_t processId : processes) {
+    if (protectedProcesses.count(processId) == 0) {
+      StopProcess(target.processId, processId);
+    }
+  }
+}
+
+// 调用方需持有 mutex_
+void FocusController::DemoteExternal(const std::set<uint32_t>& skippedProcesses) {
+  if (options_.backgroundProcesses.empty()) {
+    return;
+  }
+
+  DIR* dir = opendir("/proc");
+  if (!dir) {
+    return;
+  }
+  while (struct dirent* entry = readdir(dir)) {
+    char* end = nullptr;
+    unsigned long value = strtoul(entry->d_name, &end, 10);
+    if (!end || *end != '\0' || value == 0) {
+      continue;
+    }
+    uint32_t processId = static_cast<uint32_t>(value);
+    if (skippedProcesses.count(processId) != 0 || !MatchesProcessName(processId, options_.backgroundProcesses)) {
+      continue;
+    }
+    // 外部进程不在启动器的 cgroup 中，限流模式下无法只降低优先级：提高 nice 或改为 SCHED_IDLE 后
+    // 非特权的启动器无法恢复。与 Demote 一样只在允许退回时停止，否则记录下来供查询
+    if (options_.mode == FocusMode::Throttle && !options_.stopFallback) {
+      unthrottled_.insert(processId);
+    }
+    else {
+      StopProcess(0, processId);
+    }
+  }
+  closedir(dir);
+}
+
+// 调用方需持有 mutex_
+bool FocusController::StopProcess(uint32_t ownerProcessId, uint32_t processId) {
+  uint64_t startTime = ReadStartTime(processId);
+  if (startTime == 0 || kill(static_cast<pid_t>(processId), SIGSTOP) != 0) {
+    return false;
+  }
+  FocusDemotion demotion;
+  demotion.method = FocusDemotion::Method::Signal;
+  demotion.ownerProcessId = ownerProcessId;
+  demotion.processId = processId;
+  demotion.startTime = startTime;
+  demotions_.push_back(demotion);
+  return true;
+}
+
+void FocusController::Undo(const FocusDemotion& demotion) {
+  switch (demotion.method) {
+    case FocusDemotion::Method::CgroupThrottle:
+      if (!demotion.savedWeight.empty()) {
+        CgroupWriteFile(demotion.cgroupPath, "cpu.weight", demotion.savedWeight);
+      }
+      if (!demotion.savedMax.empty()) {
+        CgroupWriteFile(demotion.cgroupPath, "cpu.max", demotion.savedMax);
+      }
+      break;
+    case FocusDemotion::Method::CgroupFreeze:
+      CgroupWriteFile(demotion.cgroupPath, "cgroup.freeze", "0");
+      break;
+    case FocusDemotion::Method::Signal:
+      // pid 已被复用时不发送信号
+      if (ReadStartTime(demotion.processId) == demotion.startTime) {
+        kill(static_cast<pid_t>(demotion.processId), SIGCONT);
+      }
+      break;
+  }
+}
+
+// 调用方需持有 mutex_
+void FocusController::RestoreAll() {
+  for (const auto& demotion : demotions_) {
+    Undo(demotion);
+  }
+  demotions_.clear();
+  unthrottled_.clear();
+}
+
+// 每行一个条目：方式、所属根进程、进程、starttime、cpu.weight、cpu.max、cgroup 路径，以制表符分隔。
+// 先写临时文件再 rename，异常退出时文件要么是旧内容要么是新内容。调用方需持有 mutex_
+void FocusController::Persist() const {
+  if (options_.statePath.empty()) {
+    return;
+  }
+  if (demotions_.empty()) {
+    unlink(options_.statePath.c_str());
+    return;
+  }
+
+  std::string content;
+  for (const auto& demotion : demotions_) {
+    content += MethodName(demotion.method);
+    content += '\t' + std::to_string(demotion.ownerProcessId);
+    content += '\t' + std::to_string(demotion.processId);
+    content += '\t' + std::to_string(demotion.startTime);
+    content += '\t' + demotion.savedWeight;
+    content += '\t' + demotion.savedMax;
+    content += '\t' + demotion.cgroupPath;
+    content += '\n';
+  }
+
+  std::string tempPath = options_.statePath + ".tmp";
+  int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return;
+  }
+  bool ok = write(fd, content.data(), content.size()) == static_cast<ssize_t>(content.size()) && fsync(fd) == 0;
+  close(fd);
+  if (!ok || rename(tempPath.c_str(), options_.statePath.c_str()) != 0) {
+    unlink(tempPath.c_str());
+  }
+}
+
+void FocusController::RecoverFile(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) {
+    return;
+  }
+
+  std::string line;
+  while (std::getline(file, line)) {
+    std::vector<std::string> fields;
+    std::istringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, '\t')) {
+      fields.push_back(field);
+    }
+    // 末尾的空路径不会产生字段
+    if (fields.size() == 6) {
+      fields.emplace_back();
+    }
+
+    FocusDemotion demotion;
+    if (fields.size() != 7 || !ParseMethod(fields[0], demotion.method)) {
+      continue;
+    }
+    demotion.ownerProcessId = static_cast<uint32_t>(strtoul(fields[1].c_str(), nullptr, 10));
+    demotion.processId = static_cast<uint32_t>(strtoul(fields[2].c_str(), nullptr, 10));
+    demotion.startTime = strtoull(fields[3].c_str(), nullptr, 10);
+    demotion.savedWeight = fields[4];
+    demotion.savedMax = fields[5];
+    demotion.cgroupPath = fields[6];
+    Undo(demotion);
+  }
+
+  file.close();
+  unlink(path.c_str());
+}
@@ -0,0 +1,98 @@
+#pragma once
+#ifndef FOCUS_CONTROLLER_H
+#define FOCUS_CONTROLLER_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <cstdint>
+
+enum class FocusMode {
+  Throttle, // 降低 cpu.weight 并限制 cpu.max
+  Freeze,   // 写入 cgroup.freeze 暂停整个 cgroup
+};
+
+struct FocusOptions {
+  FocusMode mode = FocusMode::Throttle;
+  uint32_t cpuWeight = 1;                      // Throttle 时写入的 cpu.weight（1-10000）
+  uint32_t cpuMaxPercent = 10;                 // Throttle 时 cpu.max 的单核百分比，0 表示不限制
+  bool stopFallback = false;                   // Throttle 无法写入 cpu.weight 时退回冻结或 SIGSTOP，默认不降级
+  std::vector<std::string> backgroundProcesses; // 额外降级的进程名（comm 或可执行文件名），只能通过 SIGSTOP 暂停，
+                                               // Throttle 模式下需要 stopFallback
+  std::string statePath;                       // 恢复列表的持久化路径，为空时不持久化
+};
+
+// 单个被降级对象
+struct FocusDemotion {
+  enum class Method { CgroupThrottle, CgroupFreeze, Signal };
+  Method method = Method::Signal;
+  uint32_t ownerProcessId = 0;  // 所属启动的根进程，外部进程为 0
+  uint32_t processId = 0;       // Signal 时被停止的进程
+  uint64_t startTime = 0;       // Signal 时记录 /proc/<pid>/stat 的 starttime，防止 pid 复用
+  std::string cgroupPath;       // cgroup 方式时的叶子节点
+  std::string savedWeight;      // 降级前的 cpu.weight
+  std::string savedMax;         // 降级前的 cpu.max
+};
+
+struct FocusState {
+  bool active = false;
+  std::vector<uint32_t> foreground;
+  std::vector<FocusDemotion> demotions;
+  // 无法限制 CPU 且未退回暂停的对象：叶子节点未启用 cpu 控制器的应用根进程，以及 Throttle 模式下匹配到的外部进程
+  std::vector<uint32_t> unthrottled;
+};
+
+#ifdef __linux__
+
+// 前台应用运行期间降级其他被跟踪的应用和配置的后台进程，最后一个前台应用退出时恢复。
+// 每次变化都把恢复列表原子地写入 statePath，启动器异常退出后可在下次启动时恢复
+class FocusController {
+public:
+  // 被跟踪应用的进程树，cgroupPath 为空时对 processes 逐个发送信号
+  struct Target {
+    uint32_t processId = 0;
+    std::string cgroupPath;
+    std::vector<uint32_t> processes;
+  };
+
+  FocusController() = default;
+  ~FocusController();
+
+  // 设置 statePath 时先恢复该文件中遗留的降级
+  void SetOptions(const FocusOptions& options);
+  FocusOptions GetOptions() const;
+  FocusState GetState() const;
+
+  // 前台应用启动；已处于专注模式时只登记新的前台进程
+  void Engage(uint32_t foregroundProcessId, const std::vector<Target>& targets);
+  // 非前台应用启动：处于专注模式时立即降级，否则不做任何事
+  void Admit(const Target& target);
+  // 结束专注模式并恢复所有降级
+  void Disengage();
+  // 在终止前恢复单个应用，避免 SIGTERM 被冻结或停止的进程挂起
+  void Restore(uint32_t processId);
+  // 该应用当前是否被降级（冻结或停止的进程不应被判定为无响应）
+  bool IsDemoted(uint32_t processId) const;
+  // 进程树已结束：前台进程退出时可能结束专注模式，被降级的对象直接丢弃
+  void OnProcessExit(uint32_t processId);
+
+private:
+  mutable std::mutex mutex_;
+  FocusOptions options_;
+  std::set<uint32_t> foreground_;
+  std::vector<FocusDemotion> demotions_;
+  std::set<uint32_t> unthrottled_;
+
+  void Demote(const Target& target, const std::set<uint32_t>& protectedProcesses);
+  void DemoteExternal(const std::set<uint32_t>& skippedProcesses);
+  bool StopProcess(uint32_t ownerProcessId, uint32_t processId);
+  static void Undo(const FocusDemotion& demotion);
+  void RestoreAll();
+  void Persist() const;
+  static void RecoverFile(const std::string& path);
+};
+
+#endif // __linux__
+
+#endif // FOCUS_CONTROLLER_H
@@ -0,0 +1,308 @@
+#include "hang_detector.h"
+#include "launch_tracer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// 复用已打开的 fd，从头重新读取 /proc 文件
+ssize_t ReadProcFile(int fd, char* buffer, size_t size) {
+  if (fd < 0) {
+    return -1;
+  }
+  ssize_t bytes = pread(fd, buffer, size - 1, 0);
+  if (bytes >= 0) {
+    buffer[bytes] = '\0';
+  }
+  return bytes;
+}
+
+// 解析线程的 stat：状态字符与 utime + stime
+bool ParseThreadStat(const char* buffer, char& state, uint64_t& cpuTicks) {
+  // comm 可能包含空格，从最后一个 ')' 之后开始解析
+  const char* p = strrchr(buffer, ')');
+  if (!p) {
+    return false;
+  }
+  unsigned long long utime = 0, stime = 0;
+  if (sscanf(p + 2, "%c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu", &state, &utime, &stime) != 3) {
+    return false;
+  }
+  cpuTicks = utime + stime;
+  return true;
+}
+
+DIR* OpenTaskDir(uint32_t processId) {
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/%u/task", processId);
+  return opendir(path);
+}
+
+} // namespace
+
+HangDetector::HangDetector() {
+  thread_ = std::thread(&HangDetector::Run, this);
+}
+
+HangDetector::~HangDetector() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& pair : watches_) {
+    CloseWatch(pair.second);
+  }
+}
+
+void HangDetector::Track(const std::string& appId, uint32_t processId, TreeResolver resolver) {
+  DIR* taskDir = OpenTaskDir(processId);
+  if (!taskDir) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Watch& watch = watches_[processId];
+    CloseWatch(watch);
+    watch = Watch();
+    watch.appId = appId;
+    watch.targetProcessId = processId;
+    watch.resolver = std::move(resolver);
+    watch.taskDir = taskDir;
+    watch.lastProgress = MonotonicMs();
+  }
+  cv_.notify_all();
+}
+
+void HangDetector::Untrack(uint32_t processId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = watches_.find(processId);
+  if (it != watches_.end()) {
+    CloseWatch(it->second);
+    watches_.erase(it);
+  }
+}
+
+void HangDetector::SetWindow(uint32_t windowMs) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    windowMs_ = windowMs;
+  }
+  cv_.notify_all();
+}
+
+void HangDetector::SetSink(HangSink sink) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  sink_ = std::move(sink);
+}
+
+void HangDetector::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_) {
+    // 没有跟踪的进程或检测已关闭时不唤醒
+    if (watches_.empty() || windowMs_ == 0) {
+      cv_.wait(lock, [this] { return stop_ || (!watches_.empty() && windowMs_ > 0); });
+      continue;
+    }
+
+    cv_.wait_for(lock, std::chrono::milliseconds(kCheckIntervalMs));
+    if (stop_) {
+      break;
+    }
+
+    std::vector<HangEvent> events;
+    CheckAll(events);
+    if (events.empty()) {
+      continue;
+    }
+
+    HangSink sink = sink_;
+    lock.unlock();
+    if (sink) {
+      for (const auto& event : events) {
+        sink(event.appId, event.processId, event.hung, event.reason, event.stalledMs);
+      }
+    }
+    lock.lock();
+  }
+}
+
+// 调用方需持有 mutex_
+void HangDetector::CheckAll(std::vector<HangEvent>& events) {
+  if (windowMs_ == 0) {
+    return;
+  }
+
+  double now = MonotonicMs();
+  for (auto it = watches_.begin(); it != watches_.end(); ) {
+    if (!Check(it->first, it->second, now, windowMs_, events) && !Retarget(it->second)) {
+      CloseWatch(it->second);
+      it = watches_.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+}
+
+bool HangDetector::Check(uint32_t processId, Watch& watch, double now, uint32_t windowMs, std::vector<HangEvent>& events) {
+  // 重新列出线程：关闭已退出线程的文件，只为新线程打开文件
+  std::set<uint32_t> present;
+  rewinddir(watch.taskDir);
+  while (struct dirent* entry = readdir(watch.taskDir)) {
+    char* end = nullptr;
+    unsigned long value = strtoul(entry->d_name, &end, 10);
+    if (!end || *end != '\0' || value == 0) {
+      continue;
+    }
+    uint32_t threadId = static_cast<uint32_t>(value);
+    if (watch.threads.count(threadId) == 0) {
+      if (watch.threads.size() >= kMaxThreads) {
+        continue;
+      }
+      char path[64];
+      ThreadFiles files;
+      snprintf(path, sizeof(path), "%u/stat", threadId);
+      files.statFd = openat(dirfd(watch.taskDir), path, O_RDONLY | O_CLOEXEC);
+      if (files.statFd < 0) {
+        continue;
+      }
+      snprintf(path, sizeof(path), "%u/schedstat", threadId);
+      files.schedstatFd = openat(dirfd(watch.taskDir), path, O_RDONLY | O_CLOEXEC);
+      watch.threads[threadId] = files;
+    }
+    present.insert(threadId);
+  }
+
+  uint64_t cpuTicks = 0;
+  uint64_t switches = 0;
+  size_t blocked = 0;
+  size_t stopped = 0;
+  size_t alive = 0;
+  char buffer[1024];
+
+  for (auto it = watch.threads.begin(); it != watch.threads.end(); ) {
+    char state = '?';
+    uint64_t ticks = 0;
+    if (present.count(it->first) == 0 ||
+        ReadProcFile(it->second.statFd, buffer, sizeof(buffer)) <= 0 ||
+        !ParseThreadStat(buffer, state, ticks)) {
+      CloseThreadFiles(it->second);
+      it = watch.threads.erase(it);
+      continue;
+    }
+
+    if (state != 'Z' && state != 'X') {
+      alive++;
+      cpuTicks += ticks;
+      if (state == 'D') {
+        blocked++;
+      }
+      else if (state == 'T' || state == 't') {
+        stopped++;
+      }
+    }
+
+    // schedstat 第三个字段为在 CPU 上运行的次数，每次被调度运行都对应一次上下文切换
+    if (ReadProcFile(it->second.schedstatFd, buffer, sizeof(buffer)) > 0) {
+      unsigned long long runtime = 0, waittime = 0, timeslices = 0;
+      if (sscanf(buffer, "%llu %llu %llu", &runtime, &waittime, &timeslices) == 3) {
+        switches += timeslices;
+      }
+    }
+    ++it;
+  }
+
+  if (alive == 0) {
+    return false;
+  }
+
+  // 被停止（SIGSTOP、调试器）的进程不算无响应
+  bool progressed = cpuTicks != watch.cpuTicks || switches != watch.switches ||
+                    watch.threads.size() != watch.threadCount || stopped > 0;
+  watch.cpuTicks = cpuTicks;
+  watch.switches = switches;
+  watch.threadCount = watch.threads.size();
+  if (progressed) {
+    watch.lastProgress = now;
+  }
+
+  if (blocked == alive) {
+    if (watch.blockedSince == 0.0) {
+      watch.blockedSince = now;
+    }
+  }
+  else {
+    watch.blockedSince = 0.0;
+  }
+
+  HangReason reason = HangReason::None;
+  double stalledMs = 0.0;
+  if (watch.blockedSince > 0.0 && now - watch.blockedSince >= windowMs) {
+    reason = HangReason::UninterruptibleSleep;
+    stalledMs = now - watch.blockedSince;
+  }
+  else if (now - watch.lastProgress >= windowMs) {
+    reason = HangReason::NoProgress;
+    stalledMs = now - watch.lastProgress;
+  }
+
+  bool wasHung = watch.reason != HangReason::None;
+  bool hung = reason != HangReason::None;
+  if (hung != wasHung) {
+    events.push_back({ watch.appId, processId, hung, hung ? reason : watch.reason, stalledMs });
+  }
+  watch.reason = reason;
+  return true;
+}
+
+void HangDetector::CloseThreadFiles(ThreadFiles& files) {
+  if (files.statFd >= 0) {
+    close(files.statFd);
+    files.statFd = -1;
+  }
+  if (files.schedstatFd >= 0) {
+    close(files.schedstatFd);
+    files.schedstatFd = -1;
+  }
+}
+
+bool HangDetector::Retarget(Watch& watch) {
+  if (!watch.resolver) {
+    return false;
+  }
+  uint32_t processId = watch.resolver(watch.targetProcessId);
+  DIR* taskDir = processId != 0 ? OpenTaskDir(processId) : nullptr;
+  if (!taskDir) {
+    return false;
+  }
+
+  // 线程集合变化在下一次检查时计为推进，停滞计时从那时重新开始
+  CloseWatch(watch);
+  watch.targetProcessId = processId;
+  watch.taskDir = taskDir;
+  return true;
+}
+
+void HangDetector::CloseWatch(Watch& watch) {
+  for (auto& pair : watch.threads) {
+    CloseThreadFiles(pair.second);
+  }
+  watch.threads.clear();
+  if (watch.taskDir) {
+    closedir(watch.taskDir);
+    watch.taskDir = nullptr;
+  }
+}
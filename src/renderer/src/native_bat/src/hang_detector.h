@@ -0,0 +1,101 @@
+#pragma once
+#ifndef HANG_DETECTOR_H
+#define HANG_DETECTOR_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+
+enum class HangReason {
+  None,
+  UninterruptibleSleep, // 所有线程持续处于 D 状态
+  NoProgress,           // CPU 时间和上下文切换次数持续不变
+};
+
+#ifdef __linux__
+
+#include <dirent.h>
+
+// 定期增量读取 /proc/<pid>/task/*/{stat,schedstat}，识别仍存活但不再推进的进程。
+// task 目录和每个线程的文件描述符在两次检查之间保持打开，只为新出现的线程打开文件
+class HangDetector {
+public:
+  static constexpr uint32_t kCheckIntervalMs = 1000;
+  static constexpr uint32_t kDefaultWindowMs = 30000;
+  static constexpr size_t kMaxThreads = 256; // 每个进程最多跟踪的线程数
+
+  // hung 为 false 表示已恢复；stalledMs 为判定时已停滞的时长
+  using HangSink = std::function<void(const std::string& appId, uint32_t processId, bool hung,
+                                      HangReason reason, double stalledMs)>;
+
+  // 被跟踪的进程退出后返回进程树中另一个仍存活的进程（不能是参数中已退出的进程），没有时返回 0
+  using TreeResolver = std::function<uint32_t(uint32_t exitedProcessId)>;
+
+  HangDetector();
+  ~HangDetector();
+
+  // processId 为会话的根进程，事件和 Untrack 都以它为准。根进程先于后代退出时
+  // （例如启动器 stub 拉起游戏后退出），通过 resolver 改为检测树中仍存活的进程
+  void Track(const std::string& appId, uint32_t processId, TreeResolver resolver = nullptr);
+  void Untrack(uint32_t processId);
+
+  // 停滞多久判定为无响应，0 表示关闭检测
+  void SetWindow(uint32_t windowMs);
+  // 在检测线程中调用，不持有内部锁
+  void SetSink(HangSink sink);
+
+private:
+  struct ThreadFiles {
+    int statFd = -1;
+    int schedstatFd = -1;
+  };
+
+  struct Watch {
+    std::string appId;
+    uint32_t targetProcessId = 0;          // 当前检测的进程，起初为根进程
+    TreeResolver resolver;
+    DIR* taskDir = nullptr;                // /proc/<targetProcessId>/task
+    std::map<uint32_t, ThreadFiles> threads;
+    uint64_t cpuTicks = 0;
+    uint64_t switches = 0;
+    size_t threadCount = 0;
+    double lastProgress = 0.0;             // MonotonicMs
+    double blockedSince = 0.0;             // 所有线程进入 D 状态的时刻，0 表示未处于该状态
+    HangReason reason = HangReason::None;  // 当前判定结果
+  };
+
+  struct HangEvent {
+    std::string appId;
+    uint32_t processId;
+    bool hung;
+    HangReason reason;
+    double stalledMs;
+  };
+
+  std::map<uint32_t, Watch> watches_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread thread_;
+  std::atomic<bool> stop_{ false };
+  uint32_t windowMs_ = kDefaultWindowMs;
+  HangSink sink_;
+
+  void Run();
+  void CheckAll(std::vector<HangEvent>& events);
+  // 进程已退出时返回 false
+  static bool Check(uint32_t processId, Watch& watch, double now, uint32_t windowMs, std::vector<HangEvent>& events);
+  static void CloseThreadFiles(ThreadFiles& files);
+  static void CloseWatch(Watch& watch);
+  // 被检测的进程已退出时换到 resolver 给出的进程，成功返回 true
+  static bool Retarget(Watch& watch);
+};
+
+#endif // __linux__
+
+#endif // HANG_DETECTOR_H
@@ -0,0 +1,152 @@
+#include "launch_scheduler.h"
+
+LaunchScheduler::~LaunchScheduler() {
+  Shutdown();
+}
+
+std::shared_future<LaunchOutcome> LaunchScheduler::Submit(const std::string& key, LaunchTask task, Completion done) {
+  std::shared_ptr<Request> request;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    submitted_++;
+
+    auto it = inFlight_.find(key);
+    if (it != inFlight_.end()) {
+      coalesced_++;
+      if (done) {
+        // 合并的请求单独标记，结果的其余部分与首个请求相同
+        it->second->completions.push_back([done](const LaunchOutcome& outcome) {
+          LaunchOutcome copy = outcome;
+          copy.coalesced = true;
+          done(copy);
+        });
+      }
+      return it->second->future;
+    }
+
+    request = std::make_shared<Request>();
+    request->future = request->promise.get_future().share();
+    if (stop_) {
+      LaunchOutcome outcome;
+      outcome.errorMsg = "Launcher is shutting down";
+      request->promise.set_value(outcome);
+    }
+    else {
+      request->task = std::move(task);
+      if (done) {
+        request->completions.push_back(std::move(done));
+      }
+      inFlight_[key] = request;
+      queue_.push_back(key);
+
+      // 线程按需创建，数量不超过并发上限
+      if (workers_.size() < concurrency_ && workers_.size() < queue_.size() + running_) {
+        workers_.emplace_back(&LaunchScheduler::Run, this);
+      }
+      cv_.notify_one();
+      return request->future;
+    }
+  }
+
+  if (done) {
+    done(request->future.get());
+  }
+  return request->future;
+}
+
+void LaunchScheduler::SetConcurrency(uint32_t concurrency) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (concurrency < 1) {
+    concurrency = 1;
+  }
+  else if (concurrency > kMaxConcurrency) {
+    concurrency = kMaxConcurrency;
+  }
+  concurrency_ = concurrency;
+
+  // 提高上限后立即补足线程处理积压的请求；降低上限时多余的线程空闲等待
+  while (!stop_ && workers_.size() < concurrency_ && workers_.size() < queue_.size() + running_) {
+    workers_.emplace_back(&LaunchScheduler::Run, this);
+  }
+  cv_.notify_all();
+}
+
+LaunchSchedulerStats LaunchScheduler::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  LaunchSchedulerStats stats;
+  stats.concurrency = concurrency_;
+  stats.queued = static_cast<uint32_t>(queue_.size());
+  stats.running = running_;
+  stats.submitted = submitted_;
+  stats.coalesced = coalesced_;
+  return stats;
+}
+
+void LaunchScheduler::Shutdown() {
+  std::vector<std::shared_ptr<Request>> rejected;
+  std::vector<std::thread> workers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    for (const auto& key : queue_) {
+      auto it = inFlight_.find(key);
+      if (it != inFlight_.end()) {
+        rejected.push_back(it->second);
+        inFlight_.erase(it);
+      }
+    }
+    queue_.clear();
+    workers.swap(workers_);
+  }
+  cv_.notify_all();
+
+  for (auto& worker : workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+
+  for (const auto& request : rejected) {
+    LaunchOutcome outcome;
+    outcome.errorMsg = "Launcher is shutting down";
+    Finish(request, outcome);
+  }
+}
+
+void LaunchScheduler::Run() {
+  while (true) {
+    std::string key;
+    std::shared_ptr<Request> request;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return stop_ || (!queue_.empty() && running_ < concurrency_); });
+      if (stop_) {
+        return;
+      }
+      key = queue_.front();
+      queue_.pop_front();
+      request = inFlight_[key];
+      running_++;
+    }
+
+    LaunchOutcome outcome = request->task();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_--;
+      // 在完成前移出，之后到达的同一 key 请求会发起新的启动
+      inFlight_.erase(key);
+    }
+    cv_.notify_one();
+
+    Finish(request, outcome);
+  }
+}
+
+// 完成回调只会在请求移出 inFlight_ 之后调用，此时不会再有新的回调加入
+void LaunchScheduler::Finish(const std::shared_ptr<Request>& request, LaunchOutcome outcome) {
+  request->promise.set_value(outcome);
+  for (const auto& done : request->completions) {
+    done(outcome);
+  }
+}
@@ -0,0 +1,77 @@
+#pragma once
+#ifndef LAUNCH_SCHEDULER_H
+#define LAUNCH_SCHEDULER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <cstdint>
+
+struct LaunchOutcome {
+  bool success = false;
+  std::string errorMsg;
+  bool coalesced = false; // 合并到了同一 appId 正在进行的启动，或应用已在运行时直接返回现有会话
+};
+
+struct LaunchSchedulerStats {
+  uint32_t concurrency = 0;
+  uint32_t queued = 0;
+  uint32_t running = 0;
+  uint64_t submitted = 0;
+  uint64_t coalesced = 0;
+};
+
+// 启动调度器：有界线程池并行启动不同的应用，同一 appId 的重复请求合并为一次启动。
+// 并发上限用于批量启动时限制同时读盘的进程数
+class LaunchScheduler {
+public:
+  static constexpr uint32_t kDefaultConcurrency = 4;
+  static constexpr uint32_t kMaxConcurrency = 16;
+
+  using LaunchTask = std::function<LaunchOutcome()>;
+  // 在线程池线程中调用，不持有内部锁
+  using Completion = std::function<void(const LaunchOutcome& outcome)>;
+
+  LaunchScheduler() = default;
+  ~LaunchScheduler();
+
+  // 同一 key 已在排队或执行时不再执行 task，只等待已有的结果
+  std::shared_future<LaunchOutcome> Submit(const std::string& key, LaunchTask task, Completion done = nullptr);
+
+  void SetConcurrency(uint32_t concurrency);
+  LaunchSchedulerStats GetStats() const;
+
+  // 拒绝排队中的请求并等待正在执行的启动完成
+  void Shutdown();
+
+private:
+  struct Request {
+    LaunchTask task;
+    std::promise<LaunchOutcome> promise;
+    std::shared_future<LaunchOutcome> future;
+    std::vector<Completion> completions;
+  };
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::map<std::string, std::shared_ptr<Request>> inFlight_; // key -> 排队或执行中的请求
+  std::deque<std::string> queue_;
+  std::vector<std::thread> workers_;
+  uint32_t concurrency_ = kDefaultConcurrency;
+  uint32_t running_ = 0;
+  uint64_t submitted_ = 0;
+  uint64_t coalesced_ = 0;
+  bool stop_ = false;
+
+  void Run();
+  static void Finish(const std::shared_ptr<Request>& request, LaunchOutcome outcome);
+};
+
+#endif // LAUNCH_SCHEDULER_H
@@ -0,0 +1,266 @@
+#include "launch_tracer.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace {
+
+int OpenProcFile(uint32_t processId, const char* name) {
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/%u/%s", processId, name);
+  return open(path, O_RDONLY | O_CLOEXEC);
+}
+
+// /proc/<pid>/maps 的总长度，进程已退出时返回 -1
+ssize_t ReadMapsSize(int fd) {
+  char buffer[16384];
+  ssize_t total = 0;
+  off_t offset = 0;
+  while (true) {
+    ssize_t bytes = pread(fd, buffer, sizeof(buffer), offset);
+    if (bytes < 0) {
+      return -1;
+    }
+    if (bytes == 0) {
+      return total;
+    }
+    total += bytes;
+    offset += bytes;
+  }
+}
+
+// 累计运行时间（纳秒）。schedstat 的第一个字段精确到纳秒，stat 只有时钟滴答精度
+bool ReadRuntime(int fd, bool schedstat, uint64_t& runtime) {
+  char buffer[1024];
+  ssize_t bytes = pread(fd, buffer, sizeof(buffer) - 1, 0);
+  if (bytes <= 0) {
+    return false;
+  }
+  buffer[bytes] = '\0';
+
+  if (schedstat) {
+    runtime = strtoull(buffer, nullptr, 10);
+    return true;
+  }
+
+  // comm 可能包含空格，从最后一个 ')' 之后开始解析；utime、stime 是第 14、15 个字段
+  const char* p = strrchr(buffer, ')');
+  if (!p) {
+    return false;
+  }
+  unsigned long long utime = 0, stime = 0;
+  if (sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu", &utime, &stime) != 2) {
+    return false;
+  }
+  static const long clockTicks = sysconf(_SC_CLK_TCK);
+  runtime = (utime + stime) * 1000000000ull / static_cast<uint64_t>(clockTicks);
+  return true;
+}
+
+} // namespace
+
+LaunchTracer::LaunchTracer() {
+  epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+  wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (epollFd_ < 0 || wakeFd_ < 0) {
+    if (epollFd_ >= 0) {
+      close(epollFd_);
+      epollFd_ = -1;
+    }
+    return;
+  }
+
+  struct epoll_event event {};
+  event.events = EPOLLIN;
+  event.data.fd = wakeFd_;
+  epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &event);
+
+  thread_ = std::thread(&LaunchTracer::Run, this);
+}
+
+LaunchTracer::~LaunchTracer() {
+  stop_ = true;
+  Wake();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+
+  for (auto& pair : traces_) {
+    CloseTrace(pair.second);
+  }
+  if (epollFd_ >= 0) {
+    close(epollFd_);
+  }
+  if (wakeFd_ >= 0) {
+    close(wakeFd_);
+  }
+}
+
+void LaunchTracer::SetSink(PhaseSink sink) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  sink_ = std::move(sink);
+}
+
+void LaunchTracer::Track(const std::string& appId, uint32_t processId, double entryMs) {
+  if (!IsRunning()) {
+    return;
+  }
+
+  Trace trace;
+  trace.appId = appId;
+  trace.entryMs = entryMs;
+  trace.mapsFd = OpenProcFile(processId, "maps");
+  trace.schedFd = OpenProcFile(processId, "schedstat");
+  if (trace.schedFd < 0) {
+    trace.schedstat = false;
+    trace.schedFd = OpenProcFile(processId, "stat");
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = traces_.find(processId);
+    if (it != traces_.end()) {
+      CloseTrace(it->second);
+    }
+    traces_[processId] = trace;
+  }
+  Wake();
+}
+
+void LaunchTracer::Untrack(uint32_t processId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = traces_.find(processId);
+  if (it != traces_.end()) {
+    CloseTrace(it->second);
+    traces_.erase(it);
+  }
+}
+
+void LaunchTracer::Wake() {
+  if (wakeFd_ >= 0) {
+    uint64_t value = 1;
+    ssize_t ignored = write(wakeFd_, &value, sizeof(value));
+    (void)ignored;
+  }
+}
+
+void LaunchTracer::Run() {
+  struct epoll_event events[16];
+  double lastPoll = 0.0;
+
+  while (!stop_) {
+    bool tracing;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tracing = !traces_.empty();
+    }
+
+    // 没有正在跟踪的启动时只等待唤醒
+    int count = epoll_wait(epollFd_, events, 16, tracing ? kPollIntervalMs : -1);
+    if (count < 0 && errno != EINTR) {
+      break;
+    }
+
+    std::vector<PhaseEvent> phaseEvents;
+    for (int i = 0; i < count; i++) {
+      if (events[i].data.fd == wakeFd_) {
+        uint64_t value;
+        ssize_t ignored = read(wakeFd_, &value, sizeof(value));
+        (void)ignored;
+      }
+    }
+
+    double now = MonotonicMs();
+    if (tracing && now - lastPoll >= kPollIntervalMs) {
+      lastPoll = now;
+      PollTraces(phaseEvents);
+    }
+
+    if (!phaseEvents.empty()) {
+      PhaseSink sink;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sink = sink_;
+      }
+      if (sink) {
+        for (const auto& event : phaseEvents) {
+          sink(event.appId, event.processId, event.phase, event.offsetMs);
+        }
+      }
+    }
+  }
+}
+
+void LaunchTracer::PollTraces(std::vector<PhaseEvent>& events) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  for (auto it = traces_.begin(); it != traces_.end(); ) {
+    Trace& trace = it->second;
+    double now = MonotonicMs();
+    bool alive = true;
+
+    if (!trace.loaderDone) {
+      ssize_t size = trace.mapsFd >= 0 ? ReadMapsSize(trace.mapsFd) : -1;
+      if (size < 0) {
+        alive = false;
+      }
+      else if (size != trace.mapsSize) {
+        trace.mapsSize = size;
+        trace.lastMapsChange = now;
+        trace.stablePolls = 0;
+      }
+      else if (++trace.stablePolls >= kStablePolls) {
+        // 加载完成的时刻取最后一次映射变化
+        trace.loaderDone = true;
+        events.push_back({ trace.appId, it->first, LaunchPhase::LoaderDone, trace.lastMapsChange - trace.entryMs });
+      }
+    }
+
+    if (alive && !trace.burstDone) {
+      uint64_t runtime = 0;
+      if (trace.schedFd < 0 || !ReadRuntime(trace.schedFd, trace.schedstat, runtime)) {
+        alive = false;
+      }
+      else if (trace.windowStart == 0.0) {
+        trace.windowStart = now;
+        trace.windowRuntime = runtime;
+      }
+      else if (now - trace.windowStart >= kBurstWindowMs) {
+        double busyMs = (runtime - trace.windowRuntime) / 1e6;
+        if (busyMs >= (now - trace.windowStart) * kBurstRatio) {
+          trace.burstDone = true;
+          events.push_back({ trace.appId, it->first, LaunchPhase::FirstCpuBurst, trace.windowStart - trace.entryMs });
+        }
+        trace.windowStart = now;
+        trace.windowRuntime = runtime;
+      }
+    }
+
+    bool finished = (trace.loaderDone && trace.burstDone) || now - trace.entryMs > kTraceTimeoutMs;
+    if (!alive || finished) {
+      CloseTrace(trace);
+      it = traces_.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+}
+
+void LaunchTracer::CloseTrace(Trace& trace) {
+  if (trace.mapsFd >= 0) {
+    close(trace.mapsFd);
+    trace.mapsFd = -1;
+  }
+  if (trace.schedFd >= 0) {
+    close(trace.schedFd);
+    trace.schedFd = -1;
+  }
+}
@@ -0,0 +1,102 @@
+#pragma once
+#ifndef LAUNCH_TRACER_H
+#define LAUNCH_TRACER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+// 单调时钟毫秒数（Linux 上为 CLOCK_MONOTONIC）
+inline double MonotonicMs() {
+  return std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 一次启动的各阶段时间。entry 为绝对值，其余为相对 entry 的毫秒数，-1 表示未观测到
+struct LaunchTimeline {
+  double entry = 0.0;          // JS 调用进入
+  double lockAcquired = -1.0;  // 通过重复启动检查
+  double forked = -1.0;        // 开始 fork
+  double execSucceeded = -1.0; // exec 成功（状态管道 EOF）
+  double loaderDone = -1.0;    // 动态加载完成（/proc/<pid>/maps 稳定）
+  double firstOutput = -1.0;   // stdout/stderr 第一个字节（需要 captureOutput）
+  double firstCpuBurst = -1.0; // 第一次持续占用 CPU
+};
+
+enum class LaunchPhase {
+  LoaderDone,
+  FirstOutput,
+  FirstCpuBurst,
+};
+
+#ifdef __linux__
+
+// 启动后以较高频率轮询 /proc/<pid>/maps 与 schedstat，识别加载完成和首次 CPU 爆发。
+// 首次输出由 OutputCapture 记录
+class LaunchTracer {
+public:
+  static constexpr int kPollIntervalMs = 10;
+  static constexpr int kStablePolls = 5;             // maps 连续不变的轮询次数
+  static constexpr double kBurstWindowMs = 50.0;
+  static constexpr double kBurstRatio = 0.5;         // 窗口内至少占用半个核
+  static constexpr double kTraceTimeoutMs = 60000.0;
+
+  using PhaseSink = std::function<void(const std::string& appId, uint32_t processId, LaunchPhase phase, double offsetMs)>;
+
+  LaunchTracer();
+  ~LaunchTracer();
+
+  bool IsRunning() const { return epollFd_ >= 0; }
+  // 阶段回调在跟踪线程中调用，不持有内部锁
+  void SetSink(PhaseSink sink);
+
+  void Track(const std::string& appId, uint32_t processId, double entryMs);
+  // 停止轮询 /proc
+  void Untrack(uint32_t processId);
+
+private:
+  struct Trace {
+    std::string appId;
+    double entryMs = 0.0;
+    int mapsFd = -1;
+    int schedFd = -1;
+    bool schedstat = true;   // false 时 schedFd 指向 stat
+    bool loaderDone = false;
+    bool burstDone = false;
+    ssize_t mapsSize = -1;
+    double lastMapsChange = 0.0;
+    int stablePolls = 0;
+    double windowStart = 0.0;
+    uint64_t windowRuntime = 0;
+  };
+
+  struct PhaseEvent {
+    std::string appId;
+    uint32_t processId;
+    LaunchPhase phase;
+    double offsetMs;
+  };
+
+  std::map<uint32_t, Trace> traces_;
+  std::mutex mutex_;
+  std::thread thread_;
+  std::atomic<bool> stop_{ false };
+  int epollFd_ = -1;
+  int wakeFd_ = -1;
+  PhaseSink sink_;
+
+  void Run();
+  void Wake();
+  void PollTraces(std::vector<PhaseEvent>& events);
+  static void CloseTrace(Trace& trace);
+};
+
+#endif // __linux__
+
+#endif // LAUNCH_TRACER_H
@@ -0,0 +1,449 @@
+#include "output_capture.h"
+#include "launch_tracer.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int kMaxEvents = 16;
+
+bool WriteAll(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    ssize_t result = write(fd, data, size);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      return false;
+    }
+    data += result;
+    size -= static_cast<size_t>(result);
+  }
+  return true;
+}
+
+// 从 memfd 的 offset 处把 size 字节复制到 logFd，数据不经过用户态
+bool SendAll(int logFd, int ringFd, off_t offset, size_t size) {
+  while (size > 0) {
+    ssize_t result = sendfile(logFd, ringFd, &offset, size);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      return false;
+    }
+    size -= static_cast<size_t>(result);
+  }
+  return true;
+}
+
+} // namespace
+
+OutputCapture::Session::~Session() {
+  if (ring) {
+    munmap(ring, kRingCapacity);
+  }
+  if (ringFd >= 0) {
+    close(ringFd);
+  }
+  if (logFd >= 0) {
+    close(logFd);
+  }
+}
+
+OutputCapture::OutputCapture() {
+  epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+  wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (epollFd_ < 0 || wakeFd_ < 0) {
+    if (epollFd_ >= 0) {
+      close(epollFd_);
+      epollFd_ = -1;
+    }
+    return;
+  }
+
+  struct epoll_event event {};
+  event.events = EPOLLIN;
+  event.data.fd = wakeFd_;
+  epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &event);
+
+  thread_ = std::thread(&OutputCapture::Run, this);
+}
+
+OutputCapture::~OutputCapture() {
+  stop_ = true;
+  Wake();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+
+  for (auto& pair : pipes_) {
+    close(pair.first);
+  }
+  pipes_.clear();
+  sessions_.clear();
+  if (epollFd_ >= 0) {
+    close(epollFd_);
+  }
+  if (wakeFd_ >= 0) {
+    close(wakeFd_);
+  }
+}
+
+void OutputCapture::SetSink(FirstOutputSink sink) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  sink_ = std::move(sink);
+}
+
+void OutputCapture::SetLogDirectory(const std::string& directory, uint64_t maxBytes, uint32_t maxFiles) {
+  if (!directory.empty()) {
+    mkdir(directory.c_str(), 0755);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  logDirectory_ = directory;
+  maxLogBytes_ = maxBytes < 4096 ? 4096 : maxBytes;
+  maxLogFiles_ = maxFiles < 1 ? 1 : maxFiles;
+}
+
+void OutputCapture::Track(const std::string& appId, uint32_t processId, double entryMs, int stdoutFd, int stderrFd) {
+  if (!IsRunning() || (stdoutFd < 0 && stderrFd < 0)) {
+    if (stdoutFd >= 0) {
+      close(stdoutFd);
+    }
+    if (stderrFd >= 0) {
+      close(stderrFd);
+    }
+    return;
+  }
+
+  auto session = std::make_shared<Session>();
+  session->appId = appId;
+  session->processId = processId;
+  session->entryMs = entryMs;
+
+  // 缓冲区放在 memfd 中，既可以直接读写，也可以作为 sendfile 的源
+  session->ringFd = static_cast<int>(memfd_create("radish-output", MFD_CLOEXEC));
+  if (session->ringFd >= 0 && ftruncate(session->ringFd, kRingCapacity) == 0) {
+    void* ring = mmap(nullptr, kRingCapacity, PROT_READ | PROT_WRITE, MAP_SHARED, session->ringFd, 0);
+    session->ring = ring == MAP_FAILED ? nullptr : static_cast<char*>(ring);
+  }
+  if (!session->ring) {
+    if (session->ringFd >= 0) {
+      close(session->ringFd);
+      session->ringFd = -1;
+    }
+    void* ring = mmap(nullptr, kRingCapacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) {
+      if (stdoutFd >= 0) {
+        close(stdoutFd);
+      }
+      if (stderrFd >= 0) {
+        close(stderrFd);
+      }
+      return;
+    }
+    session->ring = static_cast<char*>(ring);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    session->logPath = LogBasePath(appId);
+    session->maxLogBytes = maxLogBytes_;
+    session->maxLogFiles = maxLogFiles_;
+  }
+  // 会话尚未发布，打开日志不需要持有锁
+  OpenLog(*session);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sessions_[appId] = session;
+
+    for (int fd : { stdoutFd, stderrFd }) {
+      if (fd < 0) {
+        continue;
+      }
+      // 读端非阻塞，Flush 可以读到管道为空为止；写端属于子进程，保持阻塞
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+      pipes_[fd] = session;
+      session->openPipes++;
+
+      struct epoll_event event {};
+      event.events = EPOLLIN;
+      event.data.fd = fd;
+      epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event);
+    }
+  }
+  Wake();
+}
+
+std::string OutputCapture::Tail(const std::string& appId, size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = sessions_.find(appId);
+  if (it == sessions_.end()) {
+    return "";
+  }
+
+  const Session& session = *it->second;
+  uint64_t limit = kRingCapacity - session.reading;
+  uint64_t available = session.written < limit ? session.written : limit;
+  size_t count = static_cast<size_t>(bytes < available ? bytes : available);
+  size_t start = static_cast<size_t>((session.written - count) % kRingCapacity);
+
+  std::string result;
+  result.reserve(count);
+  size_t first = count < kRingCapacity - start ? count : kRingCapacity - start;
+  result.append(session.ring + start, first);
+  result.append(session.ring, count - first);
+  return result;
+}
+
+void OutputCapture::Flush(const std::string& appId) {
+  std::shared_ptr<Session> session;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sessions_.find(appId);
+    if (it == sessions_.end()) {
+      return;
+    }
+    session = it->second;
+  }
+
+  // 持有 drainMutex 期间捕获线程不会关闭这些管道，fd 号不会被复用
+  std::lock_guard<std::mutex> drainLock(session->drainMutex);
+  std::vector<int> fds;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& pair : pipes_) {
+      if (pair.second == session) {
+        fds.push_back(pair.first);
+      }
+    }
+  }
+
+  // 其他后代进程可能仍在持续输出，读满一个缓冲区就停止，更早的数据反正会被覆盖。
+  // EOF 留给捕获线程处理：管道仍在 epoll 中，下一次 read 会再次返回 0
+  uint64_t start = session->written;
+  for (int fd : fds) {
+    bool first = false;
+    uint64_t before;
+    do {
+      before = session->written;
+    } while (Drain(fd, *session, first) && session->written != before && session->written - start < kRingCapacity);
+  }
+}
+
+void OutputCapture::Wake() {
+  if (wakeFd_ >= 0) {
+    uint64_t value = 1;
+    ssize_t ignored = write(wakeFd_, &value, sizeof(value));
+    (void)ignored;
+  }
+}
+
+void OutputCapture::Run() {
+  struct epoll_event events[kMaxEvents];
+
+  while (!stop_) {
+    int count = epoll_wait(epollFd_, events, kMaxEvents, -1);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+
+    struct FirstOutput {
+      std::string appId;
+      uint32_t processId;
+      double offsetMs;
+    };
+    std::vector<FirstOutput> firsts;
+    for (int i = 0; i < count; i++) {
+      int fd = events[i].data.fd;
+      if (fd == wakeFd_) {
+        uint64_t value;
+        ssize_t ignored = read(wakeFd_, &value, sizeof(value));
+        (void)ignored;
+        continue;
+      }
+
+      std::shared_ptr<Session> session;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pipes_.find(fd);
+        if (it == pipes_.end()) {
+          continue;
+        }
+        session = it->second;
+      }
+
+      std::lock_guard<std::mutex> drainLock(session->drainMutex);
+      bool first = false;
+      bool open = Drain(fd, *session, first);
+      if (first) {
+        firsts.push_back({ session->appId, session->processId, MonotonicMs() - session->entryMs });
+      }
+      if (!open) {
+        // EOF：所有持有写端的进程都已退出。先从表中移除再关闭，fd 号复用后不会误删
+        bool lastPipe;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          pipes_.erase(fd);
+          lastPipe = --session->openPipes == 0;
+        }
+        epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        if (lastPipe && session->logFd >= 0) {
+          close(session->logFd);
+          session->logFd = -1;
+        }
+      }
+    }
+
+    FirstOutputSink sink;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      sink = sink_;
+    }
+    if (sink) {
+      for (const auto& first : firsts) {
+        sink(first.appId, first.processId, first.offsetMs);
+      }
+    }
+  }
+}
+
+// 环形缓冲区只由持有 drainMutex 的一方写入。read 之前在锁内登记 reading，Tail 不会复制正被覆盖的最旧数据；
+// 读完后在锁内推进 written，日志从缓冲区已提交的区域写出
+bool OutputCapture::Drain(int fd, Session& session, bool& first) {
+  size_t position = static_cast<size_t>(session.written % kRingCapacity);
+  size_t chunk = kRingCapacity - position < kReadChunk ? kRingCapacity - position : kReadChunk;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    session.reading = chunk;
+  }
+
+  ssize_t bytes;
+  do {
+    bytes = read(fd, session.ring + position, chunk);
+  } while (bytes < 0 && errno == EINTR);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    session.reading = 0;
+    if (bytes > 0) {
+      session.written += static_cast<uint64_t>(bytes);
+    }
+  }
+  if (bytes < 0 && errno == EAGAIN) {
+    return true;
+  }
+  if (bytes <= 0) {
+    return false;
+  }
+
+  if (!session.firstSeen) {
+    session.firstSeen = true;
+    first = true;
+  }
+
+  if (session.logFd >= 0) {
+    if (session.logSize + static_cast<uint64_t>(bytes) > session.maxLogBytes) {
+      RotateLog(session);
+    }
+    if (session.logFd >= 0) {
+      bool ok = session.ringFd >= 0 && SendAll(session.logFd, session.ringFd, static_cast<off_t>(position), static_cast<size_t>(bytes));
+      if (!ok) {
+        ok = WriteAll(session.logFd, session.ring + position, static_cast<size_t>(bytes));
+      }
+      if (ok) {
+        session.logSize += static_cast<uint64_t>(bytes);
+      }
+    }
+  }
+  return true;
+}
+
+void OutputCapture::OpenLog(Session& session) {
+  if (session.logPath.empty()) {
+    return;
+  }
+
+  // sendfile 不支持 O_APPEND 的目标文件，打开后定位到末尾
+  std::string path = LogPath(session, 0);
+  session.logFd = open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+  if (session.logFd < 0) {
+    return;
+  }
+  off_t size = lseek(session.logFd, 0, SEEK_END);
+  session.logSize = size > 0 ? static_cast<uint64_t>(size) : 0;
+
+  char header[128];
+  time_t now = time(nullptr);
+  struct tm local;
+  localtime_r(&now, &local);
+  int length = snprintf(header, sizeof(header), "--- pid %u started %04d-%02d-%02dT%02d:%02d:%02d ---\n",
+                        session.processId, local.tm_year + 1900, local.tm_mon + 1, local.tm_mday,
+                        local.tm_hour, local.tm_min, local.tm_sec);
+  if (session.logSize + static_cast<uint64_t>(length) > session.maxLogBytes) {
+    RotateLog(session);
+  }
+  if (session.logFd >= 0 && WriteAll(session.logFd, header, static_cast<size_t>(length))) {
+    session.logSize += static_cast<uint64_t>(length);
+  }
+}
+
+void OutputCapture::RotateLog(Session& session) {
+  if (session.logFd >= 0) {
+    close(session.logFd);
+    session.logFd = -1;
+  }
+
+  // <appId>.log.<n-2> -> .log.<n-1>，...，<appId>.log -> .log.1，最旧的一份被覆盖
+  for (uint32_t index = session.maxLogFiles - 1; index > 0; index--) {
+    rename(LogPath(session, index - 1).c_str(), LogPath(session, index).c_str());
+  }
+
+  session.logFd = open(LogPath(session, 0).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  session.logSize = 0;
+}
+
+std::string OutputCapture::LogPath(const Session& session, uint32_t index) {
+  std::string path = session.logPath;
+  if (index > 0) {
+    path += "." + std::to_string(index);
+  }
+  return path;
+}
+
+// <directory>/<appId>.log，日志目录为空时返回空串。调用方需持有 mutex_
+std::string OutputCapture::LogBasePath(const std::string& appId) const {
+  if (logDirectory_.empty()) {
+    return "";
+  }
+
+  // appId 可能包含路径分隔符等字符，只保留安全字符
+  std::string name;
+  for (char c : appId) {
+    bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                c == '-' || c == '_' || c == '.';
+    name += safe ? c : '_';
+  }
+  if (name.empty() || name[0] == '.') {
+    name = "_" + name;
+  }
+
+  return logDirectory_ + "/" + name + ".log";
+}
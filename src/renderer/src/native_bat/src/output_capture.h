@@ -0,0 +1,104 @@
+#pragma once
+#ifndef OUTPUT_CAPTURE_H
+#define OUTPUT_CAPTURE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <functional>
+
+#ifdef __linux__
+
+// 接管子进程的 stdout/stderr：在 epoll 线程中读入每个会话固定大小的环形缓冲区，
+// 再用 sendfile 从缓冲区（memfd）写入按应用轮转的日志文件，数据不经过 JS。
+// 读管道、写日志和轮转都在锁外进行，mutex_ 只保护表和缓冲区的写入位置
+class OutputCapture {
+public:
+  static constexpr size_t kRingCapacity = 256 * 1024;
+  static constexpr size_t kReadChunk = 64 * 1024; // 单次 read 的上限
+  static constexpr uint64_t kDefaultMaxLogBytes = 8ull << 20;
+  static constexpr uint32_t kDefaultMaxLogFiles = 3;
+
+  // 第一个输出字节到达时调用（在捕获线程中，不持有内部锁）
+  using FirstOutputSink = std::function<void(const std::string& appId, uint32_t processId, double offsetMs)>;
+
+  OutputCapture();
+  ~OutputCapture();
+
+  bool IsRunning() const { return epollFd_ >= 0; }
+  void SetSink(FirstOutputSink sink);
+
+  // 日志写入 <directory>/<appId>.log，超过 maxBytes 时轮转为 .1 ~ .<maxFiles - 1>。
+  // directory 为空时只保留环形缓冲区。只影响之后开始的会话
+  void SetLogDirectory(const std::string& directory, uint64_t maxBytes, uint32_t maxFiles);
+
+  // stdoutFd/stderrFd 为子进程输出管道的读端（-1 表示未捕获），所有权转移给捕获器。
+  // 同一应用的上一次会话缓冲区被替换
+  void Track(const std::string& appId, uint32_t processId, double entryMs, int stdoutFd, int stderrFd);
+
+  // 最近 bytes 字节的输出（stdout 与 stderr 按到达顺序交错）。
+  // 正在读入的区域不返回，最多 kRingCapacity - kReadChunk
+  std::string Tail(const std::string& appId, size_t bytes);
+
+  // 在调用线程中读完该应用管道里已有的数据（至多 kRingCapacity 字节），之后的 Tail 包含进程退出前的最后输出。
+  // 会阻塞在管道读取上，调用方不应持有启动器的锁；不调用 FirstOutputSink
+  void Flush(const std::string& appId);
+
+private:
+  struct Session {
+    std::string appId;
+    uint32_t processId = 0;
+    double entryMs = 0.0;
+    bool firstSeen = false;
+    int ringFd = -1;          // memfd，不可用时为 -1，此时退回 write
+    char* ring = nullptr;
+    uint64_t written = 0;     // 累计写入字节，位置为 written % kRingCapacity，持有 drainMutex 时在 mutex_ 下更新
+    size_t reading = 0;       // 正在 read 的字节上限，这部分最旧的数据可能已被覆盖
+    int openPipes = 0;
+
+    // 持有者独占读取该会话的管道，并负责关闭到达 EOF 的管道。在 mutex_ 之前获取
+    std::mutex drainMutex;
+
+    // 以下只由持有 drainMutex 的一方访问（Track 在发布会话之前初始化）
+    std::string logPath;      // 为空时不写日志
+    uint64_t maxLogBytes = kDefaultMaxLogBytes;
+    uint32_t maxLogFiles = kDefaultMaxLogFiles;
+    int logFd = -1;
+    uint64_t logSize = 0;
+
+    Session() = default;
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+    ~Session(); // 释放缓冲区和日志文件
+  };
+
+  std::map<std::string, std::shared_ptr<Session>> sessions_; // appId -> 最近一次会话
+  std::map<int, std::shared_ptr<Session>> pipes_;            // 管道读端 -> 会话
+  std::mutex mutex_;
+  std::thread thread_;
+  std::atomic<bool> stop_{ false };
+  int epollFd_ = -1;
+  int wakeFd_ = -1;
+  std::string logDirectory_;
+  uint64_t maxLogBytes_ = kDefaultMaxLogBytes;
+  uint32_t maxLogFiles_ = kDefaultMaxLogFiles;
+  FirstOutputSink sink_;
+
+  void Run();
+  void Wake();
+  // 读取一次管道，返回 false 表示 EOF。调用方需持有 session.drainMutex，不能持有 mutex_
+  bool Drain(int fd, Session& session, bool& first);
+  static void OpenLog(Session& session);
+  static void RotateLog(Session& session);
+  static std::string LogPath(const Session& session, uint32_t index);
+  std::string LogBasePath(const std::string& appId) const;
+};
+
+#endif // __linux__
+
+#endif // OUTPUT_CAPTURE_H
@@ -0,0 +1,308 @@
+#include "process_sampler.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+int OpenProcFile(uint32_t processId, const char* name) {
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/%u/%s", processId, name);
+  return open(path, O_RDONLY | O_CLOEXEC);
+}
+
+// 复用已打开的 fd，从头重新读取 /proc 文件
+ssize_t ReadProcFile(int fd, char* buffer, size_t size) {
+  if (fd < 0) {
+    return -1;
+  }
+  ssize_t bytes = pread(fd, buffer, size - 1, 0);
+  if (bytes >= 0) {
+    buffer[bytes] = '\0';
+  }
+  return bytes;
+}
+
+double NowMs() {
+  return std::chrono::duration<double, std::milli>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// 读取符号链接目标，失败时返回空串
+std::string ReadProcLink(uint32_t processId, const char* name) {
+  char path[64];
+  char target[4096];
+  snprintf(path, sizeof(path), "/proc/%u/%s", processId, name);
+  ssize_t length = readlink(path, target, sizeof(target) - 1);
+  return length > 0 ? std::string(target, static_cast<size_t>(length)) : std::string();
+}
+
+const long kClockTicks = sysconf(_SC_CLK_TCK);
+const long kPageSize = sysconf(_SC_PAGESIZE);
+
+} // namespace
+
+ProcessSampler::ProcessSampler() {
+  thread_ = std::thread(&ProcessSampler::Run, this);
+}
+
+ProcessSampler::~ProcessSampler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& pair : sessions_) {
+    CloseSession(pair.second);
+  }
+}
+
+void ProcessSampler::Track(const std::string& appId, uint32_t processId, TreeResolver resolver) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Session& session = sessions_[appId];
+    CloseSession(session);
+
+    session.processId = processId;
+    session.resolver = std::move(resolver);
+    session.head = 0;
+    session.count = 0;
+    session.snapshot = ProcessSnapshot();
+    if (!OpenSession(session, processId)) {
+      return;
+    }
+  }
+  cv_.notify_all();
+}
+
+void ProcessSampler::Untrack(const std::string& appId, uint32_t processId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = sessions_.find(appId);
+  if (it == sessions_.end() || it->second.processId != processId) {
+    return;
+  }
+  CloseSession(it->second);
+  it->second.resolver = nullptr;
+}
+
+std::vector<ResourceSample> ProcessSampler::GetSeries(const std::string& appId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<ResourceSample> series;
+
+  auto it = sessions_.find(appId);
+  if (it == sessions_.end()) {
+    return series;
+  }
+
+  // 按时间顺序展开环形缓冲区
+  const Session& session = it->second;
+  series.reserve(session.count);
+  size_t start = (session.head + kSeriesCapacity - session.count) % kSeriesCapacity;
+  for (size_t i = 0; i < session.count; i++) {
+    series.push_back(session.samples[(start + i) % kSeriesCapacity]);
+  }
+  return series;
+}
+
+void ProcessSampler::SetInterval(uint32_t intervalMs) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    intervalMs_ = intervalMs < 100 ? 100 : intervalMs;
+  }
+  cv_.notify_all();
+}
+
+void ProcessSampler::SetCaptureSnapshot(bool enabled) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  captureSnapshot_ = enabled;
+}
+
+ProcessSnapshot ProcessSampler::GetSnapshot(const std::string& appId, uint32_t processId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = sessions_.find(appId);
+  if (it == sessions_.end() || it->second.processId != processId) {
+    return ProcessSnapshot();
+  }
+  return it->second.snapshot;
+}
+
+void ProcessSampler::SetSink(SampleSink sink) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  sink_ = std::move(sink);
+}
+
+void ProcessSampler::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_) {
+    // 没有跟踪的进程时不唤醒
+    if (activeCount_ == 0) {
+      cv_.wait(lock, [this] { return stop_ || activeCount_ > 0; });
+      continue;
+    }
+
+    cv_.wait_for(lock, std::chrono::milliseconds(intervalMs_));
+    if (stop_) {
+      break;
+    }
+    SampleAll();
+  }
+}
+
+// 调用方需持有 mutex_
+void ProcessSampler::SampleAll() {
+  double now = NowMs();
+  for (auto& pair : sessions_) {
+    Session& session = pair.second;
+    if (session.statFd < 0) {
+      continue;
+    }
+    if (!SampleSession(session, now)) {
+      // 进程已被回收；树中还有其他进程时改为采样它，下一次采样起接续序列
+      CloseSession(session);
+      uint32_t next = session.resolver ? session.resolver(session.targetProcessId) : 0;
+      if (next != 0) {
+        OpenSession(session, next);
+      }
+      continue;
+    }
+    if (sink_) {
+      const Session& sampled = session;
+      size_t last = (sampled.head + kSeriesCapacity - 1) % kSeriesCapacity;
+      sink_(pair.first, sampled.processId, sampled.samples[last]);
+    }
+  }
+}
+
+bool ProcessSampler::SampleSession(Session& session, double now) {
+  char buffer[1024];
+
+  if (ReadProcFile(session.statFd, buffer, sizeof(buffer)) <= 0) {
+    return false;
+  }
+
+  // comm 字段可能包含空格和括号，从最后一个 ')' 之后开始解析
+  const char* fields = strrchr(buffer, ')');
+  if (!fields) {
+    return false;
+  }
+  unsigned long utime = 0, stime = 0;
+  if (sscanf(fields + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime) != 2) {
+    return false;
+  }
+
+  // 进程名在 stat 中位于第一个 '(' 与最后一个 ')' 之间，buffer 随后会被复用
+  std::string comm;
+  if (session.mapsFd >= 0) {
+    const char* open = strchr(buffer, '(');
+    if (open && open < fields) {
+      comm.assign(open + 1, fields);
+    }
+  }
+
+  ResourceSample sample;
+  sample.timestamp = now;
+
+  uint64_t cpuTicks = utime + stime;
+  if (session.lastTimestamp > 0.0 && now > session.lastTimestamp) {
+    double cpuSeconds = static_cast<double>(cpuTicks - session.lastCpuTicks) / kClockTicks;
+    sample.cpuPercent = cpuSeconds * 100000.0 / (now - session.lastTimestamp);
+  }
+  session.lastCpuTicks = cpuTicks;
+  session.lastTimestamp = now;
+
+  if (ReadProcFile(session.statmFd, buffer, sizeof(buffer)) > 0) {
+    unsigned long size = 0, resident = 0;
+    if (sscanf(buffer, "%lu %lu", &size, &resident) == 2) {
+      sample.rss = static_cast<double>(resident) * kPageSize;
+    }
+  }
+
+  // /proc/<pid>/io 可能因权限不可读
+  if (ReadProcFile(session.ioFd, buffer, sizeof(buffer)) > 0) {
+    const char* readBytes = strstr(buffer, "read_bytes:");
+    const char* writeBytes = strstr(buffer, "\nwrite_bytes:");
+    if (readBytes) {
+      sample.readBytes = strtod(readBytes + 11, nullptr);
+    }
+    if (writeBytes) {
+      sample.writeBytes = strtod(writeBytes + 13, nullptr);
+    }
+  }
+
+  if (session.mapsFd >= 0) {
+    CaptureSnapshot(session, comm, now);
+  }
+
+  session.samples[session.head] = sample;
+  session.head = (session.head + 1) % kSeriesCapacity;
+  if (session.count < kSeriesCapacity) {
+    session.count++;
+  }
+  return true;
+}
+
+void ProcessSampler::CaptureSnapshot(Session& session, const std::string& comm, double now) {
+  ProcessSnapshot& snapshot = session.snapshot;
+  snapshot.timestamp = now;
+  snapshot.comm = comm;
+  // exe 和 cwd 在进程生命周期内很少变化，只在首次快照时读取
+  if (snapshot.executable.empty()) {
+    snapshot.executable = ReadProcLink(session.processId, "exe");
+    snapshot.cwd = ReadProcLink(session.processId, "cwd");
+  }
+
+  // maps 由 seq_file 生成，需从头顺序读取；clear 保留已有容量，超过上限时截断
+  snapshot.maps.clear();
+  if (lseek(session.mapsFd, 0, SEEK_SET) != 0) {
+    return;
+  }
+  char chunk[16384];
+  while (snapshot.maps.size() < kMaxMapsBytes) {
+    ssize_t bytes = read(session.mapsFd, chunk, sizeof(chunk));
+    if (bytes <= 0) {
+      break;
+    }
+    size_t count = static_cast<size_t>(bytes);
+    snapshot.maps.append(chunk, count < kMaxMapsBytes - snapshot.maps.size() ? count : kMaxMapsBytes - snapshot.maps.size());
+  }
+}
+
+// 调用方需持有 mutex_
+bool ProcessSampler::OpenSession(Session& session, uint32_t processId) {
+  session.statFd = OpenProcFile(processId, "stat");
+  if (session.statFd < 0) {
+    return false;
+  }
+  session.statmFd = OpenProcFile(processId, "statm");
+  session.ioFd = OpenProcFile(processId, "io");
+  if (captureSnapshot_) {
+    session.mapsFd = OpenProcFile(processId, "maps");
+  }
+  session.targetProcessId = processId;
+  session.lastCpuTicks = 0;
+  session.lastTimestamp = 0.0;
+  activeCount_++;
+  return true;
+}
+
+void ProcessSampler::CloseSession(Session& session) {
+  if (session.statFd < 0) {
+    return;
+  }
+  close(session.statFd);
+  if (session.statmFd >= 0) close(session.statmFd);
+  if (session.ioFd >= 0) close(session.ioFd);
+  if (session.mapsFd >= 0) close(session.mapsFd);
+  session.statFd = session.statmFd = session.ioFd = session.mapsFd = -1;
+  activeCount_--;
+}
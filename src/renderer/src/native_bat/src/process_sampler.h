@@ -0,0 +1,105 @@
+#pragma once
+#ifndef PROCESS_SAMPLER_H
+#define PROCESS_SAMPLER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+
+// 单次资源采样
+struct ResourceSample {
+  double timestamp = 0.0;  // 采样时间（Unix 毫秒）
+  double cpuPercent = 0.0; // 相对单核的 CPU 占用
+  double rss = 0.0;        // 常驻内存（字节）
+  double readBytes = 0.0;  // 累计读盘字节
+  double writeBytes = 0.0; // 累计写盘字节
+};
+
+// 最后一次采样时的进程状态，用于崩溃报告
+struct ProcessSnapshot {
+  double timestamp = 0.0;  // 采样时间（Unix 毫秒），0 表示没有快照
+  std::string comm;        // 进程名（/proc/<pid>/stat）
+  std::string executable;  // /proc/<pid>/exe
+  std::string cwd;         // /proc/<pid>/cwd
+  std::string maps;        // /proc/<pid>/maps，最多 kMaxMapsBytes
+};
+
+#ifdef __linux__
+
+// 周期性读取 /proc/<pid>/{stat,statm,io}，每个会话保存固定长度的环形缓冲区
+class ProcessSampler {
+public:
+  static constexpr size_t kSeriesCapacity = 1024;
+  static constexpr uint32_t kDefaultIntervalMs = 1000;
+  static constexpr size_t kMaxMapsBytes = 1 << 20;
+
+  // 被采样的进程退出后返回进程树中另一个仍存活的进程（不能是参数中已退出的进程），没有时返回 0
+  using TreeResolver = std::function<uint32_t(uint32_t exitedProcessId)>;
+
+  ProcessSampler();
+  ~ProcessSampler();
+
+  // processId 为会话的根进程。根进程先于后代退出时通过 resolver 改为采样树中仍存活的进程，
+  // 序列继续写入同一会话
+  void Track(const std::string& appId, uint32_t processId, TreeResolver resolver = nullptr);
+  // 停止采样并关闭文件，已有序列保留到下一次启动
+  void Untrack(const std::string& appId, uint32_t processId);
+
+  std::vector<ResourceSample> GetSeries(const std::string& appId);
+  void SetInterval(uint32_t intervalMs);
+
+  // 每次采样时一并保存进程快照（/proc/<pid>/maps 等），默认关闭
+  void SetCaptureSnapshot(bool enabled);
+  // 最后一次采样时的快照，进程退出后保留到下一次启动
+  ProcessSnapshot GetSnapshot(const std::string& appId, uint32_t processId);
+
+  // 每次采样后回调（在采样线程中调用）
+  using SampleSink = std::function<void(const std::string& appId, uint32_t processId, const ResourceSample& sample)>;
+  void SetSink(SampleSink sink);
+
+private:
+  struct Session {
+    uint32_t processId = 0;        // 根进程
+    uint32_t targetProcessId = 0;  // 当前采样的进程
+    TreeResolver resolver;
+    int statFd = -1;
+    int statmFd = -1;
+    int ioFd = -1;
+    int mapsFd = -1;
+    uint64_t lastCpuTicks = 0;
+    double lastTimestamp = 0.0;
+
+    ResourceSample samples[kSeriesCapacity];
+    size_t head = 0;  // 下一个写入位置
+    size_t count = 0;
+
+    ProcessSnapshot snapshot;
+  };
+
+  std::map<std::string, Session> sessions_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread thread_;
+  std::atomic<bool> stop_{ false };
+  uint32_t intervalMs_ = kDefaultIntervalMs;
+  size_t activeCount_ = 0;
+  bool captureSnapshot_ = false;
+  SampleSink sink_;
+
+  void Run();
+  void SampleAll();
+  static bool SampleSession(Session& session, double now);
+  static void CaptureSnapshot(Session& session, const std::string& comm, double now);
+  bool OpenSession(Session& session, uint32_t processId);
+  void CloseSession(Session& session);
+};
+
+#endif // __linux__
+
+#endif // PROCESS_SAMPLER_H
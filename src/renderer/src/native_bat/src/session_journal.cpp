@@ -0,0 +1,347 @@
+#define _CRT_SECURE_NO_WARNINGS 1
+#include "session_journal.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kMagic[8] = { 'R', 'G', 'T', 'J', 'R', 'N', 'L', '1' };
+constexpr uint32_t kVersion = 1;
+
+// CRC32 (IEEE 802.3)
+uint32_t Crc32(const void* data, size_t size) {
+  static const struct Table {
+    uint32_t entries[256];
+    Table() {
+      for (uint32_t i = 0; i < 256; i++) {
+        uint32_t value = i;
+        for (int bit = 0; bit < 8; bit++) {
+          value = (value & 1) ? (0xEDB88320u ^ (value >> 1)) : (value >> 1);
+        }
+        entries[i] = value;
+      }
+    }
+  } table;
+
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < size; i++) {
+    crc = table.entries[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return crc ^ 0xFFFFFFFFu;
+}
+
+uint32_t RecordChecksum(const JournalRecord& record) {
+  return Crc32(&record, offsetof(JournalRecord, checksum));
+}
+
+} // namespace
+
+SessionJournal::SessionJournal() {
+}
+
+SessionJournal::~SessionJournal() {
+  Close();
+}
+
+// Open/Close 由同一线程调用；映射和游标在 mutex_ 下修改，与监控、采样线程的 Append 互斥
+bool SessionJournal::Open(const std::string& path, int syncIntervalMs, std::string& errorMsg) {
+  Close();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  bool created = false;
+  size_t defaultSize = kRecordsOffset + kDefaultCapacity * sizeof(JournalRecord);
+  if (!MapFile(path, defaultSize, created, errorMsg)) {
+    return false;
+  }
+
+  header_ = reinterpret_cast<Header*>(data_);
+  bool valid = !created &&
+    memcmp(header_->magic, kMagic, sizeof(kMagic)) == 0 &&
+    header_->version == kVersion &&
+    header_->recordSize == sizeof(JournalRecord) &&
+    header_->capacity > 0 &&
+    kRecordsOffset + header_->capacity * sizeof(JournalRecord) <= mappedSize_;
+
+  if (!valid) {
+    // 新文件或无法识别的文件，重新初始化
+    memset(data_, 0, mappedSize_);
+    memcpy(header_->magic, kMagic, sizeof(kMagic));
+    header_->version = kVersion;
+    header_->recordSize = sizeof(JournalRecord);
+    header_->capacity = (mappedSize_ - kRecordsOffset) / sizeof(JournalRecord);
+    header_->ackedSequence = 0;
+  }
+
+  capacity_ = header_->capacity;
+  Recover();
+
+  syncIntervalMs_ = syncIntervalMs;
+  stopFlush_ = false;
+  dirty_ = !valid;
+  open_.store(true, std::memory_order_release);
+  lock.unlock();
+
+  flushThread_ = std::thread(&SessionJournal::FlushLoop, this);
+  return true;
+}
+
+void SessionJournal::Close() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!data_) {
+      return;
+    }
+    open_.store(false, std::memory_order_release);
+    stopFlush_ = true;
+  }
+  cv_.notify_all();
+  if (flushThread_.joinable()) {
+    flushThread_.join();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (syncIntervalMs_ >= 0) {
+    SyncToDisk();
+  }
+  UnmapFile();
+  header_ = nullptr;
+  capacity_ = 0;
+  nextSequence_ = 1;
+}
+
+bool SessionJournal::Append(JournalRecord record) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!data_) {
+    return false;
+  }
+
+  if (nextSequence_ - header_->ackedSequence > capacity_) {
+    dropped_++;
+    return false;
+  }
+
+  record.sequence = nextSequence_++;
+  record.checksum = RecordChecksum(record);
+  memcpy(Slot(record.sequence), &record, sizeof(record));
+
+  dirty_ = true;
+  cv_.notify_one();
+  return true;
+}
+
+std::vector<JournalRecord> SessionJournal::Drain(size_t maxRecords) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<JournalRecord> records;
+  if (!data_) {
+    return records;
+  }
+
+  uint64_t first = header_->ackedSequence + 1;
+  uint64_t pending = nextSequence_ - first;
+  size_t count = pending < maxRecords ? static_cast<size_t>(pending) : maxRecords;
+
+  records.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    records.push_back(*Slot(first + i));
+  }
+  return records;
+}
+
+void SessionJournal::Acknowledge(uint64_t sequence) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!data_ || sequence <= header_->ackedSequence) {
+    return;
+  }
+  if (sequence >= nextSequence_) {
+    sequence = nextSequence_ - 1;
+  }
+
+  header_->ackedSequence = sequence;
+  dirty_ = true;
+  cv_.notify_one();
+}
+
+void SessionJournal::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!data_) {
+    return;
+  }
+
+  uint64_t request = ++flushRequests_;
+  cv_.notify_one();
+  flushedCv_.wait(lock, [this, request] { return flushedRequests_ >= request || stopFlush_; });
+}
+
+JournalRecord* SessionJournal::Slot(uint64_t sequence) {
+  size_t index = static_cast<size_t>((sequence - 1) % capacity_);
+  return reinterpret_cast<JournalRecord*>(data_ + kRecordsOffset + index * sizeof(JournalRecord));
+}
+
+// 从已确认位置向后扫描，序号连续且校验通过的记录视为有效；
+// 崩溃时写了一半的记录校验失败，从该处截断
+void SessionJournal::Recover() {
+  uint64_t sequence = header_->ackedSequence + 1;
+  while (sequence - header_->ackedSequence <= capacity_) {
+    const JournalRecord* record = Slot(sequence);
+    if (record->sequence != sequence || record->checksum != RecordChecksum(*record)) {
+      break;
+    }
+    sequence++;
+  }
+  nextSequence_ = sequence;
+}
+
+void SessionJournal::FlushLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopFlush_) {
+    cv_.wait(lock, [this] {
+      return stopFlush_ || (dirty_ && syncIntervalMs_ >= 0) || flushRequests_ != flushedRequests_;
+    });
+    if (stopFlush_) {
+      break;
+    }
+
+    // 组提交：在时间窗口内合并多次写入，只落盘一次
+    if (flushRequests_ == flushedRequests_ && syncIntervalMs_ > 0) {
+      cv_.wait_for(lock, std::chrono::milliseconds(syncIntervalMs_), [this] {
+        return stopFlush_ || flushRequests_ != flushedRequests_;
+      });
+    }
+
+    uint64_t request = flushRequests_;
+    dirty_ = false;
+    lock.unlock();
+    SyncToDisk();
+    lock.lock();
+
+    flushedRequests_ = request;
+    flushedCv_.notify_all();
+  }
+  flushedCv_.notify_all();
+}
+
+void SessionJournal::SyncToDisk() {
+#ifdef _WIN32
+  FlushViewOfFile(data_, 0);
+  FlushFileBuffers(static_cast<HANDLE>(fileHandle_));
+#else
+  msync(data_, mappedSize_, MS_SYNC);
+#endif
+}
+
+#ifdef _WIN32
+
+bool SessionJournal::MapFile(const std::string& path, size_t size, bool& created, std::string& errorMsg) {
+  int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, NULL, 0);
+  std::wstring widePath(length, 0);
+  MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &widePath[0], length);
+
+  HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                            NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    errorMsg = "Failed to open journal. Error code: " + std::to_string(GetLastError());
+    return false;
+  }
+
+  LARGE_INTEGER fileSize;
+  GetFileSizeEx(file, &fileSize);
+  created = fileSize.QuadPart == 0;
+  if (static_cast<size_t>(fileSize.QuadPart) > size) {
+    size = static_cast<size_t>(fileSize.QuadPart);
+  }
+
+  HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READWRITE,
+                                      static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+                                      static_cast<DWORD>(size & 0xFFFFFFFF), NULL);
+  if (!mapping) {
+    errorMsg = "Failed to map journal. Error code: " + std::to_string(GetLastError());
+    CloseHandle(file);
+    return false;
+  }
+
+  void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+  if (!view) {
+    errorMsg = "Failed to map journal. Error code: " + std::to_string(GetLastError());
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+
+  fileHandle_ = file;
+  mappingHandle_ = mapping;
+  data_ = static_cast<uint8_t*>(view);
+  mappedSize_ = size;
+  return true;
+}
+
+void SessionJournal::UnmapFile() {
+  UnmapViewOfFile(data_);
+  CloseHandle(static_cast<HANDLE>(mappingHandle_));
+  CloseHandle(static_cast<HANDLE>(fileHandle_));
+  data_ = nullptr;
+  mappingHandle_ = nullptr;
+  fileHandle_ = nullptr;
+  mappedSize_ = 0;
+}
+
+#else
+
+bool SessionJournal::MapFile(const std::string& path, size_t size, bool& created, std::string& errorMsg) {
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    errorMsg = "Failed to open journal: " + std::string(strerror(errno));
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    errorMsg = "Failed to stat journal: " + std::string(strerror(errno));
+    close(fd);
+    return false;
+  }
+
+  created = st.st_size == 0;
+  if (static_cast<size_t>(st.st_size) > size) {
+    size = static_cast<size_t>(st.st_size);
+  }
+  else if (static_cast<size_t>(st.st_size) < size && ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    errorMsg = "Failed to resize journal: " + std::string(strerror(errno));
+    close(fd);
+    return false;
+  }
+
+  void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    errorMsg = "Failed to map journal: " + std::string(strerror(errno));
+    close(fd);
+    return false;
+  }
+
+  fd_ = fd;
+  data_ = static_cast<uint8_t*>(addr);
+  mappedSize_ = size;
+  return true;
+}
+
+void SessionJournal::UnmapFile() {
+  munmap(data_, mappedSize_);
+  close(fd_);
+  data_ = nullptr;
+  fd_ = -1;
+  mappedSize_ = 0;
+}
+
+#endif
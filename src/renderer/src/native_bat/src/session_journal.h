@@ -0,0 +1,107 @@
+#pragma once
+#ifndef SESSION_JOURNAL_H
+#define SESSION_JOURNAL_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+enum class JournalEventType : uint32_t {
+  Launch = 1,
+  Exit = 2,
+  Sample = 3,
+};
+
+// 定长日志记录（256 字节），checksum 为前面所有字节的 CRC32
+struct JournalRecord {
+  uint64_t sequence = 0;    // 从 1 开始单调递增
+  uint32_t type = 0;        // JournalEventType
+  uint32_t processId = 0;
+  double timestamp = 0.0;   // 事件时间（Unix 毫秒）
+  double startTime = 0.0;   // 会话开始时间（Unix 毫秒），与 appId、processId 一起标识会话
+  int32_t exitCode = 0;
+  int32_t exitSignal = 0;
+  double values[4] = {};    // Exit: duration, userCpuTime, systemCpuTime, maxRss
+                            // Sample: cpuPercent, rss, readBytes, writeBytes
+  uint32_t status = 0;      // Exit: 1 completed, 2 crashed
+  char appId[176] = {};
+  uint32_t checksum = 0;
+};
+
+static_assert(sizeof(JournalRecord) == 256, "JournalRecord must stay 256 bytes");
+
+// mmap 的追加式会话日志。记录写入映射内存后即可在进程崩溃后恢复；
+// 落盘由后台线程按组提交策略统一 msync。读取方先 Drain，提交到数据库后再 Acknowledge，
+// 未确认的记录在下次打开时仍会被返回
+class SessionJournal {
+public:
+  static constexpr uint64_t kDefaultCapacity = 8192;
+
+  SessionJournal();
+  ~SessionJournal();
+
+  // syncIntervalMs: < 0 不主动落盘，0 尽快落盘，> 0 按该时间窗口合并落盘
+  bool Open(const std::string& path, int syncIntervalMs, std::string& errorMsg);
+  void Close();
+  bool IsOpen() const { return open_.load(std::memory_order_acquire); }
+
+  // 日志已满（读取方长期未确认）时返回 false 并计入 dropped
+  bool Append(JournalRecord record);
+
+  std::vector<JournalRecord> Drain(size_t maxRecords);
+  void Acknowledge(uint64_t sequence);
+  // 立即落盘并等待完成
+  void Flush();
+
+  uint64_t DroppedCount() const { return dropped_; }
+
+private:
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t capacity;
+    uint64_t ackedSequence;
+    uint8_t reserved[32];
+  };
+
+  static constexpr size_t kRecordsOffset = 4096;
+
+  Header* header_ = nullptr;
+  uint8_t* data_ = nullptr;
+  size_t mappedSize_ = 0;
+  uint64_t capacity_ = 0;
+  uint64_t nextSequence_ = 1;
+  std::atomic<uint64_t> dropped_{ 0 };
+  std::atomic<bool> open_{ false };
+
+#ifdef _WIN32
+  void* fileHandle_ = nullptr;
+  void* mappingHandle_ = nullptr;
+#else
+  int fd_ = -1;
+#endif
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable flushedCv_;
+  std::thread flushThread_;
+  bool stopFlush_ = false;
+  bool dirty_ = false;
+  uint64_t flushRequests_ = 0;
+  uint64_t flushedRequests_ = 0;
+  int syncIntervalMs_ = -1;
+
+  JournalRecord* Slot(uint64_t sequence);
+  void Recover();
+  void FlushLoop();
+  void SyncToDisk();
+  bool MapFile(const std::string& path, size_t size, bool& created, std::string& errorMsg);
+  void UnmapFile();
+};
+
+#endif // SESSION_JOURNAL_H